@@ -0,0 +1,1035 @@
+#pragma once
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <stack>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "symbolTable.cpp"
+#include "sourceStream.cpp"
+#include "trace.cpp"
+
+class TypeContext
+{
+public:
+    enum class Context
+    {
+        GLOBAL,
+        DECLARATIONS,
+        FUNCTIONS,
+        FUNCTION_PARAMS,
+        VARIABLE_DECL,
+        ARRAY_DECL,
+        FUNCTION_DECL
+    };
+
+    explicit TypeContext(int maxDepth = AnalysisLimits().maxNestingDepth,
+                         std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : contextStack_(std::pmr::deque<Context>(resource)), maxDepth_(maxDepth)
+    {
+        contextStack_.push(Context::GLOBAL);
+    }
+
+    void pushContext(Context ctx)
+    {
+        if ((int)contextStack_.size() >= maxDepth_)
+            throw std::runtime_error("Erro: limite de " + std::to_string(maxDepth_) +
+                                     " contextos aninhados excedido");
+        contextStack_.push(ctx);
+    }
+
+    void popContext()
+    {
+        if (contextStack_.size() > 1)
+        {
+            contextStack_.pop();
+        }
+    }
+
+    Context currentContext() const
+    {
+        return contextStack_.top();
+    }
+
+    static std::string mapTypeToCode(TokenType type, bool isArray = false)
+    {
+        if (isArray)
+        {
+            switch (type)
+            {
+            case TokenType::REAL:
+                return "AF";
+            case TokenType::INTEGER:
+                return "AI";
+            case TokenType::STRING:
+                return "AS";
+            case TokenType::CHARACTER:
+                return "AC";
+            case TokenType::BOOLEAN:
+                return "AB";
+            default:
+                return "";
+            }
+        }
+
+        switch (type)
+        {
+        case TokenType::REAL:
+            return "FP";
+        case TokenType::INTEGER:
+            return "IN";
+        case TokenType::STRING:
+            return "ST";
+        case TokenType::CHARACTER:
+            return "CH";
+        case TokenType::BOOLEAN:
+            return "BL";
+        case TokenType::VOID:
+            return "VD";
+        default:
+            return "";
+        }
+    }
+
+private:
+    std::stack<Context, std::pmr::deque<Context>> contextStack_;
+    int maxDepth_;
+};
+
+// Trabalho realizado pela análise (preenchido mesmo quando ela termina com erro)
+struct AnalysisStats
+{
+    size_t tokensRead = 0;   // inclui releituras após putBackToken
+    size_t bytesScanned = 0; // posição alcançada no texto
+};
+
+// A linha de `tok` só é calculada quando o limite é excedido
+template <typename TokenSource>
+void checkNestingDepth(int depth, const TokenSource &lexer, const Token &tok, const AnalysisLimits &limits)
+{
+    if (depth > limits.maxNestingDepth)
+        throw std::runtime_error("Erro na linha " + std::to_string(lexer.lineOf(tok)) + ": limite de " +
+                                 std::to_string(limits.maxNestingDepth) + " niveis de aninhamento excedido");
+}
+
+// Destino dos efeitos da análise de uma função: símbolos dos parâmetros,
+// registros do .LEX e referências do corpo
+struct SymbolTableSink
+{
+    SymbolTable &symtab;
+    LexemeList &lexemes;
+
+    void define(const Token &tok)
+    {
+        symtab.defineOrGet(tok.lexeme, tok.offset, TokenType::IDENT);
+    }
+
+    void setArraySize(const Token &tok, int size)
+    {
+        symtab.setArraySize(tok.lexeme, size);
+    }
+
+    void setType(const Token &tok, const std::string &code)
+    {
+        symtab.setType(tok.lexeme, code);
+    }
+
+    // Registro do .LEX; `indexed` quando o lexema pode estar na tabela
+    void record(const Token &tok, bool indexed)
+    {
+        LexemeRecord record(lexemes.get_allocator());
+        record.type = tok.type;
+        record.lexeme = tok.lexeme;
+        record.tableIndex = indexed ? symtab.getIndex(tok.lexeme) : -1;
+        record.offset = tok.offset;
+        lexemes.push_back(std::move(record));
+    }
+
+    void reference(const Token &tok)
+    {
+        symtab.noteReference(tok.lexeme, tok.offset);
+    }
+
+    std::pmr::memory_resource *memoryResource() const
+    {
+        return symtab.memoryResource();
+    }
+};
+
+// Verificação sem relatórios (--check): a análise só valida o fonte, sem
+// tabela de símbolos nem registros do .LEX. Os lexemas usam o alocador
+// padrão e são liberados a cada token, então a memória não cresce com o
+// tamanho do fonte.
+struct CheckOnlySink
+{
+    void define(const Token &) {}
+    void setArraySize(const Token &, int) {}
+    void setType(const Token &, const std::string &) {}
+    void record(const Token &, bool) {}
+    void reference(const Token &) {}
+
+    std::pmr::memory_resource *memoryResource() const
+    {
+        return std::pmr::get_default_resource();
+    }
+};
+
+// Declaração de função, de FUNCTYPE (`tok`, já lido) até ENDFUNCTION:
+// parâmetros, tokens antes do corpo e referências no corpo vão para `sink`
+template <typename TokenSource, typename Sink>
+void analyzeFunction(TokenSource &lexer, const Token &tok, Sink &sink, const AnalysisLimits &limits)
+{
+    // Espera um tipo válido após FUNCTYPE
+    Token typeTok = lexer.nextToken();
+    if (typeTok.type != TokenType::REAL && typeTok.type != TokenType::INTEGER && typeTok.type != TokenType::STRING && typeTok.type != TokenType::BOOLEAN && typeTok.type != TokenType::CHARACTER && typeTok.type != TokenType::VOID) {
+        throw std::runtime_error("Erro: FUNCTYPE deve ser seguido de um tipo valido (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+    }
+    // Espera ':' após o tipo
+    Token colonTok = lexer.nextToken();
+    if (colonTok.type != TokenType::COLON) {
+        throw std::runtime_error("Erro: Esperado ':' apos o tipo na declaracao de funcao (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+    }
+    // Processa o nome da função, parâmetros e corpo
+    Token nextTok = lexer.nextToken();
+    do {
+        nextTok = lexer.nextToken();
+    } while (nextTok.type != TokenType::LPAREN && nextTok.type != TokenType::END_OF_FILE && nextTok.type != TokenType::ENDFUNCTIONS && nextTok.type != TokenType::LBRACE);
+    if (nextTok.type == TokenType::LPAREN) {
+        // Processa parâmetros seguindo a BNF: <Parameters> ::= <ParamTypeList> | "?"
+        Token paramStartTok = lexer.nextToken();
+        if (paramStartTok.type == TokenType::QUESTION) {
+            // Parâmetros vazios (?)
+            sink.record(paramStartTok, false);
+        } else {
+            // Processa lista de parâmetros
+            lexer.putBackToken(paramStartTok);
+            
+            while (true) {
+                Token paramTok = lexer.nextToken();
+                if (paramTok.type == TokenType::RPAREN) {
+                    lexer.putBackToken(paramTok);
+                    break;
+                }
+                if (paramTok.type == TokenType::PARAMTYPE) {
+                    // Espera tipo do parâmetro
+                    Token paramTypeTok = lexer.nextToken();
+                    TokenType paramType = paramTypeTok.type;
+                    
+                    // Verifica se é um tipo válido
+                    if (paramTypeTok.type != TokenType::REAL && paramTypeTok.type != TokenType::INTEGER && 
+                        paramTypeTok.type != TokenType::STRING && paramTypeTok.type != TokenType::BOOLEAN && 
+                        paramTypeTok.type != TokenType::CHARACTER && paramTypeTok.type != TokenType::VOID) {
+                        throw std::runtime_error("Erro: Tipo invalido para parametro (linha " + std::to_string(lexer.lineOf(paramTypeTok)) + ")");
+                    }
+                   
+                    // Espera ':'
+                    Token paramColonTok = lexer.nextToken();
+                    if (paramColonTok.type != TokenType::COLON) {
+                        throw std::runtime_error("Erro: Esperado ':' apos o tipo do parametro (linha " + std::to_string(lexer.lineOf(paramTypeTok)) + ")");
+                    }
+                    
+                    // Processa lista de parâmetros
+                    while (true) {
+                        Token paramIdentTok = lexer.nextToken();
+                        if (paramIdentTok.type == TokenType::IDENT) {
+                    
+                            sink.define(paramIdentTok);
+                            
+                            // Verifica se é array
+                            Token nextParamTok = lexer.nextToken();
+                            
+                            bool isParamArray = false;
+                            
+                            if (nextParamTok.type == TokenType::LBRACK) {
+                                Token sizeTok = lexer.nextToken();
+                                
+                                if (sizeTok.type != TokenType::INTCONST) {
+                                    throw std::runtime_error("Erro: Tamanho do array deve ser constante inteira (linha " + std::to_string(lexer.lineOf(sizeTok)) + ")");
+                                }
+                                Token rbrack = lexer.nextToken();
+                                
+                                if (rbrack.type != TokenType::RBRACK) {
+                                    throw std::runtime_error("Erro: Esperado ']' apos tamanho do array (linha " + std::to_string(lexer.lineOf(sizeTok)) + ")");
+                                }
+                                
+                                // Registra a extensão declarada do array
+                                sink.setArraySize(paramIdentTok, SymbolTable::parseArraySize(sizeTok.lexeme));
+                                isParamArray = true;
+                            } else {
+                                lexer.putBackToken(nextParamTok);
+                            }
+                            
+                            // Define o tipo correto do parâmetro na tabela de símbolos
+                            std::string typeCode = TypeContext::mapTypeToCode(paramType, isParamArray);
+                            sink.setType(paramIdentTok, typeCode);
+                            
+                            sink.record(paramIdentTok, true);
+                        } else if (paramIdentTok.type == TokenType::COMMA) {
+                            continue;
+                        } else if (paramIdentTok.type == TokenType::SEMI) {
+                            // Fim deste grupo de parâmetros, continua para o próximo grupo
+                            break;
+                        } else if (paramIdentTok.type == TokenType::RPAREN) {
+                            // Fim de todos os parâmetros
+                            lexer.putBackToken(paramIdentTok);
+                            break;
+                        } else {
+                            // Se não for identificador, vírgula, ponto e vírgula ou parêntese, volta o token e sai do loop
+                            lexer.putBackToken(paramIdentTok);
+                            break;
+                        }
+                    }
+                } else if (paramTok.type == TokenType::IDENT) {
+                    // Só identificador, sem tipo explícito
+                    
+                    sink.define(paramTok);
+                    
+                    sink.record(paramTok, true);
+                } else if (paramTok.type != TokenType::RPAREN) {
+                    sink.record(paramTok, false);
+                }
+                if (paramTok.type == TokenType::END_OF_FILE || paramTok.type == TokenType::ENDFUNCTIONS) {
+                    
+                    throw std::runtime_error("Erro: fim inesperado ao processar parametros da funcao (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+                }
+            }
+        }
+        nextTok = lexer.nextToken();
+    }
+
+    // Pula tokens até encontrar o início do corpo da função
+    while (nextTok.type != TokenType::LBRACE && nextTok.type != TokenType::END_OF_FILE && nextTok.type != TokenType::ENDFUNCTIONS) {
+        
+        sink.record(nextTok, false);
+        nextTok = lexer.nextToken();
+    }
+    
+    if (nextTok.type != TokenType::LBRACE) {
+        throw std::runtime_error("Erro: funcao nao possui corpo iniciado por '{' (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+    }
+    
+    // Processa o corpo da função
+    int braceCount = 1;
+    
+    while (braceCount > 0) {
+        Token bodyTok = lexer.nextToken();
+        
+        if (bodyTok.type == TokenType::END_OF_FILE) {
+            throw std::runtime_error("Erro: funcao nao termina com '}' (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+        }
+        
+        if (bodyTok.type == TokenType::LBRACE) checkNestingDepth(++braceCount, lexer, bodyTok, limits);
+        
+        if (bodyTok.type == TokenType::RBRACE) braceCount--;
+
+        // Referências no corpo entram só no índice de referências cruzadas
+        if (bodyTok.type == TokenType::IDENT) sink.reference(bodyTok);
+        
+        if (bodyTok.type == TokenType::ENDFUNCTIONS && braceCount > 0) {
+            throw std::runtime_error("Erro: funcao nao termina com '}' antes de ENDFUNCTIONS (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+        }
+    }
+    
+    // Espera ENDFUNCTION após o corpo
+    Token endFuncTok = lexer.nextToken();
+    if (endFuncTok.type != TokenType::ENDFUNCTION) {
+        throw std::runtime_error("Erro: funcao deve terminar com ENDFUNCTION (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+    }
+}
+
+// ===============================
+//  Análise das funções em paralelo
+// ===============================
+// Cada FUNCTYPE ... ENDFUNCTION só depende dos símbolos já definidos antes
+// dele. Uma varredura rápida do texto (findKeyword) acha o início de cada
+// função; na primeira que a análise principal encontra, todas são
+// analisadas em threads, cada uma com seu Lexer a partir do próprio
+// FUNCTYPE, contra a tabela de símbolos daquele momento (só leitura:
+// DECLARATIONS e o que veio antes). Os efeitos viram uma lista de eventos,
+// com as referências do corpo já resolvidas para a entrada do símbolo
+// quando ele está na tabela ou é parâmetro da própria função. A análise
+// principal então segue em ordem e, a cada FUNCTYPE, reaplica os eventos
+// na tabela e salta o lexer para depois do ENDFUNCTION: entradas, linhas e
+// registros ficam idênticos aos da análise sequencial. Uma função com erro
+// (ou que estouraria o limite de tokens) é refeita sequencialmente, para
+// que a mensagem e o estado sejam os mesmos.
+
+// Texto mínimo, a partir do primeiro FUNCTYPE, para valer a pena criar threads
+const size_t PARALLEL_MIN_FUNCTION_BYTES = 64 * 1024;
+
+struct FunctionEvent
+{
+    enum Kind : uint8_t
+    {
+        DEFINE,
+        ARRAY_SIZE,
+        TYPE,
+        RECORD,
+        RECORD_INDEXED,
+        REFERENCE
+    };
+
+    Kind kind;
+    TokenType type;
+    size_t offset;
+    // DEFINE e REFERENCE: entrada do símbolo, se já estava na tabela (0 se
+    // não); ARRAY_SIZE: extensão
+    int value;
+    // Índice do DEFINE da função a que o evento se refere (-1 se nenhum)
+    int local;
+    std::string lexeme; // DEFINE sem entrada, RECORD e REFERENCE sem entrada
+    std::string code;   // TYPE
+};
+
+// Sink que grava os eventos de uma função analisada fora de ordem. Tudo o
+// que dá para resolver sem a tabela definitiva (entradas já existentes,
+// parâmetros da própria função) é resolvido aqui, nas threads, para que a
+// reaplicação em ordem quase não procure lexemas.
+class FunctionEventRecorder
+{
+public:
+    FunctionEventRecorder(const SymbolTable &snapshot, std::vector<FunctionEvent> &events)
+        : snapshot_(snapshot), events_(events) {}
+
+    void define(const Token &tok)
+    {
+        int entry = snapshot_.getIndex(tok.lexeme);
+        push(FunctionEvent::DEFINE, tok, entry, -1, entry <= 0);
+        locals_[std::string(truncated(tok))] = defines_++;
+    }
+
+    void setArraySize(const Token &tok, int size)
+    {
+        push(FunctionEvent::ARRAY_SIZE, tok, size, local(tok), false);
+    }
+
+    void setType(const Token &tok, const std::string &code)
+    {
+        if (SymbolTable::isValidType(code))
+            push(FunctionEvent::TYPE, tok, 0, local(tok), false).code = code;
+    }
+
+    void record(const Token &tok, bool indexed)
+    {
+        push(indexed ? FunctionEvent::RECORD_INDEXED : FunctionEvent::RECORD, tok, 0, indexed ? local(tok) : -1, true);
+    }
+
+    void reference(const Token &tok)
+    {
+        int entry = snapshot_.getIndex(tok.lexeme);
+        int k = entry > 0 ? -1 : local(tok);
+        push(FunctionEvent::REFERENCE, tok, std::max(entry, 0), k, entry <= 0 && k < 0);
+    }
+
+private:
+    const SymbolTable &snapshot_;
+    std::vector<FunctionEvent> &events_;
+    std::map<std::string, int, std::less<>> locals_; // parâmetro -> índice do DEFINE
+    int defines_ = 0;
+
+    static std::string_view truncated(const Token &tok)
+    {
+        return std::string_view(tok.lexeme).substr(0, SymbolTable::MAX_LEXEME);
+    }
+
+    int local(const Token &tok) const
+    {
+        auto it = locals_.find(truncated(tok));
+        return it != locals_.end() ? it->second : -1;
+    }
+
+    FunctionEvent &push(FunctionEvent::Kind kind, const Token &tok, int value, int local, bool keepLexeme)
+    {
+        events_.push_back({kind, tok.type, tok.offset, value, local,
+                           keepLexeme ? std::string(tok.lexeme) : std::string(), {}});
+        return events_.back();
+    }
+};
+
+class ParallelFunctionAnalysis
+{
+public:
+    // `lines` é o índice de linhas de `source`, compartilhado pelos lexers das threads
+    ParallelFunctionAnalysis(const std::string &source, const LineIndex &lines, const AnalysisLimits &limits,
+                             unsigned jobs)
+        : source_(source), lines_(lines), limits_(limits), jobs_(jobs)
+    {
+        starts_ = findKeyword(source, "FUNCTYPE");
+        if (starts_.size() < 2 || source.size() - starts_[0] < PARALLEL_MIN_FUNCTION_BYTES)
+            starts_.clear();
+    }
+
+    // Incorpora a função que começa em `tok`, já analisada em paralelo, e
+    // avança o lexer até depois dela; false se ela deve ser analisada aqui
+    bool merge(const Token &tok, Lexer &lexer, SymbolTable &symtab, LexemeList &lexemes)
+    {
+        if (starts_.empty())
+            return false;
+        if (results_.empty())
+            analyzeAll(symtab);
+        auto it = std::lower_bound(starts_.begin(), starts_.end(), tok.offset);
+        if (it == starts_.end() || *it != tok.offset)
+            return false;
+        const Result &r = results_[it - starts_.begin()];
+        if (!r.ok || lexer.tokensRead() + r.tokens > limits_.maxTokens)
+            return false;
+
+        std::vector<int> entries; // entrada de cada DEFINE
+        auto entryOf = [&](const FunctionEvent &e)
+        {
+            return e.value > 0 ? e.value : e.local >= 0 ? entries[e.local] : symtab.getIndex(e.lexeme);
+        };
+        for (const FunctionEvent &e : r.events)
+        {
+            switch (e.kind)
+            {
+            case FunctionEvent::DEFINE:
+                if (e.value > 0)
+                    symtab.noteReference(e.value, e.offset, true);
+                entries.push_back(e.value > 0 ? e.value : symtab.defineOrGet(e.lexeme, e.offset, TokenType::IDENT));
+                break;
+            case FunctionEvent::ARRAY_SIZE:
+                symtab.setArraySize(entries[e.local], e.value);
+                break;
+            case FunctionEvent::TYPE:
+                symtab.setType(entries[e.local], e.code);
+                break;
+            case FunctionEvent::RECORD:
+            case FunctionEvent::RECORD_INDEXED:
+            {
+                LexemeRecord record(lexemes.get_allocator());
+                record.type = e.type;
+                record.lexeme = e.lexeme;
+                record.tableIndex = e.kind == FunctionEvent::RECORD_INDEXED ? entryOf(e) : -1;
+                record.offset = e.offset;
+                lexemes.push_back(std::move(record));
+                break;
+            }
+            case FunctionEvent::REFERENCE:
+            {
+                int entry = entryOf(e);
+                if (entry > 0)
+                    symtab.noteReference(entry, e.offset);
+                break;
+            }
+            }
+        }
+        lexer.skipTo(r.end, r.tokens);
+        return true;
+    }
+
+private:
+    struct Result
+    {
+        bool ok = false;
+        std::vector<FunctionEvent> events;
+        size_t end = 0; // depois do ENDFUNCTION
+        size_t tokens = 0;
+    };
+
+    const std::string &source_;
+    const LineIndex &lines_;
+    AnalysisLimits limits_;
+    unsigned jobs_;
+    std::vector<size_t> starts_;
+    std::vector<Result> results_;
+
+    void analyzeOne(size_t k, const SymbolTable &snapshot)
+    {
+        Result &r = results_[k];
+        Lexer lexer(source_, starts_[k], &lines_);
+        lexer.setLimits(limits_);
+        try
+        {
+            Token tok = lexer.nextToken();
+            r.events.reserve(64);
+            FunctionEventRecorder recorder(snapshot, r.events);
+            analyzeFunction(lexer, tok, recorder, limits_);
+            r.ok = true;
+        }
+        catch (const std::runtime_error &)
+        {
+            r.events.clear();
+        }
+        r.end = lexer.position();
+        r.tokens = lexer.tokensRead() - 1; // o FUNCTYPE já foi contado pela análise principal
+    }
+
+    // Distribui as funções entre as threads por demanda (os tamanhos variam);
+    // a tabela não muda enquanto isso
+    void analyzeAll(const SymbolTable &snapshot)
+    {
+        results_.resize(starts_.size());
+        std::atomic<size_t> next(0);
+        auto work = [&]()
+        {
+            TRACE_SCOPE("funcoes em paralelo", "");
+            for (size_t k; (k = next++) < starts_.size();)
+                analyzeOne(k, snapshot);
+        };
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < std::min<size_t>(jobs_, starts_.size()); ++t)
+            threads.emplace_back([&]
+                                 {
+                                     TRACE_THREAD("analise de funcoes");
+                                     work(); });
+        work();
+        for (auto &t : threads)
+            t.join();
+    }
+};
+
+// Análise léxica e sintática sobre uma fonte de tokens (Lexer ou
+// StreamingLexer), com os resultados entregues a `sink`:
+// - símbolos declarados e usados (define/setArraySize/setType)
+// - cada lexema lido, para o relatório .LEX (record)
+// Tokens e contextos usam o recurso de memória do sink.
+template <typename TokenSource, typename Sink>
+void analyzeTokens(TokenSource &lexer, Sink &sink, const AnalysisLimits &limits, AnalysisStats *stats,
+                   ParallelFunctionAnalysis *parallel = nullptr)
+{
+    // Inicializa o contexto de tipos
+    lexer.setLimits(limits);
+    lexer.setMemoryResource(sink.memoryResource());
+
+    struct StatsGuard
+    {
+        const TokenSource &lexer;
+        AnalysisStats *stats;
+        ~StatsGuard()
+        {
+            if (stats)
+            {
+                stats->tokensRead = lexer.tokensRead();
+                stats->bytesScanned = lexer.position();
+            }
+        }
+    } statsGuard{lexer, stats};
+    TypeContext typeContext(limits.maxNestingDepth, sink.memoryResource());
+
+    // Aninhamento de chaves/parênteses limitado para entradas patológicas
+    auto checkDepth = [&](int depth, const Token &tok)
+    {
+        checkNestingDepth(depth, lexer, tok, limits);
+    };
+
+    TokenType currentType = TokenType::VOID;
+    bool isArray = false;
+
+    // ===============================
+    //  Loop principal de análise
+    // ===============================
+    // Lê tokens um a um e executa ações conforme o tipo do token
+    while (true)
+    {
+        Token tok = lexer.nextToken();
+        if (tok.type == TokenType::END_OF_FILE)
+            break;
+
+        // Switch principal para tratar cada tipo de token
+        switch (tok.type)
+        {
+        // ====== Seções e Contextos ======
+        case TokenType::PROGRAM:
+            // Início do programa
+            typeContext.pushContext(TypeContext::Context::GLOBAL);
+            break;
+        case TokenType::DECLARATIONS:
+            // Início da seção de declarações
+            typeContext.pushContext(TypeContext::Context::DECLARATIONS);
+            break;
+        case TokenType::ENDDECLARATIONS:
+            // Fim da seção de declarações
+            typeContext.popContext();
+            break;
+        case TokenType::FUNCTIONS:
+            // Início da seção de funções
+            typeContext.pushContext(TypeContext::Context::FUNCTIONS);
+            break;
+        case TokenType::ENDFUNCTIONS:
+            // Fim da seção de funções
+            typeContext.popContext();
+            break;
+        case TokenType::VARTYPE:
+            // Início de declaração de variáveis
+            typeContext.pushContext(TypeContext::Context::VARIABLE_DECL);
+            break;
+        // ====== Declaração de Função ======
+        case TokenType::FUNCTYPE:
+            typeContext.pushContext(TypeContext::Context::FUNCTION_DECL);
+            {
+                // Funções já analisadas em paralelo só têm o resultado incorporado
+                bool merged = false;
+                if constexpr (std::is_same<TokenSource, Lexer>::value &&
+                              std::is_same<Sink, SymbolTableSink>::value)
+                    merged = parallel && parallel->merge(tok, lexer, sink.symtab, sink.lexemes);
+                if (!merged)
+                    analyzeFunction(lexer, tok, sink, limits);
+                typeContext.popContext();
+                break;
+            }
+        
+        // ====== Parâmetros de Função ======
+        case TokenType::PARAMTYPE:
+            if (typeContext.currentContext() == TypeContext::Context::FUNCTION_PARAMS)
+            {
+                typeContext.pushContext(TypeContext::Context::VARIABLE_DECL);
+            }
+            break;
+        case TokenType::LPAREN:
+            if (typeContext.currentContext() == TypeContext::Context::FUNCTION_DECL)
+            {
+                typeContext.pushContext(TypeContext::Context::FUNCTION_PARAMS);
+            }
+            break;
+        case TokenType::RPAREN:
+            if (typeContext.currentContext() == TypeContext::Context::FUNCTION_PARAMS)
+            {
+                typeContext.popContext();
+            }
+            break;
+        // ====== Declaração de Arrays ======
+        case TokenType::LBRACK:
+            isArray = true;
+            break;
+        case TokenType::RBRACK:
+            isArray = false;
+            break;
+        // ====== Fim de Declaração ======
+        case TokenType::SEMI:
+            if (typeContext.currentContext() == TypeContext::Context::VARIABLE_DECL ||
+                typeContext.currentContext() == TypeContext::Context::FUNCTION_DECL)
+            {
+                typeContext.popContext();
+            }
+            break;
+        // ====== Tipos de Variáveis ======
+        case TokenType::REAL:
+        case TokenType::INTEGER:
+        case TokenType::STRING:
+        case TokenType::BOOLEAN:
+        case TokenType::CHARACTER:
+        case TokenType::VOID:
+            // Atualiza o tipo atual para declaração
+            currentType = tok.type;
+            {
+                if (currentType != TokenType::VOID) {
+                    Token lookahead = lexer.nextToken();
+                    if (lookahead.type == TokenType::LBRACK) {
+                        Token lookahead2 = lexer.nextToken();
+                        if (lookahead2.type == TokenType::RBRACK) {
+                            isArray = true;
+                        } else {
+                            lexer.putBackToken(lookahead2);
+                            lexer.putBackToken(lookahead);
+                            isArray = false;
+                        }
+                    } else {
+                        lexer.putBackToken(lookahead);
+                        isArray = false;
+                    }
+                }
+            }
+            break;
+        // ====== Constantes Booleanas ======
+        case TokenType::TRUE:
+        case TokenType::FALSE:
+            break;
+        // ====== Identificadores ======
+        case TokenType::IDENT: {
+            // Processa identificadores (variáveis, nomes de função, etc.)
+            sink.define(tok);
+
+            Token nextTok = lexer.nextToken();
+            if (nextTok.type == TokenType::LBRACK)
+            {
+                Token sizeTok = lexer.nextToken();
+                if (sizeTok.type != TokenType::INTCONST)
+                {
+                    throw std::runtime_error("Erro na linha " + std::to_string(lexer.lineOf(tok)) +
+                                           ": Tamanho do array deve ser uma constante inteira");
+                }
+                Token rbrack = lexer.nextToken();
+                if (rbrack.type != TokenType::RBRACK)
+                {
+                    throw std::runtime_error("Erro na linha " + std::to_string(lexer.lineOf(tok)) +
+                                           ": Esperava ']' apos tamanho do array");
+                }
+                // Registra a extensão declarada do array
+                if (typeContext.currentContext() == TypeContext::Context::VARIABLE_DECL)
+                {
+                    sink.setArraySize(tok, SymbolTable::parseArraySize(sizeTok.lexeme));
+                }
+            }
+            else
+            {
+                lexer.putBackToken(nextTok);
+            }
+
+            if (typeContext.currentContext() == TypeContext::Context::VARIABLE_DECL)
+            {
+                std::string typeCode;
+                if (isArray)
+                {
+                    switch (currentType)
+                    {
+                    case TokenType::REAL:
+                        typeCode = "AF";
+                        break;
+                    case TokenType::INTEGER:
+                        typeCode = "AI";
+                        break;
+                    case TokenType::STRING:
+                        typeCode = "AS";
+                        break;
+                    case TokenType::CHARACTER:
+                        typeCode = "AC";
+                        break;
+                    case TokenType::BOOLEAN:
+                        typeCode = "AB";
+                        break;
+                    default:
+                        typeCode = "VD";
+                    }
+                }
+                else
+                {
+                    switch (currentType)
+                    {
+                    case TokenType::REAL:
+                        typeCode = "FP";
+                        break;
+                    case TokenType::INTEGER:
+                        typeCode = "IN";
+                        break;
+                    case TokenType::STRING:
+                        typeCode = "ST";
+                        break;
+                    case TokenType::CHARACTER:
+                        typeCode = "CH";
+                        break;
+                    case TokenType::BOOLEAN:
+                        typeCode = "BL";
+                        break;
+                    case TokenType::VOID:
+                        typeCode = "VD";
+                        break;
+                    default:
+                        typeCode = "VD";
+                    }
+                }
+                sink.setType(tok, typeCode);
+            }
+            break;
+        }
+        // ====== Estrutura de Repetição WHILE ======
+        case TokenType::WHILE: {
+            // Processa a condição do WHILE (entre parênteses)
+            Token nextTok = lexer.nextToken();
+            if (nextTok.type != TokenType::LPAREN) {
+                throw std::runtime_error("Erro: WHILE deve ser seguido de '(' (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+            }
+            int parenCount = 1;
+            while (parenCount > 0) {
+                Token condTok = lexer.nextToken();
+                if (condTok.type == TokenType::END_OF_FILE) {
+                    throw std::runtime_error("Erro: WHILE sem fechamento de ')' (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+                }
+                if (condTok.type == TokenType::LPAREN) checkDepth(++parenCount, condTok);
+                if (condTok.type == TokenType::RPAREN) parenCount--;
+                // Atualiza tabela de símbolos para identificadores na condição
+                if (condTok.type == TokenType::IDENT) {
+                    sink.define(condTok);
+                }
+            }
+            // Espera o início do bloco '{'
+            Token braceTok = lexer.nextToken();
+            if (braceTok.type != TokenType::LBRACE) {
+                throw std::runtime_error("Erro: WHILE deve ter bloco iniciado por '{' (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+            }
+            // Processa o bloco do WHILE
+            int braceCount = 1;
+            while (braceCount > 0) {
+                Token bodyTok = lexer.nextToken();
+                if (bodyTok.type == TokenType::END_OF_FILE) {
+                    throw std::runtime_error("Erro: WHILE sem fechamento de '}' (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+                }
+                if (bodyTok.type == TokenType::LBRACE) checkDepth(++braceCount, bodyTok);
+                if (bodyTok.type == TokenType::RBRACE) braceCount--;
+                // Atualiza tabela de símbolos para identificadores no bloco
+                if (bodyTok.type == TokenType::IDENT) {
+                    sink.define(bodyTok);
+                }
+                sink.record(bodyTok, true);
+            }
+            // Espera ENDWHILE após o bloco
+            Token endWhileTok = lexer.nextToken();
+            if (endWhileTok.type != TokenType::ENDWHILE) {
+                throw std::runtime_error("Erro: WHILE deve terminar com ENDWHILE (linha " + std::to_string(lexer.lineOf(tok)) + ")");
+            }
+            // Registra o token ENDWHILE
+            sink.record(endWhileTok, true);
+            break;
+        }
+        }
+
+        // Registra cada token lido para o relatório .LEX
+        sink.record(tok, true);
+    }
+}
+
+// Análise completa: preenche a tabela de símbolos e os registros do .LEX
+// (recurso de memória da tabela para tokens; o de `lexemes` para registros)
+template <typename TokenSource>
+void analyzeTokens(TokenSource &lexer, SymbolTable &symtab, LexemeList &lexemes,
+                   const AnalysisLimits &limits, AnalysisStats *stats,
+                   ParallelFunctionAnalysis *parallel = nullptr)
+{
+    SymbolTableSink sink{symtab, lexemes};
+    analyzeTokens(lexer, sink, limits, stats, parallel);
+}
+
+// Análise do texto fonte completo em memória; com jobs > 1, as funções são
+// analisadas em paralelo, com resultado idêntico
+void analyzeSource(const std::string &source, SymbolTable &symtab, LexemeList &lexemes,
+                   const AnalysisLimits &limits = AnalysisLimits(), AnalysisStats *stats = nullptr,
+                   unsigned jobs = 1)
+{
+    TRACE_SCOPE("analise", "");
+    symtab.lines() = LineIndex(source);
+    Lexer lexer(source, &symtab.lines());
+    std::unique_ptr<ParallelFunctionAnalysis> parallel;
+    if (jobs > 1)
+        parallel.reset(new ParallelFunctionAnalysis(source, symtab.lines(), limits, jobs));
+    analyzeTokens(lexer, symtab, lexemes, limits, stats, parallel.get());
+}
+
+// Análise lendo o fonte em blocos (ex.: descompactando um .251.gz), com a
+// memória do texto limitada à janela do StreamingLexer
+void analyzeStream(SourceReader &reader, SymbolTable &symtab, LexemeList &lexemes,
+                   const AnalysisLimits &limits = AnalysisLimits(), AnalysisStats *stats = nullptr)
+{
+    TRACE_SCOPE("analise", "");
+    symtab.lines() = LineIndex();
+    StreamingLexer lexer(reader, symtab.lines());
+    analyzeTokens(lexer, symtab, lexemes, limits, stats);
+}
+
+// Só valida o fonte (--check), com os mesmos erros da análise completa,
+// lançados como std::runtime_error. O índice de linhas só é montado se
+// houver erro a reportar.
+void checkSource(const std::string &source, const AnalysisLimits &limits = AnalysisLimits(),
+                 AnalysisStats *stats = nullptr)
+{
+    Lexer lexer(source);
+    CheckOnlySink sink;
+    analyzeTokens(lexer, sink, limits, stats);
+}
+
+// Validação lendo o fonte em blocos (.251.gz). O texto fica limitado à
+// janela do StreamingLexer, mas o índice de linhas cresce com o fonte (um
+// size_t por linha): as mensagens de erro citam a linha de tokens antigos,
+// como o WHILE sem '}' ou a FUNCTYPE sem ENDFUNCTION, já fora da janela.
+void checkStream(SourceReader &reader, const AnalysisLimits &limits = AnalysisLimits(),
+                 AnalysisStats *stats = nullptr)
+{
+    LineIndex lines;
+    StreamingLexer lexer(reader, lines);
+    CheckOnlySink sink;
+    analyzeTokens(lexer, sink, limits, stats);
+}
+
+// Grava a interface (.251i) de um fonte já analisado: variáveis de
+// DECLARATIONS e parâmetros com os tipos da tabela de símbolos, e a
+// assinatura e o texto de cada FUNCTYPE ... ENDFUNCTION
+void emitModuleInterface(const std::string &path, const std::string &source, const SymbolTable &symtab,
+                         const AnalysisLimits &limits = AnalysisLimits())
+{
+    std::vector<Token> tokens;
+    Lexer lexer(source);
+    lexer.setLimits(limits);
+    do
+        tokens.push_back(lexer.nextToken());
+    while (tokens.back().type != TokenType::END_OF_FILE);
+    auto at = [&](size_t k) -> const Token &
+    {
+        return tokens[std::min(k, tokens.size() - 1)];
+    };
+    auto name = [](const Token &tok)
+    {
+        return std::string_view(tok.lexeme).substr(0, SymbolTable::MAX_LEXEME);
+    };
+
+    std::set<std::string, std::less<>> globals, params;
+    bool inDeclarations = false;
+    for (const Token &tok : tokens)
+    {
+        if (tok.type == TokenType::DECLARATIONS)
+            inDeclarations = true;
+        else if (tok.type == TokenType::ENDDECLARATIONS)
+            inDeclarations = false;
+        else if (inDeclarations && tok.type == TokenType::IDENT)
+            globals.emplace(name(tok));
+    }
+
+    InterfaceBuilder builder;
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        if (tokens[i].type != TokenType::FUNCTYPE)
+            continue;
+        // FUNCTYPE <tipo> : <nome> ( <Parameters> ) { ... } ENDFUNCTION
+        std::string retType = TypeContext::mapTypeToCode(at(i + 1).type);
+        const Token &fnName = at(i + 3);
+        size_t k = i + 5;
+        std::vector<InterfaceBuilder::Param> fnParams;
+        while (at(k).type == TokenType::PARAMTYPE)
+        {
+            TokenType type = at(k + 1).type;
+            k += 3;
+            while (at(k).type == TokenType::IDENT)
+            {
+                InterfaceBuilder::Param p;
+                p.name = name(at(k++));
+                if (at(k).type == TokenType::LBRACK)
+                {
+                    p.arraySize = std::atoi(std::string(at(k + 1).lexeme).c_str());
+                    k += 3;
+                }
+                p.type = TypeContext::mapTypeToCode(type, p.arraySize > 0);
+                params.insert(p.name);
+                fnParams.push_back(std::move(p));
+                if (at(k).type != TokenType::COMMA)
+                    break;
+                ++k;
+            }
+            if (at(k).type == TokenType::SEMI)
+                ++k;
+        }
+
+        size_t end = k;
+        while (at(end).type != TokenType::ENDFUNCTION && at(end).type != TokenType::END_OF_FILE)
+            ++end;
+        const Token &last = at(end);
+        size_t bodyEnd = last.offset + last.lexeme.size();
+        builder.addFunction(name(fnName), retType, std::move(fnParams),
+                            std::string_view(source).substr(tokens[i].offset, bodyEnd - tokens[i].offset),
+                            lexer.lineOf(tokens[i]));
+        i = end;
+    }
+
+    for (auto &info : symtab.all())
+    {
+        std::string_view lexeme(info.lexeme);
+        if (globals.count(lexeme))
+            builder.addSymbol(info.lexeme, info.type, InterfaceSymbol::GLOBAL, info.arraySize);
+        else if (params.count(lexeme))
+            builder.addSymbol(info.lexeme, info.type, InterfaceSymbol::PARAM, info.arraySize);
+    }
+    builder.write(path);
+}
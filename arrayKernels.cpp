@@ -0,0 +1,579 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CANGA_X86 1
+#endif
+
+// ===============================
+//  Kernels vetoriais para aritmética sobre arrays completos
+// ===============================
+// Uma expressão elemento a elemento (ex.: u + arr + values) é compilada num
+// pequeno programa pós-fixo de KernelOps. A avaliação percorre os arrays em
+// blocos de KERNEL_CHUNK elementos, aplicando toda a cadeia de operações a
+// cada bloco enquanto ele está no cache: uma única passada sobre a memória.
+// Inteiros ocupam 64 bits (int64_t) e reais são double, ambos com 8 bytes
+// por elemento, em armazenamento contíguo.
+
+enum class KernelIsa
+{
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+enum class KOp : uint8_t
+{
+    LOAD_I, // elementos de um array inteiro
+    LOAD_F, // elementos de um array real
+    SPLAT_I, // escalar inteiro replicado em todas as posições
+    SPLAT_F, // escalar real replicado em todas as posições
+    I2F,
+    F2I,
+    NEG_I,
+    NEG_F,
+    ADD_I,
+    SUB_I,
+    MUL_I,
+    DIV_I,
+    MOD_I,
+    ADD_F,
+    SUB_F,
+    MUL_F,
+    DIV_F,
+    LT_I,
+    LE_I,
+    GT_I,
+    GE_I,
+    EQ_I,
+    NE_I,
+    LT_F,
+    LE_F,
+    GT_F,
+    GE_F,
+    EQ_F,
+    NE_F,
+    COUNT
+};
+
+struct KernelOp
+{
+    KOp op;
+    uint8_t pad[3];
+    int32_t operand; // registro de origem para LOAD/SPLAT
+};
+
+// Operando já resolvido pelo interpretador para cada KernelOp
+struct KernelOperand
+{
+    const void *data; // LOAD: início do array
+    int64_t length;   // LOAD: quantidade de elementos
+    int64_t i;        // SPLAT_I
+    double f;         // SPLAT_F
+};
+
+static const size_t KERNEL_CHUNK = 256;
+
+typedef void (*KernelBinaryFn)(void *d, const void *a, const void *b, size_t n);
+typedef void (*KernelUnaryFn)(void *d, const void *a, size_t n);
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define CANGA_NO_VECTORIZE __attribute__((optimize("no-tree-vectorize")))
+#else
+#define CANGA_NO_VECTORIZE
+#endif
+
+// ---------- caminho escalar ----------
+namespace scalarKernels
+{
+    template <typename T, typename R, typename F>
+    CANGA_NO_VECTORIZE static void binary(void *d, const void *a, const void *b, size_t n, F f)
+    {
+        R *D = (R *)d;
+        const T *A = (const T *)a, *B = (const T *)b;
+        for (size_t i = 0; i < n; ++i)
+            D[i] = f(A[i], B[i]);
+    }
+
+#define CANGA_SCALAR_BIN(NAME, T, R, EXPR)                                 \
+    static void NAME(void *d, const void *a, const void *b, size_t n)    \
+    {                                                                      \
+        binary<T, R>(d, a, b, n, [](T x, T y) -> R { return EXPR; });      \
+    }
+
+    // Aritmética inteira com wrap-around (sem comportamento indefinido)
+    CANGA_SCALAR_BIN(addI, int64_t, int64_t, (int64_t)((uint64_t)x + (uint64_t)y))
+    CANGA_SCALAR_BIN(subI, int64_t, int64_t, (int64_t)((uint64_t)x - (uint64_t)y))
+    CANGA_SCALAR_BIN(mulI, int64_t, int64_t, (int64_t)((uint64_t)x * (uint64_t)y))
+    CANGA_SCALAR_BIN(divI, int64_t, int64_t, y == 0 ? 0 : (y == -1 ? (int64_t)(0 - (uint64_t)x) : x / y))
+    CANGA_SCALAR_BIN(modI, int64_t, int64_t, y == 0 || y == -1 ? 0 : x % y)
+    CANGA_SCALAR_BIN(addF, double, double, x + y)
+    CANGA_SCALAR_BIN(subF, double, double, x - y)
+    CANGA_SCALAR_BIN(mulF, double, double, x * y)
+    CANGA_SCALAR_BIN(divF, double, double, x / y)
+    CANGA_SCALAR_BIN(ltI, int64_t, int64_t, x < y)
+    CANGA_SCALAR_BIN(leI, int64_t, int64_t, x <= y)
+    CANGA_SCALAR_BIN(gtI, int64_t, int64_t, x > y)
+    CANGA_SCALAR_BIN(geI, int64_t, int64_t, x >= y)
+    CANGA_SCALAR_BIN(eqI, int64_t, int64_t, x == y)
+    CANGA_SCALAR_BIN(neI, int64_t, int64_t, x != y)
+    CANGA_SCALAR_BIN(ltF, double, int64_t, x < y)
+    CANGA_SCALAR_BIN(leF, double, int64_t, x <= y)
+    CANGA_SCALAR_BIN(gtF, double, int64_t, x > y)
+    CANGA_SCALAR_BIN(geF, double, int64_t, x >= y)
+    CANGA_SCALAR_BIN(eqF, double, int64_t, x == y)
+    CANGA_SCALAR_BIN(neF, double, int64_t, x != y)
+#undef CANGA_SCALAR_BIN
+
+    CANGA_NO_VECTORIZE static void negI(void *d, const void *a, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            ((int64_t *)d)[i] = (int64_t)(0 - (uint64_t)((const int64_t *)a)[i]);
+    }
+
+    CANGA_NO_VECTORIZE static void negF(void *d, const void *a, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            ((double *)d)[i] = -((const double *)a)[i];
+    }
+
+    CANGA_NO_VECTORIZE static void i2f(void *d, const void *a, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            ((double *)d)[i] = (double)((const int64_t *)a)[i];
+    }
+
+    CANGA_NO_VECTORIZE static void f2i(void *d, const void *a, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            ((int64_t *)d)[i] = (int64_t)((const double *)a)[i];
+    }
+}
+
+#ifdef CANGA_X86
+// ---------- SSE2 (2 elementos por instrução) ----------
+namespace sse2Kernels
+{
+#define CANGA_SSE2_PD(NAME, INTRIN, SCALAR)                                       \
+    static void NAME(void *d, const void *a, const void *b, size_t n)           \
+    {                                                                             \
+        double *D = (double *)d;                                                  \
+        const double *A = (const double *)a, *B = (const double *)b;              \
+        size_t i = 0;                                                             \
+        for (; i + 2 <= n; i += 2)                                                \
+            _mm_storeu_pd(D + i, INTRIN(_mm_loadu_pd(A + i), _mm_loadu_pd(B + i))); \
+        if (i < n)                                                                \
+            scalarKernels::SCALAR(D + i, A + i, B + i, n - i);                    \
+    }
+
+    CANGA_SSE2_PD(addF, _mm_add_pd, addF)
+    CANGA_SSE2_PD(subF, _mm_sub_pd, subF)
+    CANGA_SSE2_PD(mulF, _mm_mul_pd, mulF)
+    CANGA_SSE2_PD(divF, _mm_div_pd, divF)
+#undef CANGA_SSE2_PD
+
+#define CANGA_SSE2_CMP_PD(NAME, INTRIN, SCALAR)                                    \
+    static void NAME(void *d, const void *a, const void *b, size_t n)            \
+    {                                                                              \
+        int64_t *D = (int64_t *)d;                                                 \
+        const double *A = (const double *)a, *B = (const double *)b;               \
+        const __m128i one = _mm_set1_epi64x(1);                                    \
+        size_t i = 0;                                                              \
+        for (; i + 2 <= n; i += 2)                                                 \
+        {                                                                          \
+            __m128d m = INTRIN(_mm_loadu_pd(A + i), _mm_loadu_pd(B + i));          \
+            _mm_storeu_si128((__m128i *)(D + i), _mm_and_si128(_mm_castpd_si128(m), one)); \
+        }                                                                          \
+        if (i < n)                                                                 \
+            scalarKernels::SCALAR(D + i, A + i, B + i, n - i);                     \
+    }
+
+    CANGA_SSE2_CMP_PD(ltF, _mm_cmplt_pd, ltF)
+    CANGA_SSE2_CMP_PD(leF, _mm_cmple_pd, leF)
+    CANGA_SSE2_CMP_PD(gtF, _mm_cmpgt_pd, gtF)
+    CANGA_SSE2_CMP_PD(geF, _mm_cmpge_pd, geF)
+    CANGA_SSE2_CMP_PD(eqF, _mm_cmpeq_pd, eqF)
+    CANGA_SSE2_CMP_PD(neF, _mm_cmpneq_pd, neF)
+#undef CANGA_SSE2_CMP_PD
+
+#define CANGA_SSE2_EPI64(NAME, INTRIN, SCALAR)                                    \
+    static void NAME(void *d, const void *a, const void *b, size_t n)           \
+    {                                                                             \
+        int64_t *D = (int64_t *)d;                                                \
+        const int64_t *A = (const int64_t *)a, *B = (const int64_t *)b;           \
+        size_t i = 0;                                                             \
+        for (; i + 2 <= n; i += 2)                                                \
+            _mm_storeu_si128((__m128i *)(D + i),                                  \
+                             INTRIN(_mm_loadu_si128((const __m128i *)(A + i)),    \
+                                    _mm_loadu_si128((const __m128i *)(B + i))));  \
+        if (i < n)                                                                \
+            scalarKernels::SCALAR(D + i, A + i, B + i, n - i);                    \
+    }
+
+    CANGA_SSE2_EPI64(addI, _mm_add_epi64, addI)
+    CANGA_SSE2_EPI64(subI, _mm_sub_epi64, subI)
+#undef CANGA_SSE2_EPI64
+
+    static void negF(void *d, const void *a, size_t n)
+    {
+        double *D = (double *)d;
+        const double *A = (const double *)a;
+        const __m128d sign = _mm_set1_pd(-0.0);
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            _mm_storeu_pd(D + i, _mm_xor_pd(_mm_loadu_pd(A + i), sign));
+        if (i < n)
+            scalarKernels::negF(D + i, A + i, n - i);
+    }
+
+    static void negI(void *d, const void *a, size_t n)
+    {
+        int64_t *D = (int64_t *)d;
+        const int64_t *A = (const int64_t *)a;
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2)
+            _mm_storeu_si128((__m128i *)(D + i), _mm_sub_epi64(zero, _mm_loadu_si128((const __m128i *)(A + i))));
+        if (i < n)
+            scalarKernels::negI(D + i, A + i, n - i);
+    }
+}
+
+// ---------- AVX2 (4 elementos por instrução) ----------
+namespace avx2Kernels
+{
+#define CANGA_AVX2 __attribute__((target("avx2")))
+
+#define CANGA_AVX2_PD(NAME, INTRIN, SCALAR)                                              \
+    CANGA_AVX2 static void NAME(void *d, const void *a, const void *b, size_t n)        \
+    {                                                                                    \
+        double *D = (double *)d;                                                         \
+        const double *A = (const double *)a, *B = (const double *)b;                     \
+        size_t i = 0;                                                                    \
+        for (; i + 4 <= n; i += 4)                                                       \
+            _mm256_storeu_pd(D + i, INTRIN(_mm256_loadu_pd(A + i), _mm256_loadu_pd(B + i))); \
+        if (i < n)                                                                       \
+            scalarKernels::SCALAR(D + i, A + i, B + i, n - i);                           \
+    }
+
+    CANGA_AVX2_PD(addF, _mm256_add_pd, addF)
+    CANGA_AVX2_PD(subF, _mm256_sub_pd, subF)
+    CANGA_AVX2_PD(mulF, _mm256_mul_pd, mulF)
+    CANGA_AVX2_PD(divF, _mm256_div_pd, divF)
+#undef CANGA_AVX2_PD
+
+    template <int PRED>
+    CANGA_AVX2 static void cmpF(void *d, const void *a, const void *b, size_t n, KernelBinaryFn tail)
+    {
+        int64_t *D = (int64_t *)d;
+        const double *A = (const double *)a, *B = (const double *)b;
+        const __m256i one = _mm256_set1_epi64x(1);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256d m = _mm256_cmp_pd(_mm256_loadu_pd(A + i), _mm256_loadu_pd(B + i), PRED);
+            _mm256_storeu_si256((__m256i *)(D + i), _mm256_and_si256(_mm256_castpd_si256(m), one));
+        }
+        if (i < n)
+            tail(D + i, A + i, B + i, n - i);
+    }
+
+    static void ltF(void *d, const void *a, const void *b, size_t n) { cmpF<_CMP_LT_OQ>(d, a, b, n, scalarKernels::ltF); }
+    static void leF(void *d, const void *a, const void *b, size_t n) { cmpF<_CMP_LE_OQ>(d, a, b, n, scalarKernels::leF); }
+    static void gtF(void *d, const void *a, const void *b, size_t n) { cmpF<_CMP_GT_OQ>(d, a, b, n, scalarKernels::gtF); }
+    static void geF(void *d, const void *a, const void *b, size_t n) { cmpF<_CMP_GE_OQ>(d, a, b, n, scalarKernels::geF); }
+    static void eqF(void *d, const void *a, const void *b, size_t n) { cmpF<_CMP_EQ_OQ>(d, a, b, n, scalarKernels::eqF); }
+    static void neF(void *d, const void *a, const void *b, size_t n) { cmpF<_CMP_NEQ_UQ>(d, a, b, n, scalarKernels::neF); }
+
+#define CANGA_AVX2_EPI64(NAME, BODY, SCALAR)                                           \
+    CANGA_AVX2 static void NAME(void *d, const void *a, const void *b, size_t n)      \
+    {                                                                                  \
+        int64_t *D = (int64_t *)d;                                                     \
+        const int64_t *A = (const int64_t *)a, *B = (const int64_t *)b;                \
+        const __m256i one = _mm256_set1_epi64x(1);                                     \
+        (void)one;                                                                     \
+        size_t i = 0;                                                                  \
+        for (; i + 4 <= n; i += 4)                                                     \
+        {                                                                              \
+            __m256i x = _mm256_loadu_si256((const __m256i *)(A + i));                  \
+            __m256i y = _mm256_loadu_si256((const __m256i *)(B + i));                  \
+            _mm256_storeu_si256((__m256i *)(D + i), BODY);                             \
+        }                                                                              \
+        if (i < n)                                                                     \
+            scalarKernels::SCALAR(D + i, A + i, B + i, n - i);                         \
+    }
+
+    CANGA_AVX2_EPI64(addI, _mm256_add_epi64(x, y), addI)
+    CANGA_AVX2_EPI64(subI, _mm256_sub_epi64(x, y), subI)
+    CANGA_AVX2_EPI64(ltI, _mm256_and_si256(_mm256_cmpgt_epi64(y, x), one), ltI)
+    CANGA_AVX2_EPI64(gtI, _mm256_and_si256(_mm256_cmpgt_epi64(x, y), one), gtI)
+    CANGA_AVX2_EPI64(leI, _mm256_andnot_si256(_mm256_cmpgt_epi64(x, y), one), leI)
+    CANGA_AVX2_EPI64(geI, _mm256_andnot_si256(_mm256_cmpgt_epi64(y, x), one), geI)
+    CANGA_AVX2_EPI64(eqI, _mm256_and_si256(_mm256_cmpeq_epi64(x, y), one), eqI)
+    CANGA_AVX2_EPI64(neI, _mm256_andnot_si256(_mm256_cmpeq_epi64(x, y), one), neI)
+#undef CANGA_AVX2_EPI64
+
+    CANGA_AVX2 static void negF(void *d, const void *a, size_t n)
+    {
+        double *D = (double *)d;
+        const double *A = (const double *)a;
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_pd(D + i, _mm256_xor_pd(_mm256_loadu_pd(A + i), sign));
+        if (i < n)
+            scalarKernels::negF(D + i, A + i, n - i);
+    }
+
+    CANGA_AVX2 static void negI(void *d, const void *a, size_t n)
+    {
+        int64_t *D = (int64_t *)d;
+        const int64_t *A = (const int64_t *)a;
+        const __m256i zero = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm256_storeu_si256((__m256i *)(D + i), _mm256_sub_epi64(zero, _mm256_loadu_si256((const __m256i *)(A + i))));
+        if (i < n)
+            scalarKernels::negI(D + i, A + i, n - i);
+    }
+
+    // int64 -> double sem AVX-512: truque do número mágico para |x| < 2^51,
+    // com recuo escalar para o bloco quando algum valor está fora da faixa
+    CANGA_AVX2 static void i2f(void *d, const void *a, size_t n)
+    {
+        double *D = (double *)d;
+        const int64_t *A = (const int64_t *)a;
+        const __m256i magicI = _mm256_castpd_si256(_mm256_set1_pd(6755399441055744.0)); // 2^52 + 2^51
+        const __m256d magicD = _mm256_set1_pd(6755399441055744.0);
+        const __m256i lim = _mm256_set1_epi64x((1LL << 51) - 1);
+        const __m256i nlim = _mm256_set1_epi64x(-(1LL << 51));
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(A + i));
+            __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(x, lim), _mm256_cmpgt_epi64(nlim, x));
+            if (!_mm256_testz_si256(out, out))
+            {
+                scalarKernels::i2f(D + i, A + i, 4);
+                continue;
+            }
+            __m256d v = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(x, magicI)), magicD);
+            _mm256_storeu_pd(D + i, v);
+        }
+        if (i < n)
+            scalarKernels::i2f(D + i, A + i, n - i);
+    }
+
+#undef CANGA_AVX2
+}
+#endif
+
+// ===============================
+//  Tabela de despacho por conjunto de instruções
+// ===============================
+struct KernelTable
+{
+    KernelBinaryFn binary[(int)KOp::COUNT];
+    KernelUnaryFn unary[(int)KOp::COUNT];
+};
+
+inline KernelTable kernelTableFor(KernelIsa isa)
+{
+    KernelTable t;
+    std::memset(&t, 0, sizeof(t));
+    using namespace scalarKernels;
+    t.binary[(int)KOp::ADD_I] = addI;
+    t.binary[(int)KOp::SUB_I] = subI;
+    t.binary[(int)KOp::MUL_I] = mulI;
+    t.binary[(int)KOp::DIV_I] = divI;
+    t.binary[(int)KOp::MOD_I] = modI;
+    t.binary[(int)KOp::ADD_F] = addF;
+    t.binary[(int)KOp::SUB_F] = subF;
+    t.binary[(int)KOp::MUL_F] = mulF;
+    t.binary[(int)KOp::DIV_F] = divF;
+    t.binary[(int)KOp::LT_I] = ltI;
+    t.binary[(int)KOp::LE_I] = leI;
+    t.binary[(int)KOp::GT_I] = gtI;
+    t.binary[(int)KOp::GE_I] = geI;
+    t.binary[(int)KOp::EQ_I] = eqI;
+    t.binary[(int)KOp::NE_I] = neI;
+    t.binary[(int)KOp::LT_F] = ltF;
+    t.binary[(int)KOp::LE_F] = leF;
+    t.binary[(int)KOp::GT_F] = gtF;
+    t.binary[(int)KOp::GE_F] = geF;
+    t.binary[(int)KOp::EQ_F] = eqF;
+    t.binary[(int)KOp::NE_F] = neF;
+    t.unary[(int)KOp::NEG_I] = negI;
+    t.unary[(int)KOp::NEG_F] = negF;
+    t.unary[(int)KOp::I2F] = i2f;
+    t.unary[(int)KOp::F2I] = f2i;
+
+#ifdef CANGA_X86
+    if (isa == KernelIsa::SSE2 || isa == KernelIsa::AVX2)
+    {
+        t.binary[(int)KOp::ADD_F] = sse2Kernels::addF;
+        t.binary[(int)KOp::SUB_F] = sse2Kernels::subF;
+        t.binary[(int)KOp::MUL_F] = sse2Kernels::mulF;
+        t.binary[(int)KOp::DIV_F] = sse2Kernels::divF;
+        t.binary[(int)KOp::ADD_I] = sse2Kernels::addI;
+        t.binary[(int)KOp::SUB_I] = sse2Kernels::subI;
+        t.binary[(int)KOp::LT_F] = sse2Kernels::ltF;
+        t.binary[(int)KOp::LE_F] = sse2Kernels::leF;
+        t.binary[(int)KOp::GT_F] = sse2Kernels::gtF;
+        t.binary[(int)KOp::GE_F] = sse2Kernels::geF;
+        t.binary[(int)KOp::EQ_F] = sse2Kernels::eqF;
+        t.binary[(int)KOp::NE_F] = sse2Kernels::neF;
+        t.unary[(int)KOp::NEG_F] = sse2Kernels::negF;
+        t.unary[(int)KOp::NEG_I] = sse2Kernels::negI;
+    }
+    if (isa == KernelIsa::AVX2)
+    {
+        t.binary[(int)KOp::ADD_F] = avx2Kernels::addF;
+        t.binary[(int)KOp::SUB_F] = avx2Kernels::subF;
+        t.binary[(int)KOp::MUL_F] = avx2Kernels::mulF;
+        t.binary[(int)KOp::DIV_F] = avx2Kernels::divF;
+        t.binary[(int)KOp::ADD_I] = avx2Kernels::addI;
+        t.binary[(int)KOp::SUB_I] = avx2Kernels::subI;
+        t.binary[(int)KOp::LT_I] = avx2Kernels::ltI;
+        t.binary[(int)KOp::LE_I] = avx2Kernels::leI;
+        t.binary[(int)KOp::GT_I] = avx2Kernels::gtI;
+        t.binary[(int)KOp::GE_I] = avx2Kernels::geI;
+        t.binary[(int)KOp::EQ_I] = avx2Kernels::eqI;
+        t.binary[(int)KOp::NE_I] = avx2Kernels::neI;
+        t.binary[(int)KOp::LT_F] = avx2Kernels::ltF;
+        t.binary[(int)KOp::LE_F] = avx2Kernels::leF;
+        t.binary[(int)KOp::GT_F] = avx2Kernels::gtF;
+        t.binary[(int)KOp::GE_F] = avx2Kernels::geF;
+        t.binary[(int)KOp::EQ_F] = avx2Kernels::eqF;
+        t.binary[(int)KOp::NE_F] = avx2Kernels::neF;
+        t.unary[(int)KOp::NEG_F] = avx2Kernels::negF;
+        t.unary[(int)KOp::NEG_I] = avx2Kernels::negI;
+        t.unary[(int)KOp::I2F] = avx2Kernels::i2f;
+    }
+#else
+    (void)isa;
+#endif
+    return t;
+}
+
+inline KernelIsa detectKernelIsa()
+{
+#ifdef CANGA_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return KernelIsa::AVX2;
+    return KernelIsa::SSE2;
+#else
+    return KernelIsa::SCALAR;
+#endif
+}
+
+inline const char *kernelIsaName(KernelIsa isa)
+{
+    switch (isa)
+    {
+    case KernelIsa::AVX2:
+        return "AVX2";
+    case KernelIsa::SSE2:
+        return "SSE2";
+    default:
+        return "escalar";
+    }
+}
+
+// Avaliador de kernels: mantém a tabela de despacho e os buffers de trabalho
+class KernelEvaluator
+{
+public:
+    explicit KernelEvaluator(KernelIsa isa = detectKernelIsa())
+    {
+        setIsa(isa);
+    }
+
+    void setIsa(KernelIsa isa)
+    {
+        isa_ = isa;
+        table_ = kernelTableFor(isa);
+    }
+
+    KernelIsa isa() const
+    {
+        return isa_;
+    }
+
+    // Avalia ops[0..count) sobre `length` elementos, gravando em dst
+    void eval(const KernelOp *ops, size_t count, const KernelOperand *operands, void *dst, size_t length)
+    {
+        // Metade inicial: buffers de SPLAT; metade final: intermediários
+        if (scratch_.size() < 2 * count * KERNEL_CHUNK)
+            scratch_.resize(2 * count * KERNEL_CHUNK);
+        stack_.resize(count);
+
+        // Escalares são replicados uma única vez, fora do laço de blocos
+        for (size_t k = 0; k < count; ++k)
+        {
+            int64_t *buf = &scratch_[k * KERNEL_CHUNK];
+            if (ops[k].op == KOp::SPLAT_I)
+                std::fill(buf, buf + KERNEL_CHUNK, operands[k].i);
+            else if (ops[k].op == KOp::SPLAT_F)
+                std::fill((double *)buf, (double *)buf + KERNEL_CHUNK, operands[k].f);
+        }
+
+        char *out = (char *)dst;
+        for (size_t base = 0; base < length; base += KERNEL_CHUNK)
+        {
+            size_t n = std::min(KERNEL_CHUNK, length - base);
+            size_t sp = 0;
+            for (size_t k = 0; k < count; ++k)
+            {
+                KOp op = ops[k].op;
+                switch (op)
+                {
+                case KOp::LOAD_I:
+                case KOp::LOAD_F:
+                    stack_[sp++] = (const char *)operands[k].data + base * 8;
+                    break;
+                case KOp::SPLAT_I:
+                case KOp::SPLAT_F:
+                    stack_[sp++] = &scratch_[k * KERNEL_CHUNK];
+                    break;
+                case KOp::I2F:
+                case KOp::F2I:
+                case KOp::NEG_I:
+                case KOp::NEG_F:
+                {
+                    void *res = temp(sp - 1, count);
+                    table_.unary[(int)op](res, stack_[sp - 1], n);
+                    stack_[sp - 1] = res;
+                    break;
+                }
+                default:
+                {
+                    void *res = temp(sp - 2, count);
+                    table_.binary[(int)op](res, stack_[sp - 2], stack_[sp - 1], n);
+                    stack_[sp - 2] = res;
+                    --sp;
+                    break;
+                }
+                }
+            }
+            std::memcpy(out + base * 8, stack_[0], n * 8);
+        }
+    }
+
+private:
+    KernelIsa isa_;
+    KernelTable table_;
+    std::vector<int64_t> scratch_;
+    std::vector<const void *> stack_;
+
+    // Buffer intermediário da posição `slot` da pilha
+    void *temp(size_t slot, size_t count)
+    {
+        return &scratch_[(count + slot) * KERNEL_CHUNK];
+    }
+};
@@ -0,0 +1,546 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trace.cpp"
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define CANGA_IO_URING 1
+#endif
+#endif
+
+// ===============================
+//  E/S de arquivos em lote
+// ===============================
+// Na compilação de vários fontes, as leituras dos próximos arquivos e as
+// gravações dos relatórios prontos são enfileiradas aqui e feitas em
+// segundo plano enquanto a thread principal analisa. Por padrão um pool de
+// threads faz as leituras e gravações com E/S bloqueante. Com io_uring
+// (opcional, Linux 5.6 ou mais novo) abrir, consultar o tamanho, ler ou
+// gravar e fechar cada arquivo viram operações do anel, e cada
+// io_uring_enter submete o lote pendente e recolhe as que terminaram. Se o
+// kernel não tiver io_uring ou alguma dessas operações (verificado com
+// IORING_REGISTER_PROBE), o pool é usado no lugar. Nas medições do
+// benchmark o io_uring ficou mais lento que o pool para fontes pequenos,
+// por isso não é o padrão.
+
+// Operações em andamento no io_uring
+const unsigned BATCH_IO_RING_ENTRIES = 64;
+
+class BatchIo
+{
+public:
+    // `threads`: tamanho do pool; `useIoUring` pede o io_uring, se o
+    // kernel tiver todas as operações usadas
+    explicit BatchIo(unsigned threads = 4, bool useIoUring = false)
+    {
+#ifdef CANGA_IO_URING
+        if (useIoUring && setupRing())
+            return;
+#endif
+        (void)useIoUring;
+        for (unsigned t = 0; t < std::max(1u, threads); ++t)
+            workers_.emplace_back([this]
+                                  { work(); });
+    }
+
+    ~BatchIo()
+    {
+        try
+        {
+            finish();
+#ifdef CANGA_IO_URING
+            // Leituras não recolhidas ainda escrevem nos buffers das operações
+            while (usingIoUring() && inFlight_)
+                reap(true);
+#endif
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto &t : workers_)
+            t.join();
+#ifdef CANGA_IO_URING
+        if (ring_.fd >= 0)
+            unmapRing();
+#endif
+    }
+
+    BatchIo(const BatchIo &) = delete;
+    BatchIo &operator=(const BatchIo &) = delete;
+
+    bool usingIoUring() const
+    {
+        return workers_.empty();
+    }
+
+    // Enfileira a leitura do arquivo inteiro; o conteúdo sai em take(id)
+    size_t read(const std::string &path)
+    {
+        ops_.emplace_back(new Op{path, {}, false});
+        start(ops_.back().get());
+        return ops_.size() - 1;
+    }
+
+    // Espera a leitura `id` e devolve o conteúdo
+    std::string take(size_t id)
+    {
+        Op *op = ops_[id].get();
+        wait(op);
+        if (!op->error.empty())
+            throw std::runtime_error(op->error);
+        std::string data = std::move(op->data);
+        ops_[id].reset();
+        return data;
+    }
+
+    // Enfileira a gravação de `text` em `path` (arquivo criado ou truncado)
+    void write(const std::string &path, std::string text)
+    {
+        ops_.emplace_back(new Op{path, std::move(text), true});
+        writes_.push_back(ops_.size() - 1);
+        start(ops_.back().get());
+    }
+
+    // Envia as operações enfileiradas sem esperar por elas (no pool elas já
+    // começam ao serem enfileiradas)
+    void submit()
+    {
+#ifdef CANGA_IO_URING
+        if (usingIoUring() && pending_)
+            reap(false);
+#endif
+    }
+
+    // Espera todas as gravações enfileiradas; o primeiro erro é lançado
+    void finish()
+    {
+        std::string error;
+        for (size_t id : writes_)
+        {
+            Op *op = ops_[id].get();
+            wait(op);
+            if (error.empty())
+                error = op->error;
+            ops_[id].reset();
+        }
+        writes_.clear();
+        if (!error.empty())
+            throw std::runtime_error(error);
+    }
+
+private:
+    struct Op
+    {
+        std::string path;
+        std::string data;
+        bool write;
+        std::string error = "";
+        size_t done = 0; // bytes já transferidos
+        int fd = -1;
+        bool complete = false; // protegido por mutex_ no pool
+#ifdef CANGA_IO_URING
+        int stage = 0;            // RingStage da operação no anel
+        struct statx status = {}; // tamanho do arquivo lido
+#endif
+#ifdef CANGA_WITH_TRACE
+        TraceLog::Clock::time_point started = {}; // envio ao io_uring
+#endif
+    };
+
+    std::vector<std::unique_ptr<Op>> ops_;
+    std::vector<size_t> writes_;
+
+    void start(Op *op)
+    {
+#ifdef CANGA_IO_URING
+        if (usingIoUring())
+        {
+            startRing(op);
+            return;
+        }
+#endif
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(op);
+        }
+        wake_.notify_one();
+    }
+
+    void wait(Op *op)
+    {
+        TRACE_SCOPE("espera de E/S", op->path);
+#ifdef CANGA_IO_URING
+        if (usingIoUring())
+        {
+            while (!op->complete)
+                reap(true);
+            return;
+        }
+#endif
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [op]
+                   { return op->complete; });
+    }
+
+    // ---------- Pool de threads ----------
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::deque<Op *> queue_;
+    bool stopping_ = false;
+
+    void work()
+    {
+        TRACE_THREAD("E/S");
+        while (true)
+        {
+            Op *op;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]
+                           { return stopping_ || !queue_.empty(); });
+                if (queue_.empty())
+                    return;
+                op = queue_.front();
+                queue_.pop_front();
+            }
+            if (op->write)
+                blockingWrite(*op);
+            else
+                blockingRead(*op);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                op->complete = true;
+            }
+            done_.notify_all();
+        }
+    }
+
+    static void blockingRead(Op &op)
+    {
+        TRACE_SCOPE("leitura", op.path);
+        std::FILE *file = std::fopen(op.path.c_str(), "rb");
+        if (!file)
+        {
+            op.error = "Erro ao abrir arquivo: " + op.path;
+            return;
+        }
+        char chunk[64 * 1024];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            op.data.append(chunk, n);
+        std::fclose(file);
+    }
+
+    static void blockingWrite(Op &op)
+    {
+        TRACE_SCOPE("gravacao", op.path);
+        std::FILE *file = std::fopen(op.path.c_str(), "wb");
+        if (!file)
+        {
+            op.error = "Erro ao criar arquivo: " + op.path;
+            return;
+        }
+        bool ok = op.data.empty() || std::fwrite(op.data.data(), 1, op.data.size(), file) == op.data.size();
+        if (std::fclose(file) != 0 || !ok)
+            op.error = "Erro ao gravar arquivo: " + op.path;
+        op.data.clear();
+        op.data.shrink_to_fit();
+    }
+
+#ifdef CANGA_IO_URING
+    // ---------- io_uring ----------
+    // Anéis mapeados do kernel (sem liburing: só as chamadas de sistema)
+    struct Ring
+    {
+        int fd = -1;
+        void *sq = nullptr, *cq = nullptr;
+        size_t sqSize = 0, cqSize = 0, sqesSize = 0;
+        unsigned *sqTail, *sqMask, *sqArray;
+        unsigned *cqHead, *cqTail, *cqMask;
+        io_uring_sqe *sqes = nullptr;
+        io_uring_cqe *cqes;
+    } ring_;
+    unsigned pending_ = 0;  // SQEs preenchidas e ainda não submetidas
+    unsigned inFlight_ = 0; // submetidas ou pendentes, sem conclusão
+
+    // Etapas de cada arquivo no anel; cada uma é uma SQE, enviada quando a
+    // anterior termina
+    enum RingStage
+    {
+        RING_OPEN,
+        RING_STATX, // só leituras: tamanho do buffer
+        RING_TRANSFER,
+        RING_CLOSE
+    };
+
+    bool setupRing()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = (int)syscall(__NR_io_uring_setup, BATCH_IO_RING_ENTRIES, &params);
+        if (fd < 0)
+            return false;
+        if (!supportsOps(fd))
+        {
+            ::close(fd);
+            return false;
+        }
+        ring_.sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring_.cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single)
+            ring_.sqSize = ring_.cqSize = std::max(ring_.sqSize, ring_.cqSize);
+        void *sq = mmap(nullptr, ring_.sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *cq = sq;
+        if (!single)
+        {
+            cq = mmap(nullptr, ring_.cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED)
+            {
+                munmap(sq, ring_.sqSize);
+                ::close(fd);
+                return false;
+            }
+        }
+        ring_.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, ring_.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            if (!single)
+                munmap(cq, ring_.cqSize);
+            munmap(sq, ring_.sqSize);
+            ::close(fd);
+            return false;
+        }
+        char *s = (char *)sq, *c = (char *)cq;
+        ring_.fd = fd;
+        ring_.sq = sq;
+        ring_.cq = cq;
+        ring_.sqTail = (unsigned *)(s + params.sq_off.tail);
+        ring_.sqMask = (unsigned *)(s + params.sq_off.ring_mask);
+        ring_.sqArray = (unsigned *)(s + params.sq_off.array);
+        ring_.cqHead = (unsigned *)(c + params.cq_off.head);
+        ring_.cqTail = (unsigned *)(c + params.cq_off.tail);
+        ring_.cqMask = (unsigned *)(c + params.cq_off.ring_mask);
+        ring_.cqes = (io_uring_cqe *)(c + params.cq_off.cqes);
+        ring_.sqes = (io_uring_sqe *)sqes;
+        return true;
+    }
+
+    // Se o kernel tem todas as operações usadas. IORING_REGISTER_PROBE
+    // surgiu junto com OPENAT, STATX e CLOSE (5.6): kernels mais antigos,
+    // em que o io_uring existe mas nem READ/WRITE estão garantidos, falham
+    // aqui e ficam com o pool
+    static bool supportsOps(int fd)
+    {
+        const unsigned maxOps = 256;
+        std::vector<char> buffer(sizeof(io_uring_probe) + maxOps * sizeof(io_uring_probe_op), 0);
+        io_uring_probe *probe = (io_uring_probe *)buffer.data();
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, maxOps) < 0)
+            return false;
+        for (unsigned op : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE})
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        return true;
+    }
+
+    void unmapRing()
+    {
+        munmap(ring_.sqes, ring_.sqesSize);
+        if (ring_.cq != ring_.sq)
+            munmap(ring_.cq, ring_.cqSize);
+        munmap(ring_.sq, ring_.sqSize);
+        ::close(ring_.fd);
+        ring_.fd = -1;
+    }
+
+    void startRing(Op *op)
+    {
+#ifdef CANGA_WITH_TRACE
+        op->started = TraceLog::Clock::now();
+#endif
+        op->stage = RING_OPEN;
+        io_uring_sqe &sqe = nextSqe(op);
+        sqe.opcode = IORING_OP_OPENAT;
+        sqe.fd = AT_FDCWD;
+        sqe.addr = (uint64_t)(uintptr_t)op->path.c_str();
+        sqe.open_flags = op->write ? O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDONLY | O_CLOEXEC;
+        sqe.len = op->write ? 0644 : 0;
+        queueSqe();
+    }
+
+    // SQE livre, zerada e marcada com `op`; enviada por queueSqe()
+    io_uring_sqe &nextSqe(Op *op)
+    {
+        while (inFlight_ >= BATCH_IO_RING_ENTRIES)
+            reap(true);
+        unsigned index = *ring_.sqTail & *ring_.sqMask;
+        io_uring_sqe &sqe = ring_.sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.user_data = (uint64_t)(uintptr_t)op;
+        ring_.sqArray[index] = index;
+        return sqe;
+    }
+
+    void queueSqe()
+    {
+        __atomic_store_n(ring_.sqTail, *ring_.sqTail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+        ++inFlight_;
+        // Lotes grandes vão sem esperar; os demais seguem no próximo submit()
+        // ou na próxima espera
+        if (pending_ >= BATCH_IO_RING_ENTRIES / 2)
+            enter(0);
+    }
+
+    // Envia a próxima etapa de `op`
+    void advance(Op *op)
+    {
+        io_uring_sqe &sqe = nextSqe(op);
+        sqe.fd = op->fd;
+        switch (op->stage)
+        {
+        case RING_STATX:
+            sqe.opcode = IORING_OP_STATX;
+            sqe.addr = (uint64_t)(uintptr_t)"";
+            sqe.len = STATX_SIZE;
+            sqe.off = (uint64_t)(uintptr_t)&op->status;
+            sqe.statx_flags = AT_EMPTY_PATH;
+            break;
+        case RING_TRANSFER:
+            // A partir de op->done: transferências parciais são retomadas
+            sqe.opcode = op->write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe.addr = (uint64_t)(uintptr_t)(op->data.data() + op->done);
+            sqe.len = (uint32_t)std::min<size_t>(op->data.size() - op->done, 1u << 30);
+            sqe.off = op->done;
+            break;
+        default:
+            sqe.opcode = IORING_OP_CLOSE;
+        }
+        queueSqe();
+    }
+
+    void enter(unsigned minComplete)
+    {
+        unsigned flags = minComplete ? IORING_ENTER_GETEVENTS : 0;
+        long r = syscall(__NR_io_uring_enter, ring_.fd, pending_, minComplete, flags, nullptr, 0);
+        if (r >= 0)
+            pending_ -= std::min<unsigned>(pending_, (unsigned)r);
+        else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            throw std::runtime_error("Erro no io_uring: " + std::string(std::strerror(errno)));
+    }
+
+    // Processa as conclusões disponíveis; com `block`, espera pelo menos uma
+    void reap(bool block)
+    {
+        unsigned head = *ring_.cqHead;
+        if (block && head == __atomic_load_n(ring_.cqTail, __ATOMIC_ACQUIRE))
+            enter(1);
+        else if (pending_)
+            enter(0);
+        unsigned tail = __atomic_load_n(ring_.cqTail, __ATOMIC_ACQUIRE);
+        std::vector<Op *> next;
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe &cqe = ring_.cqes[head & *ring_.cqMask];
+            Op *op = (Op *)(uintptr_t)cqe.user_data;
+            --inFlight_;
+            if (completed(op, cqe.res))
+                next.push_back(op);
+        }
+        __atomic_store_n(ring_.cqHead, head, __ATOMIC_RELEASE);
+        for (Op *op : next)
+            advance(op);
+    }
+
+    // Trata o fim de uma etapa de `op`; retorna se há uma próxima a enviar
+    bool completed(Op *op, int res)
+    {
+        switch (op->stage)
+        {
+        case RING_OPEN:
+            if (res < 0)
+            {
+                op->error = (op->write ? "Erro ao criar arquivo: " : "Erro ao abrir arquivo: ") + op->path;
+                finishRing(op);
+                return false;
+            }
+            op->fd = res;
+            op->stage = op->write ? (op->data.empty() ? RING_CLOSE : RING_TRANSFER) : RING_STATX;
+            return true;
+        case RING_STATX:
+            if (res < 0)
+                return failRing(op, "Erro ao abrir arquivo: ");
+            op->data.resize((size_t)op->status.stx_size);
+            op->stage = op->data.empty() ? RING_CLOSE : RING_TRANSFER;
+            return true;
+        case RING_TRANSFER:
+            if (res < 0 || (res == 0 && op->write))
+                return failRing(op, op->write ? "Erro ao gravar arquivo: " : "Erro ao ler arquivo: ");
+            if (res == 0)
+                op->data.resize(op->done); // arquivo encolheu depois do statx
+            op->done += (size_t)res;
+            if (op->done < op->data.size())
+                return true; // transferência parcial
+            op->stage = RING_CLOSE;
+            return true;
+        default:
+            // Numa gravação, o erro pode aparecer só ao fechar
+            if (res < 0 && op->write && op->error.empty())
+                op->error = "Erro ao gravar arquivo: " + op->path;
+            finishRing(op);
+            return false;
+        }
+    }
+
+    // Registra o erro e segue para o fechamento do arquivo
+    bool failRing(Op *op, const char *error)
+    {
+        op->error = error + op->path;
+        op->stage = RING_CLOSE;
+        return true;
+    }
+
+    void finishRing(Op *op)
+    {
+#ifdef CANGA_WITH_TRACE
+        TraceLog::recordAsync(op->write ? "gravacao" : "leitura", op->path, op->started);
+#endif
+        op->fd = -1;
+        if (op->write || !op->error.empty())
+        {
+            op->data.clear();
+            op->data.shrink_to_fit();
+        }
+        op->complete = true;
+    }
+#endif
+};
@@ -0,0 +1,1614 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include "interpreter.cpp"
+#include "incrementalLexer.cpp"
+#include "analyzer.cpp"
+#include "reports.cpp"
+#include "profiler.cpp"
+#include "bytecodeCache.cpp"
+#include "batchIo.cpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+// ===============================
+//  Benchmarks de desempenho
+// ===============================
+// Programa separado do compilador. Compilar com:
+//   g++ -std=c++17 -O2 benchmark.cpp -o CangaBenchmark
+// ou, incluindo a leitura de fontes .251.gz:
+//   g++ -std=c++17 -O2 -DCANGA_WITH_ZLIB benchmark.cpp -lz -o CangaBenchmark
+
+// Contagem de alocações: substitui o operator new global deste programa.
+// Atômica porque as seções paralelas (análise, relatórios, E/S) também alocam
+static std::atomic<size_t> _allocationCount{0};
+
+void *operator new(size_t size)
+{
+    _allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// std::pmr::new_delete_resource usa as versões alinhadas
+void *operator new(size_t size, std::align_val_t align)
+{
+    _allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::aligned_alloc((size_t)align, ((size ? size : 1) + (size_t)align - 1) / (size_t)align * (size_t)align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+static double _elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Saída descartada: o benchmark mede apenas a execução
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+};
+
+// Constrói o módulo otimizado de um programa cujas variáveis globais são
+// declaradas diretamente na tabela de símbolos
+static IRModule _buildModule(const std::string &source,
+                             const std::vector<std::pair<std::string, std::string>> &vars,
+                             int arrayLength)
+{
+    SymbolTable symtab;
+    for (auto &v : vars)
+    {
+        symtab.defineOrGet(v.first, 0, TokenType::IDENT);
+        symtab.setType(v.first, v.second);
+        if (v.second[0] == 'A')
+            symtab.setArraySize(v.first, arrayLength);
+    }
+    IRModule module = IRBuilder(source, symtab).build();
+    PassManager::standard().run(module);
+    return module;
+}
+
+static double _timeRun(const BcProgram &program, KernelIsa isa)
+{
+    NullBuffer nullBuf;
+    std::ostream nullOut(&nullBuf);
+    Interpreter interpreter(program, nullOut);
+    interpreter.kernels().setIsa(isa);
+    auto start = std::chrono::steady_clock::now();
+    interpreter.run();
+    return _elapsedMs(start);
+}
+
+// Aritmética sobre arrays completos: `u + arr + values` e variações, com
+// os kernels escalares, SSE2 e AVX2, fundidos ou avaliados operação a operação
+static void _benchmarkArrayKernels()
+{
+    const int length = 1 << 18;
+    const int repeats = 200;
+    std::vector<std::pair<std::string, std::string>> vars = {
+        {"K", "IN"}, {"U", "IN"}, {"ARR", "AI"}, {"VALUES", "AI"}, {"OUT", "AI"},
+        {"X", "AF"}, {"Y", "AF"}, {"Z", "AF"}};
+
+    struct Case
+    {
+        const char *name;
+        std::string statement;
+    };
+    std::vector<Case> cases = {
+        {"u + arr + values", "OUT := U + ARR + VALUES;"},
+        {"(arr * values) - u", "OUT := ARR * VALUES - U;"},
+        {"x * 2.5 + y * z", "Z := X * 2.5 + Y * Z;"},
+        {"arr * 0.5 + x", "X := ARR * 0.5 + X;"}};
+
+    std::cout << "== Kernels de arrays (" << length << " elementos, " << repeats << " repeticoes) ==\n";
+    std::cout << std::left << std::setw(26) << "Expressao" << std::setw(10) << "ISA"
+              << std::right << std::setw(14) << "Fundido(ms)" << std::setw(16) << "Separado(ms)"
+              << std::setw(14) << "Melem/s" << "\n";
+
+    KernelIsa best = detectKernelIsa();
+    for (auto &c : cases)
+    {
+        std::string source = "PROGRAM\n{\n    K := 0;\n    U := 7;\n    WHILE (K < " +
+                             std::to_string(repeats) + ") {\n        " + c.statement +
+                             "\n        K := K + 1;\n    }\n    ENDWHILE\n}\nENDPROGRAM\n";
+        IRModule module = _buildModule(source, vars, length);
+        BcProgram fused = BcLowering(true).lower(module);
+        BcProgram separate = BcLowering(false).lower(module);
+
+        for (KernelIsa isa : {KernelIsa::SCALAR, KernelIsa::SSE2, KernelIsa::AVX2})
+        {
+            if ((int)isa > (int)best)
+                continue;
+            double fusedMs = _timeRun(fused, isa);
+            double separateMs = _timeRun(separate, isa);
+            double melems = (double)length * repeats / (fusedMs * 1000.0);
+            std::cout << std::left << std::setw(26) << c.name << std::setw(10) << kernelIsaName(isa)
+                      << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << fusedMs << std::setw(16) << separateMs
+                      << std::setw(14) << melems << "\n";
+        }
+    }
+
+    // Referência: o mesmo cálculo elemento a elemento no interpretador
+    const int loopRepeats = 10;
+    std::string source = "PROGRAM\n{\n    K := 0;\n    U := 7;\n    WHILE (K < " +
+                         std::to_string(loopRepeats) + ") {\n        I := 0;\n        WHILE (I < " +
+                         std::to_string(length) + ") {\n            OUT[I] := U + ARR[I] + VALUES[I];\n"
+                         "            I := I + 1;\n        }\n        ENDWHILE\n        K := K + 1;\n    }\n"
+                         "    ENDWHILE\n}\nENDPROGRAM\n";
+    vars.push_back({"I", "IN"});
+    BcProgram loop = BcLowering(true).lower(_buildModule(source, vars, length));
+    double loopMs = _timeRun(loop, best);
+    std::cout << std::left << std::setw(26) << "laco elemento a elemento" << std::setw(10) << "-"
+              << std::right << std::setw(14) << loopMs << std::setw(16) << "-"
+              << std::setw(14) << (double)length * loopRepeats / (loopMs * 1000.0) << "\n\n";
+}
+
+// Análise de um fonte grande com a memória vinda do heap global, de uma
+// arena monotônica e de um pool sem sincronização; o tempo inclui a
+// liberação de tudo no fim
+static void _benchmarkMemoryResources()
+{
+    std::mt19937 rng(251);
+    std::string source = "PROGRAM\nDECLARATIONS\n    varType integer: a, b;\n";
+    for (int k = 0; k < 5000; ++k)
+        source += "    varType real: valor_intermediario_" + std::to_string(k) + ";\n";
+    source += "ENDDECLARATIONS\n{\n";
+    while (source.size() < (8u << 20))
+    {
+        std::string n = std::to_string(rng() % 5000);
+        source += "    valor_intermediario_" + n + " := a + b * " + n +
+                  "; /* passo do calculo */ PRINT \"resultado parcial do passo\";\n";
+    }
+    source += "}\nENDPROGRAM\n";
+
+    std::cout << "== Recursos de memoria (" << source.size() / (1 << 20) << " MB de fonte) ==\n";
+    std::cout << std::left << std::setw(22) << "Recurso" << std::right << std::setw(14) << "Alocacoes"
+              << std::setw(14) << "Analise(ms)" << std::setw(16) << "Liberacao(ms)" << "\n";
+
+    // Melhor de 5 execuções; o recurso é criado e destruído dentro da medida
+    auto run = [&](const char *name, auto makeResource)
+    {
+        size_t allocations = 0;
+        double bestAnalysis = 1e300, bestRelease = 1e300;
+        for (int r = 0; r < 5; ++r)
+        {
+            size_t before = _allocationCount.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            auto resource = makeResource();
+            std::unique_ptr<SymbolTable> symtab(new SymbolTable(resource.get()));
+            std::unique_ptr<LexemeList> lexemes(new LexemeList(resource.get()));
+            analyzeSource(source, *symtab, *lexemes);
+            bestAnalysis = std::min(bestAnalysis, _elapsedMs(start));
+
+            start = std::chrono::steady_clock::now();
+            lexemes.reset();
+            symtab.reset();
+            resource.reset();
+            bestRelease = std::min(bestRelease, _elapsedMs(start));
+            allocations = _allocationCount.load(std::memory_order_relaxed) - before;
+        }
+        std::cout << std::left << std::setw(22) << name << std::right << std::setw(14) << allocations
+                  << std::fixed << std::setprecision(2) << std::setw(14) << bestAnalysis
+                  << std::setw(16) << bestRelease << "\n";
+    };
+
+    // Sem recurso próprio: o comportamento anterior, tudo no heap global
+    run("heap global", []
+        { return std::unique_ptr<std::pmr::memory_resource, void (*)(std::pmr::memory_resource *)>(
+              std::pmr::new_delete_resource(), [](std::pmr::memory_resource *) {}); });
+    run("arena monotonica", []
+        { return std::unique_ptr<std::pmr::memory_resource>(new std::pmr::monotonic_buffer_resource(1 << 16)); });
+    run("pool por thread", []
+        { return std::unique_ptr<std::pmr::memory_resource>(new std::pmr::unsynchronized_pool_resource()); });
+    std::cout << "\n";
+}
+
+static std::string _joined(const std::vector<std::string> &shards)
+{
+    std::string out;
+    for (auto &s : shards)
+        out += s;
+    return out;
+}
+
+// Formatação do .TAB e do .LEX: o caminho anterior (cópia da tabela e
+// ordenação por entrada) contra a varredura em ordem de inserção,
+// sequencial e em fatias paralelas; os textos têm de ser idênticos
+static bool _benchmarkReports()
+{
+    std::mt19937 rng(251);
+    std::string source = "PROGRAM\nDECLARATIONS\n";
+    for (int k = 0; k < 20000; ++k)
+        source += "    varType integer: v" + std::to_string(k) + ", w" + std::to_string(k) + ";\n";
+    source += "ENDDECLARATIONS\n{\n";
+    for (int k = 0; k < 100000; ++k)
+        source += "    v" + std::to_string(rng() % 20000) + " := w" + std::to_string(rng() % 20000) + " + 1;\n";
+    source += "}\nENDPROGRAM\n";
+
+    SymbolTable symtab;
+    LexemeList lexemes;
+    analyzeSource(source, symtab, lexemes);
+    unsigned jobs = std::max(2u, std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    SymbolTable copy = symtab;
+    std::vector<SymbolTable::SymbolInfo> sorted(copy.all().begin(), copy.all().end());
+    std::sort(sorted.begin(), sorted.end(), [](auto &a, auto &b)
+              { return a.entry < b.entry; });
+    std::string tabBefore = _joined(formatSymbolEntries(copy, 1));
+    double tabCopyMs = _elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::string tabSequential = _joined(formatSymbolEntries(symtab, 1));
+    double tabSequentialMs = _elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    std::string tabParallel = _joined(formatSymbolEntries(symtab, jobs));
+    double tabParallelMs = _elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    LexemeList lexCopy = lexemes;
+    std::string lexBefore = _joined(formatLexRecords(lexCopy, symtab.lines(), 1));
+    double lexCopyMs = _elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    std::string lexSequential = _joined(formatLexRecords(lexemes, symtab.lines(), 1));
+    double lexSequentialMs = _elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    std::string lexParallel = _joined(formatLexRecords(lexemes, symtab.lines(), jobs));
+    double lexParallelMs = _elapsedMs(start);
+
+    if (tabBefore != tabSequential || tabSequential != tabParallel ||
+        lexBefore != lexSequential || lexSequential != lexParallel)
+    {
+        std::cout << "Relatorios diferentes entre os caminhos de formatacao\n";
+        return false;
+    }
+
+    std::cout << "== Relatorios (" << symtab.all().size() << " simbolos, " << lexemes.size() << " lexemas) ==\n";
+    std::cout << std::left << std::setw(34) << "Caminho" << std::right << std::setw(12) << ".TAB(ms)"
+              << std::setw(12) << ".LEX(ms)" << "\n"
+              << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(34) << "copia da tabela + ordenacao" << std::right
+              << std::setw(12) << tabCopyMs << std::setw(12) << lexCopyMs << "\n";
+    std::cout << std::left << std::setw(34) << "ordem de insercao, sequencial" << std::right
+              << std::setw(12) << tabSequentialMs << std::setw(12) << lexSequentialMs << "\n";
+    std::cout << std::left << std::setw(34) << ("ordem de insercao, " + std::to_string(jobs) + " threads") << std::right
+              << std::setw(12) << tabParallelMs << std::setw(12) << lexParallelMs << "\n";
+    std::cout << "Textos identicos nos tres caminhos\n\n";
+    return true;
+}
+
+// Análise das funções em paralelo: programa com milhares de FUNCTYPE,
+// analisado com 1, 2, 4 e todas as threads da máquina. O .LEX, o .TAB e as
+// referências cruzadas têm de ser idênticos aos da análise sequencial.
+static bool _benchmarkParallelAnalysis()
+{
+    const int functions = 4000;
+    std::string source = "PROGRAM\nDECLARATIONS\n    varType integer: g, h, total;\n"
+                         "    varType real[]: tab[10];\nENDDECLARATIONS\nFUNCTIONS\n";
+    for (int f = 0; f < functions; ++f)
+    {
+        std::string n = std::to_string(f);
+        source += "    FUNCTYPE integer: f" + n + "(paramType integer: a" + std::to_string(f % 50) + ", b" + n +
+                  "; paramType real: x[4])\n    {\n"
+                  "        g := a" + std::to_string(f % 50) + " + b" + n + " * h + b" + std::to_string(f / 2) + ";\n"
+                  "        WHILE (g < 10) { g := g + 1; total := total + x[1] + tab[2]; }\n"
+                  "        ENDWHILE\n        return b" + n + " + total;\n    }\n    ENDFUNCTION\n";
+    }
+    source += "ENDFUNCTIONS\n{\n    g := 1;\n}\nENDPROGRAM\n";
+
+    std::string expectedLex, expectedTab, expectedXref;
+    double sequentialMs = 0;
+    std::cout << "== Analise paralela das funcoes (" << functions << " funcoes, " << source.size() / 1024
+              << " KiB; menor de 3) ==\n"
+              << std::setw(8) << "Threads" << std::setw(12) << "Tempo(ms)" << std::setw(10) << "ganho" << "\n"
+              << std::fixed << std::setprecision(2);
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> jobCounts = {1, 2, 4};
+    if (hardware > 4)
+        jobCounts.push_back(hardware);
+    for (unsigned jobs : jobCounts)
+    {
+        double best = 1e30;
+        for (int r = 0; r < 3; ++r)
+        {
+            SymbolTable symtab;
+            LexemeList lexemes;
+            auto start = std::chrono::steady_clock::now();
+            analyzeSource(source, symtab, lexemes, AnalysisLimits(), nullptr, jobs);
+            best = std::min(best, _elapsedMs(start));
+
+            std::string lex = _joined(formatLexRecords(lexemes, symtab.lines()));
+            std::string tab = _joined(formatSymbolEntries(symtab));
+            std::ostringstream xref;
+            for (auto &info : symtab.all())
+                for (auto &use : symtab.usesOf(info.lexeme))
+                    xref << info.entry << ":" << use.line << ":" << use.column << "\n";
+            if (expectedLex.empty())
+            {
+                expectedLex = lex;
+                expectedTab = tab;
+                expectedXref = xref.str();
+            }
+            else if (lex != expectedLex || tab != expectedTab || xref.str() != expectedXref)
+            {
+                std::cout << "Resultado diferente da analise sequencial com " << jobs << " threads\n";
+                return false;
+            }
+        }
+        if (jobs == 1)
+            sequentialMs = best;
+        std::cout << std::setw(8) << jobs << std::setw(12) << best << std::setw(9) << sequentialMs / best << "x\n";
+    }
+    std::cout << ".LEX, .TAB e referencias cruzadas identicos aos da analise sequencial\n\n";
+    return true;
+}
+
+// Custo do perfil de execução: o mesmo programa (laço com chamadas) sem
+// perfil e com contagem + amostragem; confere a contagem exata de entradas
+// na função chamada
+static bool _benchmarkProfiler()
+{
+    const int outer = 200, inner = 10000;
+    std::string source = "PROGRAM\nDECLARATIONS\n    varType integer: i, s, k;\nENDDECLARATIONS\nFUNCTIONS\n"
+                         "    FUNCTYPE integer: quadrado(paramType integer: x)\n    {\n        return x * x;\n    }\n"
+                         "    ENDFUNCTION\n"
+                         "    FUNCTYPE integer: acumula(paramType integer: n)\n    {\n        k := 0;\n"
+                         "        WHILE (k < n) {\n            s := s + quadrado(k) % 7;\n            k := k + 1;\n"
+                         "        }\n        ENDWHILE\n        return s;\n    }\n    ENDFUNCTION\nENDFUNCTIONS\n"
+                         "{\n    i := 0;\n    s := 0;\n    WHILE (i < " + std::to_string(outer) + ") {\n"
+                         "        s := acumula(" + std::to_string(inner) + ");\n        i := i + 1;\n    }\n"
+                         "    ENDWHILE\n    PRINT s;\n}\nENDPROGRAM\n";
+    SymbolTable symtab;
+    LexemeList lexemes;
+    analyzeSource(source, symtab, lexemes);
+    IRModule module = IRBuilder(source, symtab).build();
+    // Sem expansão de funções: QUADRADO tem de continuar sendo chamada
+    PassManager::standard(0).run(module);
+    BcProgram program = BcLowering().lower(module);
+
+    NullBuffer nullBuf;
+    std::ostream nullOut(&nullBuf);
+    const int repeats = 15;
+    double plainMs = 1e30, profiledMs = 1e30;
+    ExecutionProfile profile;
+    for (int r = 0; r < repeats; ++r)
+    {
+        Interpreter plain(program, nullOut);
+        auto start = std::chrono::steady_clock::now();
+        plain.run();
+        plainMs = std::min(plainMs, _elapsedMs(start));
+
+        Interpreter profiled(program, nullOut);
+        profiled.setProfile(&profile);
+        start = std::chrono::steady_clock::now();
+        profiled.run();
+        profiledMs = std::min(profiledMs, _elapsedMs(start));
+    }
+
+    uint64_t instructions = 0, calls = 0;
+    for (uint64_t c : profile.counts)
+        instructions += c;
+    for (auto &fn : program.functions)
+        if (fn.name == "QUADRADO")
+            calls = profile.counts[fn.codeStart];
+    if (calls != (uint64_t)outer * inner)
+    {
+        std::cout << "Perfil: " << calls << " entradas em QUADRADO, esperadas " << (uint64_t)outer * inner << "\n";
+        return false;
+    }
+
+    std::cout << "== Perfil de execucao (" << instructions << " instrucoes) ==\n"
+              << std::fixed << std::setprecision(2)
+              << std::left << std::setw(34) << "sem perfil (ms)" << std::right << std::setw(12) << plainMs << "\n"
+              << std::left << std::setw(34) << "contagem + amostragem (ms)" << std::right << std::setw(12) << profiledMs
+              << "\n"
+              << std::left << std::setw(34) << "custo do perfil" << std::right << std::setw(11)
+              << 100.0 * (profiledMs - plainMs) / plainMs << "%\n"
+              << "Amostras de tempo: " << profile.samples << "; entradas em QUADRADO conferidas\n\n";
+    return true;
+}
+
+// Compilação separada: um programa pequeno que usa uma biblioteca grande,
+// analisado com a biblioteca no mesmo fonte e importando a interface .251i
+// gerada uma vez. Os tipos dos símbolos do programa têm de coincidir.
+static bool _benchmarkModuleInterface()
+{
+    const int functions = 4000;
+    std::string declarations, library;
+    for (int k = 0; k < functions; ++k)
+    {
+        std::string n = std::to_string(k);
+        declarations += "    varType integer: g" + n + ";\n    varType real[]: w" + n + "[4];\n";
+        library += "    FUNCTYPE integer: f" + n + "(paramType integer: a" + n + ", b" + n +
+                   "; paramType real: v" + n + "[4])\n    {\n        g" + n + " := g" + n + " + a" + n +
+                   ";\n        return a" + n + " + b" + n + " * " + n + ";\n    }\n    ENDFUNCTION\n";
+    }
+    std::string body = "{\n";
+    for (int k = 0; k < 20; ++k)
+    {
+        std::string n = std::to_string(k * 97);
+        body += "    r := r + f" + n + "(g" + n + ", " + std::to_string(k) + ", w" + n + ");\n";
+    }
+    body += "    PRINT r;\n}\nENDPROGRAM\n";
+    std::string libSource = "PROGRAM\nDECLARATIONS\n" + declarations + "ENDDECLARATIONS\nFUNCTIONS\n" + library +
+                            "ENDFUNCTIONS\n{\n}\nENDPROGRAM\n";
+    std::string whole = "PROGRAM\nDECLARATIONS\n    varType integer: r;\n" + declarations +
+                        "ENDDECLARATIONS\nFUNCTIONS\n" + library + "ENDFUNCTIONS\n" + body;
+    std::string program = "PROGRAM\nDECLARATIONS\n    varType integer: r;\nENDDECLARATIONS\n" + body;
+
+    std::string dir = "/tmp";
+    if (const char *tmp = std::getenv("TMPDIR"))
+        dir = tmp;
+    std::string path = dir + "/canga-bench.251i";
+    auto start = std::chrono::steady_clock::now();
+    {
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(libSource, symtab, lexemes);
+        emitModuleInterface(path, libSource, symtab);
+    }
+    double emitMs = _elapsedMs(start);
+
+    const int repeats = 5;
+    double wholeMs = 1e30, importMs = 1e30, wholeIrMs = 1e30, importIrMs = 1e30;
+    bool same = true;
+    for (int r = 0; r < repeats; ++r)
+    {
+        start = std::chrono::steady_clock::now();
+        SymbolTable full;
+        LexemeList fullLexemes;
+        analyzeSource(whole, full, fullLexemes);
+        wholeMs = std::min(wholeMs, _elapsedMs(start));
+        start = std::chrono::steady_clock::now();
+        IRModule fullModule = IRBuilder(whole, full).build();
+        wholeIrMs = std::min(wholeIrMs, _elapsedMs(start));
+
+        start = std::chrono::steady_clock::now();
+        ModuleInterface iface(path);
+        SymbolTable small;
+        small.importInterface(iface);
+        LexemeList smallLexemes;
+        analyzeSource(program, small, smallLexemes);
+        importMs = std::min(importMs, _elapsedMs(start));
+        start = std::chrono::steady_clock::now();
+        IRModule smallModule = IRBuilder(program, small).build();
+        importIrMs = std::min(importIrMs, _elapsedMs(start));
+
+        for (auto &info : small.all())
+        {
+            const SymbolTable::SymbolInfo *other = full.find(info.lexeme);
+            same = same && other && other->type == info.type && other->arraySize == info.arraySize;
+        }
+        same = same && smallModule.functions.size() == 21 && smallModule.find("F97") &&
+               fullModule.functions.size() == (size_t)functions + 1;
+    }
+    std::remove(path.c_str());
+    if (!same)
+    {
+        std::cout << "Tipos diferentes entre o fonte unico e a interface importada\n";
+        return false;
+    }
+
+    std::cout << "== Compilacao separada (biblioteca com " << functions << " funcoes, "
+              << libSource.size() / 1024 << " KB) ==\n"
+              << std::left << std::setw(34) << "Caminho" << std::right << std::setw(12) << "Analise(ms)"
+              << std::setw(12) << "IR(ms)" << "\n"
+              << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(34) << "biblioteca no mesmo fonte" << std::right
+              << std::setw(12) << wholeMs << std::setw(12) << wholeIrMs << "\n";
+    std::cout << std::left << std::setw(34) << "--import da interface (mmap)" << std::right
+              << std::setw(12) << importMs << std::setw(12) << importIrMs << "\n";
+    std::cout << "Geracao da interface (uma vez): " << emitMs << " ms\n\n";
+    return true;
+}
+
+// Otimizações de laços: cada kernel compilado sem os passes de laço e sem
+// a coalescência de PHIs, e depois com cada otimização ligada sozinha e com
+// todas. a, b e c vêm de um array para que o dobramento de constantes não
+// resolva o invariante sozinho. As saídas de todas as configurações têm de
+// ser idênticas.
+static bool _benchmarkLoopOptimizations()
+{
+    const std::string header = "PROGRAM\nDECLARATIONS\n    varType integer: i, j, s, a, b, c, k, n;\n"
+                               "    varType integer[]: v[4];\nENDDECLARATIONS\n{\n"
+                               "    v[0] := 3;\n    v[1] := 1;\n    v[2] := 4;\n    v[3] := 1;\n"
+                               "    a := v[0] + 9;\n    b := v[2] * 8;\n    c := v[1] + 4;\n    k := 9;\n"
+                               "    n := 400000;\n"
+                               "    i := 0;\n    s := 0;\n";
+    const std::string footer = "    ENDWHILE\n    PRINT s;\n}\nENDPROGRAM\n";
+    struct Kernel
+    {
+        const char *name;
+        std::string body;
+    };
+    const Kernel kernels[] = {
+        {"invariante no corpo", "    WHILE (i < n) {\n        s := s + (a * b + c) % 7 + (a - c) * 2 + i;\n"
+                                "        i := i + 1;\n    }\n"},
+        {"i * k (inducao)", "    WHILE (i < n) {\n        s := s + i * k + i * 3;\n        i := i + 1;\n    }\n"},
+        {"laco interno de 4", "    WHILE (i < n) {\n        j := 0;\n        WHILE (j < 4) {\n"
+                              "            s := s + v[j] * j;\n            j := j + 1;\n        }\n"
+                              "        ENDWHILE\n        i := i + 1;\n    }\n"},
+        {"varias variaveis de laco", "    j := 1;\n    WHILE (i < n) {\n        s := s + j;\n        j := j + 2;\n"
+                                     "        i := i + 1;\n    }\n"}};
+    struct Config
+    {
+        const char *name;
+        bool unroll, licm, reduce, coalesce;
+    };
+    const Config configs[] = {{"nenhuma", false, false, false, false},
+                              {"unroll", true, false, false, false},
+                              {"licm", false, true, false, false},
+                              {"reducao", false, false, true, false},
+                              {"coalesce", false, false, false, true},
+                              {"todas", true, true, true, true}};
+    const int configCount = sizeof(configs) / sizeof(configs[0]);
+
+    std::cout << "== Otimizacoes de lacos (ms; menor de 3 execucoes) ==\n"
+              << std::left << std::setw(26) << "Kernel" << std::right;
+    for (auto &cfg : configs)
+        std::cout << std::setw(10) << cfg.name;
+    std::cout << std::setw(10) << "ganho" << "\n"
+              << std::fixed << std::setprecision(2);
+
+    for (auto &kernel : kernels)
+    {
+        std::string source = header + kernel.body + footer;
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(source, symtab, lexemes);
+        std::cout << std::left << std::setw(26) << kernel.name << std::right;
+        std::string expected;
+        double times[configCount];
+        for (int c = 0; c < configCount; ++c)
+        {
+            const Config &cfg = configs[c];
+            IRModule module = IRBuilder(source, symtab).build();
+            PassManager passes = PassManager::standard();
+            if (!cfg.unroll)
+                passes.remove("loop-unroll");
+            if (!cfg.licm)
+                passes.remove("licm");
+            if (!cfg.reduce)
+                passes.remove("strength-reduction");
+            passes.run(module);
+            BcProgram program = BcLowering(true, cfg.coalesce).lower(module);
+
+            times[c] = 1e30;
+            for (int r = 0; r < 3; ++r)
+            {
+                std::ostringstream out;
+                Interpreter interpreter(program, out);
+                auto start = std::chrono::steady_clock::now();
+                interpreter.run();
+                times[c] = std::min(times[c], _elapsedMs(start));
+                if (c == 0 && r == 0)
+                    expected = out.str();
+                else if (out.str() != expected)
+                {
+                    std::cout << "\nSaida diferente em " << kernel.name << " com " << cfg.name << "\n";
+                    return false;
+                }
+            }
+            std::cout << std::setw(10) << times[c];
+        }
+        std::cout << std::setw(9) << times[0] / times[configCount - 1] << "x\n";
+    }
+    std::cout << "\n";
+    return true;
+}
+
+// Expansão de funções: chamadas a funções pequenas dentro de laços, com o
+// crescimento da IR limitado a 0% (sem expansão), 25%, 100% (padrão) e 400%.
+// As saídas têm de ser idênticas.
+// Regressão: o STOREG de um array copia para o próprio array, lido depois
+// pela referência do primeiro LOADG (que o CSE reaproveita); o CSE e o DCE
+// não podem encaminhá-lo nem descartá-lo como o de uma global escalar
+static bool _checkArrayStores()
+{
+    const std::string source =
+        "PROGRAM\nDECLARATIONS\n    varType real: u;\n    varType real[]: r[4], a[4], v[4];\nENDDECLARATIONS\n{\n"
+        "    u := 1.5;\n    a[0] := 1.0;\n    a[1] := 2.0;\n    a[2] := 3.0;\n    a[3] := 4.0;\n"
+        "    v[0] := 10.0;\n    v[1] := 20.0;\n    v[2] := 30.0;\n    v[3] := 40.0;\n    PRINT r;\n"
+        "    r := u + a + v;\n    PRINT r;\n    r := a * 2.5 - u;\n    PRINT r;\n}\nENDPROGRAM\n";
+    SymbolTable symtab;
+    LexemeList lexemes;
+    analyzeSource(source, symtab, lexemes);
+    std::string outputs[2];
+    for (int optimized = 0; optimized < 2; ++optimized)
+    {
+        IRModule module = IRBuilder(source, symtab).build();
+        if (optimized)
+            PassManager::standard().run(module);
+        BcProgram program = BcLowering().lower(module);
+        std::ostringstream out;
+        Interpreter(program, out).run();
+        outputs[optimized] = out.str();
+    }
+    if (outputs[0] != outputs[1])
+    {
+        std::cout << "Escrita de array perdida pela otimizacao:\n" << outputs[1] << "esperado:\n" << outputs[0];
+        return false;
+    }
+    return true;
+}
+
+static bool _benchmarkInlining()
+{
+    const std::string source =
+        "PROGRAM\nDECLARATIONS\n    varType integer: i, s, t, n;\n    varType integer[]: v[8];\nENDDECLARATIONS\n"
+        "FUNCTIONS\n"
+        "    FUNCTYPE integer: quad(paramType integer: x)\n    {\n        return x * x;\n    }\n    ENDFUNCTION\n"
+        "    FUNCTYPE integer: maior(paramType integer: a, b)\n    {\n        IF (a > b) {\n            return a;\n"
+        "        }\n        ENDIF\n        return b;\n    }\n    ENDFUNCTION\n"
+        "    FUNCTYPE integer: pega(paramType integer: w[8]; paramType integer: k)\n    {\n"
+        "        return w[k % 8] + t;\n    }\n    ENDFUNCTION\n"
+        "    FUNCTYPE void: conta(paramType integer: d)\n    {\n        t := t + d % 3;\n    }\n    ENDFUNCTION\n"
+        "ENDFUNCTIONS\n{\n    i := 0;\n    s := 0;\n    t := 1;\n    n := 300000;\n"
+        "    WHILE (i < n) {\n        v[i % 8] := quad(i % 100) - i;\n        conta(i);\n"
+        "        s := s + maior(v[i % 8], t) + pega(v, i);\n        i := i + 1;\n    }\n    ENDWHILE\n"
+        "    PRINT s;\n    PRINT t;\n}\nENDPROGRAM\n";
+    SymbolTable symtab;
+    LexemeList lexemes;
+    analyzeSource(source, symtab, lexemes);
+
+    std::cout << "== Expansao de funcoes (ms; menor de 3 execucoes) ==\n"
+              << std::setw(12) << "Crescimento" << std::setw(10) << "IR" << std::setw(10) << "CALLs"
+              << std::setw(10) << "Tempo" << std::setw(10) << "ganho" << "\n"
+              << std::fixed << std::setprecision(2);
+    std::string expected;
+    double baseline = 0;
+    for (int growth : {0, 25, 100, 400})
+    {
+        IRModule module = IRBuilder(source, symtab).build();
+        PassManager::standard(growth).run(module);
+        int calls = 0;
+        for (auto &fn : module.functions)
+            for (auto &blk : fn.blocks)
+                for (int id : blk.instrs)
+                    calls += fn.instrs[id].op == IROp::CALL;
+        BcProgram program = BcLowering().lower(module);
+
+        double best = 1e30;
+        for (int r = 0; r < 3; ++r)
+        {
+            std::ostringstream out;
+            Interpreter interpreter(program, out);
+            auto start = std::chrono::steady_clock::now();
+            interpreter.run();
+            best = std::min(best, _elapsedMs(start));
+            if (expected.empty())
+                expected = out.str();
+            else if (out.str() != expected)
+            {
+                std::cout << "Saida diferente com crescimento de " << growth << "%\n";
+                return false;
+            }
+        }
+        if (growth == 0)
+            baseline = best;
+        std::cout << std::setw(11) << growth << "%" << std::setw(10) << module.size() << std::setw(10) << calls
+                  << std::setw(10) << best << std::setw(9) << baseline / best << "x\n";
+    }
+    std::cout << "\n";
+    return true;
+}
+
+// Strings em tempo de execução: `s := s + ...` num WHILE (cordas) com
+// tamanhos crescentes, em que o custo por volta deve ficar constante, e um
+// programa que só faz PRINT. O texto impresso é conferido com o esperado.
+static bool _benchmarkStrings()
+{
+    auto compile = [](const std::string &source)
+    {
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(source, symtab, lexemes);
+        IRModule module = IRBuilder(source, symtab).build();
+        PassManager::standard().run(module);
+        return BcLowering().lower(module);
+    };
+    auto run = [](const BcProgram &program, std::string &output)
+    {
+        double best = 1e30;
+        for (int r = 0; r < 3; ++r)
+        {
+            std::ostringstream out;
+            Interpreter interpreter(program, out);
+            auto start = std::chrono::steady_clock::now();
+            interpreter.run();
+            best = std::min(best, _elapsedMs(start));
+            output = out.str();
+        }
+        return best;
+    };
+
+    std::cout << "== Strings em tempo de execucao (ms; menor de 3 execucoes) ==\n"
+              << std::setw(10) << "Voltas" << std::setw(12) << "Bytes" << std::setw(10) << "Tempo"
+              << std::setw(14) << "ns/volta" << "\n"
+              << std::fixed << std::setprecision(2);
+    for (int n : {10000, 40000, 160000})
+    {
+        const std::string source =
+            "PROGRAM\nDECLARATIONS\n    varType integer: i, n;\n    varType string: s, p;\nENDDECLARATIONS\n{\n"
+            "    i := 0;\n    n := " + std::to_string(n) + ";\n    s := \"\";\n    p := \"\";\n"
+            "    WHILE (i < n) {\n        s := s + \"ab\" + i;\n        p := i + \",\" + p;\n        i := i + 1;\n"
+            "    }\n    ENDWHILE\n    PRINT s;\n    PRINT p = s;\n}\nENDPROGRAM\n";
+        std::string expected;
+        for (int i = 0; i < n; ++i)
+            expected += "ab" + std::to_string(i);
+        expected += "\nFALSE\n";
+
+        std::string output;
+        double ms = run(compile(source), output);
+        if (output != expected)
+        {
+            std::cout << "Saida diferente da esperada com " << n << " concatenacoes\n";
+            return false;
+        }
+        std::cout << std::setw(10) << n << std::setw(12) << expected.size() << std::setw(10) << ms
+                  << std::setw(14) << ms * 1e6 / n << "\n";
+    }
+
+    // Acréscimo com leitura do texto a cada volta: cada corda é achatada, e
+    // a memória das strings tem de ficar linear no tamanho final
+    {
+        const int appends = 20000;
+        const std::string piece = "0123456789abcdefghijklmnopqrstuvwxyz";
+        const std::string source =
+            "PROGRAM\nDECLARATIONS\n    varType integer: i, k;\n    varType string: s;\nENDDECLARATIONS\n{\n"
+            "    i := 0;\n    k := 0;\n    s := \"\";\n    WHILE (i < " + std::to_string(appends) + ") {\n"
+            "        s := s + \"" + piece + "\";\n        IF (s == \"x\") {\n            k := k + 1;\n"
+            "        }\n        ENDIF\n        i := i + 1;\n    }\n    ENDWHILE\n    PRINT k;\n    PRINT s;\n}\nENDPROGRAM\n";
+        std::string expected = "0\n";
+        for (int i = 0; i < appends; ++i)
+            expected += piece;
+        expected += "\n";
+
+        BcProgram program = compile(source);
+        std::ostringstream out;
+        Interpreter interpreter(program, out);
+        auto start = std::chrono::steady_clock::now();
+        interpreter.run();
+        double ms = _elapsedMs(start);
+        size_t bytes = interpreter.stringBytes(), finalLength = (size_t)appends * piece.size();
+        if (out.str() != expected)
+        {
+            std::cout << "Saida diferente da esperada no acrescimo com comparacao\n";
+            return false;
+        }
+        std::cout << "Acrescimo + comparacao: " << appends << " voltas em " << ms << " ms, "
+                  << bytes / 1024 << " KiB de strings para " << finalLength / 1024 << " KiB de texto\n";
+        if (bytes > 8 * finalLength)
+        {
+            std::cout << "Memoria das strings cresce mais que linearmente no acrescimo com comparacao\n";
+            return false;
+        }
+    }
+
+    const int prints = 200000;
+    const std::string source =
+        "PROGRAM\nDECLARATIONS\n    varType integer: i;\n    varType real: r;\nENDDECLARATIONS\n{\n"
+        "    i := 0;\n    WHILE (i < " + std::to_string(prints) + ") {\n        r := i;\n"
+        "        PRINT i;\n        PRINT r / 8.0;\n        PRINT \"linha de texto\";\n        PRINT i > 7;\n"
+        "        i := i + 1;\n    }\n    ENDWHILE\n}\nENDPROGRAM\n";
+    std::ostringstream expected;
+    for (int i = 0; i < prints; ++i)
+        expected << i << "\n" << i / 8.0 << "\nlinha de texto\n" << (i > 7 ? "TRUE" : "FALSE") << "\n";
+    std::string output;
+    double ms = run(compile(source), output);
+    if (output != expected.str())
+    {
+        std::cout << "Saida do PRINT diferente da esperada\n";
+        return false;
+    }
+    std::cout << "PRINT: " << 4 * prints << " linhas (" << output.size() / 1024 << " KiB) em " << ms << " ms, "
+              << ms * 1e6 / (4 * prints) << " ns/linha\n\n";
+    return true;
+}
+
+// JIT de base: interpretador contra código nativo em kernels de aritmética
+// inteira e real, acesso a arrays, chamadas recursivas, um laço com PRINT e
+// um com concatenação de strings, que sai para o interpretador a cada volta.
+// As saídas têm de ser idênticas.
+static bool _benchmarkJit()
+{
+    if (!BaselineJit::available())
+    {
+        std::cout << "== JIT de base: indisponivel nesta plataforma ==\n\n";
+        return true;
+    }
+    const std::string header = "PROGRAM\nDECLARATIONS\n    varType integer: i, j, s, n;\n    varType real: x, y;\n"
+                               "    varType integer[]: v[64];\nENDDECLARATIONS\n";
+    const std::string functions =
+        "FUNCTIONS\n    FUNCTYPE integer: fib(paramType integer: k)\n    {\n        IF (k < 2) {\n"
+        "            return k;\n        }\n        ENDIF\n        return fib(k - 1) + fib(k - 2);\n    }\n"
+        "    ENDFUNCTION\nENDFUNCTIONS\n";
+    struct Kernel
+    {
+        const char *name;
+        std::string body;
+    };
+    const Kernel kernels[] = {
+        {"inteiros", "{\n    i := 0;\n    s := 0;\n    WHILE (i < 3000000) {\n"
+                     "        s := s + (i * 7 + 3) % 1001 - i / 5;\n        i := i + 1;\n    }\n    ENDWHILE\n"
+                     "    PRINT s;\n}\nENDPROGRAM\n"},
+        {"reais", "{\n    i := 0;\n    x := 0.0;\n    y := 1.0;\n    WHILE (i < 2000000) {\n"
+                  "        x := x * 0.999 + y / (i + 1.0);\n        IF (x > 100.0) {\n            x := x - 50.0;\n"
+                  "        }\n        ENDIF\n        i := i + 1;\n    }\n    ENDWHILE\n    PRINT x;\n}\nENDPROGRAM\n"},
+        {"arrays", "{\n    i := 0;\n    WHILE (i < 1000000) {\n        j := i % 64;\n"
+                   "        v[j] := v[(j + 17) % 64] + i;\n        s := s + v[j] % 13;\n        i := i + 1;\n    }\n"
+                   "    ENDWHILE\n    PRINT s;\n    PRINT v;\n}\nENDPROGRAM\n"},
+        {"chamadas (fib 27)", functions + "{\n    PRINT fib(27);\n}\nENDPROGRAM\n"},
+        {"PRINT no laco", "{\n    i := 0;\n    WHILE (i < 200000) {\n        s := s + i * 3;\n"
+                          "        PRINT s;\n        i := i + 1;\n    }\n    ENDWHILE\n}\nENDPROGRAM\n"},
+        {"strings no laco (deopt)", "{\n    i := 0;\n    WHILE (i < 200000) {\n        s := s + i * 3;\n"
+                                    "        IF (\"a\" + i == \"a7\") {\n            s := s + 1;\n        }\n"
+                                    "        ENDIF\n        i := i + 1;\n    }\n    ENDWHILE\n    PRINT s;\n}\nENDPROGRAM\n"}};
+
+    std::cout << "== JIT de base x86-64 (ms; menor de 3 execucoes) ==\n"
+              << std::left << std::setw(24) << "Kernel" << std::right << std::setw(14) << "Interpretador"
+              << std::setw(10) << "JIT" << std::setw(10) << "ganho" << std::setw(12) << "Funcoes" << std::setw(10)
+              << "Bytes" << "\n"
+              << std::fixed << std::setprecision(2);
+    for (auto &kernel : kernels)
+    {
+        std::string source = header + kernel.body;
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(source, symtab, lexemes);
+        IRModule module = IRBuilder(source, symtab).build();
+        PassManager::standard().run(module);
+        BcProgram program = BcLowering().lower(module);
+
+        std::string expected;
+        double times[2];
+        size_t compiled = 0, bytes = 0;
+        for (int jit = 0; jit < 2; ++jit)
+        {
+            times[jit] = 1e30;
+            for (int r = 0; r < 3; ++r)
+            {
+                std::ostringstream out;
+                Interpreter interpreter(program, out);
+                interpreter.setJit(jit);
+                auto start = std::chrono::steady_clock::now();
+                interpreter.run();
+                times[jit] = std::min(times[jit], _elapsedMs(start));
+                if (jit && interpreter.jit())
+                {
+                    compiled = interpreter.jit()->compiledFunctions();
+                    bytes = interpreter.jit()->codeBytes();
+                }
+                if (!jit && r == 0)
+                    expected = out.str();
+                else if (out.str() != expected)
+                {
+                    std::cout << "\nSaida diferente com o JIT em " << kernel.name << "\n";
+                    return false;
+                }
+            }
+        }
+        std::cout << std::left << std::setw(24) << kernel.name << std::right << std::setw(14) << times[0]
+                  << std::setw(10) << times[1] << std::setw(9) << times[0] / times[1] << "x" << std::setw(12)
+                  << compiled << std::setw(10) << bytes << "\n";
+    }
+    std::cout << "\n";
+    return true;
+}
+
+// Compilação de muitos fontes pequenos (.LEX e .TAB de cada um): leitura e
+// gravação bloqueantes arquivo a arquivo, como na compilação de um único
+// fonte, contra a E/S em lote (pool de threads e io_uring) sobreposta à
+// análise. Os relatórios gravados têm de ser os mesmos nos três modos.
+static bool _benchmarkBatchIo()
+{
+    const int files = 3000;
+    std::string dir = "/tmp";
+    if (const char *tmp = std::getenv("TMPDIR"))
+        dir = tmp;
+    std::vector<std::string> paths;
+    size_t bytes = 0;
+    for (int f = 0; f < files; ++f)
+    {
+        std::string source = "PROGRAM\nDECLARATIONS\n    varType integer: total, i;\n";
+        for (int k = 0; k < 12; ++k)
+            source += "    varType real: valor_" + std::to_string(f) + "_" + std::to_string(k) + ";\n";
+        source += "ENDDECLARATIONS\n{\n    i := 0;\n    WHILE (i < " + std::to_string(f + 10) + ") {\n";
+        for (int k = 0; k < 12; ++k)
+            source += "        valor_" + std::to_string(f) + "_" + std::to_string(k) + " := i * " +
+                      std::to_string(k) + ".5 + total; /* passo */\n";
+        source += "        total := total + i;\n        i := i + 1;\n    }\n    ENDWHILE\n    PRINT total;\n}\nENDPROGRAM\n";
+        paths.push_back(dir + "/canga-bench-lote-" + std::to_string(f) + ".251");
+        std::ofstream(paths.back(), std::ios::binary) << source;
+        bytes += source.size();
+    }
+
+    auto reports = [](const std::string &source, std::string &lex, std::string &tab)
+    {
+        std::pmr::monotonic_buffer_resource arena(1 << 16);
+        SymbolTable symtab(&arena);
+        LexemeList lexemes(&arena);
+        analyzeSource(source, symtab, lexemes);
+        lex.clear();
+        tab.clear();
+        for (auto &shard : formatLexRecords(lexemes, symtab.lines()))
+            lex += shard;
+        for (auto &shard : formatSymbolEntries(symtab))
+            tab += shard;
+    };
+    // Hash de todos os relatórios gravados, para comparar os modos
+    auto outputs = [&]()
+    {
+        uint64_t hash = fnv1a("");
+        for (auto &path : paths)
+            for (const char *ext : {".LEX", ".TAB"})
+            {
+                std::ifstream in(path.substr(0, path.size() - 4) + ext, std::ios::binary);
+                std::stringstream text;
+                text << in.rdbuf();
+                hash = fnv1a(text.str(), hash);
+            }
+        return hash;
+    };
+
+    auto blocking = [&]()
+    {
+        std::string lex, tab;
+        for (auto &path : paths)
+        {
+            std::ifstream in(path);
+            std::stringstream buffer;
+            buffer << in.rdbuf();
+            reports(buffer.str(), lex, tab);
+            std::string base = path.substr(0, path.size() - 4);
+            std::ofstream(base + ".LEX") << lex;
+            std::ofstream(base + ".TAB") << tab;
+        }
+    };
+    auto batched = [&](BatchIo &io)
+    {
+        const size_t readAhead = 32;
+        std::vector<size_t> reads(paths.size());
+        size_t queued = 0;
+        std::string lex, tab;
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            for (; queued < paths.size() && queued < i + readAhead; ++queued)
+                reads[queued] = io.read(paths[queued]);
+            io.submit();
+            reports(io.take(reads[i]), lex, tab);
+            std::string base = paths[i].substr(0, paths[i].size() - 4);
+            io.write(base + ".LEX", lex);
+            io.write(base + ".TAB", tab);
+        }
+        io.finish();
+    };
+
+    std::cout << "== E/S em lote (" << files << " fontes, " << bytes / 1024 << " KiB; menor de 3) ==\n"
+              << std::left << std::setw(22) << "Modo" << std::right << std::setw(12) << "Tempo(ms)"
+              << std::setw(14) << "fontes/s" << std::setw(10) << "ganho" << "\n"
+              << std::fixed << std::setprecision(2);
+    bool ok = true;
+    uint64_t expected = 0;
+    double baseline = 0;
+    for (int mode = 0; mode < 3 && ok; ++mode)
+    {
+        double best = 1e30;
+        bool ring = false;
+        for (int r = 0; r < 3; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (mode == 0)
+                blocking();
+            else
+            {
+                BatchIo io(4, mode == 2);
+                ring = io.usingIoUring();
+                batched(io);
+            }
+            best = std::min(best, _elapsedMs(start));
+        }
+        if (mode == 2 && !ring)
+        {
+            std::cout << std::left << std::setw(22) << "io_uring" << std::right << "  indisponivel\n";
+            break;
+        }
+        uint64_t hash = outputs();
+        if (mode == 0)
+        {
+            expected = hash;
+            baseline = best;
+        }
+        else if (hash != expected)
+            ok = false;
+        const char *names[] = {"ifstream/ofstream", "lote (pool de threads)", "lote (io_uring)"};
+        std::cout << std::left << std::setw(22) << names[mode] << std::right << std::setw(12) << best
+                  << std::setw(14) << files / (best / 1000) << std::setw(9) << baseline / best << "x\n";
+    }
+    for (auto &path : paths)
+    {
+        std::string base = path.substr(0, path.size() - 4);
+        std::remove(path.c_str());
+        std::remove((base + ".LEX").c_str());
+        std::remove((base + ".TAB").c_str());
+    }
+    std::cout << (ok ? "Relatorios identicos nos tres modos\n\n" : "Relatorios diferentes entre os modos\n\n");
+    return ok;
+}
+
+// Cache de bytecode: do fonte até o BcProgram pronto para executar, pelo
+// pipeline completo e carregando o .251c gravado uma vez. As saídas dos dois
+// programas têm de ser idênticas.
+static bool _benchmarkBytecodeCache()
+{
+    const int functions = 300;
+    std::string declarations = "    varType integer: r;\n    varType real[]: w[8];\n    varType string: nome;\n";
+    std::string library, body = "{\n    r := 0;\n    nome := \"canga\";\n";
+    for (int k = 0; k < functions; ++k)
+    {
+        std::string n = std::to_string(k);
+        library += "    FUNCTYPE integer: f" + n + "(paramType integer: a, b)\n    {\n        w := w + " + n +
+                   ".5;\n        WHILE (a < b) {\n            a := a + " + n + " % 7 + 1;\n        }\n"
+                   "        ENDWHILE\n        return a * 2 + b;\n    }\n    ENDFUNCTION\n";
+        body += "    r := r + f" + n + "(r % 13, " + n + ");\n";
+    }
+    body += "    PRINT r;\n    PRINT w;\n    PRINT nome;\n}\nENDPROGRAM\n";
+    std::string source = "PROGRAM\nDECLARATIONS\n" + declarations + "ENDDECLARATIONS\nFUNCTIONS\n" + library +
+                         "ENDFUNCTIONS\n" + body;
+
+    std::string dir = "/tmp";
+    if (const char *tmp = std::getenv("TMPDIR"))
+        dir = tmp;
+    std::string path = dir + "/canga-bench.251c";
+    uint64_t key = bytecodeCacheKey(source, "");
+
+    const int repeats = 20;
+    double compileUs = 1e30, loadUs = 1e30;
+    BcProgram compiled, loaded;
+    for (int r = 0; r < repeats; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(source, symtab, lexemes);
+        IRModule module = IRBuilder(source, symtab).build();
+        PassManager::standard().run(module);
+        compiled = BcLowering().lower(module);
+        compileUs = std::min(compileUs, 1000.0 * _elapsedMs(start));
+        if (r == 0)
+            writeBytecodeCache(path, compiled, key);
+
+        start = std::chrono::steady_clock::now();
+        BytecodeCache cache(path);
+        if (cache.key() != key)
+            break;
+        loaded = cache.load();
+        loadUs = std::min(loadUs, 1000.0 * _elapsedMs(start));
+    }
+    size_t fileSize = 0;
+    if (std::FILE *f = std::fopen(path.c_str(), "rb"))
+    {
+        std::fseek(f, 0, SEEK_END);
+        fileSize = (size_t)std::ftell(f);
+        std::fclose(f);
+    }
+    std::remove(path.c_str());
+
+    std::ostringstream compiledOut, loadedOut;
+    Interpreter(compiled, compiledOut).run();
+    Interpreter(loaded, loadedOut).run();
+    if (loadUs == 1e30 || compiledOut.str() != loadedOut.str() || loaded.code.size() != compiled.code.size())
+    {
+        std::cout << "Programa carregado do .251c difere do compilado\n";
+        return false;
+    }
+
+    std::cout << "== Cache de bytecode (" << functions << " funcoes, " << compiled.code.size() << " instrucoes, "
+              << fileSize / 1024 << " KB em .251c) ==\n"
+              << std::fixed << std::setprecision(1)
+              << std::left << std::setw(34) << "fonte -> bytecode (us)" << std::right << std::setw(12) << compileUs
+              << "\n"
+              << std::left << std::setw(34) << ".251c (mmap) -> bytecode (us)" << std::right << std::setw(12) << loadUs
+              << "\n"
+              << "Saidas identicas\n\n";
+    return true;
+}
+
+#ifdef CANGA_WITH_ZLIB
+// Tira o arquivo do cache de páginas do sistema, para medir a leitura a frio
+static void _dropFromCache(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// Leitura de ponta a ponta (arquivo -> análise) de um fonte grande, comum e
+// compactado, com o cache de páginas esvaziado antes de cada execução
+static void _benchmarkCompressedInput()
+{
+    std::string dir = "/tmp";
+    if (const char *tmp = std::getenv("TMPDIR"))
+        dir = tmp;
+    std::string plainPath = dir + "/canga-bench.251", gzPath = plainPath + ".gz";
+
+    // Constantes e comentários variados, para uma taxa de compressão realista
+    std::mt19937 rng(251);
+    auto statement = [&]()
+    {
+        std::string n = std::to_string(rng() % 100000);
+        switch (rng() % 3)
+        {
+        case 0:
+            return "    a := a + b * " + n + "; // acumula o produto " + std::to_string(rng()) + "\n";
+        case 1:
+            return "    /* passo " + n + " do calculo\n       valor " + std::to_string(rng()) + " */\n";
+        default:
+            return "    PRINT \"valor parcial " + n + "\";\n";
+        }
+    };
+    {
+        std::ofstream plain(plainPath, std::ios::binary);
+        gzFile gz = gzopen(gzPath.c_str(), "wb6");
+        std::string head = "PROGRAM\nDECLARATIONS\n    varType integer: a, b;\nENDDECLARATIONS\n{\n";
+        plain << head;
+        gzwrite(gz, head.data(), (unsigned)head.size());
+        for (int k = 0; k < 64; ++k)
+        {
+            std::string block;
+            while (block.size() < (1u << 20))
+                block += statement();
+            plain << block;
+            gzwrite(gz, block.data(), (unsigned)block.size());
+        }
+        std::string tail = "}\nENDPROGRAM\n";
+        plain << tail;
+        gzwrite(gz, tail.data(), (unsigned)tail.size());
+        gzclose(gz);
+    }
+
+    auto fileSize = [](const std::string &path)
+    {
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
+        return (size_t)f.tellg();
+    };
+    size_t plainSize = fileSize(plainPath), gzSize = fileSize(gzPath);
+
+    std::cout << "== Entrada compactada (" << plainSize / (1 << 20) << " MB, .gz com "
+              << gzSize / (1 << 10) << " KB, cache frio) ==\n";
+    std::cout << std::left << std::setw(30) << "Leitura" << std::right << std::setw(12) << "Tempo(ms)"
+              << std::setw(16) << "Texto em RAM" << "\n";
+
+    auto report = [](const char *name, double ms, size_t bytes)
+    {
+        std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << ms << std::setw(13) << bytes / 1024 << " KB\n";
+    };
+
+    // Arquivo comum lido por inteiro (caminho padrão do compilador)
+    {
+        _dropFromCache(plainPath);
+        auto start = std::chrono::steady_clock::now();
+        std::ifstream ifs(plainPath, std::ios::binary);
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        std::string source = buffer.str();
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(source, symtab, lexemes);
+        report(".251 inteiro em memoria", _elapsedMs(start), source.size());
+    }
+
+    for (const std::string *path : {&plainPath, &gzPath})
+    {
+        _dropFromCache(*path);
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<SourceReader> reader = openSourceReader(*path);
+        SymbolTable symtab;
+        LexemeList lexemes;
+        StreamingLexer lexer(*reader, symtab.lines());
+        analyzeTokens(lexer, symtab, lexemes, AnalysisLimits(), nullptr);
+        report(path == &gzPath ? ".251.gz em fluxo" : ".251 em fluxo", _elapsedMs(start), lexer.peakWindow());
+    }
+    std::cout << "\n";
+    std::remove(plainPath.c_str());
+    std::remove(gzPath.c_str());
+}
+#endif
+
+// Validação de UTF-8: vazão em GB/s da versão escalar e da AVX2, em texto só
+// ASCII e em texto com acentos; ambas são comparadas em entradas corrompidas
+static bool _benchmarkUtf8Validation()
+{
+    std::string ascii, accented;
+    std::string asciiUnit = "    x := a + b; // soma simples\n    PRINT \"resultado\";\n";
+    std::string accentedUnit = "    /* ação: não é possível */ x := a + b; // coração\n    PRINT \"Olá, 世界 🎉\";\n";
+    while (ascii.size() < (1u << 20))
+        ascii += asciiUnit;
+    while (accented.size() < (1u << 20))
+        accented += accentedUnit;
+
+    // Corrupções aleatórias de bytes isolados: as duas versões têm de
+    // apontar o mesmo primeiro byte inválido
+    std::mt19937 rng(251);
+    std::string sample = accented.substr(0, 4096);
+    for (int k = 0; k < 20000; ++k)
+    {
+        std::string bad = sample.substr(0, 1 + rng() % sample.size());
+        int flips = 1 + rng() % 3;
+        for (int f = 0; f < flips; ++f)
+            bad[rng() % bad.size()] = (char)(rng() % 256);
+        Utf8Scan scalar = scanUtf8Scalar(bad.data(), bad.size());
+        Utf8Scan vector = scanUtf8(bad.data(), bad.size());
+        if (scalar.errorOffset != vector.errorOffset || scalar.ascii != vector.ascii)
+        {
+            std::cout << "Divergencia na validacao UTF-8 (entrada " << k << ")\n";
+            return false;
+        }
+    }
+
+    const int repeats = 300;
+    std::cout << "== Validacao UTF-8 (" << (ascii.size() >> 20) << " MB, " << repeats << " repeticoes) ==\n";
+    std::cout << std::left << std::setw(12) << "Texto" << std::setw(10) << "Versao"
+              << std::right << std::setw(10) << "GB/s" << "\n";
+    for (auto *text : {&ascii, &accented})
+    {
+        for (bool vectorized : {false, true})
+        {
+            if (vectorized && !utf8HasAvx2())
+                continue;
+            auto start = std::chrono::steady_clock::now();
+            bool valid = true;
+            for (int r = 0; r < repeats; ++r)
+                valid &= scanUtf8(text->data(), text->size(), 0, vectorized).valid();
+            double ms = _elapsedMs(start);
+            if (!valid)
+            {
+                std::cout << "Texto valido rejeitado\n";
+                return false;
+            }
+            std::cout << std::left << std::setw(12) << (text == &ascii ? "ASCII" : "acentuado")
+                      << std::setw(10) << (vectorized ? "AVX2" : "escalar") << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(10)
+                      << (double)text->size() * repeats / (ms * 1e6) << "\n";
+        }
+    }
+    std::cout << "\n";
+    return true;
+}
+
+static bool _sameTokens(const std::vector<Token> &a, const std::vector<Token> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t k = 0; k < a.size(); ++k)
+    {
+        if (a[k].type != b[k].type || a[k].lexeme != b[k].lexeme || a[k].offset != b[k].offset ||
+            a[k].length != b[k].length)
+            return false;
+    }
+    return true;
+}
+
+// Re-análise incremental: edições aleatórias (inclusive abrindo/fechando
+// comentários e strings) validadas contra a análise completa do novo texto
+static bool _benchmarkIncrementalLexer()
+{
+    std::string unit =
+        "FUNCTYPE integer: f(paramType integer: a, b)\n{\n    /* soma */ x := a + b; // fim\n"
+        "    PRINT \"texto\";\n    c := 'k';\n    WHILE (x <= 10) { x := x * 2.5; }\n    ENDWHILE\n}\nENDFUNCTION\n";
+    std::string source;
+    for (int k = 0; k < 400; ++k)
+        source += unit;
+
+    static const char *snippets[] = {"/*", "*/", "\"", "'", "\n", "//", " ", "abc", "12", "3.5", ":=",
+                                     "<", "=", "x1", "{", "}", "WHILE", "\"s\"", "/", "*"};
+    const int edits = 2000;
+    std::mt19937 rng(251);
+    IncrementalLexer inc(source);
+    LineIndex lines(source); // atualizado só pela edição, como no --lsp
+    double incMs = 0, fullMs = 0;
+    size_t relexed = 0;
+    int errors = 0;
+
+    for (int e = 0; e < edits; ++e)
+    {
+        const std::string &cur = inc.source();
+        TextEdit edit;
+        edit.offset = rng() % (cur.size() + 1);
+        edit.removed = std::min<size_t>(rng() % 4, cur.size() - edit.offset);
+        edit.inserted = rng() % 3 ? snippets[rng() % (sizeof(snippets) / sizeof(snippets[0]))] : "";
+
+        std::string expectedText = cur;
+        expectedText.replace(edit.offset, edit.removed, edit.inserted);
+        std::vector<Token> expected;
+        bool fullFailed = false;
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            expected = IncrementalLexer::lexAll(expectedText);
+        }
+        catch (const std::runtime_error &)
+        {
+            fullFailed = true;
+        }
+        fullMs += _elapsedMs(start);
+
+        bool incFailed = false;
+        start = std::chrono::steady_clock::now();
+        try
+        {
+            inc.applyEdit(edit);
+        }
+        catch (const std::runtime_error &)
+        {
+            incFailed = true;
+        }
+        incMs += _elapsedMs(start);
+
+        if (fullFailed != incFailed || (!incFailed && !_sameTokens(expected, inc.tokens())))
+        {
+            std::cout << "Divergencia na edicao " << e << " (posicao " << edit.offset << ")\n";
+            return false;
+        }
+        if (incFailed)
+        {
+            ++errors;
+            continue;
+        }
+        relexed += inc.lastRelexed();
+
+        lines.replace(edit.offset, edit.removed, edit.inserted);
+        LineIndex rebuilt(inc.source());
+        bool sameLines = lines.lineCount() == rebuilt.lineCount() && lines.size() == rebuilt.size();
+        for (int line = 1; sameLines && line <= rebuilt.lineCount(); ++line)
+            sameLines = lines.lineStart(line) == rebuilt.lineStart(line);
+        if (!sameLines)
+        {
+            std::cout << "Indice de linhas divergente na edicao " << e << " (posicao " << edit.offset << ")\n";
+            return false;
+        }
+    }
+
+    std::cout << "== Re-analise lexica incremental (" << source.size() << " bytes, " << edits << " edicoes) ==\n";
+    std::cout << std::fixed << std::setprecision(2)
+              << "Completa: " << fullMs << " ms, incremental: " << incMs << " ms ("
+              << fullMs / std::max(incMs, 1e-9) << "x)\n"
+              << "Tokens re-analisados por edicao: " << (double)relexed / std::max(edits - errors, 1)
+              << " de " << inc.tokens().size() << ", edicoes com erro lexico: " << errors
+              << "\nTokens e indice de linhas identicos aos da analise completa em todas as edicoes\n\n";
+    return true;
+}
+
+// Índice de linhas: montagem escalar (memchr) e SSE2, conferidas contra a
+// contagem direta de linhas e colunas; depois a análise léxica do mesmo
+// texto e o custo de resolver linha e coluna de todos os tokens
+static bool _benchmarkLineIndex()
+{
+    std::string unit = "FUNCTYPE integer: f(paramType integer: a, b)\n{\n    /* soma\n de dois */ x := a + b; // fim\n"
+                       "    PRINT \"texto\";\n    c := 'k';\n\n}\nENDFUNCTION\n";
+    std::string source;
+    while (source.size() < (8u << 20))
+        source += unit;
+
+    LineIndex scalar(source, 1, false), vector(source, 1, true);
+    int line = 1, column = 1;
+    for (size_t pos = 0; pos <= source.size(); ++pos)
+    {
+        if (pos % 61 == 0 || pos == source.size())
+        {
+            SourcePosition a = scalar.position(pos), b = vector.position(pos);
+            if (a.line != line || a.column != column || b.line != line || b.column != column)
+            {
+                std::cout << "Indice de linhas divergente na posicao " << pos << "\n";
+                return false;
+            }
+        }
+        if (pos < source.size() && source[pos] == '\n')
+        {
+            ++line;
+            column = 1;
+        }
+        else
+            ++column;
+    }
+
+    const int repeats = 20;
+    std::cout << "== Indice de linhas (" << (source.size() >> 20) << " MB, " << vector.lineCount() << " linhas, "
+              << repeats << " repeticoes) ==\n"
+              << std::left << std::setw(10) << "Versao" << std::right << std::setw(10) << "GB/s" << "\n";
+    for (bool vectorized : {false, true})
+    {
+        auto start = std::chrono::steady_clock::now();
+        int lines = 0;
+        for (int r = 0; r < repeats; ++r)
+            lines += LineIndex(source, 1, vectorized).lineCount();
+        double ms = _elapsedMs(start);
+        if (lines != repeats * vector.lineCount())
+            return false;
+        std::cout << std::left << std::setw(10) << (vectorized ? "SSE2" : "escalar") << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << (double)source.size() * repeats / (ms * 1e6) << "\n";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Token> tokens = IncrementalLexer::lexAll(source);
+    double lexMs = _elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    long long check = 0;
+    for (const Token &tok : tokens)
+    {
+        SourcePosition at = vector.position(tok.offset);
+        check += at.line + at.column;
+    }
+    double resolveMs = _elapsedMs(start);
+    if (check <= 0)
+        return false;
+    std::cout << "Analise lexica: " << lexMs << " ms (" << tokens.size() / (lexMs * 1e3) << " Mtokens/s); "
+              << "linha e coluna de todos os " << tokens.size() << " tokens: " << resolveMs << " ms\n\n";
+    return true;
+}
+
+// Modo --check contra a análise completa com formatação do .TAB e do .LEX:
+// tempo e alocações. Erros têm de sair com a mesma mensagem nos dois modos.
+static bool _benchmarkCheckMode()
+{
+    std::mt19937 rng(251);
+    std::string source = "PROGRAM\nDECLARATIONS\n";
+    for (int k = 0; k < 2000; ++k)
+        source += "    varType integer: v" + std::to_string(k) + ";\n";
+    source += "ENDDECLARATIONS\nFUNCTIONS\n";
+    for (int k = 0; k < 2000; ++k)
+        source += "FUNCTYPE integer: f" + std::to_string(k) + "(paramType integer: a, b)\n{\n    RETURN a + b;\n}\n"
+                  "ENDFUNCTION\n";
+    source += "ENDFUNCTIONS\n{\n";
+    while (source.size() < (8u << 20))
+    {
+        std::string n = std::to_string(rng() % 2000);
+        source += "    WHILE (v" + n + " < 10) {\n        v" + n + " := f" + n + "(v" + n + ", 1);\n"
+                  "        PRINT \"passo\";\n    }\n    ENDWHILE\n";
+    }
+    source += "}\nENDPROGRAM\n";
+
+    const int repeats = 3;
+    double fullMs = 1e300, checkMs = 1e300;
+    size_t fullAllocations = 0, checkAllocations = 0, reportBytes = 0;
+    for (int r = 0; r < repeats; ++r)
+    {
+        size_t before = _allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::pmr::monotonic_buffer_resource arena(1 << 16);
+            SymbolTable symtab(&arena);
+            LexemeList lexemes(&arena);
+            analyzeSource(source, symtab, lexemes);
+            reportBytes = _joined(formatSymbolEntries(symtab, 1)).size() +
+                          _joined(formatLexRecords(lexemes, symtab.lines(), 1)).size();
+        }
+        fullMs = std::min(fullMs, _elapsedMs(start));
+        fullAllocations = _allocationCount.load(std::memory_order_relaxed) - before;
+
+        before = _allocationCount.load(std::memory_order_relaxed);
+        start = std::chrono::steady_clock::now();
+        checkSource(source);
+        checkMs = std::min(checkMs, _elapsedMs(start));
+        checkAllocations = _allocationCount.load(std::memory_order_relaxed) - before;
+    }
+
+    // Um erro no fim do fonte: a mesma mensagem, com a mesma linha
+    std::string broken = source.substr(0, source.size() - 13) + "    x := @;\n}\nENDPROGRAM\n";
+    std::string fullError, checkError;
+    try
+    {
+        SymbolTable symtab;
+        LexemeList lexemes;
+        analyzeSource(broken, symtab, lexemes);
+    }
+    catch (const std::runtime_error &e)
+    {
+        fullError = e.what();
+    }
+    try
+    {
+        checkSource(broken);
+    }
+    catch (const std::runtime_error &e)
+    {
+        checkError = e.what();
+    }
+    if (fullError.empty() || fullError != checkError)
+    {
+        std::cout << "Erros diferentes entre --check e a analise completa: '" << fullError << "' / '"
+                  << checkError << "'\n";
+        return false;
+    }
+
+    std::cout << "== Modo --check (" << (source.size() >> 20) << " MB de fonte, melhor de " << repeats << ") ==\n"
+              << std::left << std::setw(30) << "Modo" << std::right << std::setw(12) << "Tempo(ms)"
+              << std::setw(14) << "Alocacoes" << "\n"
+              << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(30) << "analise + .TAB e .LEX" << std::right << std::setw(12) << fullMs
+              << std::setw(14) << fullAllocations << "\n";
+    std::cout << std::left << std::setw(30) << "--check" << std::right << std::setw(12) << checkMs
+              << std::setw(14) << checkAllocations << "\n";
+    std::cout << "Relatorios evitados: " << (reportBytes >> 20) << " MB; " << fullMs / checkMs
+              << "x mais rapido; erro identico nos dois modos\n\n";
+    return true;
+}
+
+int main()
+{
+    if (!_benchmarkUtf8Validation())
+        return 1;
+    if (!_benchmarkIncrementalLexer())
+        return 1;
+    if (!_benchmarkLineIndex())
+        return 1;
+    if (!_benchmarkCheckMode())
+        return 1;
+    if (!_benchmarkParallelAnalysis())
+        return 1;
+    _benchmarkArrayKernels();
+    if (!_benchmarkProfiler())
+        return 1;
+    _benchmarkMemoryResources();
+    if (!_benchmarkReports())
+        return 1;
+    if (!_benchmarkModuleInterface())
+        return 1;
+    if (!_benchmarkBytecodeCache())
+        return 1;
+    if (!_benchmarkLoopOptimizations())
+        return 1;
+    if (!_checkArrayStores())
+        return 1;
+    if (!_benchmarkInlining())
+        return 1;
+    if (!_benchmarkStrings())
+        return 1;
+    if (!_benchmarkJit())
+        return 1;
+    if (!_benchmarkBatchIo())
+        return 1;
+#ifdef CANGA_WITH_ZLIB
+    _benchmarkCompressedInput();
+#endif
+    return 0;
+}
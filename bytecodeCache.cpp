@@ -0,0 +1,574 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "interpreter.cpp"
+#include "mappedFile.cpp"
+
+// ===============================
+//  Cache de bytecode (.251c)
+// ===============================
+// Com --cache, o bytecode pronto para o interpretador é gravado em um
+// arquivo .251c ao lado do fonte. Na execução seguinte do mesmo fonte (mesmo
+// texto, mesmas opções de otimização e as mesmas interfaces importadas), o
+// arquivo é mapeado em memória e o programa começa a executar sem lexer,
+// análise, IR nem otimizações.
+//
+// O arquivo é relocável: uma tabela de seções com offsets a partir do início
+// do arquivo, cada seção um vetor de registros de tamanho fixo (instruções,
+// linhas, argumentos de chamada, kernels, globais e funções), e os nomes e
+// strings constantes como offsets num bloco de texto. Os inteiros estão na
+// ordem de bytes da máquina que gerou o arquivo, como no .251i.
+//
+// O cabeçalho guarda um hash de tudo o que vem depois dele, conferido ao
+// abrir: um arquivo truncado ou alterado é recusado como "sem cache". Na
+// carga, cada instrução é verificada contra o programa (opcode, registradores
+// dentro do quadro da função, índices de strings, globais, funções, kernels e
+// argumentos de chamada, desvios dentro da função), para que um .251c
+// inválido não leve o interpretador a acessar memória fora dos vetores. Não
+// são reverificados os tipos dos registradores nem os acessos a arrays com
+// limites já provados (ALOADNC/ASTORENC): o hash recusa arquivos corrompidos,
+// mas um .251c forjado com hash válido ainda pode derrubar o interpretador.
+// A gravação vai para
+// um arquivo temporário renomeado por cima do .251c: quem ainda tem o antigo
+// mapeado continua lendo o arquivo antigo, e uma falha no meio não deixa um
+// .251c pela metade.
+
+const char BYTECODE_MAGIC[8] = {'C', 'A', 'N', 'G', 'A', '2', '5', 'C'};
+const uint32_t BYTECODE_VERSION = 3;
+
+enum BytecodeSection : uint32_t
+{
+    BC_CODE,
+    BC_LINES,
+    BC_CALL_ARGS,
+    BC_KERNEL_OPS,
+    BC_KERNELS,
+    BC_GLOBALS,
+    BC_FUNCTIONS,
+    BC_STRINGS,
+    BC_TEXT,
+    BC_SECTION_COUNT
+};
+
+struct BytecodeHeader
+{
+    char magic[8];
+    uint32_t version;
+    int32_t mainFunction;
+    uint64_t key;      // hash do fonte e das opções (bytecodeCacheKey)
+    uint64_t checksum; // bytecodeChecksum do arquivo depois do cabeçalho
+    struct
+    {
+        uint32_t offset;
+        uint32_t count;
+    } sections[BC_SECTION_COUNT];
+};
+
+struct BytecodeString
+{
+    uint32_t offset; // no bloco de texto
+    uint32_t length;
+};
+
+struct BytecodeGlobal
+{
+    BytecodeString name;
+    int32_t type; // IRType
+    int32_t extent;
+};
+
+struct BytecodeFunction
+{
+    BytecodeString name;
+    int32_t codeStart;
+    int32_t codeEnd;
+    int32_t nregs;
+    int32_t nparams;
+    int32_t retType; // IRType
+};
+
+// FNV-1a de 64 bits
+inline uint64_t fnv1a(std::string_view data, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Hash do conteúdo do .251c: FNV-1a sobre palavras de 8 bytes em quatro
+// faixas independentes (palavras intercaladas), combinadas no fim, e o final
+// byte a byte. As faixas não esperam a multiplicação umas das outras, então
+// conferir o arquivo inteiro a cada carga pesa pouco nela
+inline uint64_t bytecodeChecksum(std::string_view data)
+{
+    uint64_t lanes[4] = {0xcbf29ce484222325ull, 0x84222325cbf29ce4ull, 0x9e3779b97f4a7c15ull, 0x7f4a7c159e3779b9ull};
+    size_t blocks = data.size() / 32;
+    for (size_t i = 0; i < blocks; ++i)
+        for (int l = 0; l < 4; ++l)
+        {
+            uint64_t w;
+            std::memcpy(&w, data.data() + i * 32 + l * 8, 8);
+            lanes[l] = (lanes[l] ^ w) * 0x100000001b3ull;
+            lanes[l] ^= lanes[l] >> 29;
+        }
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint64_t lane : lanes)
+    {
+        hash = (hash ^ lane) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    return fnv1a(data.substr(blocks * 32), hash);
+}
+
+// Chave do cache: o bytecode depende do texto do fonte, das opções que mudam
+// a tradução (`options`, em qualquer forma textual estável) e do conteúdo
+// das interfaces importadas
+inline uint64_t bytecodeCacheKey(std::string_view source, std::string_view options,
+                                 const std::vector<std::string_view> &imports = {})
+{
+    uint64_t hash = fnv1a(options, fnv1a(source));
+    for (auto bytes : imports)
+        hash = fnv1a(bytes, hash);
+    return hash;
+}
+
+// Grava o programa em `path` (via arquivo temporário e rename)
+inline void writeBytecodeCache(const std::string &path, const BcProgram &program, uint64_t key)
+{
+    std::string text;
+    auto intern = [&](const std::string &s)
+    {
+        BytecodeString r = {(uint32_t)text.size(), (uint32_t)s.size()};
+        text += s;
+        return r;
+    };
+
+    std::vector<BytecodeString> strings;
+    for (auto &s : program.strings)
+        strings.push_back(intern(s));
+    std::vector<BytecodeGlobal> globals;
+    for (auto &g : program.globals)
+        globals.push_back({intern(g.name), (int32_t)g.type, g.extent});
+    std::vector<BytecodeFunction> functions;
+    for (auto &f : program.functions)
+        functions.push_back({intern(f.name), f.codeStart, f.codeEnd, f.nregs, f.nparams, (int32_t)f.retType});
+
+    struct Section
+    {
+        const void *data;
+        size_t count;
+        size_t recordSize;
+    };
+    const Section sections[BC_SECTION_COUNT] = {
+        {program.code.data(), program.code.size(), sizeof(BcInstr)},
+        {program.lines.data(), program.lines.size(), sizeof(int32_t)},
+        {program.callArgs.data(), program.callArgs.size(), sizeof(int32_t)},
+        {program.kernelOps.data(), program.kernelOps.size(), sizeof(KernelOp)},
+        {program.kernels.data(), program.kernels.size(), sizeof(BcKernel)},
+        {globals.data(), globals.size(), sizeof(BytecodeGlobal)},
+        {functions.data(), functions.size(), sizeof(BytecodeFunction)},
+        {strings.data(), strings.size(), sizeof(BytecodeString)},
+        {text.data(), text.size(), 1}};
+
+    BytecodeHeader header = {};
+    std::memcpy(header.magic, BYTECODE_MAGIC, sizeof(BYTECODE_MAGIC));
+    header.version = BYTECODE_VERSION;
+    header.mainFunction = program.mainFunction;
+    header.key = key;
+    // Cada seção começa alinhada a 8 bytes
+    size_t offset = sizeof(BytecodeHeader);
+    for (uint32_t s = 0; s < BC_SECTION_COUNT; ++s)
+    {
+        header.sections[s].offset = (uint32_t)offset;
+        header.sections[s].count = (uint32_t)sections[s].count;
+        offset = (offset + sections[s].count * sections[s].recordSize + 7) & ~(size_t)7;
+    }
+
+    std::string image(offset, '\0');
+    for (uint32_t s = 0; s < BC_SECTION_COUNT; ++s)
+        if (sections[s].count)
+            std::memcpy(&image[header.sections[s].offset], sections[s].data, sections[s].count * sections[s].recordSize);
+    header.checksum = bytecodeChecksum(std::string_view(image).substr(sizeof(BytecodeHeader)));
+    std::memcpy(&image[0], &header, sizeof(header));
+
+    std::string temp = path + ".tmp" + std::to_string(getpid());
+    std::FILE *out = std::fopen(temp.c_str(), "wb");
+    if (!out)
+        throw std::runtime_error("Erro ao criar arquivo: " + temp);
+    bool ok = std::fwrite(image.data(), 1, image.size(), out) == image.size();
+    if (std::fclose(out) != 0 || !ok || std::rename(temp.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temp.c_str());
+        throw std::runtime_error("Erro ao gravar arquivo: " + path);
+    }
+}
+
+// Arquivo .251c mapeado em memória
+class BytecodeCache
+{
+public:
+    explicit BytecodeCache(const std::string &path)
+        : path_(path), file_(path)
+    {
+        if (file_.size() < sizeof(BytecodeHeader))
+            invalid("arquivo truncado");
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, BYTECODE_MAGIC, sizeof(BYTECODE_MAGIC)) != 0)
+            invalid("nao e um bytecode .251c");
+        if (header_.version != BYTECODE_VERSION)
+            invalid("versao " + std::to_string(header_.version) + " nao suportada");
+        std::string_view payload((const char *)file_.data() + sizeof(BytecodeHeader),
+                                 file_.size() - sizeof(BytecodeHeader));
+        if (bytecodeChecksum(payload) != header_.checksum)
+            invalid("hash do conteudo nao confere");
+    }
+
+    uint64_t key() const
+    {
+        return header_.key;
+    }
+
+    // Reconstrói o programa; os vetores de registros são copiados direto do
+    // mapeamento, e só nomes e strings constantes viram std::string
+    BcProgram load() const
+    {
+        BcProgram program;
+        copy(BC_CODE, program.code);
+        copy(BC_LINES, program.lines);
+        copy(BC_CALL_ARGS, program.callArgs);
+        copy(BC_KERNEL_OPS, program.kernelOps);
+        copy(BC_KERNELS, program.kernels);
+
+        std::string_view text((const char *)table(BC_TEXT, 1), header_.sections[BC_TEXT].count);
+        auto string = [&](const BytecodeString &s)
+        {
+            if (s.offset > text.size() || s.length > text.size() - s.offset)
+                invalid("texto fora do arquivo");
+            return std::string(text.substr(s.offset, s.length));
+        };
+
+        const BytecodeString *strings = (const BytecodeString *)table(BC_STRINGS, sizeof(BytecodeString));
+        program.strings.reserve(header_.sections[BC_STRINGS].count);
+        for (uint32_t i = 0; i < header_.sections[BC_STRINGS].count; ++i)
+            program.strings.push_back(string(strings[i]));
+
+        const BytecodeGlobal *globals = (const BytecodeGlobal *)table(BC_GLOBALS, sizeof(BytecodeGlobal));
+        for (uint32_t i = 0; i < header_.sections[BC_GLOBALS].count; ++i)
+            program.globals.push_back({string(globals[i].name), (IRType)globals[i].type, globals[i].extent});
+
+        const BytecodeFunction *functions = (const BytecodeFunction *)table(BC_FUNCTIONS, sizeof(BytecodeFunction));
+        for (uint32_t i = 0; i < header_.sections[BC_FUNCTIONS].count; ++i)
+        {
+            const BytecodeFunction &f = functions[i];
+            if (f.codeStart < 0 || f.codeStart > f.codeEnd || (size_t)f.codeEnd > program.code.size())
+                invalid("funcao fora do codigo");
+            program.functions.push_back({string(f.name), f.codeStart, f.codeEnd, f.nregs, f.nparams, (IRType)f.retType});
+        }
+
+        if (header_.mainFunction < -1 || header_.mainFunction >= (int32_t)program.functions.size())
+            invalid("funcao principal inexistente");
+        program.mainFunction = header_.mainFunction;
+        verify(program);
+        return program;
+    }
+
+private:
+    std::string path_;
+    MappedFile file_;
+    BytecodeHeader header_;
+
+    [[noreturn]] void invalid(const std::string &why) const
+    {
+        throw std::runtime_error("Bytecode invalido (" + why + "): " + path_);
+    }
+
+    const void *table(BytecodeSection s, size_t recordSize) const
+    {
+        uint32_t offset = header_.sections[s].offset;
+        if (offset % 4 != 0 || offset > file_.size() ||
+            (uint64_t)header_.sections[s].count * recordSize > file_.size() - offset)
+            invalid("secao fora do arquivo");
+        return file_.data() + offset;
+    }
+
+    static bool validType(IRType type)
+    {
+        return (int)type >= (int)IRType::INT && (int)type <= (int)IRType::ARR_BOOL;
+    }
+
+    // Confere os índices de todas as instruções de cada função (ver o
+    // comentário do início do arquivo)
+    void verify(const BcProgram &program) const
+    {
+        if (program.lines.size() != program.code.size())
+            invalid("linhas nao correspondem ao codigo");
+        for (auto &g : program.globals)
+            if (!validType(g.type))
+                invalid("tipo de global invalido");
+        for (auto &k : program.kernels)
+            verifyKernel(program, k);
+        for (auto &fn : program.functions)
+        {
+            if (fn.nparams < 0 || fn.nregs < fn.nparams || fn.nregs > (1 << 24) || !validType(fn.retType))
+                invalid("quadro da funcao " + fn.name);
+            if (fn.codeStart == fn.codeEnd)
+                invalid("funcao " + fn.name + " sem codigo");
+            // A última instrução não pode seguir para a função seguinte
+            Opcode last = program.code[fn.codeEnd - 1].op;
+            if (last != Opcode::RET && last != Opcode::RETV && last != Opcode::JMP)
+                invalid("funcao " + fn.name + " sem retorno");
+            verifyCode(program, fn);
+        }
+    }
+
+    // Papel de cada operando, para a verificação das instruções
+    enum OperandKind : uint8_t
+    {
+        OPERAND_NONE, // constante ou não usado
+        OPERAND_REG,
+        OPERAND_STRING,
+        OPERAND_GLOBAL,
+        OPERAND_GLOBAL_END, // 0 a globals.size() (AKERNEL: global + 1 ou 0)
+        OPERAND_KERNEL,
+        OPERAND_FUNCTION,
+        OPERAND_CALL_ARGS,
+        OPERAND_TARGET, // desvio dentro da função
+        OPERAND_KIND_COUNT
+    };
+
+    struct InstrOperands
+    {
+        bool known; // opcode existente
+        OperandKind a, b, c;
+    };
+
+    static constexpr InstrOperands operandsOf(Opcode op)
+    {
+        switch (op)
+        {
+        case Opcode::LOADK:
+        case Opcode::RET:
+        case Opcode::PRINTI:
+        case Opcode::PRINTF:
+        case Opcode::PRINTS:
+        case Opcode::PRINTC:
+        case Opcode::PRINTB:
+        case Opcode::PRINTA:
+            return {true, OPERAND_REG, OPERAND_NONE, OPERAND_NONE};
+        case Opcode::LOADS:
+            return {true, OPERAND_REG, OPERAND_STRING, OPERAND_NONE};
+        case Opcode::MOV:
+        case Opcode::NEGI:
+        case Opcode::NEGF:
+        case Opcode::NOT:
+        case Opcode::I2F:
+        case Opcode::F2I:
+        case Opcode::I2S:
+        case Opcode::F2S:
+        case Opcode::C2S:
+        case Opcode::B2S:
+            return {true, OPERAND_REG, OPERAND_REG, OPERAND_NONE};
+        case Opcode::LOADG:
+        case Opcode::STOREG:
+        case Opcode::STOREGA:
+            return {true, OPERAND_REG, OPERAND_GLOBAL, OPERAND_NONE};
+        case Opcode::AKERNEL:
+            return {true, OPERAND_REG, OPERAND_KERNEL, OPERAND_GLOBAL_END};
+        case Opcode::CALL:
+            return {true, OPERAND_REG, OPERAND_FUNCTION, OPERAND_CALL_ARGS};
+        case Opcode::RETV:
+            return {true, OPERAND_NONE, OPERAND_NONE, OPERAND_NONE};
+        case Opcode::JMP:
+            return {true, OPERAND_TARGET, OPERAND_NONE, OPERAND_NONE};
+        case Opcode::JT:
+        case Opcode::JF:
+            return {true, OPERAND_REG, OPERAND_TARGET, OPERAND_NONE};
+        default:
+            // Operações binárias: a = b op c
+            if (op > Opcode::JF)
+                return {false, OPERAND_NONE, OPERAND_NONE, OPERAND_NONE};
+            return {true, OPERAND_REG, OPERAND_REG, OPERAND_REG};
+        }
+    }
+
+    // operandsOf para cada byte de opcode, montada na compilação
+    struct OperandTable
+    {
+        InstrOperands entries[256];
+
+        constexpr OperandTable() : entries()
+        {
+            for (int op = 0; op < 256; ++op)
+                entries[op] = operandsOf((Opcode)op);
+        }
+    };
+
+    // Faixas válidas de cada tipo de operando numa função: o operando x
+    // vale se (uint32_t)(x - start) < size
+    struct OperandRanges
+    {
+        int64_t start[OPERAND_KIND_COUNT];
+        uint64_t size[OPERAND_KIND_COUNT];
+
+        bool fits(int32_t x, OperandKind kind) const
+        {
+            return (uint64_t)(uint32_t)(x - start[kind]) < size[kind];
+        }
+    };
+
+    // Confere os operandos de todas as instruções de `fn`. O laço só faz
+    // comparações contra as faixas da função; só uma instrução inválida
+    // passa por verifyInstr, que monta a mensagem de erro
+    void verifyCode(const BcProgram &program, const BcFunction &fn) const
+    {
+        static constexpr OperandTable table;
+        OperandRanges ranges = {};
+        ranges.size[OPERAND_NONE] = (uint64_t)1 << 32;
+        ranges.size[OPERAND_REG] = (uint64_t)fn.nregs;
+        ranges.size[OPERAND_STRING] = program.strings.size();
+        ranges.size[OPERAND_GLOBAL] = program.globals.size();
+        ranges.size[OPERAND_GLOBAL_END] = program.globals.size() + 1;
+        ranges.size[OPERAND_KERNEL] = program.kernels.size();
+        ranges.size[OPERAND_FUNCTION] = program.functions.size();
+        ranges.size[OPERAND_CALL_ARGS] = program.callArgs.size();
+        ranges.start[OPERAND_TARGET] = fn.codeStart;
+        ranges.size[OPERAND_TARGET] = (uint64_t)(fn.codeEnd - fn.codeStart);
+        for (int32_t pc = fn.codeStart; pc < fn.codeEnd; ++pc)
+        {
+            const BcInstr &in = program.code[pc];
+            const InstrOperands &ops = table.entries[(uint8_t)in.op];
+            bool ok = ops.known & ranges.fits(in.a, ops.a) & ranges.fits(in.b, ops.b) & ranges.fits(in.c, ops.c);
+            if (ok && in.op == Opcode::CALL)
+            {
+                int32_t argc = program.callArgs[in.c];
+                ok = argc == program.functions[in.b].nparams && (size_t)argc < program.callArgs.size() - in.c;
+                for (int32_t k = 1; ok && k <= argc; ++k)
+                    ok = ranges.fits(program.callArgs[in.c + k], OPERAND_REG);
+            }
+            else if (ok && in.op == Opcode::AKERNEL)
+            {
+                const BcKernel &k = program.kernels[in.b];
+                for (int32_t j = 0; ok && j < k.opCount; ++j)
+                {
+                    const KernelOp &op = program.kernelOps[k.opStart + j];
+                    if (op.op == KOp::LOAD_I || op.op == KOp::LOAD_F || op.op == KOp::SPLAT_I || op.op == KOp::SPLAT_F)
+                        ok = ranges.fits(op.operand, OPERAND_REG);
+                }
+            }
+            if (!ok)
+            {
+                verifyInstr(program, fn, in);
+                invalid("instrucao invalida em " + fn.name);
+            }
+        }
+    }
+
+    // Verificação completa de uma instrução, com a mensagem de erro
+    void verifyInstr(const BcProgram &program, const BcFunction &fn, const BcInstr &in) const
+    {
+        InstrOperands ops = operandsOf(in.op);
+        if (!ops.known)
+            invalid("opcode desconhecido em " + fn.name);
+        auto check = [&](int32_t x, OperandKind kind)
+        {
+            switch (kind)
+            {
+            case OPERAND_REG:
+                if (x < 0 || x >= fn.nregs)
+                    invalid("registrador fora do quadro em " + fn.name);
+                break;
+            case OPERAND_STRING:
+                if (x < 0 || (size_t)x >= program.strings.size())
+                    invalid("string inexistente em " + fn.name);
+                break;
+            case OPERAND_GLOBAL:
+            case OPERAND_GLOBAL_END:
+                if (x < 0 || (size_t)x >= program.globals.size() + (kind == OPERAND_GLOBAL_END))
+                    invalid("global inexistente em " + fn.name);
+                break;
+            case OPERAND_KERNEL:
+                if (x < 0 || (size_t)x >= program.kernels.size())
+                    invalid("kernel inexistente em " + fn.name);
+                break;
+            case OPERAND_FUNCTION:
+                if (x < 0 || (size_t)x >= program.functions.size())
+                    invalid("funcao inexistente em " + fn.name);
+                break;
+            case OPERAND_CALL_ARGS:
+                if (x < 0 || (size_t)x >= program.callArgs.size())
+                    invalid("lista de argumentos inexistente em " + fn.name);
+                break;
+            case OPERAND_TARGET:
+                if (x < fn.codeStart || x >= fn.codeEnd)
+                    invalid("desvio para fora de " + fn.name);
+                break;
+            default:
+                break;
+            }
+        };
+        check(in.a, ops.a);
+        check(in.b, ops.b);
+        check(in.c, ops.c);
+
+        if (in.op == Opcode::AKERNEL)
+        {
+            const BcKernel &k = program.kernels[in.b];
+            for (int32_t j = 0; j < k.opCount; ++j)
+            {
+                KOp op = program.kernelOps[k.opStart + j].op;
+                if (op == KOp::LOAD_I || op == KOp::LOAD_F || op == KOp::SPLAT_I || op == KOp::SPLAT_F)
+                    check(program.kernelOps[k.opStart + j].operand, OPERAND_REG);
+            }
+        }
+        else if (in.op == Opcode::CALL)
+        {
+            int32_t argc = program.callArgs[in.c];
+            if (argc != program.functions[in.b].nparams || (size_t)argc >= program.callArgs.size() - in.c)
+                invalid("argumentos de chamada em " + fn.name);
+            for (int32_t k = 1; k <= argc; ++k)
+                check(program.callArgs[in.c + k], OPERAND_REG);
+        }
+    }
+
+    // Faixa de operações e pilha de avaliação do kernel
+    void verifyKernel(const BcProgram &program, const BcKernel &k) const
+    {
+        if (k.opStart < 0 || k.opCount <= 0 || (size_t)k.opStart > program.kernelOps.size() ||
+            (size_t)k.opCount > program.kernelOps.size() - k.opStart || !validType(k.resultType))
+            invalid("kernel fora das operacoes");
+        int32_t depth = 0;
+        for (int32_t j = 0; j < k.opCount; ++j)
+        {
+            KOp op = program.kernelOps[k.opStart + j].op;
+            if (op >= KOp::COUNT)
+                invalid("operacao de kernel desconhecida");
+            if (op == KOp::LOAD_I || op == KOp::LOAD_F || op == KOp::SPLAT_I || op == KOp::SPLAT_F)
+                ++depth;
+            else if (op == KOp::I2F || op == KOp::F2I || op == KOp::NEG_I || op == KOp::NEG_F)
+            {
+                if (depth < 1)
+                    invalid("pilha do kernel");
+            }
+            else if (depth-- < 2)
+                invalid("pilha do kernel");
+        }
+        if (depth != 1)
+            invalid("pilha do kernel");
+    }
+
+    template <typename Record>
+    void copy(BytecodeSection s, std::vector<Record> &out) const
+    {
+        const Record *records = (const Record *)table(s, sizeof(Record));
+        out.assign(records, records + header_.sections[s].count);
+    }
+};
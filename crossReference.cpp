@@ -0,0 +1,201 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+// ===============================
+//  Índice de referências cruzadas
+// ===============================
+// Guarda todas as ocorrências de cada símbolo como offsets no texto; linha e
+// coluna são resolvidas pelo LineIndex só quando um relatório pede (ver
+// SymbolTable). As listas ficam num único buffer compartilhado, em blocos
+// encadeados de tamanho fixo, com um varint por ocorrência:
+//   delta do offset (zigzag) << 1 | contada
+// "Contada" marca as ocorrências que entram nas linhas do .TAB. Cada trecho
+// de XREF_BUCKET_BYTES do texto tem também a sua lista, com dois varints
+// por ocorrência (delta do offset em zigzag, entrada), para as consultas
+// por linha não percorrerem as ocorrências do programa inteiro.
+
+// Bytes do texto por lista de ocorrências por trecho
+const size_t XREF_BUCKET_BYTES = 1024;
+class CrossReferenceIndex
+{
+public:
+    CrossReferenceIndex()
+    {
+        // Bloco 0 reservado: offset 0 significa "sem bloco"
+        buffer_.resize(CHAIN_BLOCK_SIZE, 0);
+    }
+
+    void add(int entry, size_t offset, bool counted)
+    {
+        if (entry <= 0)
+            return;
+        if ((size_t)entry >= symbols_.size())
+            symbols_.resize(entry + 1);
+
+        Chain &sym = symbols_[entry];
+        putVarint(sym, (zigzag((int64_t)offset - sym.last) << 1) | (counted ? 1 : 0));
+        sym.last = (int64_t)offset;
+        sym.count++;
+
+        size_t bucket = offset / XREF_BUCKET_BYTES;
+        if (bucket >= buckets_.size())
+            buckets_.resize(bucket + 1);
+        Chain &near = buckets_[bucket];
+        putVarint(near, zigzag((int64_t)offset - near.last));
+        putVarint(near, (uint64_t)entry);
+        near.last = (int64_t)offset;
+        near.count++;
+    }
+
+    // Chama f(offset, entrada) para cada ocorrência em [from, to), trecho a
+    // trecho do texto (não necessariamente em ordem de offset)
+    template <typename F>
+    void forEachInRange(size_t from, size_t to, F f) const
+    {
+        for (size_t bucket = from / XREF_BUCKET_BYTES; bucket < buckets_.size() && bucket * XREF_BUCKET_BYTES < to;
+             ++bucket)
+        {
+            const Chain &near = buckets_[bucket];
+            Reader r(*this, near.head);
+            int64_t offset = 0;
+            for (uint32_t k = 0; k < near.count; ++k)
+            {
+                offset += unzigzag(r.varint());
+                int entry = (int)r.varint();
+                if ((size_t)offset >= from && (size_t)offset < to)
+                    f((size_t)offset, entry);
+            }
+        }
+    }
+
+    // Offsets de todas as ocorrências do símbolo, na ordem em que foram registradas
+    std::vector<size_t> uses(int entry) const
+    {
+        std::vector<size_t> out;
+        forEachUse(entry, [&](size_t offset, bool)
+                   { out.push_back(offset); });
+        return out;
+    }
+
+    // Chama f(offset, contada) para cada ocorrência, na ordem em que foram registradas
+    template <typename F>
+    void forEachUse(int entry, F f) const
+    {
+        if (entry <= 0 || (size_t)entry >= symbols_.size())
+            return;
+        const Chain &sym = symbols_[entry];
+        Reader r(*this, sym.head);
+        int64_t offset = 0;
+        for (uint32_t k = 0; k < sym.count; ++k)
+        {
+            uint64_t v = r.varint();
+            offset += unzigzag(v >> 1);
+            f((size_t)offset, (v & 1) != 0);
+        }
+    }
+
+    size_t useCount(int entry) const
+    {
+        return entry > 0 && (size_t)entry < symbols_.size() ? symbols_[entry].count : 0;
+    }
+
+    // Bytes ocupados pelo buffer compartilhado
+    size_t bytes() const
+    {
+        return buffer_.size();
+    }
+
+private:
+    static const uint32_t CHAIN_BLOCK_SIZE = 32;
+    static const uint32_t CHAIN_BLOCK_PAYLOAD = CHAIN_BLOCK_SIZE - sizeof(uint32_t);
+
+    // Lista encadeada de blocos no buffer; cada bloco começa com o offset
+    // do próximo (0 no último)
+    struct Chain
+    {
+        uint32_t head = 0;
+        uint32_t tail = 0;
+        uint32_t used = CHAIN_BLOCK_PAYLOAD;
+        uint32_t count = 0;
+        int64_t last = 0;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const CrossReferenceIndex &idx, uint32_t block)
+            : idx_(idx), block_(block), pos_(0) {}
+
+        uint64_t varint()
+        {
+            uint64_t v = 0;
+            int shift = 0;
+            while (true)
+            {
+                uint8_t b = byte();
+                v |= (uint64_t)(b & 0x7f) << shift;
+                if (!(b & 0x80))
+                    return v;
+                shift += 7;
+            }
+        }
+
+    private:
+        const CrossReferenceIndex &idx_;
+        uint32_t block_;
+        uint32_t pos_;
+
+        uint8_t byte()
+        {
+            if (pos_ == CHAIN_BLOCK_PAYLOAD)
+            {
+                std::memcpy(&block_, &idx_.buffer_[block_], sizeof(uint32_t));
+                pos_ = 0;
+            }
+            return idx_.buffer_[block_ + sizeof(uint32_t) + pos_++];
+        }
+    };
+
+    std::vector<uint8_t> buffer_;
+    std::vector<Chain> symbols_; // indexado pela entrada do símbolo
+    std::vector<Chain> buckets_; // indexado por offset / XREF_BUCKET_BYTES
+
+    static uint64_t zigzag(int64_t v)
+    {
+        return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t v)
+    {
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    void putByte(Chain &c, uint8_t b)
+    {
+        if (c.used == CHAIN_BLOCK_PAYLOAD)
+        {
+            uint32_t block = (uint32_t)buffer_.size();
+            buffer_.resize(buffer_.size() + CHAIN_BLOCK_SIZE, 0);
+            if (c.tail)
+                std::memcpy(&buffer_[c.tail], &block, sizeof(uint32_t));
+            else
+                c.head = block;
+            c.tail = block;
+            c.used = 0;
+        }
+        buffer_[c.tail + sizeof(uint32_t) + c.used++] = b;
+    }
+
+    void putVarint(Chain &c, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            putByte(c, (uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        putByte(c, (uint8_t)v);
+    }
+};
@@ -0,0 +1,276 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/inotify.h>)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define CANGA_INOTIFY 1
+#endif
+#endif
+
+// ===============================
+//  Observação de fontes (--watch)
+// ===============================
+// Observa fontes .251 e diretórios (todos os .251 dentro deles, inclusive
+// os criados depois) e devolve, a cada rajada de alterações, os fontes que
+// mudaram. No Linux usa inotify sobre os diretórios, não sobre os arquivos:
+// editores costumam salvar gravando um arquivo temporário e renomeando-o
+// por cima do original, o que trocaria o inode observado. Interessam o fim
+// de uma gravação (IN_CLOSE_WRITE) e a chegada por rename (IN_MOVED_TO);
+// os .LEX/.TAB gravados no mesmo diretório são ignorados pelo nome. Sem
+// inotify, as datas de modificação são consultadas periodicamente.
+//
+// Uma gravação costuma gerar vários eventos seguidos (vários fontes salvos
+// juntos, um checkout): depois do primeiro, a espera continua até passar
+// WATCH_DEBOUNCE_MS sem eventos novos, ou no máximo WATCH_MAX_DELAY_MS.
+
+const int WATCH_DEBOUNCE_MS = 50;
+const int WATCH_MAX_DELAY_MS = 1000;
+
+class FileWatcher
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // `paths`: fontes e diretórios; lança std::runtime_error se algum não existir
+    explicit FileWatcher(const std::vector<std::string> &paths)
+    {
+        for (auto &path : paths)
+        {
+            std::error_code ec;
+            if (std::filesystem::is_directory(path, ec))
+            {
+                std::string dir = path;
+                while (dir.size() > 1 && dir.back() == '/')
+                    dir.pop_back();
+                dirs_[dir].all = true;
+            }
+            else if (std::filesystem::is_regular_file(path, ec))
+            {
+                std::filesystem::path p(path);
+                std::string dir = p.has_parent_path() ? p.parent_path().string() : ".";
+                dirs_[dir].files[p.filename().string()] = path;
+            }
+            else
+                throw std::runtime_error("Erro ao abrir arquivo: " + path);
+        }
+        for (auto &[dir, watched] : dirs_)
+        {
+            for (auto &[name, path] : watched.files)
+                sources_.insert(path);
+            if (watched.all)
+                for (auto &entry : std::filesystem::directory_iterator(dir))
+                    if (isSourceName(entry.path().filename().string()) && entry.is_regular_file())
+                        sources_.insert(dir + "/" + entry.path().filename().string());
+        }
+#ifdef CANGA_INOTIFY
+        fd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        for (auto it = dirs_.begin(); fd_ >= 0 && it != dirs_.end(); ++it)
+        {
+            int wd = inotify_add_watch(fd_, it->first.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd < 0)
+            {
+                // Limite de watches atingido, por exemplo: usa a consulta periódica
+                ::close(fd_);
+                fd_ = -1;
+                break;
+            }
+            watches_[wd] = it->first;
+        }
+#endif
+        if (!usingInotify())
+            for (auto &path : sources_)
+                stamps_[path] = stamp(path);
+    }
+
+    ~FileWatcher()
+    {
+#ifdef CANGA_INOTIFY
+        if (fd_ >= 0)
+            ::close(fd_);
+#endif
+    }
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    bool usingInotify() const
+    {
+        return fd_ >= 0;
+    }
+
+    // Fontes observados, em ordem
+    std::vector<std::string> sources() const
+    {
+        return std::vector<std::string>(sources_.begin(), sources_.end());
+    }
+
+    // Momento do último evento da rajada devolvida por wait()
+    Clock::time_point lastEvent() const
+    {
+        return lastEvent_;
+    }
+
+    // Bloqueia até a próxima rajada de alterações e devolve os fontes
+    // alterados, em ordem e sem repetições
+    std::vector<std::string> wait()
+    {
+        std::set<std::string> changed;
+        Clock::time_point first{};
+        for (;;)
+        {
+            int timeout = -1;
+            if (!changed.empty())
+            {
+                auto now = Clock::now();
+                int quiet = WATCH_DEBOUNCE_MS - (int)elapsedMs(lastEvent_, now);
+                int limit = WATCH_MAX_DELAY_MS - (int)elapsedMs(first, now);
+                timeout = std::min(quiet, limit);
+                if (timeout <= 0)
+                    break;
+            }
+            size_t before = changed.size();
+            bool events = usingInotify() ? readEvents(changed, timeout) : pollStamps(changed, timeout);
+            if (!events)
+                continue;
+            // Eventos repetidos do mesmo fonte também adiam a recompilação
+            lastEvent_ = Clock::now();
+            if (before == 0 && !changed.empty())
+                first = lastEvent_;
+        }
+        return std::vector<std::string>(changed.begin(), changed.end());
+    }
+
+private:
+    struct WatchedDir
+    {
+        bool all = false;                         // todos os .251 do diretório
+        std::map<std::string, std::string> files; // nome -> caminho dado
+    };
+
+    std::map<std::string, WatchedDir> dirs_;
+    std::set<std::string> sources_;
+    std::map<std::string, std::pair<std::filesystem::file_time_type, uintmax_t>> stamps_;
+    Clock::time_point lastEvent_{};
+    int fd_ = -1;
+#ifdef CANGA_INOTIFY
+    std::map<int, std::string> watches_; // descritor do watch -> diretório
+#endif
+
+    static bool isSourceName(const std::string &name)
+    {
+        return name.size() > 4 && name.compare(name.size() - 4, 4, ".251") == 0;
+    }
+
+    static double elapsedMs(Clock::time_point from, Clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    static std::pair<std::filesystem::file_time_type, uintmax_t> stamp(const std::string &path)
+    {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        return {ec ? std::filesystem::file_time_type{} : time, ec ? 0 : size};
+    }
+
+    // Caminho do fonte `name` no diretório `dir`, se ele é observado
+    std::string sourcePath(const std::string &dir, const std::string &name)
+    {
+        auto it = dirs_.find(dir);
+        if (it == dirs_.end())
+            return "";
+        auto file = it->second.files.find(name);
+        if (file != it->second.files.end())
+            return file->second;
+        if (it->second.all && isSourceName(name))
+        {
+            std::string path = dir + "/" + name;
+            sources_.insert(path);
+            return path;
+        }
+        return "";
+    }
+
+    // Espera até `timeout` ms (-1: sem limite) por eventos; true se chegou algum
+    bool readEvents(std::set<std::string> &changed, int timeout)
+    {
+#ifdef CANGA_INOTIFY
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, timeout);
+        if (ready < 0 && errno != EINTR)
+            throw std::runtime_error(std::string("Erro ao observar arquivos: ") + std::strerror(errno));
+        if (ready <= 0)
+            return false;
+
+        alignas(inotify_event) char buffer[16 * 1024];
+        bool any = false;
+        for (;;)
+        {
+            ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+            if (n <= 0)
+                break;
+            for (char *p = buffer; p < buffer + n;)
+            {
+                auto *event = (const inotify_event *)p;
+                p += sizeof(inotify_event) + event->len;
+                auto dir = watches_.find(event->wd);
+                if (dir == watches_.end() || event->len == 0 || (event->mask & IN_ISDIR))
+                    continue;
+                std::string path = sourcePath(dir->second, event->name);
+                if (path.empty())
+                    continue;
+                changed.insert(path);
+                any = true;
+            }
+        }
+        return any;
+#else
+        (void)changed;
+        (void)timeout;
+        return false;
+#endif
+    }
+
+    // Consulta periódica: compara data e tamanho de cada fonte e procura
+    // fontes novos nos diretórios observados
+    bool pollStamps(std::set<std::string> &changed, int timeout)
+    {
+        int interval = timeout < 0 ? WATCH_DEBOUNCE_MS : std::min(timeout, WATCH_DEBOUNCE_MS);
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+        bool any = false;
+        for (auto &[dir, watched] : dirs_)
+            if (watched.all)
+            {
+                std::error_code ec;
+                for (auto &entry : std::filesystem::directory_iterator(dir, ec))
+                    if (isSourceName(entry.path().filename().string()))
+                        sources_.insert(dir + "/" + entry.path().filename().string());
+            }
+        for (auto &path : sources_)
+        {
+            auto now = stamp(path);
+            auto it = stamps_.find(path);
+            if (it != stamps_.end() && it->second == now)
+                continue;
+            stamps_[path] = now;
+            changed.insert(path);
+            any = true;
+        }
+        return any;
+    }
+};
@@ -0,0 +1,220 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "analyzer.cpp"
+
+// ===============================
+//  Fuzzing de desempenho
+// ===============================
+// Alvo para fuzzing guiado por cobertura do Lexer e do laço principal de
+// análise. Com libFuzzer (clang):
+//   clang++ -std=c++17 -O1 -g -fsanitize=fuzzer,address fuzz.cpp -o CangaFuzz
+//   ./CangaFuzz corpus/
+// Sem libFuzzer o mesmo arquivo gera um executável que roda as entradas
+// passadas na linha de comando e, sem argumentos, um laço de mutações
+// aleatórias a partir dos exemplos embutidos:
+//   g++ -std=c++17 -O2 -DCANGA_FUZZ_STANDALONE fuzz.cpp -o CangaFuzz
+//
+// Para cada entrada são medidos tempo, tokens lidos e bytes percorridos pelo
+// lexer e pela análise. A entrada duplicada é comparada com ela mesma
+// repetida 4 vezes (duplicar antes emparelha aspas e comentários abertos, para
+// que as cópias sejam analisadas da mesma forma): como o trabalho linear
+// cresce na mesma proporção dos bytes e tokens, o custo por unidade de
+// trabalho deveria se manter; se ele crescer mais que SUPERLINEAR_RATIO, o
+// comportamento superlinear é reportado (e o processo aborta, para que o
+// libFuzzer salve a entrada). CANGA_FUZZ_LOG=<arquivo> grava uma linha CSV
+// por entrada: bytes,tokens,microssegundos,razao.
+
+static const double SUPERLINEAR_RATIO = 3.0;
+static const double MIN_MEASURABLE_US = 500.0;
+
+struct FuzzMeasure
+{
+    size_t tokens;
+    size_t work; // bytes percorridos (inclusive varreduras do texto inteiro) + tokens lidos (com peso de um token típico)
+    double micros;
+
+    double cost() const
+    {
+        return micros / (double)(work + 1);
+    }
+};
+
+// Uma execução completa: lexer sobre todo o texto e o laço principal de análise
+static FuzzMeasure _fuzzRunOnce(const std::string &source)
+{
+    // Limites baixos o bastante para que cada entrada termine rápido
+    AnalysisLimits limits;
+    limits.maxTokens = 200000;
+    limits.maxNestingDepth = 256;
+    limits.maxIdentifierLength = 1024;
+
+    FuzzMeasure m = {0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+
+    Lexer lexer(source);
+    lexer.setLimits(limits);
+    try
+    {
+        while (lexer.nextToken().type != TokenType::END_OF_FILE)
+        {
+        }
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    SymbolTable symtab;
+    LexemeList lexemes;
+    AnalysisStats stats;
+    try
+    {
+        analyzeSource(source, symtab, lexemes, limits, &stats);
+    }
+    catch (const std::runtime_error &)
+    {
+    }
+
+    m.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    m.tokens = lexer.tokensRead() + stats.tokensRead;
+    // Além do que os lexers alcançam, o texto inteiro é percorrido antes do
+    // primeiro token mesmo quando há um erro léxico logo no início: a
+    // validação do UTF-8 em cada Lexer e o índice de linhas da análise
+    const size_t fullPasses = 3;
+    m.work = lexer.position() + stats.bytesScanned + fullPasses * source.size() + 32 * m.tokens;
+    return m;
+}
+
+// Repete a execução por pelo menos MIN_MEASURABLE_US e fica com o menor tempo,
+// reduzindo o ruído de medição em entradas pequenas
+static FuzzMeasure _fuzzAnalyze(const std::string &source)
+{
+    FuzzMeasure best = _fuzzRunOnce(source);
+    double total = best.micros;
+    while (total < MIN_MEASURABLE_US)
+    {
+        FuzzMeasure m = _fuzzRunOnce(source);
+        total += m.micros;
+        if (m.micros < best.micros)
+            best = m;
+    }
+    return best;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::string source((const char *)data, size);
+    std::string twice = source + source;
+    FuzzMeasure once = _fuzzAnalyze(twice);
+    FuzzMeasure four = _fuzzAnalyze(twice + twice + twice + twice);
+    double ratio = four.cost() / once.cost();
+
+    if (const char *path = std::getenv("CANGA_FUZZ_LOG"))
+    {
+        std::ofstream log(path, std::ios::app);
+        log << size << "," << once.tokens << "," << once.micros << "," << ratio << "\n";
+    }
+
+    if (ratio > SUPERLINEAR_RATIO)
+    {
+        // Confirma antes de reportar, para descartar ruído de medição
+        FuzzMeasure again = _fuzzAnalyze(twice + twice + twice + twice);
+        FuzzMeasure base = _fuzzAnalyze(twice);
+        if (again.cost() / base.cost() > SUPERLINEAR_RATIO)
+        {
+            std::fprintf(stderr, "Comportamento superlinear: %zu bytes, %zu tokens, %.0f us; 4x a entrada: %.0f us "
+                                 "(custo por unidade de trabalho %.1fx maior)\n",
+                         size, base.tokens, base.micros, again.micros, again.cost() / base.cost());
+#ifdef CANGA_FUZZ_STANDALONE
+            // O libFuzzer salva a entrada sozinho; aqui ela vai para um arquivo
+            std::ofstream("superlinear-input.251", std::ios::binary) << source;
+#endif
+            std::abort();
+        }
+    }
+    return 0;
+}
+
+#ifdef CANGA_FUZZ_STANDALONE
+static const char *_fuzzSeeds[] = {
+    "PROGRAM\nDECLARATIONS\n    varType integer: a, b;\n    varType real[]: v[10];\nENDDECLARATIONS\n"
+    "FUNCTIONS\n    FUNCTYPE integer: f(paramType integer: x, y; paramType real: z[3])\n    {\n"
+    "        return x + y;\n    }\n    ENDFUNCTION\nENDFUNCTIONS\n{\n    a := 1;\n"
+    "    WHILE (a < 10) { a := a + 1; }\n    ENDWHILE\n    PRINT \"fim\";\n}\nENDPROGRAM\n",
+    "{ { ( ( /* comentario */ \"texto\" 'c' 12.5 ) ) } } // fim\n",
+    "FUNCTYPE integer: g(?) { { } } ENDFUNCTION\n"};
+
+static std::string _mutate(std::string s, std::mt19937 &rng)
+{
+    static const char *pieces[] = {"{", "}", "(", ")", "[", "]", "/*", "*/", "\"", "'", "//", "\n",
+                                   "FUNCTYPE", "paramType", "varType", "WHILE", "ENDWHILE", "ENDFUNCTION",
+                                   "integer", "real", ":", ";", ",", "x", "123", "?"};
+    int edits = 1 + rng() % 8;
+    for (int e = 0; e < edits; ++e)
+    {
+        size_t at = s.empty() ? 0 : rng() % (s.size() + 1);
+        switch (rng() % 4)
+        {
+        case 0:
+            if (!s.empty() && at < s.size())
+                s.erase(at, 1 + rng() % 8);
+            break;
+        case 1:
+        {
+            // Duplica um trecho: gera aninhamentos e repetições longas
+            if (s.empty())
+                break;
+            size_t from = rng() % s.size();
+            size_t len = std::min<size_t>(1 + rng() % 64, s.size() - from);
+            std::string chunk = s.substr(from, len);
+            int times = 1 + rng() % 16;
+            for (int k = 0; k < times; ++k)
+                s.insert(at, chunk);
+            break;
+        }
+        default:
+            s.insert(at, pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))]);
+        }
+        if (s.size() > 64 * 1024)
+            s.resize(64 * 1024);
+    }
+    return s;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::ifstream ifs(argv[i], std::ios::binary);
+            std::stringstream buffer;
+            buffer << ifs.rdbuf();
+            std::string data = buffer.str();
+            LLVMFuzzerTestOneInput((const uint8_t *)data.data(), data.size());
+        }
+        return 0;
+    }
+
+    std::mt19937 rng(251);
+    std::vector<std::string> corpus(std::begin(_fuzzSeeds), std::end(_fuzzSeeds));
+    const int iterations = 5000;
+    for (int it = 0; it < iterations; ++it)
+    {
+        std::string input = _mutate(corpus[rng() % corpus.size()], rng);
+        LLVMFuzzerTestOneInput((const uint8_t *)input.data(), input.size());
+        if (corpus.size() < 256)
+            corpus.push_back(input);
+        else
+            corpus[rng() % corpus.size()] = input;
+    }
+    std::printf("%d entradas executadas sem comportamento superlinear\n", iterations);
+    return 0;
+}
+#endif
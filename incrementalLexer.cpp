@@ -0,0 +1,220 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "lexer.cpp"
+
+// ===============================
+//  Re-análise léxica incremental
+// ===============================
+// Mantém o texto e a sequência de tokens de um buffer de editor. A cada
+// edição, re-analisa apenas a partir da última fronteira segura antes da
+// edição até a nova sequência voltar a coincidir com a antiga; os tokens
+// restantes são reaproveitados com a posição deslocada (tokens guardam só o
+// offset, então linha e coluna não precisam ser corrigidas).
+//
+// O lexer não guarda estado entre tokens além da posição, então
+// a fronteira segura é o fim do último token que termina antes da edição
+// (o lookahead de um token nunca passa do seu próprio fim), e a
+// ressincronização acontece quando um token novo termina, já depois do
+// trecho inserido, exatamente onde terminava um token antigo.
+
+struct TextEdit
+{
+    size_t offset;        // posição da edição no texto antigo
+    size_t removed;       // quantidade de caracteres removidos
+    std::string inserted; // texto inserido no lugar
+};
+
+class IncrementalLexer
+{
+public:
+    explicit IncrementalLexer(std::string source)
+        : source_(std::move(source))
+    {
+        tokens_ = lexAll(source_);
+        lastRelexed_ = tokens_.size();
+    }
+
+    const std::string &source() const
+    {
+        return source_;
+    }
+
+    // Tokens do texto atual, terminando em END_OF_FILE
+    const std::vector<Token> &tokens() const
+    {
+        return tokens_;
+    }
+
+    // Tokens produzidos pelo lexer na última edição (os demais foram reaproveitados)
+    size_t lastRelexed() const
+    {
+        return lastRelexed_;
+    }
+
+    // Se a última edição não mudou nenhum token (só espaços ou
+    // comentários): os tokens a partir do fim do trecho removido apenas
+    // foram deslocados pelo tamanho da edição
+    bool lastKeptTokens() const
+    {
+        return lastKeptTokens_;
+    }
+
+    // Aplica a edição. Se o novo texto tiver um erro léxico, a exceção do
+    // lexer é propagada e o estado anterior é mantido.
+    void applyEdit(const TextEdit &edit)
+    {
+        if (edit.offset > source_.size() || edit.removed > source_.size() - edit.offset)
+            throw std::runtime_error("Edicao fora dos limites do texto");
+
+        std::string text = source_;
+        text.replace(edit.offset, edit.removed, edit.inserted);
+        long long delta = (long long)edit.inserted.size() - (long long)edit.removed;
+        size_t editEndNew = edit.offset + edit.inserted.size();
+        size_t editEndOld = edit.offset + edit.removed;
+
+        // Fronteira segura: fim do último token que termina antes da edição
+        size_t keep = std::partition_point(tokens_.begin(), tokens_.end() - 1,
+                                           [&](const Token &t)
+                                           { return end(t) < edit.offset; }) -
+                      tokens_.begin();
+        size_t restart = keep ? end(tokens_[keep - 1]) : 0;
+
+        std::vector<Token> fresh;
+        Lexer lexer(text, restart, nullptr);
+        size_t oldIdx = keep;
+        bool resynced = false;
+        while (true)
+        {
+            Token tok = lexer.nextToken();
+            fresh.push_back(tok);
+            if (tok.type == TokenType::END_OF_FILE)
+                break;
+
+            size_t newEnd = end(tok);
+            if (newEnd < editEndNew)
+                continue;
+
+            // Procura um token antigo que termine na posição equivalente
+            size_t oldEnd = (size_t)((long long)newEnd - delta);
+            if (oldEnd < editEndOld)
+                continue;
+            while (oldIdx < tokens_.size() && tokens_[oldIdx].type != TokenType::END_OF_FILE &&
+                   end(tokens_[oldIdx]) < oldEnd)
+                ++oldIdx;
+            if (oldIdx >= tokens_.size() || tokens_[oldIdx].type == TokenType::END_OF_FILE ||
+                end(tokens_[oldIdx]) != oldEnd)
+                continue;
+
+            resynced = true;
+            break;
+        }
+
+        // A partir daqui nada mais lança exceção: atualiza o estado
+        size_t removedTo = resynced ? oldIdx + 1 : tokens_.size();
+        lastKeptTokens_ = fresh.size() == removedTo - keep;
+        for (size_t k = 0; lastKeptTokens_ && k < fresh.size(); ++k)
+        {
+            const Token &old = tokens_[keep + k];
+            size_t moved = old.offset >= editEndOld ? (size_t)((long long)old.offset + delta) : old.offset;
+            lastKeptTokens_ = fresh[k].type == old.type && fresh[k].lexeme == old.lexeme &&
+                              fresh[k].offset == moved && fresh[k].length == old.length;
+        }
+        tokens_.erase(tokens_.begin() + keep, tokens_.begin() + removedTo);
+        tokens_.insert(tokens_.begin() + keep, fresh.begin(), fresh.end());
+        for (size_t k = keep + fresh.size(); resynced && k < tokens_.size(); ++k)
+            tokens_[k].offset = (size_t)((long long)tokens_[k].offset + delta);
+        source_.swap(text);
+        lastRelexed_ = fresh.size();
+    }
+
+    // Análise completa, usada na construção e como referência de validação
+    static std::vector<Token> lexAll(const std::string &text)
+    {
+        std::vector<Token> out;
+        Lexer lexer(text);
+        while (true)
+        {
+            out.push_back(lexer.nextToken());
+            if (out.back().type == TokenType::END_OF_FILE)
+                break;
+        }
+        return out;
+    }
+
+private:
+    std::string source_;
+    std::vector<Token> tokens_;
+    size_t lastRelexed_ = 0;
+    bool lastKeptTokens_ = false;
+
+    static size_t end(const Token &tok)
+    {
+        return tok.offset + tok.length;
+    }
+};
+
+// Fonte de tokens para analyzeTokens sobre tokens já produzidos (os de um
+// IncrementalLexer), sem passar o lexer de novo pelo texto. `lines` é o
+// índice de linhas do mesmo texto, usado nas mensagens de erro.
+class TokenCursor
+{
+public:
+    TokenCursor(const std::vector<Token> &tokens, const LineIndex &lines)
+        : tokens_(tokens), lines_(lines) {}
+
+    void setLimits(const AnalysisLimits &limits)
+    {
+        limits_ = limits;
+    }
+
+    // Recurso de memória dos lexemas dos tokens entregues
+    void setMemoryResource(std::pmr::memory_resource *resource)
+    {
+        resource_ = resource;
+    }
+
+    size_t tokensRead() const
+    {
+        return tokensRead_;
+    }
+
+    // Fim do último token entregue
+    size_t position() const
+    {
+        return next_ ? tokens_[next_ - 1].offset + tokens_[next_ - 1].length : 0;
+    }
+
+    int lineOf(const Token &tok) const
+    {
+        return lines_.line(tok.offset);
+    }
+
+    // Como no Lexer, END_OF_FILE se repete no fim
+    Token nextToken()
+    {
+        const Token &tok = tokens_[next_];
+        if (++tokensRead_ > limits_.maxTokens)
+            throw std::runtime_error("Erro na linha " + std::to_string(lineOf(tok)) +
+                                     ": Limite de " + std::to_string(limits_.maxTokens) + " tokens excedido");
+        if (tok.type != TokenType::END_OF_FILE)
+            ++next_;
+        return Token{tok.type, std::pmr::string(tok.lexeme, resource_), tok.offset, tok.length};
+    }
+
+    // Volta ao token devolvido (sempre um dos últimos entregues)
+    void putBackToken(const Token &tok)
+    {
+        while (next_ > 0 && tokens_[next_ - 1].offset >= tok.offset)
+            --next_;
+    }
+
+private:
+    const std::vector<Token> &tokens_; // terminam em END_OF_FILE
+    const LineIndex &lines_;
+    AnalysisLimits limits_;
+    size_t next_ = 0;
+    size_t tokensRead_ = 0;
+    std::pmr::memory_resource *resource_ = std::pmr::get_default_resource();
+};
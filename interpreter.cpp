@@ -0,0 +1,1672 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <exception>
+#include <map>
+#include <sstream>
+#include <memory>
+#include "ir.cpp"
+#include "arrayKernels.cpp"
+#include "stringRuntime.cpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <ctime>
+#define CANGA_PROFILE_TIMER 1
+#endif
+
+// ===============================
+//  Execução: bytecode de registradores
+// ===============================
+// A IR otimizada é traduzida para um bytecode plano (vetores de structs POD,
+// referências por índice) executado por um interpretador de registradores.
+// Cada valor SSA ocupa um registrador; os PHIs viram cópias nas arestas.
+
+union Slot
+{
+    int64_t i;
+    double f;
+    void *p;
+    uint64_t s; // string (ver stringRuntime.cpp)
+};
+
+enum class Opcode : uint8_t
+{
+    LOADK, // a = constante de 64 bits (b = parte baixa, c = parte alta)
+    LOADS, // a = string constante b
+    MOV,
+    ADDI,
+    SUBI,
+    MULI,
+    DIVI,
+    MODI,
+    NEGI,
+    ADDF,
+    SUBF,
+    MULF,
+    DIVF,
+    NEGF,
+    CAT,
+    LTI,
+    LEI,
+    GTI,
+    GEI,
+    EQI,
+    NEI,
+    LTF,
+    LEF,
+    GTF,
+    GEF,
+    EQF,
+    NEF,
+    LTS,
+    LES,
+    GTS,
+    GES,
+    EQS,
+    NES,
+    NOT,
+    I2F,
+    F2I,
+    I2S,
+    F2S,
+    C2S,
+    B2S,
+    LOADG,   // a = global b
+    STOREG,  // global b = a
+    STOREGA, // copia os elementos do array a para o array global b
+    ALOAD,   // a = b[c], com verificação de limites
+    ALOADNC, // a = b[c], limites provados
+    ASTORE,  // a[b] = c, com verificação de limites
+    ASTORENC,
+    AKERNEL, // a = kernel b (aritmética de arrays); c > 0: grava no global c - 1
+    CALL,    // a = função b (argumentos em callArgs[c])
+    RET,
+    RETV,
+    PRINTI,
+    PRINTF,
+    PRINTS,
+    PRINTC,
+    PRINTB,
+    PRINTA,
+    JMP, // pc = a
+    JT,  // se a: pc = b
+    JF   // se !a: pc = b
+};
+
+struct BcInstr
+{
+    Opcode op;
+    uint8_t pad[3];
+    int32_t a;
+    int32_t b;
+    int32_t c;
+};
+
+struct BcKernel
+{
+    int32_t opStart;
+    int32_t opCount;
+    IRType resultType;
+};
+
+struct BcFunction
+{
+    std::string name;
+    int32_t codeStart;
+    int32_t codeEnd;
+    int32_t nregs;
+    int32_t nparams;
+    IRType retType;
+};
+
+struct BcGlobal
+{
+    std::string name;
+    IRType type;
+    int32_t extent;
+};
+
+struct BcProgram
+{
+    std::vector<BcInstr> code;
+    std::vector<int32_t> lines; // linha de origem de cada instrução
+    std::vector<std::string> strings;
+    std::vector<int32_t> callArgs; // [argc, r1, ..., rn] por chamada
+    std::vector<KernelOp> kernelOps;
+    std::vector<BcKernel> kernels;
+    std::vector<BcGlobal> globals;
+    std::vector<BcFunction> functions;
+    int32_t mainFunction = -1;
+};
+
+// ===============================
+//  Tradução IR -> bytecode
+// ===============================
+class BcLowering
+{
+public:
+    // fuseKernels: encadeia operações de arrays num único kernel
+    // coalesceCopies: atualizações de variáveis de laço escrevem direto no
+    // registrador do PHI (ver coalescePhis)
+    explicit BcLowering(bool fuseKernels = true, bool coalesceCopies = true)
+        : fuse_(fuseKernels), coalesce_(coalesceCopies) {}
+
+    BcProgram lower(const IRModule &module)
+    {
+        prog_ = BcProgram();
+        stringIndex_.clear();
+        for (auto &g : module.globals)
+        {
+            auto ext = module.arrayExtents.find(g.first);
+            globalIndex_[g.first] = (int)prog_.globals.size();
+            prog_.globals.push_back({g.first, g.second, ext != module.arrayExtents.end() ? ext->second : 0});
+        }
+        for (size_t i = 0; i < module.functions.size(); ++i)
+        {
+            functionIndex_[module.functions[i].name] = (int)i;
+            BcFunction f;
+            f.name = module.functions[i].name;
+            f.nparams = (int32_t)module.functions[i].params.size();
+            f.retType = module.functions[i].retType;
+            f.codeStart = f.codeEnd = 0;
+            f.nregs = 0;
+            prog_.functions.push_back(f);
+            if (f.name == "PROGRAM")
+                prog_.mainFunction = (int32_t)i;
+        }
+        for (size_t i = 0; i < module.functions.size(); ++i)
+            lowerFunction(module.functions[i], prog_.functions[i]);
+        return prog_;
+    }
+
+private:
+    bool fuse_;
+    bool coalesce_;
+    BcProgram prog_;
+    std::map<std::string, int> globalIndex_;
+    std::map<std::string, int> functionIndex_;
+    std::map<std::string, int> stringIndex_; // constantes iguais ficam numa só entrada
+
+    const IRFunction *fn_ = nullptr;
+    int nparams_ = 0;
+    int nregs_ = 0;
+    std::vector<int> uses_;
+    std::vector<char> fused_;
+    std::vector<int> alias_; // valor -> PHI cujo registrador ele usa, ou -1
+    std::vector<int> directStore_; // kernel -> global de destino (+1), 0 se nenhum
+    std::vector<int> blockStart_;
+    std::vector<std::pair<size_t, int>> jumpPatches_; // (instrução, bloco) em a
+    std::vector<std::pair<size_t, int>> condPatches_; // (instrução, bloco) em b
+
+    [[noreturn]] void error(int line, const std::string &msg) const
+    {
+        throw std::runtime_error("Erro na linha " + std::to_string(line) + ": " + msg);
+    }
+
+    int reg(int id) const
+    {
+        if (alias_[id] >= 0)
+            id = alias_[id];
+        const IRInstr &in = fn_->instrs[id];
+        if (in.op == IROp::PARAM)
+            return (int)in.ival;
+        return nparams_ + id;
+    }
+
+    size_t emit(Opcode op, int a = 0, int b = 0, int c = 0, int line = 0)
+    {
+        BcInstr in;
+        in.op = op;
+        std::memset(in.pad, 0, sizeof(in.pad));
+        in.a = a;
+        in.b = b;
+        in.c = c;
+        prog_.code.push_back(in);
+        prog_.lines.push_back(line);
+        return prog_.code.size() - 1;
+    }
+
+    static bool isInt(IRType t)
+    {
+        return t == IRType::INT || t == IRType::CHAR || t == IRType::BOOL;
+    }
+
+    static bool isArrayOp(const IRInstr &in)
+    {
+        if (!irIsArray(in.type))
+            return false;
+        switch (in.op)
+        {
+        case IROp::ADD:
+        case IROp::SUB:
+        case IROp::MUL:
+        case IROp::DIV:
+        case IROp::MOD:
+        case IROp::NEG:
+        case IROp::LT:
+        case IROp::LE:
+        case IROp::GT:
+        case IROp::GE:
+        case IROp::EQ:
+        case IROp::NE:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool hasSideEffect(const IRInstr &in)
+    {
+        return in.op == IROp::ASTORE || in.op == IROp::STOREG || in.op == IROp::CALL;
+    }
+
+    // Marca operações de array cujo único uso é outra operação de array no
+    // mesmo bloco, sem efeitos colaterais entre elas: serão avaliadas dentro
+    // do kernel do consumidor
+    void computeFusion()
+    {
+        const IRFunction &fn = *fn_;
+        uses_.assign(fn.instrs.size(), 0);
+        fused_.assign(fn.instrs.size(), 0);
+        std::vector<int> user(fn.instrs.size(), -1);
+        for (auto &b : fn.blocks)
+        {
+            if (b.removed)
+                continue;
+            for (int id : b.instrs)
+                for (int a : fn.instrs[id].args)
+                {
+                    uses_[a]++;
+                    user[a] = id;
+                }
+        }
+        directStore_.assign(fn.instrs.size(), 0);
+        for (auto &b : fn.blocks)
+        {
+            if (b.removed)
+                continue;
+            for (size_t k = 0; k < b.instrs.size(); ++k)
+            {
+                // `g := <expressão de arrays>`: o kernel grava direto no
+                // global, sem array temporário nem cópia, quando nada entre
+                // o kernel e o STOREG observa a memória
+                const IRInstr &st = fn.instrs[b.instrs[k]];
+                if (st.op != IROp::STOREG)
+                    continue;
+                int src = st.args[0];
+                const IRInstr &kin = fn.instrs[src];
+                IRType globalType = prog_.globals[globalIndex_.at(st.sval)].type;
+                if (!isArrayOp(kin) || uses_[src] != 1 ||
+                    kernelIsReal(kin.type) != kernelIsReal(globalType))
+                    continue;
+                size_t j = k;
+                while (j > 0 && b.instrs[j - 1] != src)
+                {
+                    IROp op = fn.instrs[b.instrs[j - 1]].op;
+                    if (op != IROp::CONST && !isArrayOp(fn.instrs[b.instrs[j - 1]]))
+                        break;
+                    --j;
+                }
+                if (j > 0 && b.instrs[j - 1] == src)
+                    directStore_[src] = globalIndex_.at(st.sval) + 1;
+            }
+        }
+        if (!fuse_)
+            return;
+        for (auto &b : fn.blocks)
+        {
+            if (b.removed)
+                continue;
+            std::map<int, size_t> position;
+            for (size_t k = 0; k < b.instrs.size(); ++k)
+                position[b.instrs[k]] = k;
+            for (size_t k = 0; k < b.instrs.size(); ++k)
+            {
+                int id = b.instrs[k];
+                if (!isArrayOp(fn.instrs[id]) || uses_[id] != 1)
+                    continue;
+                int u = user[id];
+                auto pu = position.find(u);
+                if (pu == position.end() || !isArrayOp(fn.instrs[u]))
+                    continue;
+                bool clean = true;
+                for (size_t j = k + 1; j < pu->second && clean; ++j)
+                    clean = !hasSideEffect(fn.instrs[b.instrs[j]]);
+                fused_[id] = clean;
+            }
+        }
+    }
+
+    // ---------- kernels de arrays ----------
+    static bool kernelIsReal(IRType t)
+    {
+        return irElementType(t) == IRType::REAL;
+    }
+
+    void pushKernelOp(KOp op, int operand = 0)
+    {
+        KernelOp k;
+        k.op = op;
+        std::memset(k.pad, 0, sizeof(k.pad));
+        k.operand = operand;
+        prog_.kernelOps.push_back(k);
+    }
+
+    // Emite a subárvore de id; `wantReal` é o tipo de elemento esperado
+    void emitKernelTree(int id, int root, bool wantReal)
+    {
+        const IRInstr &in = fn_->instrs[id];
+        IRType elem = irElementType(in.type);
+        if (elem == IRType::STRING)
+            error(in.line, "Operacao elemento a elemento nao suportada para arrays de string");
+
+        bool real;
+        if (isArrayOp(in) && (id == root || fused_[id]))
+        {
+            bool compare = in.op == IROp::LT || in.op == IROp::LE || in.op == IROp::GT ||
+                           in.op == IROp::GE || in.op == IROp::EQ || in.op == IROp::NE;
+            bool opReal = false;
+            for (int a : in.args)
+                opReal |= kernelIsReal(fn_->instrs[a].type);
+            if (!compare)
+                opReal = kernelIsReal(in.type);
+            for (int a : in.args)
+                emitKernelTree(a, root, opReal);
+            pushKernelOp(kernelOpFor(in.op, opReal, in.line));
+            real = compare ? false : opReal;
+        }
+        else if (irIsArray(in.type))
+        {
+            real = kernelIsReal(in.type);
+            pushKernelOp(real ? KOp::LOAD_F : KOp::LOAD_I, reg(id));
+        }
+        else
+        {
+            real = in.type == IRType::REAL;
+            pushKernelOp(real ? KOp::SPLAT_F : KOp::SPLAT_I, reg(id));
+        }
+        if (real != wantReal)
+            pushKernelOp(wantReal ? KOp::I2F : KOp::F2I);
+    }
+
+    KOp kernelOpFor(IROp op, bool real, int line) const
+    {
+        switch (op)
+        {
+        case IROp::ADD:
+            return real ? KOp::ADD_F : KOp::ADD_I;
+        case IROp::SUB:
+            return real ? KOp::SUB_F : KOp::SUB_I;
+        case IROp::MUL:
+            return real ? KOp::MUL_F : KOp::MUL_I;
+        case IROp::DIV:
+            return real ? KOp::DIV_F : KOp::DIV_I;
+        case IROp::MOD:
+            if (real)
+                error(line, "Operador % nao se aplica a reais");
+            return KOp::MOD_I;
+        case IROp::NEG:
+            return real ? KOp::NEG_F : KOp::NEG_I;
+        case IROp::LT:
+            return real ? KOp::LT_F : KOp::LT_I;
+        case IROp::LE:
+            return real ? KOp::LE_F : KOp::LE_I;
+        case IROp::GT:
+            return real ? KOp::GT_F : KOp::GT_I;
+        case IROp::GE:
+            return real ? KOp::GE_F : KOp::GE_I;
+        case IROp::EQ:
+            return real ? KOp::EQ_F : KOp::EQ_I;
+        default:
+            return real ? KOp::NE_F : KOp::NE_I;
+        }
+    }
+
+    void emitKernel(int id)
+    {
+        const IRInstr &in = fn_->instrs[id];
+        BcKernel k;
+        k.opStart = (int32_t)prog_.kernelOps.size();
+        emitKernelTree(id, id, kernelIsReal(in.type));
+        k.opCount = (int32_t)prog_.kernelOps.size() - k.opStart;
+        k.resultType = in.type;
+        prog_.kernels.push_back(k);
+        emit(Opcode::AKERNEL, reg(id), (int)prog_.kernels.size() - 1, directStore_[id], in.line);
+    }
+
+    // ---------- operações escalares ----------
+    void emitScalar(int id)
+    {
+        const IRInstr &in = fn_->instrs[id];
+        IRType t = fn_->instrs[in.args[0]].type;
+        int a = reg(in.args[0]);
+        int b = in.args.size() > 1 ? reg(in.args[1]) : 0;
+        bool str = t == IRType::STRING;
+        bool real = t == IRType::REAL;
+        Opcode op;
+        switch (in.op)
+        {
+        case IROp::ADD:
+            op = str ? Opcode::CAT : real ? Opcode::ADDF : Opcode::ADDI;
+            break;
+        case IROp::SUB:
+            op = real ? Opcode::SUBF : Opcode::SUBI;
+            break;
+        case IROp::MUL:
+            op = real ? Opcode::MULF : Opcode::MULI;
+            break;
+        case IROp::DIV:
+            op = real ? Opcode::DIVF : Opcode::DIVI;
+            break;
+        case IROp::MOD:
+            if (real)
+                error(in.line, "Operador % nao se aplica a reais");
+            op = Opcode::MODI;
+            break;
+        case IROp::NEG:
+            op = real ? Opcode::NEGF : Opcode::NEGI;
+            break;
+        case IROp::NOT:
+            op = Opcode::NOT;
+            break;
+        case IROp::LT:
+            op = str ? Opcode::LTS : real ? Opcode::LTF : Opcode::LTI;
+            break;
+        case IROp::LE:
+            op = str ? Opcode::LES : real ? Opcode::LEF : Opcode::LEI;
+            break;
+        case IROp::GT:
+            op = str ? Opcode::GTS : real ? Opcode::GTF : Opcode::GTI;
+            break;
+        case IROp::GE:
+            op = str ? Opcode::GES : real ? Opcode::GEF : Opcode::GEI;
+            break;
+        case IROp::EQ:
+            op = str ? Opcode::EQS : real ? Opcode::EQF : Opcode::EQI;
+            break;
+        default:
+            op = str ? Opcode::NES : real ? Opcode::NEF : Opcode::NEI;
+            break;
+        }
+        if (str && (in.op == IROp::SUB || in.op == IROp::MUL || in.op == IROp::DIV ||
+                    in.op == IROp::MOD || in.op == IROp::NEG))
+            error(in.line, "Operacao aritmetica invalida para strings");
+        emit(op, reg(id), a, b, in.line);
+    }
+
+    void emitConversion(int id)
+    {
+        const IRInstr &in = fn_->instrs[id];
+        IRType from = fn_->instrs[in.args[0]].type;
+        IRType to = in.type;
+        int src = reg(in.args[0]);
+        Opcode op = Opcode::MOV;
+        if (to == IRType::STRING)
+        {
+            op = from == IRType::REAL ? Opcode::F2S : from == IRType::CHAR ? Opcode::C2S
+                                                  : from == IRType::BOOL   ? Opcode::B2S
+                                                                           : Opcode::I2S;
+        }
+        else if (from == IRType::STRING)
+        {
+            error(in.line, "Conversao de string para " + irTypeToCode(to) + " nao suportada");
+        }
+        else if (to == IRType::REAL && from != IRType::REAL)
+        {
+            op = Opcode::I2F;
+        }
+        else if (to != IRType::REAL && from == IRType::REAL)
+        {
+            op = Opcode::F2I;
+        }
+        emit(op, reg(id), src, 0, in.line);
+    }
+
+    // Cópias dos PHIs do bloco `succ` para a aresta pred -> succ
+    void emitEdgeCopies(int pred, int succ)
+    {
+        const IRBlock &blk = fn_->blocks[succ];
+        size_t k = 0;
+        while (k < blk.preds.size() && blk.preds[k] != pred)
+            ++k;
+        std::vector<std::pair<int, int>> copies;
+        for (int id : blk.instrs)
+        {
+            const IRInstr &in = fn_->instrs[id];
+            if (in.op != IROp::PHI)
+                continue;
+            if (k >= in.args.size())
+                continue;
+            int dst = reg(id), src = reg(in.args[k]);
+            if (dst != src)
+                copies.push_back({dst, src});
+        }
+        // Cópia paralela em sequência: sai primeiro a cópia cujo destino
+        // nenhuma outra pendente ainda lê; um ciclo (troca de valores) é
+        // quebrado salvando uma origem no registrador temporário
+        while (!copies.empty())
+        {
+            size_t ready = copies.size();
+            for (size_t j = 0; j < copies.size() && ready == copies.size(); ++j)
+            {
+                bool read = false;
+                for (auto &c : copies)
+                    read |= c.second == copies[j].first;
+                if (!read)
+                    ready = j;
+            }
+            if (ready == copies.size())
+            {
+                emit(Opcode::MOV, nregs_, copies[0].second);
+                copies[0].second = nregs_;
+                extraRegs_ = std::max(extraRegs_, 1);
+                continue;
+            }
+            emit(Opcode::MOV, copies[ready].first, copies[ready].second);
+            copies.erase(copies.begin() + ready);
+        }
+    }
+
+    // O valor v que um PHI p recebe de um predecessor L terminado em BR
+    // (tipicamente `i := i + 1` no fim do corpo de um WHILE) é calculado
+    // direto no registrador de p, e a cópia na aresta some. Vale quando v é
+    // definido em L e só usado ali e pelos PHIs dessa aresta, e p não é mais
+    // lido em L depois de v nem copiado para outro PHI na mesma aresta.
+    void coalescePhis()
+    {
+        const IRFunction &fn = *fn_;
+        alias_.assign(fn.instrs.size(), -1);
+        if (!coalesce_)
+            return;
+        std::vector<std::vector<int>> users(fn.instrs.size());
+        std::vector<int> position(fn.instrs.size(), -1);
+        for (auto &b : fn.blocks)
+        {
+            if (b.removed)
+                continue;
+            for (size_t k = 0; k < b.instrs.size(); ++k)
+            {
+                position[b.instrs[k]] = (int)k;
+                for (int a : fn.instrs[b.instrs[k]].args)
+                    users[a].push_back(b.instrs[k]);
+            }
+        }
+
+        for (size_t h = 0; h < fn.blocks.size(); ++h)
+        {
+            const IRBlock &blk = fn.blocks[h];
+            if (blk.removed)
+                continue;
+            for (int p : blk.instrs)
+            {
+                const IRInstr &phi = fn.instrs[p];
+                if (phi.op != IROp::PHI || irIsArray(phi.type))
+                    continue;
+                for (size_t k = 0; k < blk.preds.size() && k < phi.args.size(); ++k)
+                {
+                    int L = blk.preds[k], v = phi.args[k];
+                    const IRInstr &def = fn.instrs[v];
+                    const IRInstr *t = fn_->terminator(L);
+                    if (!t || t->op != IROp::BR || def.block != L || alias_[v] >= 0 ||
+                        def.op == IROp::PHI || def.op == IROp::PARAM || irIsArray(def.type))
+                        continue;
+                    bool ok = true;
+                    for (int u : users[v])
+                    {
+                        const IRInstr &use = fn.instrs[u];
+                        if (use.op == IROp::PHI && use.block == (int)h)
+                            for (size_t j = 0; j < use.args.size(); ++j)
+                                ok &= use.args[j] != v || blk.preds[j] == L;
+                        else
+                            ok &= use.block == L && position[u] > position[v];
+                    }
+                    for (int u : users[p])
+                    {
+                        const IRInstr &use = fn.instrs[u];
+                        if (use.op == IROp::PHI && use.block == (int)h)
+                            ok &= use.args[k] != p;
+                        else
+                            ok &= use.block != L || position[u] <= position[v];
+                    }
+                    if (ok)
+                        alias_[v] = p;
+                }
+            }
+        }
+    }
+
+    bool hasPhis(int b) const
+    {
+        for (int id : fn_->blocks[b].instrs)
+            if (fn_->instrs[id].op == IROp::PHI)
+                return true;
+        return false;
+    }
+
+    int extraRegs_ = 0;
+
+    void lowerFunction(const IRFunction &fn, BcFunction &out)
+    {
+        fn_ = &fn;
+        nparams_ = (int)fn.params.size();
+        nregs_ = nparams_ + (int)fn.instrs.size();
+        extraRegs_ = 0;
+        computeFusion();
+        coalescePhis();
+        blockStart_.assign(fn.blocks.size(), -1);
+        jumpPatches_.clear();
+        condPatches_.clear();
+        out.codeStart = (int32_t)prog_.code.size();
+
+        for (int b : fn.reversePostOrder())
+        {
+            blockStart_[b] = (int)prog_.code.size();
+            for (int id : fn.blocks[b].instrs)
+                lowerInstr(b, id);
+        }
+        for (auto &p : jumpPatches_)
+            prog_.code[p.first].a = blockStart_[p.second];
+        for (auto &p : condPatches_)
+            prog_.code[p.first].b = blockStart_[p.second];
+
+        out.codeEnd = (int32_t)prog_.code.size();
+        out.nregs = nregs_ + extraRegs_;
+        fn_ = nullptr;
+    }
+
+    void lowerInstr(int b, int id)
+    {
+        const IRInstr &in = fn_->instrs[id];
+        switch (in.op)
+        {
+        case IROp::PHI:
+        case IROp::PARAM:
+            return;
+        case IROp::CONST:
+        {
+            if (in.type == IRType::STRING)
+            {
+                auto found = stringIndex_.emplace(in.sval, (int)prog_.strings.size());
+                if (found.second)
+                    prog_.strings.push_back(in.sval);
+                emit(Opcode::LOADS, reg(id), found.first->second, 0, in.line);
+                return;
+            }
+            uint64_t bits;
+            if (in.type == IRType::REAL)
+                std::memcpy(&bits, &in.fval, sizeof(bits));
+            else
+                bits = (uint64_t)in.ival;
+            emit(Opcode::LOADK, reg(id), (int32_t)(uint32_t)bits, (int32_t)(uint32_t)(bits >> 32), in.line);
+            return;
+        }
+        case IROp::COPY:
+            emit(Opcode::MOV, reg(id), reg(in.args[0]), 0, in.line);
+            return;
+        case IROp::LOADG:
+            emit(Opcode::LOADG, reg(id), globalIndex_.at(in.sval), 0, in.line);
+            return;
+        case IROp::STOREG:
+            if (directStore_[in.args[0]])
+                return;
+            emit(irIsArray(fn_->instrs[in.args[0]].type) ? Opcode::STOREGA : Opcode::STOREG,
+                 reg(in.args[0]), globalIndex_.at(in.sval), 0, in.line);
+            return;
+        case IROp::CONV:
+            emitConversion(id);
+            return;
+        case IROp::ALOAD:
+            emit(in.boundsCheck ? Opcode::ALOAD : Opcode::ALOADNC, reg(id), reg(in.args[0]),
+                 reg(in.args[1]), in.line);
+            return;
+        case IROp::ASTORE:
+            emit(in.boundsCheck ? Opcode::ASTORE : Opcode::ASTORENC, reg(in.args[0]),
+                 reg(in.args[1]), reg(in.args[2]), in.line);
+            return;
+        case IROp::CALL:
+        {
+            int32_t at = (int32_t)prog_.callArgs.size();
+            prog_.callArgs.push_back((int32_t)in.args.size());
+            for (int a : in.args)
+                prog_.callArgs.push_back(reg(a));
+            emit(Opcode::CALL, reg(id), functionIndex_.at(in.sval), at, in.line);
+            return;
+        }
+        case IROp::PRINT:
+        {
+            IRType t = fn_->instrs[in.args[0]].type;
+            Opcode op = irIsArray(t) ? Opcode::PRINTA : t == IRType::REAL ? Opcode::PRINTF
+                                                    : t == IRType::STRING ? Opcode::PRINTS
+                                                    : t == IRType::CHAR   ? Opcode::PRINTC
+                                                    : t == IRType::BOOL   ? Opcode::PRINTB
+                                                                          : Opcode::PRINTI;
+            emit(op, reg(in.args[0]), 0, 0, in.line);
+            return;
+        }
+        case IROp::BR:
+            emitEdgeCopies(b, in.target1);
+            jumpPatches_.push_back({emit(Opcode::JMP, 0, 0, 0, in.line), in.target1});
+            return;
+        case IROp::CBR:
+        {
+            int cond = reg(in.args[0]);
+            if (!hasPhis(in.target1) && !hasPhis(in.target2))
+            {
+                condPatches_.push_back({emit(Opcode::JT, cond, 0, 0, in.line), in.target1});
+                jumpPatches_.push_back({emit(Opcode::JMP, 0, 0, 0, in.line), in.target2});
+                return;
+            }
+            size_t jf = emit(Opcode::JF, cond, 0, 0, in.line);
+            emitEdgeCopies(b, in.target1);
+            jumpPatches_.push_back({emit(Opcode::JMP, 0, 0, 0, in.line), in.target1});
+            prog_.code[jf].b = (int32_t)prog_.code.size();
+            emitEdgeCopies(b, in.target2);
+            jumpPatches_.push_back({emit(Opcode::JMP, 0, 0, 0, in.line), in.target2});
+            return;
+        }
+        case IROp::RET:
+            if (in.args.empty())
+                emit(Opcode::RETV, 0, 0, 0, in.line);
+            else
+                emit(Opcode::RET, reg(in.args[0]), 0, 0, in.line);
+            return;
+        default:
+            if (isArrayOp(in))
+            {
+                if (!fused_[id])
+                    emitKernel(id);
+                return;
+            }
+            emitScalar(id);
+            return;
+        }
+    }
+};
+
+// ===============================
+//  Objetos de tempo de execução
+// ===============================
+struct ArrayObj
+{
+    IRType elemType;
+    int64_t length;
+    Slot *items; // storage.data(), lido diretamente pelo código do JIT
+    std::vector<Slot> storage;
+
+    Slot *data() { return items; }
+};
+
+// Objetos alocados durante a execução; liberados ao final do programa
+class RuntimeHeap
+{
+public:
+    ArrayObj *newArray(IRType elemType, int64_t length)
+    {
+        std::unique_ptr<ArrayObj> arr(new ArrayObj());
+        arr->elemType = elemType;
+        arr->length = length;
+        Slot zero;
+        zero.i = 0;
+        if (elemType == IRType::STRING)
+            zero.s = StringHeap::empty();
+        arr->storage.assign((size_t)length, zero);
+        arr->items = arr->storage.data();
+        arrays_.push_back(std::move(arr));
+        return arrays_.back().get();
+    }
+
+    StringHeap &strings()
+    {
+        return strings_;
+    }
+
+    const StringHeap &strings() const
+    {
+        return strings_;
+    }
+
+private:
+    std::vector<std::unique_ptr<ArrayObj>> arrays_;
+    StringHeap strings_;
+};
+
+// ===============================
+//  Perfil de execução (--profile)
+// ===============================
+// O laço do interpretador é instanciado duas vezes: sem perfil ele é o
+// mesmo de antes, sem nenhum teste a mais. Com perfil:
+// - contagem: só os desvios (JMP/JT/JF) e as entradas de função incrementam
+//   um contador, o do pc de destino; a contagem de cada instrução sai depois
+//   somando as entradas ao longo do código sequencial
+// - tempo: um temporizador (SIGPROF) amostra a cada PROFILE_SAMPLE_US o
+//   início do trecho sem desvios em execução e o nó da pilha de chamadas,
+//   atualizados pelo laço junto com as entradas (gravar o pc a cada
+//   instrução custava mais de 20%). O tempo de parede da execução é dividido
+//   entre as amostras e, dentro de cada trecho, entre as instruções.
+const int PROFILE_SAMPLE_US = 1000;
+const size_t PROFILE_MAX_SAMPLES = 1 << 20;
+
+struct ExecutionProfile
+{
+    std::vector<uint64_t> counts; // instruções executadas, por pc
+    // Pilha amostrada (pcs das chamadas em aberto + pc atual) -> nanossegundos
+    std::map<std::vector<int32_t>, uint64_t> stacks;
+    uint64_t samples = 0;
+    uint64_t wallNs = 0;
+    bool timed = false; // temporizador disponível nesta plataforma
+};
+
+// Estado lido pelo tratador do sinal: o laço grava pc e nó da pilha, o
+// tratador só copia os dois para um buffer pré-alocado
+struct ProfileSampler
+{
+    struct Sample
+    {
+        int32_t node;
+        int32_t pc;
+    };
+
+    volatile int32_t pc = 0;
+    volatile int32_t node = 0;
+    std::unique_ptr<Sample[]> samples; // sem zerar: as páginas só são tocadas quando usadas
+    size_t capacity = 0;
+    volatile size_t count = 0;
+
+    static ProfileSampler *&active()
+    {
+        static ProfileSampler *sampler = nullptr;
+        return sampler;
+    }
+
+#ifdef CANGA_PROFILE_TIMER
+    static void onSignal(int)
+    {
+        ProfileSampler *s = active();
+        if (s && s->count < s->capacity)
+        {
+            s->samples[s->count] = {s->node, s->pc};
+            s->count = s->count + 1;
+        }
+    }
+
+    // Temporizador POSIX de alta resolução sobre o relógio monotônico
+    // (setitimer fica preso à granularidade do tick do kernel)
+    bool start()
+    {
+        samples.reset(new Sample[PROFILE_MAX_SAMPLES]);
+        capacity = PROFILE_MAX_SAMPLES;
+        count = 0;
+        active() = this;
+        struct sigaction sa;
+        std::memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = &ProfileSampler::onSignal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGPROF, &sa, nullptr);
+
+        struct sigevent ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.sigev_notify = SIGEV_SIGNAL;
+        ev.sigev_signo = SIGPROF;
+        if (timer_create(CLOCK_MONOTONIC, &ev, &timer_) != 0)
+            return false;
+        struct itimerspec spec;
+        spec.it_interval.tv_sec = 0;
+        spec.it_interval.tv_nsec = PROFILE_SAMPLE_US * 1000L;
+        spec.it_value = spec.it_interval;
+        armed_ = timer_settime(timer_, 0, &spec, nullptr) == 0;
+        return armed_;
+    }
+
+    void stop()
+    {
+        if (armed_)
+            timer_delete(timer_);
+        armed_ = false;
+        signal(SIGPROF, SIG_DFL);
+        active() = nullptr;
+    }
+
+private:
+    timer_t timer_;
+    bool armed_ = false;
+#else
+    bool start()
+    {
+        return false;
+    }
+
+    void stop() {}
+#endif
+};
+
+#include "jit.cpp"
+
+// ===============================
+//  Interpretador
+// ===============================
+class Interpreter
+{
+public:
+    explicit Interpreter(const BcProgram &program, std::ostream &out = std::cout)
+        : prog_(program), out_(out)
+    {
+        literals_.reserve(prog_.strings.size());
+        for (auto &s : prog_.strings)
+            literals_.push_back(heap_.strings().literal(s));
+    }
+
+    KernelEvaluator &kernels()
+    {
+        return kernels_;
+    }
+
+    // Passa a coletar o perfil em `profile` nas próximas execuções (nulo desativa)
+    void setProfile(ExecutionProfile *profile)
+    {
+        profile_ = profile;
+    }
+
+    // Traduz as funções quentes para código nativo (jit.cpp) quando a
+    // plataforma permite; ignorado com perfil, que conta cada instrução
+    void setJit(bool enabled)
+    {
+        if (!enabled || !BaselineJit::available())
+            jit_.reset();
+        else if (!jit_)
+            jit_.reset(new BaselineJit(prog_, &Interpreter::jitCall, &Interpreter::jitPrint));
+    }
+
+    const BaselineJit *jit() const
+    {
+        return jit_.get();
+    }
+
+    // Bytes alocados para strings desde a criação (arena do StringHeap)
+    size_t stringBytes() const
+    {
+        return heap_.strings().allocated();
+    }
+
+    void run()
+    {
+        globals_.assign(prog_.globals.size(), Slot());
+        for (size_t g = 0; g < prog_.globals.size(); ++g)
+        {
+            const BcGlobal &glob = prog_.globals[g];
+            if (irIsArray(glob.type))
+                globals_[g].p = heap_.newArray(irElementType(glob.type), glob.extent);
+            else if (glob.type == IRType::STRING)
+                globals_[g].s = StringHeap::empty();
+            else
+                globals_[g].i = 0;
+        }
+        if (prog_.mainFunction < 0)
+            return;
+        stack_.assign(prog_.functions[prog_.mainFunction].nregs, Slot());
+        depth_ = 0;
+        if (!profile_)
+        {
+            try
+            {
+                execute<false>(prog_.mainFunction, 0);
+            }
+            catch (...)
+            {
+                print_.flush();
+                throw;
+            }
+            print_.flush();
+            out_.flush();
+            return;
+        }
+
+        entries_.assign(prog_.code.size() + 1, 0);
+        nodes_.assign(1, CallNode{-1, -1, -1, -1});
+        sampler_.node = 0;
+        sampler_.pc = prog_.functions[prog_.mainFunction].codeStart;
+        profile_->timed = sampler_.start();
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            execute<true>(prog_.mainFunction, 0);
+        }
+        catch (...)
+        {
+            print_.flush();
+            finishProfile(start);
+            throw;
+        }
+        print_.flush();
+        finishProfile(start);
+        out_.flush();
+    }
+
+private:
+    const BcProgram &prog_;
+    std::ostream &out_;
+    PrintBuffer print_{out_};
+    RuntimeHeap heap_;
+    std::vector<uint64_t> literals_; // prog_.strings como valores string
+    KernelEvaluator kernels_;
+    std::vector<Slot> globals_;
+    std::vector<Slot> stack_;
+    std::vector<KernelOperand> operands_;
+    int depth_ = 0;
+    std::unique_ptr<BaselineJit> jit_;
+    std::exception_ptr jitError_; // exceção de uma chamada feita pelo código nativo
+
+    // Perfil: entradas por pc e árvore das pilhas de chamadas, em que cada nó
+    // é um CALL (pc) aberto dentro do nó pai
+    struct CallNode
+    {
+        int32_t parent;
+        int32_t callPc;
+        int32_t firstChild;
+        int32_t nextSibling;
+    };
+
+    ExecutionProfile *profile_ = nullptr;
+    std::vector<uint64_t> entries_;
+    std::vector<CallNode> nodes_;
+    ProfileSampler sampler_;
+
+    // Filho de `node` para a chamada em `callPc`, criado na primeira vez
+    int32_t enterCall(int32_t node, int32_t callPc)
+    {
+        for (int32_t c = nodes_[node].firstChild; c >= 0; c = nodes_[c].nextSibling)
+            if (nodes_[c].callPc == callPc)
+                return c;
+        nodes_.push_back(CallNode{node, callPc, -1, nodes_[node].firstChild});
+        nodes_[node].firstChild = (int32_t)nodes_.size() - 1;
+        return nodes_[node].firstChild;
+    }
+
+    // Contagem por instrução a partir das entradas e pilhas das amostras
+    void finishProfile(std::chrono::steady_clock::time_point start)
+    {
+        sampler_.stop();
+        profile_->wallNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+        profile_->counts.assign(prog_.code.size(), 0);
+        uint64_t flowing = 0;
+        for (size_t pc = 0; pc < prog_.code.size(); ++pc)
+        {
+            flowing += entries_[pc];
+            profile_->counts[pc] = flowing;
+            Opcode op = prog_.code[pc].op;
+            if (op == Opcode::JMP || op == Opcode::JT || op == Opcode::JF || op == Opcode::RET || op == Opcode::RETV)
+                flowing = 0;
+        }
+
+        std::vector<int32_t> functionOf(prog_.code.size(), -1);
+        for (size_t f = 0; f < prog_.functions.size(); ++f)
+            for (int32_t pc = prog_.functions[f].codeStart; pc < prog_.functions[f].codeEnd; ++pc)
+                functionOf[pc] = (int32_t)f;
+
+        // Nas trocas de função pc e nó não mudam juntos: logo após o CALL o
+        // pc ainda é o do chamador (a amostra fica com o nó pai) e logo após
+        // o retorno, o da função chamada (a amostra é descartada)
+        auto functionOfNode = [&](int32_t node)
+        {
+            return node > 0 ? prog_.code[nodes_[node].callPc].b : prog_.mainFunction;
+        };
+        auto endsRun = [&](int32_t pc)
+        {
+            Opcode op = prog_.code[pc].op;
+            return op == Opcode::JMP || op == Opcode::JT || op == Opcode::JF || op == Opcode::RET ||
+                   op == Opcode::RETV || op == Opcode::CALL;
+        };
+        std::vector<std::vector<int32_t>> keys;
+        for (size_t k = 0; k < sampler_.count; ++k)
+        {
+            int32_t pc = sampler_.samples[k].pc;
+            int32_t node = sampler_.samples[k].node;
+            if (functionOf[pc] != functionOfNode(node))
+            {
+                if (node == 0 || functionOf[pc] != functionOfNode(nodes_[node].parent))
+                    continue;
+                node = nodes_[node].parent;
+            }
+            std::vector<int32_t> key(1, pc);
+            for (; node > 0; node = nodes_[node].parent)
+                key.push_back(nodes_[node].callPc);
+            std::reverse(key.begin(), key.end());
+            keys.push_back(std::move(key));
+        }
+        profile_->samples = keys.size();
+        profile_->stacks.clear();
+        for (auto &key : keys)
+        {
+            int32_t first = key.back(), last = first;
+            while (last + 1 < (int32_t)prog_.code.size() && !endsRun(last))
+                ++last;
+            uint64_t share = profile_->wallNs / keys.size() / (uint64_t)(last - first + 1);
+            for (int32_t pc = first; pc <= last; ++pc)
+            {
+                key.back() = pc;
+                profile_->stacks[key] += share;
+            }
+        }
+        sampler_.samples.reset();
+        sampler_.capacity = 0;
+    }
+
+    [[noreturn]] void runtimeError(int32_t pc, const std::string &msg) const
+    {
+        throw std::runtime_error("Erro em tempo de execucao na linha " +
+                                 std::to_string(prog_.lines[pc]) + ": " + msg);
+    }
+
+    // O compilador só indexa arrays; o teste de nulo cobre bytecode ou
+    // interfaces que chegaram com uma variável escalar no lugar
+    void checkIndex(int32_t pc, const ArrayObj *arr, int64_t idx) const
+    {
+        if (!arr)
+            runtimeError(pc, "Variavel indexada nao e um array");
+        if (idx < 0 || idx >= arr->length)
+            runtimeError(pc, "Indice " + std::to_string(idx) + " fora dos limites do array (tamanho " +
+                                 std::to_string(arr->length) + ")");
+    }
+
+    std::string_view str(const Slot &s)
+    {
+        return heap_.strings().view(s.s);
+    }
+
+    int compare(const Slot &a, const Slot &b)
+    {
+        return str(a).compare(str(b));
+    }
+
+    static const char *boolText(int64_t v)
+    {
+        return v ? "TRUE" : "FALSE";
+    }
+
+    void printArray(const ArrayObj *arr)
+    {
+        print_.put('[');
+        for (int64_t k = 0; k < arr->length; ++k)
+        {
+            if (k)
+                print_.text(", ");
+            const Slot &e = arr->storage[k];
+            switch (arr->elemType)
+            {
+            case IRType::REAL:
+                print_.real(e.f);
+                break;
+            case IRType::STRING:
+                print_.text(str(e));
+                break;
+            case IRType::CHAR:
+                print_.put((char)e.i);
+                break;
+            case IRType::BOOL:
+                print_.text(boolText(e.i));
+                break;
+            default:
+                print_.integer(e.i);
+            }
+        }
+        print_.text("]\n");
+    }
+
+    void copyArray(ArrayObj *dst, const ArrayObj *src)
+    {
+        int64_t n = std::min(dst->length, src->length);
+        bool toReal = dst->elemType == IRType::REAL, fromReal = src->elemType == IRType::REAL;
+        for (int64_t k = 0; k < n; ++k)
+        {
+            Slot v = src->storage[k];
+            if (toReal && !fromReal)
+                v.f = (double)src->storage[k].i;
+            else if (!toReal && fromReal)
+                v.i = (int64_t)src->storage[k].f;
+            dst->storage[k] = v;
+        }
+    }
+
+    ArrayObj *runKernel(int32_t pc, const BcKernel &k, Slot *R, int32_t directGlobal)
+    {
+        const KernelOp *ops = &prog_.kernelOps[k.opStart];
+        operands_.resize(k.opCount);
+        int64_t length = -1;
+        for (int32_t j = 0; j < k.opCount; ++j)
+        {
+            KernelOperand &o = operands_[j];
+            o.data = nullptr;
+            o.length = 0;
+            switch (ops[j].op)
+            {
+            case KOp::LOAD_I:
+            case KOp::LOAD_F:
+            {
+                ArrayObj *arr = (ArrayObj *)R[ops[j].operand].p;
+                o.data = arr->data();
+                o.length = arr->length;
+                // Operandos de tamanhos diferentes: usa o menor comprimento
+                length = length < 0 ? arr->length : std::min(length, arr->length);
+                break;
+            }
+            case KOp::SPLAT_I:
+                o.i = R[ops[j].operand].i;
+                break;
+            case KOp::SPLAT_F:
+                o.f = R[ops[j].operand].f;
+                break;
+            default:
+                break;
+            }
+        }
+        if (length < 0)
+            runtimeError(pc, "Kernel de array sem operando array");
+        ArrayObj *res;
+        if (directGlobal > 0)
+        {
+            res = (ArrayObj *)globals_[directGlobal - 1].p;
+            length = std::min(length, res->length);
+        }
+        else
+        {
+            res = heap_.newArray(irElementType(k.resultType), length);
+        }
+        kernels_.eval(ops, (size_t)k.opCount, operands_.data(), res->data(), (size_t)length);
+        return res;
+    }
+
+    // Prepara a chamada do CALL `in` (em `pc`) feita por uma função cujos
+    // registradores começam em `base`; devolve a base da função chamada
+    size_t pushFrame(const BcInstr &in, int32_t pc, size_t base, int32_t callerRegs)
+    {
+        const BcFunction &callee = prog_.functions[in.b];
+        const int32_t *args = &prog_.callArgs[in.c];
+        size_t calleeBase = base + callerRegs;
+        if (++depth_ > 10000)
+            runtimeError(pc, "Estouro da pilha de chamadas");
+        if (stack_.size() < calleeBase + callee.nregs)
+            stack_.resize(calleeBase + callee.nregs);
+        Slot *R = &stack_[base];
+        for (int32_t k = 0; k < args[0]; ++k)
+            stack_[calleeBase + k] = R[args[1 + k]];
+        return calleeBase;
+    }
+
+    // CALL feito pelo código nativo; exceções não podem atravessá-lo e são
+    // guardadas para o interpretador relançar
+    static int32_t jitCall(JitFrame *frame, int32_t pc)
+    {
+        Interpreter *self = (Interpreter *)frame->context;
+        const BcInstr &in = self->prog_.code[pc];
+        try
+        {
+            size_t calleeBase = self->pushFrame(in, pc, frame->base, self->prog_.functions[frame->fidx].nregs);
+            Slot result;
+            if (self->jit_->tick(in.b))
+            {
+                // Função chamada já nativa: sem passar pelo laço do interpretador
+                JitFrame callee{&self->stack_[calleeBase], frame->globals, self, calleeBase, in.b, Slot()};
+                int32_t next = self->jit_->run(callee, self->prog_.functions[in.b].codeStart);
+                if (next == JIT_EXCEPTION)
+                    return JIT_EXCEPTION;
+                result = next == JIT_RETURNED ? callee.result : self->execute<false>(in.b, calleeBase, next);
+            }
+            else
+                result = self->execute<false>(in.b, calleeBase);
+            --self->depth_;
+            frame->R = &self->stack_[frame->base];
+            frame->R[in.a] = result;
+            return 0;
+        }
+        catch (...)
+        {
+            self->jitError_ = std::current_exception();
+            return JIT_EXCEPTION;
+        }
+    }
+
+    // PRINT de um escalar feito pelo código nativo
+    static int32_t jitPrint(JitFrame *frame, int32_t pc)
+    {
+        Interpreter *self = (Interpreter *)frame->context;
+        const BcInstr &in = self->prog_.code[pc];
+        const Slot &v = frame->R[in.a];
+        switch (in.op)
+        {
+        case Opcode::PRINTI:
+            self->print_.integer(v.i);
+            break;
+        case Opcode::PRINTF:
+            self->print_.real(v.f);
+            break;
+        case Opcode::PRINTC:
+            self->print_.put((char)v.i);
+            break;
+        default:
+            self->print_.text(boolText(v.i));
+        }
+        self->print_.put('\n');
+        return 0;
+    }
+
+    // Executa o código nativo de `fidx` a partir de `pc`. Devolve true se a
+    // função retornou (valor em `result`); senão `pc` passa a ser a
+    // instrução em que o interpretador continua
+    bool runNative(int32_t fidx, int32_t &pc, size_t base, Slot *&R, Slot &result)
+    {
+        JitFrame frame{&stack_[base], globals_.data(), this, base, fidx, Slot()};
+        int32_t next = jit_->run(frame, pc);
+        R = &stack_[base];
+        if (next == JIT_EXCEPTION)
+        {
+            std::exception_ptr error = jitError_;
+            jitError_ = nullptr;
+            std::rethrow_exception(error);
+        }
+        if (next == JIT_RETURNED)
+        {
+            result = frame.result;
+            return true;
+        }
+        pc = next;
+        return false;
+    }
+
+    // `resumePc`: continua a função a partir desta instrução, com os
+    // registradores já preenchidos (saída do código nativo)
+    template <bool Profile>
+    Slot execute(int32_t fidx, size_t base, int32_t resumePc = -1)
+    {
+        const BcFunction &fn = prog_.functions[fidx];
+        const BcInstr *code = prog_.code.data();
+        int32_t pc = resumePc < 0 ? fn.codeStart : resumePc;
+        Slot *R = &stack_[base];
+        Slot none;
+        none.i = 0;
+        Slot result; // devolvido pelo código nativo
+
+        // Com perfil: ponteiros em variáveis locais, para não recarregar os
+        // membros a cada instrução
+        uint64_t *entries = Profile ? entries_.data() : nullptr;
+        volatile int32_t *sampledPc = &sampler_.pc;
+        if constexpr (Profile)
+        {
+            ++entries[pc];
+            *sampledPc = pc;
+        }
+        else if (resumePc < 0 && jit_ && jit_->tick(fidx) && runNative(fidx, pc, base, R, result))
+            return result;
+
+        while (true)
+        {
+            const BcInstr &in = code[pc++];
+            switch (in.op)
+            {
+            case Opcode::LOADK:
+                R[in.a].i = (int64_t)((uint64_t)(uint32_t)in.b | ((uint64_t)(uint32_t)in.c << 32));
+                break;
+            case Opcode::LOADS:
+                R[in.a].s = literals_[in.b];
+                break;
+            case Opcode::MOV:
+                R[in.a] = R[in.b];
+                break;
+            case Opcode::ADDI:
+                R[in.a].i = (int64_t)((uint64_t)R[in.b].i + (uint64_t)R[in.c].i);
+                break;
+            case Opcode::SUBI:
+                R[in.a].i = (int64_t)((uint64_t)R[in.b].i - (uint64_t)R[in.c].i);
+                break;
+            case Opcode::MULI:
+                R[in.a].i = (int64_t)((uint64_t)R[in.b].i * (uint64_t)R[in.c].i);
+                break;
+            case Opcode::DIVI:
+                if (R[in.c].i == 0)
+                    runtimeError(pc - 1, "Divisao por zero");
+                R[in.a].i = R[in.c].i == -1 ? (int64_t)(0 - (uint64_t)R[in.b].i) : R[in.b].i / R[in.c].i;
+                break;
+            case Opcode::MODI:
+                if (R[in.c].i == 0)
+                    runtimeError(pc - 1, "Divisao por zero");
+                R[in.a].i = R[in.c].i == -1 ? 0 : R[in.b].i % R[in.c].i;
+                break;
+            case Opcode::NEGI:
+                R[in.a].i = (int64_t)(0 - (uint64_t)R[in.b].i);
+                break;
+            case Opcode::ADDF:
+                R[in.a].f = R[in.b].f + R[in.c].f;
+                break;
+            case Opcode::SUBF:
+                R[in.a].f = R[in.b].f - R[in.c].f;
+                break;
+            case Opcode::MULF:
+                R[in.a].f = R[in.b].f * R[in.c].f;
+                break;
+            case Opcode::DIVF:
+                R[in.a].f = R[in.b].f / R[in.c].f;
+                break;
+            case Opcode::NEGF:
+                R[in.a].f = -R[in.b].f;
+                break;
+            case Opcode::CAT:
+                R[in.a].s = heap_.strings().concat(R[in.b].s, R[in.c].s);
+                break;
+            case Opcode::LTI:
+                R[in.a].i = R[in.b].i < R[in.c].i;
+                break;
+            case Opcode::LEI:
+                R[in.a].i = R[in.b].i <= R[in.c].i;
+                break;
+            case Opcode::GTI:
+                R[in.a].i = R[in.b].i > R[in.c].i;
+                break;
+            case Opcode::GEI:
+                R[in.a].i = R[in.b].i >= R[in.c].i;
+                break;
+            case Opcode::EQI:
+                R[in.a].i = R[in.b].i == R[in.c].i;
+                break;
+            case Opcode::NEI:
+                R[in.a].i = R[in.b].i != R[in.c].i;
+                break;
+            case Opcode::LTF:
+                R[in.a].i = R[in.b].f < R[in.c].f;
+                break;
+            case Opcode::LEF:
+                R[in.a].i = R[in.b].f <= R[in.c].f;
+                break;
+            case Opcode::GTF:
+                R[in.a].i = R[in.b].f > R[in.c].f;
+                break;
+            case Opcode::GEF:
+                R[in.a].i = R[in.b].f >= R[in.c].f;
+                break;
+            case Opcode::EQF:
+                R[in.a].i = R[in.b].f == R[in.c].f;
+                break;
+            case Opcode::NEF:
+                R[in.a].i = R[in.b].f != R[in.c].f;
+                break;
+            case Opcode::LTS:
+                R[in.a].i = compare(R[in.b], R[in.c]) < 0;
+                break;
+            case Opcode::LES:
+                R[in.a].i = compare(R[in.b], R[in.c]) <= 0;
+                break;
+            case Opcode::GTS:
+                R[in.a].i = compare(R[in.b], R[in.c]) > 0;
+                break;
+            case Opcode::GES:
+                R[in.a].i = compare(R[in.b], R[in.c]) >= 0;
+                break;
+            case Opcode::EQS:
+                R[in.a].i = compare(R[in.b], R[in.c]) == 0;
+                break;
+            case Opcode::NES:
+                R[in.a].i = compare(R[in.b], R[in.c]) != 0;
+                break;
+            case Opcode::NOT:
+                R[in.a].i = R[in.b].i == 0;
+                break;
+            case Opcode::I2F:
+                R[in.a].f = (double)R[in.b].i;
+                break;
+            case Opcode::F2I:
+                R[in.a].i = (int64_t)R[in.b].f;
+                break;
+            case Opcode::I2S:
+            {
+                char digits[24];
+                char *end = std::to_chars(digits, digits + sizeof(digits), R[in.b].i).ptr;
+                R[in.a].s = heap_.strings().make(std::string_view(digits, end - digits));
+                break;
+            }
+            case Opcode::F2S:
+            {
+                char digits[32];
+                R[in.a].s = heap_.strings().make(
+                    std::string_view(digits, PrintBuffer::formatReal(digits, sizeof(digits), R[in.b].f)));
+                break;
+            }
+            case Opcode::C2S:
+            {
+                char c = (char)R[in.b].i;
+                R[in.a].s = heap_.strings().make(std::string_view(&c, 1));
+                break;
+            }
+            case Opcode::B2S:
+                R[in.a].s = heap_.strings().make(boolText(R[in.b].i));
+                break;
+            case Opcode::LOADG:
+                R[in.a] = globals_[in.b];
+                break;
+            case Opcode::STOREG:
+                globals_[in.b] = R[in.a];
+                break;
+            case Opcode::STOREGA:
+                copyArray((ArrayObj *)globals_[in.b].p, (const ArrayObj *)R[in.a].p);
+                break;
+            case Opcode::ALOAD:
+            {
+                ArrayObj *arr = (ArrayObj *)R[in.b].p;
+                checkIndex(pc - 1, arr, R[in.c].i);
+                R[in.a] = arr->storage[R[in.c].i];
+                break;
+            }
+            case Opcode::ALOADNC:
+                R[in.a] = ((ArrayObj *)R[in.b].p)->storage[R[in.c].i];
+                break;
+            case Opcode::ASTORE:
+            {
+                ArrayObj *arr = (ArrayObj *)R[in.a].p;
+                checkIndex(pc - 1, arr, R[in.b].i);
+                arr->storage[R[in.b].i] = R[in.c];
+                break;
+            }
+            case Opcode::ASTORENC:
+                ((ArrayObj *)R[in.a].p)->storage[R[in.b].i] = R[in.c];
+                break;
+            case Opcode::AKERNEL:
+                R[in.a].p = runKernel(pc - 1, prog_.kernels[in.b], R, in.c);
+                break;
+            case Opcode::CALL:
+            {
+                size_t calleeBase = pushFrame(in, pc - 1, base, fn.nregs);
+                int32_t callerNode = 0;
+                if constexpr (Profile)
+                {
+                    callerNode = sampler_.node;
+                    sampler_.node = enterCall(callerNode, pc - 1);
+                }
+                Slot result = execute<Profile>(in.b, calleeBase);
+                if constexpr (Profile)
+                {
+                    sampler_.node = callerNode;
+                    *sampledPc = pc;
+                }
+                --depth_;
+                R = &stack_[base];
+                R[in.a] = result;
+                break;
+            }
+            case Opcode::RET:
+                return R[in.a];
+            case Opcode::RETV:
+                return none;
+            case Opcode::PRINTI:
+                print_.integer(R[in.a].i);
+                print_.put('\n');
+                break;
+            case Opcode::PRINTF:
+                print_.real(R[in.a].f);
+                print_.put('\n');
+                break;
+            case Opcode::PRINTS:
+                print_.text(str(R[in.a]));
+                print_.put('\n');
+                break;
+            case Opcode::PRINTC:
+                print_.put((char)R[in.a].i);
+                print_.put('\n');
+                break;
+            case Opcode::PRINTB:
+                print_.text(boolText(R[in.a].i));
+                print_.put('\n');
+                break;
+            case Opcode::PRINTA:
+                printArray((const ArrayObj *)R[in.a].p);
+                break;
+            // Sem perfil, os desvios para trás (voltas de laço) contam para o
+            // JIT e entram no código nativo quando ele existe
+            case Opcode::JMP:
+            {
+                bool backward = in.a < pc;
+                pc = in.a;
+                if constexpr (Profile)
+                {
+                    ++entries[pc];
+                    *sampledPc = pc;
+                }
+                else if (backward && jit_ && jit_->tick(fidx) && runNative(fidx, pc, base, R, result))
+                    return result;
+                break;
+            }
+            case Opcode::JT:
+                if (R[in.a].i)
+                {
+                    bool backward = in.b < pc;
+                    pc = in.b;
+                    if constexpr (!Profile)
+                        if (backward && jit_ && jit_->tick(fidx) && runNative(fidx, pc, base, R, result))
+                            return result;
+                }
+                if constexpr (Profile)
+                {
+                    ++entries[pc];
+                    *sampledPc = pc;
+                }
+                break;
+            case Opcode::JF:
+                if (!R[in.a].i)
+                {
+                    bool backward = in.b < pc;
+                    pc = in.b;
+                    if constexpr (!Profile)
+                        if (backward && jit_ && jit_->tick(fidx) && runNative(fidx, pc, base, R, result))
+                            return result;
+                }
+                if constexpr (Profile)
+                {
+                    ++entries[pc];
+                    *sampledPc = pc;
+                }
+                break;
+            }
+        }
+    }
+};
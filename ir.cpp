@@ -0,0 +1,3452 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <cstdio>
+#include <climits>
+#include <charconv>
+#include <algorithm>
+#include "symbolTable.cpp"
+#include "trace.cpp"
+
+// ===============================
+//  Representação intermediária (IR) em forma SSA
+// ===============================
+// Cada função (FUNCTYPE) e o bloco principal viram um IRFunction composto
+// por blocos básicos. Os valores são identificados pelo índice da instrução
+// que os define (%n), e cada variável escalar é renomeada a cada atribuição,
+// com PHIs nos pontos de junção (construção de Braun et al.).
+
+enum class IRType
+{
+    INT,
+    REAL,
+    STRING,
+    CHAR,
+    BOOL,
+    VOID,
+    ARR_INT,
+    ARR_REAL,
+    ARR_STRING,
+    ARR_CHAR,
+    ARR_BOOL
+};
+
+enum class IROp
+{
+    CONST,  // constante (ival/fval/sval)
+    PARAM,  // parâmetro da função (ival = posição)
+    LOADG,  // leitura de variável global (sval = nome)
+    STOREG, // escrita de variável global (sval = nome)
+    PHI,    // args alinhados com os predecessores do bloco
+    COPY,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    NEG,
+    NOT,
+    LT,
+    LE,
+    GT,
+    GE,
+    EQ,
+    NE,
+    CONV,   // conversão para o tipo da instrução
+    ALOAD,  // args: array, índice
+    ASTORE, // args: array, índice, valor
+    CALL,   // sval = nome da função
+    PRINT,
+    BR,     // target1
+    CBR,    // args: condição; target1 (verdadeiro), target2 (falso)
+    RET
+};
+
+struct IRInstr
+{
+    IROp op;
+    IRType type;
+    std::vector<int> args;
+    long long ival = 0;
+    double fval = 0.0;
+    std::string sval;
+    int target1 = -1;
+    int target2 = -1;
+    int block = -1;
+    int line = 0;
+    bool dead = false;
+    int extent = 0;          // LOADG/PARAM de array: tamanho declarado
+    bool boundsCheck = true; // ALOAD/ASTORE: exige verificação de limites
+};
+
+struct IRBlock
+{
+    std::vector<int> instrs;
+    std::vector<int> preds;
+    bool sealed = false;
+    bool removed = false;
+    std::map<std::string, int> defs;
+    std::map<std::string, int> incompletePhis;
+};
+
+struct IRFunction
+{
+    std::string name;
+    IRType retType = IRType::VOID;
+    std::vector<std::pair<std::string, IRType>> params;
+    std::vector<int> paramExtents;
+    std::vector<IRInstr> instrs;
+    std::vector<IRBlock> blocks;
+    int line = 0;
+
+    // Tamanho da IR: quantidade de instruções vivas
+    int size() const
+    {
+        int n = 0;
+        for (auto &b : blocks)
+            if (!b.removed)
+                n += (int)b.instrs.size();
+        return n;
+    }
+
+    const IRInstr *terminator(int b) const
+    {
+        if (blocks[b].instrs.empty())
+            return nullptr;
+        const IRInstr &last = instrs[blocks[b].instrs.back()];
+        if (last.op == IROp::BR || last.op == IROp::CBR || last.op == IROp::RET)
+            return &last;
+        return nullptr;
+    }
+
+    std::vector<int> successors(int b) const
+    {
+        const IRInstr *t = terminator(b);
+        if (!t || t->op == IROp::RET)
+            return {};
+        if (t->op == IROp::BR)
+            return {t->target1};
+        if (t->target1 == t->target2)
+            return {t->target1};
+        return {t->target1, t->target2};
+    }
+
+    // Remove a aresta pred -> b, descartando o operando correspondente dos PHIs
+    void removeEdge(int pred, int b)
+    {
+        IRBlock &blk = blocks[b];
+        for (size_t k = 0; k < blk.preds.size(); ++k)
+        {
+            if (blk.preds[k] != pred)
+                continue;
+            blk.preds.erase(blk.preds.begin() + k);
+            for (int id : blk.instrs)
+            {
+                IRInstr &in = instrs[id];
+                if (in.op == IROp::PHI && k < in.args.size())
+                    in.args.erase(in.args.begin() + k);
+            }
+            return;
+        }
+    }
+
+    // Ordem reversa de pós-ordem a partir do bloco de entrada
+    std::vector<int> reversePostOrder() const
+    {
+        std::vector<int> order;
+        std::vector<char> visited(blocks.size(), 0);
+        std::vector<std::pair<int, size_t>> stack;
+        stack.push_back({0, 0});
+        visited[0] = 1;
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            std::vector<int> succ = successors(top.first);
+            if (top.second < succ.size())
+            {
+                int s = succ[top.second++];
+                if (!visited[s])
+                {
+                    visited[s] = 1;
+                    stack.push_back({s, 0});
+                }
+            }
+            else
+            {
+                order.push_back(top.first);
+                stack.pop_back();
+            }
+        }
+        return std::vector<int>(order.rbegin(), order.rend());
+    }
+};
+
+struct IRModule
+{
+    std::vector<IRFunction> functions;
+    std::map<std::string, IRType> globals;
+    std::map<std::string, int> arrayExtents;
+
+    IRFunction *find(const std::string &name)
+    {
+        for (auto &f : functions)
+            if (f.name == name)
+                return &f;
+        return nullptr;
+    }
+
+    int size() const
+    {
+        int n = 0;
+        for (auto &f : functions)
+            n += f.size();
+        return n;
+    }
+};
+
+// ===============================
+//  Utilitários de tipos
+// ===============================
+static IRType irTypeFromCode(const std::string &code)
+{
+    static const std::map<std::string, IRType> codes = {
+        {"IN", IRType::INT},
+        {"FP", IRType::REAL},
+        {"ST", IRType::STRING},
+        {"CH", IRType::CHAR},
+        {"BL", IRType::BOOL},
+        {"VD", IRType::VOID},
+        {"AI", IRType::ARR_INT},
+        {"AF", IRType::ARR_REAL},
+        {"AS", IRType::ARR_STRING},
+        {"AC", IRType::ARR_CHAR},
+        {"AB", IRType::ARR_BOOL}};
+    auto it = codes.find(code);
+    return it != codes.end() ? it->second : IRType::VOID;
+}
+
+static std::string irTypeToCode(IRType t)
+{
+    switch (t)
+    {
+    case IRType::INT:
+        return "IN";
+    case IRType::REAL:
+        return "FP";
+    case IRType::STRING:
+        return "ST";
+    case IRType::CHAR:
+        return "CH";
+    case IRType::BOOL:
+        return "BL";
+    case IRType::ARR_INT:
+        return "AI";
+    case IRType::ARR_REAL:
+        return "AF";
+    case IRType::ARR_STRING:
+        return "AS";
+    case IRType::ARR_CHAR:
+        return "AC";
+    case IRType::ARR_BOOL:
+        return "AB";
+    default:
+        return "VD";
+    }
+}
+
+static bool irIsArray(IRType t)
+{
+    return t == IRType::ARR_INT || t == IRType::ARR_REAL || t == IRType::ARR_STRING ||
+           t == IRType::ARR_CHAR || t == IRType::ARR_BOOL;
+}
+
+static IRType irElementType(IRType t)
+{
+    switch (t)
+    {
+    case IRType::ARR_INT:
+        return IRType::INT;
+    case IRType::ARR_REAL:
+        return IRType::REAL;
+    case IRType::ARR_STRING:
+        return IRType::STRING;
+    case IRType::ARR_CHAR:
+        return IRType::CHAR;
+    case IRType::ARR_BOOL:
+        return IRType::BOOL;
+    default:
+        return t;
+    }
+}
+
+static IRType irArrayOf(IRType t)
+{
+    switch (t)
+    {
+    case IRType::INT:
+        return IRType::ARR_INT;
+    case IRType::REAL:
+        return IRType::ARR_REAL;
+    case IRType::STRING:
+        return IRType::ARR_STRING;
+    case IRType::CHAR:
+        return IRType::ARR_CHAR;
+    case IRType::BOOL:
+        return IRType::ARR_BOOL;
+    default:
+        return t;
+    }
+}
+
+static IRType irTypeFromToken(TokenType t)
+{
+    switch (t)
+    {
+    case TokenType::INTEGER:
+        return IRType::INT;
+    case TokenType::REAL:
+        return IRType::REAL;
+    case TokenType::STRING:
+        return IRType::STRING;
+    case TokenType::CHARACTER:
+        return IRType::CHAR;
+    case TokenType::BOOLEAN:
+        return IRType::BOOL;
+    default:
+        return IRType::VOID;
+    }
+}
+
+static const char *irOpName(IROp op)
+{
+    switch (op)
+    {
+    case IROp::CONST:
+        return "CONST";
+    case IROp::PARAM:
+        return "PARAM";
+    case IROp::LOADG:
+        return "LOADG";
+    case IROp::STOREG:
+        return "STOREG";
+    case IROp::PHI:
+        return "PHI";
+    case IROp::COPY:
+        return "COPY";
+    case IROp::ADD:
+        return "ADD";
+    case IROp::SUB:
+        return "SUB";
+    case IROp::MUL:
+        return "MUL";
+    case IROp::DIV:
+        return "DIV";
+    case IROp::MOD:
+        return "MOD";
+    case IROp::NEG:
+        return "NEG";
+    case IROp::NOT:
+        return "NOT";
+    case IROp::LT:
+        return "LT";
+    case IROp::LE:
+        return "LE";
+    case IROp::GT:
+        return "GT";
+    case IROp::GE:
+        return "GE";
+    case IROp::EQ:
+        return "EQ";
+    case IROp::NE:
+        return "NE";
+    case IROp::CONV:
+        return "CONV";
+    case IROp::ALOAD:
+        return "ALOAD";
+    case IROp::ASTORE:
+        return "ASTORE";
+    case IROp::CALL:
+        return "CALL";
+    case IROp::PRINT:
+        return "PRINT";
+    case IROp::BR:
+        return "BR";
+    case IROp::CBR:
+        return "CBR";
+    case IROp::RET:
+        return "RET";
+    }
+    return "?";
+}
+
+// Instruções sem efeitos colaterais (podem ser removidas ou reaproveitadas)
+static bool irIsPure(const IRInstr &in)
+{
+    switch (in.op)
+    {
+    case IROp::CONST:
+    case IROp::COPY:
+    case IROp::PHI:
+    case IROp::ADD:
+    case IROp::SUB:
+    case IROp::MUL:
+    case IROp::DIV:
+    case IROp::MOD:
+    case IROp::NEG:
+    case IROp::NOT:
+    case IROp::LT:
+    case IROp::LE:
+    case IROp::GT:
+    case IROp::GE:
+    case IROp::EQ:
+    case IROp::NE:
+    case IROp::CONV:
+    case IROp::PARAM:
+    case IROp::LOADG:
+    case IROp::ALOAD:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ===============================
+//  Construção da IR a partir dos tokens
+// ===============================
+class IRBuilder
+{
+public:
+    IRBuilder(const std::string &source, const SymbolTable &symtab,
+              const AnalysisLimits &limits = AnalysisLimits())
+        : symtab_(symtab), pos_(0), maxDepth_(limits.maxNestingDepth)
+    {
+        texts_.push_back({0, LineIndex(source)});
+        Lexer lexer(source, &texts_.back().lines);
+        lexer.setLimits(limits);
+        while (true)
+        {
+            Token tok = lexer.nextToken();
+            tokens_.push_back(tok);
+            if (tok.type == TokenType::END_OF_FILE)
+                break;
+        }
+    }
+
+    IRModule build()
+    {
+        for (auto &info : symtab_.all())
+        {
+            if (info.type == "VD")
+                continue;
+            std::string name(info.lexeme);
+            module_.globals[name] = irTypeFromCode(std::string(info.type));
+            if (info.arraySize > 0)
+                module_.arrayExtents[name] = info.arraySize;
+        }
+
+        // Primeira passada: assinaturas das funções (permite chamadas adiante)
+        std::vector<size_t> bodies;
+        for (size_t i = 0; i < tokens_.size(); ++i)
+        {
+            if (tokens_[i].type != TokenType::FUNCTYPE)
+                continue;
+            IRFunction fn = parseSignature(i);
+            signatures_[fn.name] = fn;
+            module_.functions.push_back(fn);
+            bodies.push_back(pos_);
+        }
+        for (auto &fn : module_.functions)
+            module_.globals.erase(fn.name);
+        for (auto &fn : module_.functions)
+            for (auto &p : fn.params)
+                if (!isDeclaredGlobal(p.first))
+                    module_.globals.erase(p.first);
+
+        for (size_t k = 0; k < bodies.size(); ++k)
+        {
+            pos_ = bodies[k];
+            buildFunction(module_.functions[k], TokenType::ENDFUNCTION);
+        }
+
+        // Bloco principal: '{' ... '}' após ENDFUNCTIONS (ou ENDDECLARATIONS)
+        size_t start = 0;
+        for (size_t i = 0; i < tokens_.size(); ++i)
+            if (tokens_[i].type == TokenType::ENDFUNCTIONS ||
+                (tokens_[i].type == TokenType::ENDDECLARATIONS && start == 0))
+                start = i + 1;
+        if (start == 0 && tokens_[0].type == TokenType::PROGRAM)
+            start = 1;
+        IRFunction mainFn;
+        mainFn.name = "PROGRAM";
+        pos_ = start;
+        mainFn.line = lineOf(peek());
+        module_.functions.push_back(mainFn);
+        buildFunction(module_.functions.back(), TokenType::ENDPROGRAM);
+
+        // Funções importadas: só as alcançadas por chamadas são construídas
+        for (size_t k = 0; k < pendingImports_.size(); ++k)
+            buildImported(pendingImports_[k].first, *pendingImports_[k].second);
+        return module_;
+    }
+
+private:
+    const SymbolTable &symtab_;
+    std::vector<Token> tokens_;
+    size_t pos_;
+
+    // Textos de onde vieram os tokens: o fonte, com offsets a partir de 0, e
+    // o corpo de cada função importada, com offsets deslocados para depois
+    // do texto anterior (ver buildImported)
+    struct TokenText
+    {
+        size_t base;
+        LineIndex lines;
+    };
+    std::vector<TokenText> texts_;
+    IRModule module_;
+    std::map<std::string, IRFunction> signatures_;
+    std::set<std::string> declaredGlobals_;
+    std::vector<std::pair<const ModuleInterface *, const InterfaceFunction *>> pendingImports_;
+
+    IRFunction *fn_ = nullptr;
+    int cur_ = 0;
+    std::set<std::string> writtenGlobals_;
+    std::set<std::string> usedGlobals_;
+    std::vector<std::pair<int, int>> loops_; // (cabeçalho, saída)
+    int maxDepth_;
+    int depth_ = 0;
+
+    // Limita a recursão de comandos e expressões aninhados
+    struct NestingGuard
+    {
+        IRBuilder &b;
+        NestingGuard(IRBuilder &builder, int line) : b(builder)
+        {
+            if (++b.depth_ > b.maxDepth_)
+                b.error(line, "limite de " + std::to_string(b.maxDepth_) + " niveis de aninhamento excedido");
+        }
+        ~NestingGuard()
+        {
+            --b.depth_;
+        }
+    };
+
+    // ---------- tokens ----------
+    int lineOf(const Token &tok) const
+    {
+        auto text = std::upper_bound(texts_.begin(), texts_.end(), tok.offset, [](size_t offset, const TokenText &t)
+                                     { return offset < t.base; });
+        --text;
+        return text->lines.line(tok.offset - text->base);
+    }
+
+    const Token &peek(size_t k = 0) const
+    {
+        size_t i = std::min(pos_ + k, tokens_.size() - 1);
+        return tokens_[i];
+    }
+
+    Token advance()
+    {
+        Token t = peek();
+        if (pos_ < tokens_.size() - 1)
+            ++pos_;
+        return t;
+    }
+
+    bool accept(TokenType t)
+    {
+        if (peek().type != t)
+            return false;
+        advance();
+        return true;
+    }
+
+    Token expect(TokenType t, const std::string &what)
+    {
+        if (peek().type != t)
+            error(lineOf(peek()), "Esperava " + what + ", encontrou '" + lexemeOf(peek()) + "'");
+        return advance();
+    }
+
+    // Lexema como std::string, truncado em `max` caracteres (35 para nomes,
+    // como na tabela de símbolos)
+    static std::string lexemeOf(const Token &tok, size_t max = std::string::npos)
+    {
+        return std::string(std::string_view(tok.lexeme).substr(0, max));
+    }
+
+    // Lexema numérico inteiro convertido; false se não couber no tipo
+    template <typename T>
+    static bool parseNumber(const Token &tok, T &value)
+    {
+        const char *end = tok.lexeme.data() + tok.lexeme.size();
+        auto result = std::from_chars(tok.lexeme.data(), end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    [[noreturn]] void error(int line, const std::string &msg) const
+    {
+        throw std::runtime_error("Erro na linha " + std::to_string(line) + ": " + msg);
+    }
+
+    bool isDeclaredGlobal(const std::string &name)
+    {
+        if (declaredGlobals_.empty())
+        {
+            bool inDecl = false;
+            for (auto &t : tokens_)
+            {
+                if (t.type == TokenType::DECLARATIONS)
+                    inDecl = true;
+                else if (t.type == TokenType::ENDDECLARATIONS)
+                    break;
+                else if (inDecl && t.type == TokenType::IDENT)
+                    declaredGlobals_.insert(lexemeOf(t, 35));
+            }
+        }
+        return declaredGlobals_.count(name.substr(0, 35)) > 0;
+    }
+
+    // FUNCTYPE <tipo> : <nome> ( <Parameters> ), com o FUNCTYPE em tokens_[i];
+    // deixa pos_ no início do corpo
+    IRFunction parseSignature(size_t i)
+    {
+        pos_ = i + 1;
+        IRFunction fn;
+        fn.line = lineOf(tokens_[i]);
+        fn.retType = irTypeFromToken(advance().type);
+        expect(TokenType::COLON, "':' apos o tipo da funcao");
+        fn.name = lexemeOf(expect(TokenType::IDENT, "nome da funcao"));
+        parseParams(fn);
+        return fn;
+    }
+
+    // Assinatura de uma função declarada numa interface importada (--import),
+    // consultada na primeira chamada; o corpo entra na fila de construção
+    std::map<std::string, IRFunction>::iterator importSignature(const std::string &name)
+    {
+        for (const ModuleInterface *iface : symtab_.imports())
+        {
+            const InterfaceFunction *f = iface->findFunction(name);
+            if (!f)
+                continue;
+            IRFunction fn;
+            fn.name = name;
+            fn.line = f->bodyLine;
+            fn.retType = irTypeFromCode(std::string(ModuleInterface::code(f->retType)));
+            for (uint32_t k = 0; k < f->paramCount; ++k)
+            {
+                const InterfaceParam &p = iface->param(*f, k);
+                fn.params.push_back({std::string(iface->nameOf(p)),
+                                     irTypeFromCode(std::string(ModuleInterface::code(p.type)))});
+                fn.paramExtents.push_back(p.arraySize);
+            }
+            pendingImports_.push_back({iface, f});
+            return signatures_.emplace(name, fn).first;
+        }
+        return signatures_.end();
+    }
+
+    // Lê o texto da função importada, acrescenta os tokens antes do fim do
+    // arquivo e constrói a função como as do próprio programa. Variáveis
+    // globais da biblioteca usadas no corpo entram no módulo com o tipo da
+    // interface, se o programa não declarou outra com o mesmo nome.
+    void buildImported(const ModuleInterface *iface, const InterfaceFunction &f)
+    {
+        std::string text(iface->text(f.body, f.bodyLength));
+        size_t first = tokens_.size() - 1;
+        try
+        {
+            size_t base = texts_.back().base + texts_.back().lines.size() + 1;
+            texts_.push_back({base, LineIndex(text, f.bodyLine)});
+            Lexer lexer(text, 0, &texts_.back().lines);
+            std::vector<Token> body;
+            for (Token tok = lexer.nextToken(); tok.type != TokenType::END_OF_FILE; tok = lexer.nextToken())
+            {
+                tok.offset += base;
+                body.push_back(std::move(tok));
+            }
+            tokens_.insert(tokens_.begin() + first, body.begin(), body.end());
+
+            for (size_t i = first; i + 1 < tokens_.size(); ++i)
+            {
+                if (tokens_[i].type != TokenType::IDENT)
+                    continue;
+                std::string name = lexemeOf(tokens_[i], 35);
+                const InterfaceSymbol *sym = iface->findSymbol(name);
+                if (!sym || sym->kind != InterfaceSymbol::GLOBAL || module_.globals.count(name))
+                    continue;
+                module_.globals[name] = irTypeFromCode(std::string(ModuleInterface::code(sym->type)));
+                if (sym->arraySize > 0)
+                    module_.arrayExtents[name] = sym->arraySize;
+            }
+
+            IRFunction fn = parseSignature(first);
+            module_.functions.push_back(fn);
+            buildFunction(module_.functions.back(), TokenType::ENDFUNCTION);
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw std::runtime_error(std::string(e.what()) + " (funcao importada de " + iface->path() + ")");
+        }
+    }
+
+    // <Parameters> ::= "?" | paramType <tipo> : a[, b[N]]; ...
+    void parseParams(IRFunction &fn)
+    {
+        expect(TokenType::LPAREN, "'(' apos o nome da funcao");
+        if (accept(TokenType::QUESTION))
+        {
+            expect(TokenType::RPAREN, "')'");
+            return;
+        }
+        while (peek().type == TokenType::PARAMTYPE)
+        {
+            advance();
+            IRType type = irTypeFromToken(advance().type);
+            expect(TokenType::COLON, "':' apos o tipo do parametro");
+            while (peek().type == TokenType::IDENT)
+            {
+                std::string name = lexemeOf(advance(), 35);
+                IRType paramType = type;
+                int extent = 0;
+                if (accept(TokenType::LBRACK))
+                {
+                    extent = SymbolTable::parseArraySize(expect(TokenType::INTCONST, "tamanho do array").lexeme);
+                    expect(TokenType::RBRACK, "']'");
+                    paramType = irArrayOf(type);
+                }
+                fn.params.push_back({name, paramType});
+                fn.paramExtents.push_back(extent);
+                if (!accept(TokenType::COMMA))
+                    break;
+            }
+            accept(TokenType::SEMI);
+        }
+        expect(TokenType::RPAREN, "')' ao final dos parametros");
+    }
+
+    // ---------- emissão ----------
+    int emit(IROp op, IRType type, std::vector<int> args = {}, int line = 0)
+    {
+        IRInstr in;
+        in.op = op;
+        in.type = type;
+        in.args = std::move(args);
+        in.block = cur_;
+        in.line = line;
+        fn_->instrs.push_back(in);
+        int id = (int)fn_->instrs.size() - 1;
+        fn_->blocks[cur_].instrs.push_back(id);
+        return id;
+    }
+
+    int emitConstInt(long long v, IRType type = IRType::INT)
+    {
+        int id = emit(IROp::CONST, type);
+        fn_->instrs[id].ival = v;
+        return id;
+    }
+
+    int newBlock()
+    {
+        fn_->blocks.push_back(IRBlock());
+        return (int)fn_->blocks.size() - 1;
+    }
+
+    bool terminated() const
+    {
+        return fn_->terminator(cur_) != nullptr;
+    }
+
+    void branch(int target)
+    {
+        if (terminated())
+            return;
+        int id = emit(IROp::BR, IRType::VOID);
+        fn_->instrs[id].target1 = target;
+        fn_->blocks[target].preds.push_back(cur_);
+    }
+
+    void condBranch(int cond, int ifTrue, int ifFalse, int line)
+    {
+        int id = emit(IROp::CBR, IRType::VOID, {cond}, line);
+        fn_->instrs[id].target1 = ifTrue;
+        fn_->instrs[id].target2 = ifFalse;
+        fn_->blocks[ifTrue].preds.push_back(cur_);
+        fn_->blocks[ifFalse].preds.push_back(cur_);
+    }
+
+    // Após um desvio incondicional, o código segue num bloco inalcançável
+    void startUnreachable()
+    {
+        cur_ = newBlock();
+        fn_->blocks[cur_].sealed = true;
+    }
+
+    // ---------- SSA (Braun et al.) ----------
+    IRType variableType(const std::string &name) const
+    {
+        for (auto &p : fn_->params)
+            if (p.first == name)
+                return p.second;
+        auto it = module_.globals.find(name);
+        return it != module_.globals.end() ? it->second : IRType::VOID;
+    }
+
+    bool isParam(const std::string &name) const
+    {
+        for (auto &p : fn_->params)
+            if (p.first == name)
+                return true;
+        return false;
+    }
+
+    void writeVariable(const std::string &var, int block, int value)
+    {
+        fn_->blocks[block].defs[var] = value;
+    }
+
+    int readVariable(const std::string &var, int block)
+    {
+        auto it = fn_->blocks[block].defs.find(var);
+        if (it != fn_->blocks[block].defs.end())
+            return it->second;
+        return readVariableRecursive(var, block);
+    }
+
+    int newPhi(int block, IRType type)
+    {
+        IRInstr in;
+        in.op = IROp::PHI;
+        in.type = type;
+        in.block = block;
+        fn_->instrs.push_back(in);
+        int id = (int)fn_->instrs.size() - 1;
+        auto &list = fn_->blocks[block].instrs;
+        size_t at = 0;
+        while (at < list.size() && fn_->instrs[list[at]].op == IROp::PHI)
+            ++at;
+        list.insert(list.begin() + at, id);
+        return id;
+    }
+
+    int readVariableRecursive(const std::string &var, int block)
+    {
+        IRBlock &blk = fn_->blocks[block];
+        IRType type = variableType(var);
+        int value;
+        if (!blk.sealed)
+        {
+            value = newPhi(block, type);
+            fn_->blocks[block].incompletePhis[var] = value;
+        }
+        else if (blk.preds.size() == 1)
+        {
+            value = readVariable(var, blk.preds[0]);
+        }
+        else if (blk.preds.empty())
+        {
+            value = initialValue(var, block, type);
+        }
+        else
+        {
+            value = newPhi(block, type);
+            writeVariable(var, block, value);
+            addPhiOperands(var, value);
+        }
+        writeVariable(var, block, value);
+        return value;
+    }
+
+    void addPhiOperands(const std::string &var, int phi)
+    {
+        int block = fn_->instrs[phi].block;
+        std::vector<int> preds = fn_->blocks[block].preds;
+        for (int p : preds)
+        {
+            int v = readVariable(var, p);
+            fn_->instrs[phi].args.push_back(v);
+        }
+    }
+
+    void sealBlock(int block)
+    {
+        auto pending = fn_->blocks[block].incompletePhis;
+        for (auto &p : pending)
+            addPhiOperands(p.first, p.second);
+        fn_->blocks[block].incompletePhis.clear();
+        fn_->blocks[block].sealed = true;
+    }
+
+    // Valor na entrada da função: LOADG para globais; blocos inalcançáveis
+    // recebem uma constante qualquer do tipo
+    int initialValue(const std::string &var, int block, IRType type)
+    {
+        IRInstr in;
+        in.block = block;
+        in.type = type;
+        if (block == 0)
+        {
+            in.op = IROp::LOADG;
+            in.sval = var;
+        }
+        else
+        {
+            in.op = IROp::CONST;
+        }
+        fn_->instrs.push_back(in);
+        int id = (int)fn_->instrs.size() - 1;
+        auto &list = fn_->blocks[block].instrs;
+        size_t at = 0;
+        while (at < list.size() && (fn_->instrs[list[at]].op == IROp::PHI ||
+                                    fn_->instrs[list[at]].op == IROp::PARAM))
+            ++at;
+        list.insert(list.begin() + at, id);
+        return id;
+    }
+
+    // Variáveis globais escalares são promovidas a valores SSA dentro da
+    // função; chamadas e retornos sincronizam a memória global.
+    void spillGlobals()
+    {
+        for (auto &g : writtenGlobals_)
+        {
+            int v = readVariable(g, cur_);
+            int id = emit(IROp::STOREG, IRType::VOID, {v});
+            fn_->instrs[id].sval = g;
+        }
+    }
+
+    void reloadGlobals()
+    {
+        for (auto &g : usedGlobals_)
+        {
+            int id = emit(IROp::LOADG, variableType(g));
+            fn_->instrs[id].sval = g;
+            writeVariable(g, cur_, id);
+        }
+    }
+
+    void scanGlobals(TokenType endTok)
+    {
+        writtenGlobals_.clear();
+        usedGlobals_.clear();
+        for (size_t i = pos_; i < tokens_.size() && tokens_[i].type != endTok; ++i)
+        {
+            if (tokens_[i].type != TokenType::IDENT)
+                continue;
+            std::string name = lexemeOf(tokens_[i], 35);
+            if (isParam(name) || !module_.globals.count(name) || irIsArray(module_.globals[name]))
+                continue;
+            usedGlobals_.insert(name);
+            if (i + 1 < tokens_.size() && tokens_[i + 1].type == TokenType::ASSIGN)
+                writtenGlobals_.insert(name);
+        }
+    }
+
+    void buildFunction(IRFunction &fn, TokenType endTok)
+    {
+        fn_ = &fn;
+        loops_.clear();
+        cur_ = newBlock();
+        fn_->blocks[cur_].sealed = true;
+        for (size_t i = 0; i < fn.params.size(); ++i)
+        {
+            int id = emit(IROp::PARAM, fn.params[i].second);
+            fn_->instrs[id].ival = (long long)i;
+            fn_->instrs[id].sval = fn.params[i].first;
+            fn_->instrs[id].extent = fn.paramExtents[i];
+            writeVariable(fn.params[i].first, cur_, id);
+        }
+        scanGlobals(endTok);
+
+        expect(TokenType::LBRACE, "'{' no inicio do bloco");
+        parseStatements();
+        expect(TokenType::RBRACE, "'}' ao final do bloco");
+        accept(endTok);
+
+        if (!terminated())
+        {
+            if (endTok != TokenType::ENDPROGRAM)
+                spillGlobals();
+            emit(IROp::RET, IRType::VOID);
+        }
+        for (auto &b : fn_->blocks)
+        {
+            b.defs.clear();
+            b.incompletePhis.clear();
+        }
+        fn_ = nullptr;
+    }
+
+    // ---------- comandos ----------
+    bool atBlockEnd() const
+    {
+        TokenType t = peek().type;
+        return t == TokenType::RBRACE || t == TokenType::ENDIF || t == TokenType::ELSE ||
+               t == TokenType::ENDWHILE || t == TokenType::ENDFUNCTION ||
+               t == TokenType::ENDPROGRAM || t == TokenType::END_OF_FILE;
+    }
+
+    void parseStatements()
+    {
+        while (!atBlockEnd())
+            parseStatement();
+    }
+
+    void parseStatement()
+    {
+        Token tok = peek();
+        NestingGuard guard(*this, lineOf(tok));
+        switch (tok.type)
+        {
+        case TokenType::SEMI:
+            advance();
+            return;
+        case TokenType::LBRACE:
+            advance();
+            parseStatements();
+            expect(TokenType::RBRACE, "'}'");
+            return;
+        case TokenType::PRINT:
+        {
+            advance();
+            int v = parseExpression();
+            emit(IROp::PRINT, IRType::VOID, {v}, lineOf(tok));
+            accept(TokenType::SEMI);
+            return;
+        }
+        case TokenType::RETURN:
+        {
+            advance();
+            std::vector<int> args;
+            if (!atBlockEnd() && peek().type != TokenType::SEMI)
+            {
+                int v = parseExpression();
+                IRType vt = fn_->instrs[v].type;
+                if (irIsArray(vt) && irElementType(vt) == fn_->retType)
+                    fn_->retType = vt;
+                args.push_back(convert(v, fn_->retType));
+            }
+            accept(TokenType::SEMI);
+            if (fn_->name != "PROGRAM")
+                spillGlobals();
+            emit(IROp::RET, args.empty() ? IRType::VOID : fn_->retType, args, lineOf(tok));
+            startUnreachable();
+            return;
+        }
+        case TokenType::BREAK:
+            advance();
+            accept(TokenType::SEMI);
+            if (loops_.empty())
+                error(lineOf(tok), "BREAK fora de um WHILE");
+            branch(loops_.back().second);
+            startUnreachable();
+            return;
+        case TokenType::IF:
+            parseIf();
+            return;
+        case TokenType::WHILE:
+            parseWhile();
+            return;
+        case TokenType::IDENT:
+            parseAssignOrCall();
+            return;
+        default:
+            error(lineOf(tok), "Comando inesperado '" + lexemeOf(tok) + "'");
+        }
+    }
+
+    void parseIf()
+    {
+        Token tok = advance();
+        expect(TokenType::LPAREN, "'(' apos IF");
+        int cond = parseExpression();
+        expect(TokenType::RPAREN, "')' apos a condicao do IF");
+
+        int thenB = newBlock();
+        int elseB = newBlock();
+        int joinB = newBlock();
+        condBranch(cond, thenB, elseB, lineOf(tok));
+        sealBlock(thenB);
+        sealBlock(elseB);
+
+        cur_ = thenB;
+        parseStatements();
+        branch(joinB);
+
+        cur_ = elseB;
+        if (accept(TokenType::ELSE))
+            parseStatements();
+        branch(joinB);
+
+        expect(TokenType::ENDIF, "ENDIF");
+        sealBlock(joinB);
+        cur_ = joinB;
+    }
+
+    void parseWhile()
+    {
+        Token tok = advance();
+        int header = newBlock();
+        int body = newBlock();
+        int exit = newBlock();
+        branch(header);
+
+        cur_ = header;
+        expect(TokenType::LPAREN, "'(' apos WHILE");
+        int cond = parseExpression();
+        expect(TokenType::RPAREN, "')' apos a condicao do WHILE");
+        condBranch(cond, body, exit, lineOf(tok));
+        sealBlock(body);
+
+        loops_.push_back({header, exit});
+        cur_ = body;
+        expect(TokenType::LBRACE, "'{' no bloco do WHILE");
+        parseStatements();
+        expect(TokenType::RBRACE, "'}' no bloco do WHILE");
+        branch(header);
+        loops_.pop_back();
+        expect(TokenType::ENDWHILE, "ENDWHILE");
+
+        sealBlock(header);
+        sealBlock(exit);
+        cur_ = exit;
+    }
+
+    void parseAssignOrCall()
+    {
+        Token name = advance();
+        std::string var = lexemeOf(name, 35);
+
+        if (peek().type == TokenType::LPAREN)
+        {
+            pos_--;
+            parseExpression();
+            accept(TokenType::SEMI);
+            return;
+        }
+
+        IRType type = variableType(var);
+        if (type == IRType::VOID && !isParam(var) && !module_.globals.count(var))
+            error(lineOf(name), "Identificador '" + lexemeOf(name) + "' nao declarado");
+
+        if (accept(TokenType::LBRACK))
+        {
+            if (!irIsArray(type))
+                error(lineOf(name), "'" + lexemeOf(name) + "' nao e um array e nao pode ser indexado");
+            int index = convert(parseExpression(), IRType::INT);
+            expect(TokenType::RBRACK, "']'");
+            expect(TokenType::ASSIGN, "':=' na atribuicao");
+            int value = convert(parseExpression(), irElementType(type));
+            int arr = arrayRef(var, lineOf(name));
+            emit(IROp::ASTORE, IRType::VOID, {arr, index, value}, lineOf(name));
+            accept(TokenType::SEMI);
+            return;
+        }
+
+        expect(TokenType::ASSIGN, "':=' na atribuicao");
+        int value = convert(parseExpression(), type);
+        if (irIsArray(type) && !isParam(var))
+        {
+            int id = emit(IROp::STOREG, IRType::VOID, {value}, lineOf(name));
+            fn_->instrs[id].sval = var;
+        }
+        else
+        {
+            writeVariable(var, cur_, value);
+        }
+        accept(TokenType::SEMI);
+    }
+
+    // ---------- expressões ----------
+    int convert(int value, IRType to)
+    {
+        IRType from = fn_->instrs[value].type;
+        if (from == to || to == IRType::VOID || irIsArray(to) != irIsArray(from))
+            return value;
+        return emit(IROp::CONV, to, {value}, fn_->instrs[value].line);
+    }
+
+    static IRType resultType(IRType a, IRType b)
+    {
+        bool arr = irIsArray(a) || irIsArray(b);
+        IRType ea = irElementType(a), eb = irElementType(b);
+        IRType base;
+        if (ea == IRType::STRING || eb == IRType::STRING)
+            base = IRType::STRING;
+        else if (ea == IRType::REAL || eb == IRType::REAL)
+            base = IRType::REAL;
+        else if (ea == IRType::INT || eb == IRType::INT)
+            base = IRType::INT;
+        else
+            base = ea;
+        return arr ? irArrayOf(base) : base;
+    }
+
+    int binary(IROp op, int a, int b, int line)
+    {
+        IRType ta = fn_->instrs[a].type, tb = fn_->instrs[b].type;
+        IRType common = resultType(ta, tb);
+        IRType scalar = irElementType(common);
+        if (!irIsArray(ta))
+            a = convert(a, scalar);
+        if (!irIsArray(tb))
+            b = convert(b, scalar);
+        bool compare = op == IROp::LT || op == IROp::LE || op == IROp::GT ||
+                       op == IROp::GE || op == IROp::EQ || op == IROp::NE;
+        IRType type = compare ? (irIsArray(common) ? IRType::ARR_BOOL : IRType::BOOL) : common;
+        return emit(op, type, {a, b}, line);
+    }
+
+    int parseExpression()
+    {
+        int left = parseAdditive();
+        while (true)
+        {
+            Token tok = peek();
+            IROp op;
+            switch (tok.type)
+            {
+            case TokenType::LT:
+                op = IROp::LT;
+                break;
+            case TokenType::LE:
+                op = IROp::LE;
+                break;
+            case TokenType::GT:
+                op = IROp::GT;
+                break;
+            case TokenType::GE:
+                op = IROp::GE;
+                break;
+            case TokenType::EQ:
+            case TokenType::ASSIGN: // '=' dentro de expressões é comparação
+                op = IROp::EQ;
+                break;
+            case TokenType::NE:
+                op = IROp::NE;
+                break;
+            default:
+                return left;
+            }
+            advance();
+            left = binary(op, left, parseAdditive(), lineOf(tok));
+        }
+    }
+
+    int parseAdditive()
+    {
+        int left = parseTerm();
+        while (peek().type == TokenType::PLUS || peek().type == TokenType::MINUS)
+        {
+            Token tok = advance();
+            int right = parseTerm();
+            left = binary(tok.type == TokenType::PLUS ? IROp::ADD : IROp::SUB, left, right, lineOf(tok));
+        }
+        return left;
+    }
+
+    int parseTerm()
+    {
+        int left = parseUnary();
+        while (peek().type == TokenType::MUL || peek().type == TokenType::DIV ||
+               peek().type == TokenType::MOD)
+        {
+            Token tok = advance();
+            int right = parseUnary();
+            IROp op = tok.type == TokenType::MUL ? IROp::MUL : tok.type == TokenType::DIV ? IROp::DIV
+                                                                                           : IROp::MOD;
+            left = binary(op, left, right, lineOf(tok));
+        }
+        return left;
+    }
+
+    int parseUnary()
+    {
+        Token tok = peek();
+        NestingGuard guard(*this, lineOf(tok));
+        if (tok.type == TokenType::MINUS)
+        {
+            advance();
+            int v = parseUnary();
+            return emit(IROp::NEG, fn_->instrs[v].type, {v}, lineOf(tok));
+        }
+        if (tok.type == TokenType::HASH)
+        {
+            advance();
+            int v = parseUnary();
+            return emit(IROp::NOT, IRType::BOOL, {v}, lineOf(tok));
+        }
+        return parsePrimary();
+    }
+
+    int arrayRef(const std::string &var, int line)
+    {
+        if (isParam(var))
+            return readVariable(var, cur_);
+        int id = emit(IROp::LOADG, variableType(var), {}, line);
+        fn_->instrs[id].sval = var;
+        fn_->instrs[id].extent = symtab_.getArraySize(var);
+        return id;
+    }
+
+    int parsePrimary()
+    {
+        Token tok = advance();
+        switch (tok.type)
+        {
+        case TokenType::INTCONST:
+        {
+            long long value = 0;
+            if (!parseNumber(tok, value))
+                error(lineOf(tok), "Constante inteira fora do intervalo: " + lexemeOf(tok));
+            return emitConstInt(value);
+        }
+        case TokenType::REALCONST:
+        {
+            double value = 0;
+            if (!parseNumber(tok, value))
+                error(lineOf(tok), "Constante real fora do intervalo: " + lexemeOf(tok));
+            int id = emit(IROp::CONST, IRType::REAL, {}, lineOf(tok));
+            fn_->instrs[id].fval = value;
+            return id;
+        }
+        case TokenType::STRINGCONST:
+        {
+            int id = emit(IROp::CONST, IRType::STRING, {}, lineOf(tok));
+            fn_->instrs[id].sval = lexemeOf(tok);
+            return id;
+        }
+        case TokenType::CHARCONST:
+            return emitConstInt(tok.lexeme.empty() ? 0 : (unsigned char)tok.lexeme[0], IRType::CHAR);
+        case TokenType::TRUE:
+            return emitConstInt(1, IRType::BOOL);
+        case TokenType::FALSE:
+            return emitConstInt(0, IRType::BOOL);
+        case TokenType::LPAREN:
+        {
+            int v = parseExpression();
+            expect(TokenType::RPAREN, "')'");
+            return v;
+        }
+        case TokenType::IDENT:
+        {
+            std::string var = lexemeOf(tok, 35);
+            if (peek().type == TokenType::LPAREN)
+                return parseCall(tok);
+            if (!isParam(var) && !module_.globals.count(var))
+                error(lineOf(tok), "Identificador '" + lexemeOf(tok) + "' nao declarado");
+            IRType type = variableType(var);
+            if (accept(TokenType::LBRACK))
+            {
+                if (!irIsArray(type))
+                    error(lineOf(tok), "'" + lexemeOf(tok) + "' nao e um array e nao pode ser indexado");
+                int index = convert(parseExpression(), IRType::INT);
+                expect(TokenType::RBRACK, "']'");
+                int arr = arrayRef(var, lineOf(tok));
+                return emit(IROp::ALOAD, irElementType(type), {arr, index}, lineOf(tok));
+            }
+            if (irIsArray(type))
+                return arrayRef(var, lineOf(tok));
+            return readVariable(var, cur_);
+        }
+        default:
+            error(lineOf(tok), "Expressao invalida em '" + lexemeOf(tok) + "'");
+        }
+    }
+
+    int parseCall(const Token &name)
+    {
+        auto it = signatures_.find(lexemeOf(name, 35));
+        if (it == signatures_.end())
+            it = importSignature(lexemeOf(name, 35));
+        if (it == signatures_.end())
+            error(lineOf(name), "Funcao '" + lexemeOf(name) + "' nao declarada");
+        const IRFunction &callee = it->second;
+
+        expect(TokenType::LPAREN, "'('");
+        std::vector<int> args;
+        if (!accept(TokenType::QUESTION))
+        {
+            while (peek().type != TokenType::RPAREN)
+            {
+                int v = parseExpression();
+                if (args.size() < callee.params.size())
+                    v = convert(v, callee.params[args.size()].second);
+                args.push_back(v);
+                if (!accept(TokenType::COMMA))
+                    break;
+            }
+        }
+        expect(TokenType::RPAREN, "')' apos os argumentos");
+        if (args.size() != callee.params.size())
+            error(lineOf(name), "Funcao '" + lexemeOf(name) + "' espera " +
+                                 std::to_string(callee.params.size()) + " argumento(s)");
+
+        spillGlobals();
+        IRFunction *built = module_.find(callee.name);
+        int id = emit(IROp::CALL, built ? built->retType : callee.retType, args, lineOf(name));
+        fn_->instrs[id].sval = callee.name;
+        reloadGlobals();
+        return id;
+    }
+};
+
+// ===============================
+//  Passes de otimização
+// ===============================
+struct PassStats
+{
+    std::string pass;
+    double millis;
+    int sizeBefore;
+    int sizeAfter;
+};
+
+class Pass
+{
+public:
+    virtual ~Pass() {}
+    virtual const char *name() const = 0;
+    // Retorna true se alterou a função
+    virtual bool run(IRFunction &fn) = 0;
+    // Resumo opcional exibido junto das estatísticas
+    virtual std::string summary() const { return ""; }
+    // Chamado antes de cada rodada do passo, com o módulo inteiro (para
+    // passos que consultam outras funções)
+    virtual void prepare(IRModule &module) { (void)module; }
+};
+
+// Substitui os usos segundo o mapa de substituição (seguindo cadeias)
+static void irApplyReplacements(IRFunction &fn, std::vector<int> &repl)
+{
+    auto resolve = [&](int v)
+    {
+        while (repl[v] != v)
+            v = repl[v];
+        return v;
+    };
+    for (auto &b : fn.blocks)
+    {
+        if (b.removed)
+            continue;
+        for (int id : b.instrs)
+            for (auto &a : fn.instrs[id].args)
+                a = resolve(a);
+    }
+}
+
+static void irRemoveDeadInstrs(IRFunction &fn)
+{
+    for (auto &b : fn.blocks)
+    {
+        std::vector<int> kept;
+        for (int id : b.instrs)
+            if (!fn.instrs[id].dead)
+                kept.push_back(id);
+        b.instrs.swap(kept);
+    }
+}
+
+static bool irSameConst(const IRInstr &a, const IRInstr &b)
+{
+    return a.op == IROp::CONST && b.op == IROp::CONST && a.type == b.type &&
+           a.ival == b.ival && a.fval == b.fval && a.sval == b.sval;
+}
+
+// Propagação e dobramento de constantes, incluindo desvios condicionais
+class ConstantFoldingPass : public Pass
+{
+public:
+    const char *name() const override { return "constant-folding"; }
+
+    bool run(IRFunction &fn) override
+    {
+        bool changed = false, again = true;
+        while (again)
+        {
+            again = false;
+            for (int b : fn.reversePostOrder())
+            {
+                for (int id : fn.blocks[b].instrs)
+                {
+                    IRInstr &in = fn.instrs[id];
+                    if (in.op == IROp::CBR)
+                        again |= foldBranch(fn, b, in);
+                    else if (in.op == IROp::PHI)
+                        again |= foldPhi(fn, id);
+                    else
+                        again |= fold(fn, in);
+                }
+            }
+            changed |= again;
+        }
+        return changed;
+    }
+
+private:
+    static bool isNumeric(IRType t)
+    {
+        return t == IRType::INT || t == IRType::REAL || t == IRType::CHAR || t == IRType::BOOL;
+    }
+
+    static double asReal(const IRInstr &c)
+    {
+        return c.type == IRType::REAL ? c.fval : (double)c.ival;
+    }
+
+    static void makeConst(IRInstr &in, long long iv, double fv)
+    {
+        in.op = IROp::CONST;
+        in.args.clear();
+        in.ival = iv;
+        in.fval = fv;
+        in.sval.clear();
+    }
+
+    bool foldBranch(IRFunction &fn, int b, IRInstr &in)
+    {
+        const IRInstr &c = fn.instrs[in.args[0]];
+        if (c.op != IROp::CONST)
+            return false;
+        int taken = c.ival ? in.target1 : in.target2;
+        int dropped = c.ival ? in.target2 : in.target1;
+        fn.removeEdge(b, dropped);
+        in.op = IROp::BR;
+        in.args.clear();
+        in.target1 = taken;
+        in.target2 = -1;
+        return true;
+    }
+
+    bool foldPhi(IRFunction &fn, int id)
+    {
+        IRInstr &in = fn.instrs[id];
+        const IRInstr *value = nullptr;
+        for (int a : in.args)
+        {
+            if (a == id)
+                continue;
+            const IRInstr &arg = fn.instrs[a];
+            if (arg.op != IROp::CONST)
+                return false;
+            if (value && !irSameConst(*value, arg))
+                return false;
+            value = &arg;
+        }
+        if (!value)
+            return false;
+        IRInstr c = *value;
+        makeConst(in, c.ival, c.fval);
+        in.sval = c.sval;
+        return true;
+    }
+
+    bool fold(IRFunction &fn, IRInstr &in)
+    {
+        if (in.op == IROp::CONST || !irIsPure(in) || in.op == IROp::LOADG ||
+            in.op == IROp::PARAM || in.op == IROp::ALOAD || in.args.empty() || irIsArray(in.type))
+            return false;
+        for (int a : in.args)
+            if (fn.instrs[a].op != IROp::CONST)
+                return foldIdentity(fn, in);
+
+        const IRInstr &x = fn.instrs[in.args[0]];
+        const IRInstr *y = in.args.size() > 1 ? &fn.instrs[in.args[1]] : nullptr;
+
+        if (in.op == IROp::COPY)
+        {
+            IRInstr c = x;
+            makeConst(in, c.ival, c.fval);
+            in.sval = c.sval;
+            return true;
+        }
+        if (in.op == IROp::CONV)
+        {
+            if (in.type == IRType::REAL && isNumeric(x.type))
+                makeConst(in, 0, asReal(x));
+            else if (in.type == IRType::INT && isNumeric(x.type))
+                makeConst(in, x.type == IRType::REAL ? (long long)x.fval : x.ival, 0.0);
+            else
+                return false;
+            return true;
+        }
+        if (!isNumeric(x.type) || (y && !isNumeric(y->type)))
+            return false;
+
+        bool real = x.type == IRType::REAL || (y && y->type == IRType::REAL);
+        long long a = x.ival, b = y ? y->ival : 0;
+        double fa = asReal(x), fb = y ? asReal(*y) : 0.0;
+        // Inteiros como no interpretador: + - * dão a volta em 64 bits e a
+        // divisão por -1 não estoura. Divisão por zero fica para a execução,
+        // que reporta o erro
+        uint64_t ua = (uint64_t)a, ub = (uint64_t)b;
+        switch (in.op)
+        {
+        case IROp::ADD:
+            real ? makeConst(in, 0, fa + fb) : makeConst(in, (long long)(ua + ub), 0.0);
+            return true;
+        case IROp::SUB:
+            real ? makeConst(in, 0, fa - fb) : makeConst(in, (long long)(ua - ub), 0.0);
+            return true;
+        case IROp::MUL:
+            real ? makeConst(in, 0, fa * fb) : makeConst(in, (long long)(ua * ub), 0.0);
+            return true;
+        case IROp::DIV:
+            if (real)
+                makeConst(in, 0, fa / fb);
+            else if (b != 0)
+                makeConst(in, b == -1 ? (long long)(0 - ua) : a / b, 0.0);
+            else
+                return false;
+            return true;
+        case IROp::MOD:
+            if (real || b == 0)
+                return false;
+            makeConst(in, b == -1 ? 0 : a % b, 0.0);
+            return true;
+        case IROp::NEG:
+            real ? makeConst(in, 0, -fa) : makeConst(in, (long long)(0 - ua), 0.0);
+            return true;
+        case IROp::NOT:
+            makeConst(in, a == 0, 0.0);
+            return true;
+        case IROp::LT:
+            makeConst(in, real ? fa < fb : a < b, 0.0);
+            return true;
+        case IROp::LE:
+            makeConst(in, real ? fa <= fb : a <= b, 0.0);
+            return true;
+        case IROp::GT:
+            makeConst(in, real ? fa > fb : a > b, 0.0);
+            return true;
+        case IROp::GE:
+            makeConst(in, real ? fa >= fb : a >= b, 0.0);
+            return true;
+        case IROp::EQ:
+            makeConst(in, real ? fa == fb : a == b, 0.0);
+            return true;
+        case IROp::NE:
+            makeConst(in, real ? fa != fb : a != b, 0.0);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Identidades algébricas inteiras: x + 0, x - 0, x * 1, x / 1, x * 0
+    bool foldIdentity(IRFunction &fn, IRInstr &in)
+    {
+        if (in.type != IRType::INT || in.args.size() != 2)
+            return false;
+        const IRInstr &x = fn.instrs[in.args[0]];
+        const IRInstr &y = fn.instrs[in.args[1]];
+        auto isConst = [](const IRInstr &c, long long v)
+        { return c.op == IROp::CONST && c.type == IRType::INT && c.ival == v; };
+
+        if (((in.op == IROp::ADD || in.op == IROp::SUB) && isConst(y, 0)) ||
+            ((in.op == IROp::MUL || in.op == IROp::DIV) && isConst(y, 1)))
+        {
+            in.op = IROp::COPY;
+            in.args = {in.args[0]};
+            return true;
+        }
+        if ((in.op == IROp::ADD && isConst(x, 0)) || (in.op == IROp::MUL && isConst(x, 1)))
+        {
+            in.op = IROp::COPY;
+            in.args = {in.args[1]};
+            return true;
+        }
+        if (in.op == IROp::MUL && (isConst(x, 0) || isConst(y, 0)))
+        {
+            makeConst(in, 0, 0.0);
+            return true;
+        }
+        return false;
+    }
+};
+
+// Propagação de cópias: elimina COPY e PHIs triviais
+class CopyPropagationPass : public Pass
+{
+public:
+    const char *name() const override { return "copy-propagation"; }
+
+    bool run(IRFunction &fn) override
+    {
+        std::vector<int> repl(fn.instrs.size());
+        for (size_t i = 0; i < repl.size(); ++i)
+            repl[i] = (int)i;
+        auto resolve = [&](int v)
+        {
+            while (repl[v] != v)
+                v = repl[v];
+            return v;
+        };
+
+        bool changed = false, again = true;
+        while (again)
+        {
+            again = false;
+            for (auto &b : fn.blocks)
+            {
+                if (b.removed)
+                    continue;
+                for (int id : b.instrs)
+                {
+                    IRInstr &in = fn.instrs[id];
+                    if (in.dead)
+                        continue;
+                    int target = -1;
+                    if (in.op == IROp::COPY)
+                    {
+                        target = resolve(in.args[0]);
+                    }
+                    else if (in.op == IROp::PHI)
+                    {
+                        for (int a : in.args)
+                        {
+                            int r = resolve(a);
+                            if (r == id || r == target)
+                                continue;
+                            if (target != -1)
+                            {
+                                target = -2;
+                                break;
+                            }
+                            target = r;
+                        }
+                    }
+                    if (target >= 0 && target != id)
+                    {
+                        repl[id] = target;
+                        in.dead = true;
+                        again = changed = true;
+                    }
+                }
+            }
+        }
+        if (changed)
+        {
+            irApplyReplacements(fn, repl);
+            irRemoveDeadInstrs(fn);
+        }
+        return changed;
+    }
+};
+
+// Árvore de dominadores (Cooper, Harvey e Kennedy)
+static std::vector<int> irDominators(const IRFunction &fn, const std::vector<int> &rpo)
+{
+    std::vector<int> order(fn.blocks.size(), -1);
+    for (size_t i = 0; i < rpo.size(); ++i)
+        order[rpo[i]] = (int)i;
+    std::vector<int> idom(fn.blocks.size(), -1);
+    idom[rpo[0]] = rpo[0];
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); ++i)
+        {
+            int b = rpo[i];
+            int newIdom = -1;
+            for (int p : fn.blocks[b].preds)
+            {
+                if (order[p] < 0 || idom[p] < 0)
+                    continue;
+                if (newIdom < 0)
+                {
+                    newIdom = p;
+                    continue;
+                }
+                int x = p, y = newIdom;
+                while (x != y)
+                {
+                    while (order[x] > order[y])
+                        x = idom[x];
+                    while (order[y] > order[x])
+                        y = idom[y];
+                }
+                newIdom = x;
+            }
+            if (newIdom >= 0 && idom[b] != newIdom)
+            {
+                idom[b] = newIdom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+// Eliminação de subexpressões comuns, em escopos da árvore de dominadores
+class CSEPass : public Pass
+{
+public:
+    const char *name() const override { return "cse"; }
+
+    bool run(IRFunction &fn) override
+    {
+        std::vector<int> rpo = fn.reversePostOrder();
+        std::vector<int> idom = irDominators(fn, rpo);
+        std::vector<std::vector<int>> children(fn.blocks.size());
+        for (int b : rpo)
+            if (b != rpo[0] && idom[b] >= 0)
+                children[idom[b]].push_back(b);
+
+        std::vector<int> repl(fn.instrs.size());
+        for (size_t i = 0; i < repl.size(); ++i)
+            repl[i] = (int)i;
+
+        bool changed = false;
+        std::map<std::string, int> available;
+        globalsOut_.assign(fn.blocks.size(), {});
+        std::vector<std::pair<int, size_t>> stack;
+        std::vector<std::vector<std::string>> scopes;
+        stack.push_back({rpo[0], 0});
+        scopes.push_back(visit(fn, rpo[0], -1, available, repl, changed));
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            if (top.second < children[top.first].size())
+            {
+                int parent = top.first;
+                int child = children[parent][top.second++];
+                stack.push_back({child, 0});
+                scopes.push_back(visit(fn, child, parent, available, repl, changed));
+            }
+            else
+            {
+                for (auto &k : scopes.back())
+                    available.erase(k);
+                scopes.pop_back();
+                stack.pop_back();
+            }
+        }
+        if (changed)
+        {
+            irApplyReplacements(fn, repl);
+            irRemoveDeadInstrs(fn);
+        }
+        return changed;
+    }
+
+private:
+    // Valor conhecido de cada global escalar no fim de cada bloco
+    std::vector<std::map<std::string, int>> globalsOut_;
+
+    static bool candidate(const IRInstr &in)
+    {
+        if (!irIsPure(in) || in.op == IROp::PHI || in.op == IROp::PARAM ||
+            in.op == IROp::ALOAD || in.op == IROp::COPY)
+            return false;
+        // Globais escalares podem mudar; referências a arrays são estáveis
+        if (in.op == IROp::LOADG)
+            return irIsArray(in.type);
+        return true;
+    }
+
+    static std::string key(const IRInstr &in, std::vector<int> &repl)
+    {
+        std::string k = std::to_string((int)in.op) + ":" + std::to_string((int)in.type);
+        for (int a : in.args)
+        {
+            while (repl[a] != a)
+                a = repl[a];
+            k += "," + std::to_string(a);
+        }
+        if (in.op == IROp::CONST || in.op == IROp::LOADG)
+            k += "|" + std::to_string(in.ival) + "|" + std::to_string(in.fval) + "|" + in.sval;
+        return k;
+    }
+
+    // Globais conhecidas na entrada de `b`: as do fim do dominador imediato,
+    // se nenhum caminho entre os dois passa por CALL nem volta a `b`, menos
+    // as escritas no caminho
+    std::map<std::string, int> inherited(const IRFunction &fn, int b, int idom) const
+    {
+        if (idom < 0 || globalsOut_[idom].empty())
+            return {};
+        std::map<std::string, int> known = globalsOut_[idom];
+        std::vector<char> seen(fn.blocks.size(), 0);
+        std::vector<int> work(fn.blocks[b].preds);
+        seen[idom] = 1;
+        while (!work.empty())
+        {
+            int p = work.back();
+            work.pop_back();
+            if (seen[p])
+                continue;
+            if (p == b)
+                return {};
+            seen[p] = 1;
+            for (int id : fn.blocks[p].instrs)
+            {
+                const IRInstr &in = fn.instrs[id];
+                if (in.op == IROp::CALL)
+                    return {};
+                if (in.op == IROp::STOREG)
+                    known.erase(in.sval);
+            }
+            for (int q : fn.blocks[p].preds)
+                work.push_back(q);
+        }
+        return known;
+    }
+
+    // Encaminhamento de globais escalares: sem CALL no meio, um LOADG depois
+    // de um STOREG ou LOADG da mesma variável reusa o valor, e um STOREG do
+    // valor que a variável já tem é descartado. Some assim com a
+    // sincronização de globais em volta de chamadas expandidas. Arrays ficam
+    // de fora: o STOREG de um array copia o conteúdo para o próprio array,
+    // visível pelas referências carregadas antes.
+    static bool forwardGlobal(IRFunction &fn, int id, std::map<std::string, int> &globals, std::vector<int> &repl)
+    {
+        IRInstr &in = fn.instrs[id];
+        if (in.op == IROp::CALL)
+        {
+            globals.clear();
+            return false;
+        }
+        if (in.op != IROp::LOADG && in.op != IROp::STOREG)
+            return false;
+        if (irIsArray(in.op == IROp::LOADG ? in.type : fn.instrs[in.args[0]].type))
+            return false;
+        auto known = globals.find(in.sval);
+        if (in.op == IROp::LOADG)
+        {
+            if (known != globals.end() && fn.instrs[known->second].type == in.type)
+            {
+                repl[id] = known->second;
+                in.dead = true;
+                return true;
+            }
+            globals[in.sval] = id;
+            return false;
+        }
+        int v = in.args[0];
+        while (repl[v] != v)
+            v = repl[v];
+        if (known != globals.end() && known->second == v)
+        {
+            in.dead = true;
+            return true;
+        }
+        globals[in.sval] = v;
+        return false;
+    }
+
+    std::vector<std::string> visit(IRFunction &fn, int b, int idom, std::map<std::string, int> &available,
+                                   std::vector<int> &repl, bool &changed)
+    {
+        std::vector<std::string> added;
+        std::map<std::string, int> globals = inherited(fn, b, idom);
+        for (int id : fn.blocks[b].instrs)
+        {
+            IRInstr &in = fn.instrs[id];
+            if (forwardGlobal(fn, id, globals, repl))
+            {
+                changed = true;
+                continue;
+            }
+            if (!candidate(in))
+                continue;
+            std::string k = key(in, repl);
+            auto it = available.find(k);
+            if (it != available.end())
+            {
+                repl[id] = it->second;
+                in.dead = true;
+                changed = true;
+            }
+            else
+            {
+                available[k] = id;
+                added.push_back(k);
+            }
+        }
+        globalsOut_[b] = globals;
+        return added;
+    }
+};
+
+// Eliminação de código morto: blocos inalcançáveis, instruções sem uso e
+// fusão de blocos ligados por um desvio incondicional
+class DeadCodeEliminationPass : public Pass
+{
+public:
+    const char *name() const override { return "dce"; }
+
+    bool run(IRFunction &fn) override
+    {
+        bool changed = removeUnreachable(fn);
+        changed |= mergeBlocks(fn);
+        changed |= removeDeadStores(fn);
+        changed |= removeUnused(fn);
+        return changed;
+    }
+
+private:
+    // STOREG de global escalar que, em todos os caminhos, é sobrescrito por
+    // outro STOREG da mesma variável antes de qualquer LOADG, CALL ou RET.
+    // Análise para trás: overwritten[b] = globais certamente reescritas a
+    // partir da entrada de `b`. O STOREG de um array copia para o próprio
+    // array, que pode ser lido por uma referência carregada antes (o CSE
+    // junta esses LOADG): nunca é descartado.
+    bool removeDeadStores(IRFunction &fn)
+    {
+        auto scalarStore = [&](const IRInstr &in)
+        {
+            return in.op == IROp::STOREG && !irIsArray(fn.instrs[in.args[0]].type);
+        };
+        // Começa de "todas as globais escalares escritas na função" e só diminui
+        std::vector<int> rpo = fn.reversePostOrder();
+        std::set<std::string> stored;
+        for (int b : rpo)
+            for (int id : fn.blocks[b].instrs)
+                if (scalarStore(fn.instrs[id]))
+                    stored.insert(fn.instrs[id].sval);
+        if (stored.empty())
+            return false;
+        std::vector<std::set<std::string>> overwritten(fn.blocks.size(), stored);
+        auto transfer = [&](int b, bool remove)
+        {
+            std::set<std::string> out = stored;
+            for (int s : fn.successors(b))
+            {
+                std::set<std::string> both;
+                for (auto &g : out)
+                    if (overwritten[s].count(g))
+                        both.insert(g);
+                out.swap(both);
+            }
+            bool changed = false;
+            auto &list = fn.blocks[b].instrs;
+            for (size_t k = list.size(); k-- > 0;)
+            {
+                IRInstr &in = fn.instrs[list[k]];
+                if (in.op == IROp::LOADG)
+                    out.erase(in.sval);
+                else if (in.op == IROp::CALL || in.op == IROp::RET)
+                    out.clear();
+                else if (scalarStore(in))
+                {
+                    if (remove && out.count(in.sval))
+                    {
+                        in.dead = true;
+                        changed = true;
+                    }
+                    out.insert(in.sval);
+                }
+            }
+            if (remove)
+                return changed;
+            changed = out != overwritten[b];
+            overwritten[b].swap(out);
+            return changed;
+        };
+        for (bool again = true; again;)
+        {
+            again = false;
+            for (size_t k = rpo.size(); k-- > 0;)
+                again |= transfer(rpo[k], false);
+        }
+        bool changed = false;
+        for (int b : rpo)
+            changed |= transfer(b, true);
+        if (changed)
+            irRemoveDeadInstrs(fn);
+        return changed;
+    }
+
+    bool removeUnreachable(IRFunction &fn)
+    {
+        std::vector<char> reachable(fn.blocks.size(), 0);
+        for (int b : fn.reversePostOrder())
+            reachable[b] = 1;
+        bool changed = false;
+        for (size_t b = 0; b < fn.blocks.size(); ++b)
+        {
+            if (reachable[b] || fn.blocks[b].removed)
+                continue;
+            const IRInstr *t = fn.terminator((int)b);
+            if (t && t->op != IROp::RET)
+                for (int s : {t->target1, t->target2})
+                    if (s >= 0 && reachable[s])
+                        fn.removeEdge((int)b, s);
+            for (int id : fn.blocks[b].instrs)
+                fn.instrs[id].dead = true;
+            fn.blocks[b].instrs.clear();
+            fn.blocks[b].preds.clear();
+            fn.blocks[b].removed = true;
+            changed = true;
+        }
+        return changed;
+    }
+
+    bool mergeBlocks(IRFunction &fn)
+    {
+        bool changed = false;
+        for (size_t b = 0; b < fn.blocks.size(); ++b)
+        {
+            while (!fn.blocks[b].removed)
+            {
+                const IRInstr *t = fn.terminator((int)b);
+                if (!t || t->op != IROp::BR)
+                    break;
+                int s = t->target1;
+                if (s == (int)b || s == 0 || fn.blocks[s].preds.size() != 1)
+                    break;
+                // PHIs com um único predecessor já foram resolvidos pela cópia
+                bool hasPhi = false;
+                for (int id : fn.blocks[s].instrs)
+                    hasPhi |= fn.instrs[id].op == IROp::PHI;
+                if (hasPhi)
+                    break;
+
+                fn.instrs[fn.blocks[b].instrs.back()].dead = true;
+                fn.blocks[b].instrs.pop_back();
+                for (int id : fn.blocks[s].instrs)
+                {
+                    fn.instrs[id].block = (int)b;
+                    fn.blocks[b].instrs.push_back(id);
+                }
+                for (int succ : fn.successors((int)b))
+                    for (auto &p : fn.blocks[succ].preds)
+                        if (p == s)
+                            p = (int)b;
+                fn.blocks[s].instrs.clear();
+                fn.blocks[s].preds.clear();
+                fn.blocks[s].removed = true;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool removeUnused(IRFunction &fn)
+    {
+        std::vector<char> live(fn.instrs.size(), 0);
+        std::vector<int> work;
+        for (auto &b : fn.blocks)
+        {
+            if (b.removed)
+                continue;
+            for (int id : b.instrs)
+                if (!irIsPure(fn.instrs[id]))
+                {
+                    live[id] = 1;
+                    work.push_back(id);
+                }
+        }
+        while (!work.empty())
+        {
+            int id = work.back();
+            work.pop_back();
+            for (int a : fn.instrs[id].args)
+                if (!live[a])
+                {
+                    live[a] = 1;
+                    work.push_back(a);
+                }
+        }
+        bool changed = false;
+        for (auto &b : fn.blocks)
+        {
+            if (b.removed)
+                continue;
+            for (int id : b.instrs)
+                if (!live[id])
+                {
+                    fn.instrs[id].dead = true;
+                    changed = true;
+                }
+        }
+        if (changed)
+            irRemoveDeadInstrs(fn);
+        return changed;
+    }
+};
+
+// ===============================
+//  Eliminação de verificações de limites
+// ===============================
+// Análise de intervalos sobre a SSA: constantes, aritmética com constantes,
+// variáveis de indução de WHILE (PHI incrementado por passo constante) e
+// condições de desvio que dominam o acesso (ex.: i < 10 no corpo do laço).
+// Acessos cujo índice está provadamente em [0, extensão) dispensam a
+// verificação em tempo de execução.
+struct IRRange
+{
+    long long lo;
+    long long hi;
+
+    static IRRange full() { return {LLONG_MIN, LLONG_MAX}; }
+    bool within(long long a, long long b) const { return lo >= a && hi <= b; }
+};
+
+class BoundsCheckEliminationPass : public Pass
+{
+public:
+    const char *name() const override { return "bounds-check-elim"; }
+
+    bool run(IRFunction &fn) override
+    {
+        fn_ = &fn;
+        std::vector<int> rpo = fn.reversePostOrder();
+        idom_ = irDominators(fn, rpo);
+        memo_.clear();
+        inProgress_.clear();
+
+        int total = 0, proven = 0;
+        bool changed = false;
+        for (int b : rpo)
+        {
+            for (int id : fn.blocks[b].instrs)
+            {
+                IRInstr &in = fn.instrs[id];
+                if (in.op != IROp::ALOAD && in.op != IROp::ASTORE)
+                    continue;
+                ++total;
+                // Uma vez provado, o acesso continua seguro: os passes seguintes
+                // preservam os valores, mesmo quando a prova deixa de ser
+                // visível (ex.: índice reduzido a outra variável de indução)
+                int extent = fn.instrs[in.args[0]].extent;
+                bool safe = !in.boundsCheck || (extent > 0 && rangeAt(in.args[1], b).within(0, extent - 1));
+                if (safe)
+                    ++proven;
+                if (safe && in.boundsCheck)
+                {
+                    in.boundsCheck = false;
+                    changed = true;
+                }
+            }
+        }
+        counts_[fn.name] = {proven, total};
+        fn_ = nullptr;
+        return changed;
+    }
+
+    std::string summary() const override
+    {
+        int proven = 0, total = 0;
+        for (auto &c : counts_)
+        {
+            proven += c.second.first;
+            total += c.second.second;
+        }
+        char buf[128];
+        std::snprintf(buf, sizeof(buf), "%d de %d verificacoes de limites eliminadas (%.1f%%)",
+                      proven, total, total ? 100.0 * proven / total : 0.0);
+        return buf;
+    }
+
+private:
+    IRFunction *fn_ = nullptr;
+    std::vector<int> idom_;
+    std::map<std::pair<int, int>, IRRange> memo_;
+    std::set<std::pair<int, int>> inProgress_;
+    std::map<std::string, std::pair<int, int>> counts_;
+
+    static long long sat(__int128 v)
+    {
+        if (v < (__int128)LLONG_MIN)
+            return LLONG_MIN;
+        if (v > (__int128)LLONG_MAX)
+            return LLONG_MAX;
+        return (long long)v;
+    }
+
+    static IRRange add(IRRange a, IRRange b)
+    {
+        long long lo = (a.lo == LLONG_MIN || b.lo == LLONG_MIN) ? LLONG_MIN : sat((__int128)a.lo + b.lo);
+        long long hi = (a.hi == LLONG_MAX || b.hi == LLONG_MAX) ? LLONG_MAX : sat((__int128)a.hi + b.hi);
+        return {lo, hi};
+    }
+
+    static IRRange negate(IRRange a)
+    {
+        return {a.hi == LLONG_MAX ? LLONG_MIN : -a.hi, a.lo == LLONG_MIN ? LLONG_MAX : -a.lo};
+    }
+
+    // Intervalo do valor v válido dentro do bloco b
+    IRRange rangeAt(int v, int b)
+    {
+        auto key = std::make_pair(v, b);
+        auto it = memo_.find(key);
+        if (it != memo_.end())
+            return it->second;
+        if (inProgress_.count(key))
+            return IRRange::full();
+        inProgress_.insert(key);
+        IRRange r = refine(v, b, base(v, b));
+        inProgress_.erase(key);
+        memo_[key] = r;
+        return r;
+    }
+
+    IRRange base(int v, int b)
+    {
+        const IRInstr &in = fn_->instrs[v];
+        if (in.type != IRType::INT && in.type != IRType::CHAR && in.type != IRType::BOOL)
+            return IRRange::full();
+        switch (in.op)
+        {
+        case IROp::CONST:
+            return {in.ival, in.ival};
+        case IROp::COPY:
+            return rangeAt(in.args[0], b);
+        case IROp::ADD:
+            return add(rangeAt(in.args[0], b), rangeAt(in.args[1], b));
+        case IROp::SUB:
+            return add(rangeAt(in.args[0], b), negate(rangeAt(in.args[1], b)));
+        case IROp::NEG:
+            return negate(rangeAt(in.args[0], b));
+        case IROp::MUL:
+        {
+            IRRange x = rangeAt(in.args[0], b), y = rangeAt(in.args[1], b);
+            if (x.lo == LLONG_MIN || x.hi == LLONG_MAX || y.lo == LLONG_MIN || y.hi == LLONG_MAX)
+                return IRRange::full();
+            __int128 c[4] = {(__int128)x.lo * y.lo, (__int128)x.lo * y.hi,
+                             (__int128)x.hi * y.lo, (__int128)x.hi * y.hi};
+            __int128 lo = c[0], hi = c[0];
+            for (auto p : c)
+            {
+                lo = p < lo ? p : lo;
+                hi = p > hi ? p : hi;
+            }
+            return {sat(lo), sat(hi)};
+        }
+        case IROp::MOD:
+        {
+            IRRange x = rangeAt(in.args[0], b), y = rangeAt(in.args[1], b);
+            if (x.lo >= 0 && y.lo > 0 && y.hi != LLONG_MAX)
+                return {0, std::min(x.hi, y.hi - 1)};
+            return IRRange::full();
+        }
+        case IROp::LT:
+        case IROp::LE:
+        case IROp::GT:
+        case IROp::GE:
+        case IROp::EQ:
+        case IROp::NE:
+        case IROp::NOT:
+            return {0, 1};
+        case IROp::PHI:
+            return phi(v);
+        default:
+            return IRRange::full();
+        }
+    }
+
+    // Variável de indução: PHI cujos demais operandos são PHI + passo constante
+    IRRange phi(int v)
+    {
+        const IRInstr &in = fn_->instrs[v];
+        const IRBlock &blk = fn_->blocks[in.block];
+        IRRange init = {LLONG_MAX, LLONG_MIN};
+        bool up = true, down = true, anyInit = false;
+        for (size_t k = 0; k < in.args.size() && k < blk.preds.size(); ++k)
+        {
+            int a = in.args[k];
+            const IRInstr &arg = fn_->instrs[a];
+            if (a == v)
+                continue;
+            if ((arg.op == IROp::ADD || arg.op == IROp::SUB) && arg.args[0] == v &&
+                fn_->instrs[arg.args[1]].op == IROp::CONST)
+            {
+                long long step = fn_->instrs[arg.args[1]].ival;
+                if (arg.op == IROp::SUB)
+                    step = -step;
+                up &= step >= 0;
+                down &= step <= 0;
+                continue;
+            }
+            IRRange r = rangeAt(a, blk.preds[k]);
+            init.lo = std::min(init.lo, r.lo);
+            init.hi = std::max(init.hi, r.hi);
+            anyInit = true;
+        }
+        if (!anyInit)
+            return IRRange::full();
+        if (up && down)
+            return init;
+        if (up)
+            return {init.lo, LLONG_MAX};
+        if (down)
+            return {LLONG_MIN, init.hi};
+        return IRRange::full();
+    }
+
+    // Aplica as condições de desvio que dominam o bloco b
+    IRRange refine(int v, int b, IRRange r)
+    {
+        for (int a = b; a >= 0; a = idom_[a] == a ? -1 : idom_[a])
+        {
+            const IRBlock &blk = fn_->blocks[a];
+            if (blk.preds.size() != 1)
+                continue;
+            const IRInstr *t = fn_->terminator(blk.preds[0]);
+            if (!t || t->op != IROp::CBR || t->target1 == t->target2)
+                continue;
+            const IRInstr &cond = fn_->instrs[t->args[0]];
+            if (cond.args.size() != 2)
+                continue;
+            IROp op = cond.op;
+            if (a == t->target2)
+                op = negateCompare(op);
+            if (cond.args[0] == v)
+                r = constrain(r, op, cond.args[1], a);
+            else if (cond.args[1] == v)
+                r = constrain(r, swapCompare(op), cond.args[0], a);
+        }
+        return r;
+    }
+
+    static IROp negateCompare(IROp op)
+    {
+        switch (op)
+        {
+        case IROp::LT:
+            return IROp::GE;
+        case IROp::LE:
+            return IROp::GT;
+        case IROp::GT:
+            return IROp::LE;
+        case IROp::GE:
+            return IROp::LT;
+        case IROp::EQ:
+            return IROp::NE;
+        case IROp::NE:
+            return IROp::EQ;
+        default:
+            return IROp::COPY;
+        }
+    }
+
+    static IROp swapCompare(IROp op)
+    {
+        switch (op)
+        {
+        case IROp::LT:
+            return IROp::GT;
+        case IROp::LE:
+            return IROp::GE;
+        case IROp::GT:
+            return IROp::LT;
+        case IROp::GE:
+            return IROp::LE;
+        default:
+            return op;
+        }
+    }
+
+    // v <op> w, com w avaliado no bloco onde a condição vale
+    IRRange constrain(IRRange r, IROp op, int w, int b)
+    {
+        IRRange o = rangeAt(w, b);
+        switch (op)
+        {
+        case IROp::LT:
+            if (o.hi != LLONG_MAX)
+                r.hi = std::min(r.hi, o.hi - 1);
+            break;
+        case IROp::LE:
+            r.hi = std::min(r.hi, o.hi);
+            break;
+        case IROp::GT:
+            if (o.lo != LLONG_MIN)
+                r.lo = std::max(r.lo, o.lo + 1);
+            break;
+        case IROp::GE:
+            r.lo = std::max(r.lo, o.lo);
+            break;
+        case IROp::EQ:
+            r.lo = std::max(r.lo, o.lo);
+            r.hi = std::min(r.hi, o.hi);
+            break;
+        default:
+            break;
+        }
+        return r;
+    }
+};
+
+// ===============================
+//  Otimizações de laços
+// ===============================
+// Laços naturais, encontrados pelas arestas de retorno (latch -> header, com
+// o header dominando o latch). Os passes tratam os laços na forma em que a IR
+// constrói um WHILE: um único latch e um pré-cabeçalho, o único predecessor
+// de fora do laço, terminando em BR para o header.
+struct IRLoop
+{
+    int header = -1;
+    int latch = -1;          // -1 se houver mais de uma aresta de retorno
+    int preheader = -1;      // -1 se não houver
+    std::vector<int> blocks; // em ordem reversa de pós-ordem, a partir do header
+    std::vector<char> contains;
+
+    bool simple() const
+    {
+        return latch >= 0 && preheader >= 0;
+    }
+
+    bool inside(const IRFunction &fn, int value) const
+    {
+        return contains[fn.instrs[value].block];
+    }
+};
+
+static bool irDominates(const std::vector<int> &idom, int a, int b)
+{
+    while (a != b)
+    {
+        if (b < 0 || idom[b] < 0 || idom[b] == b)
+            return false;
+        b = idom[b];
+    }
+    return true;
+}
+
+// Laços da função, dos mais internos para os mais externos
+static std::vector<IRLoop> irFindLoops(const IRFunction &fn)
+{
+    std::vector<int> rpo = fn.reversePostOrder();
+    std::vector<int> idom = irDominators(fn, rpo);
+    std::vector<char> reachable(fn.blocks.size(), 0);
+    for (int b : rpo)
+        reachable[b] = 1;
+    std::map<int, std::vector<int>> latches;
+    for (int b : rpo)
+        for (int s : fn.successors(b))
+            if (irDominates(idom, s, b))
+                latches[s].push_back(b);
+
+    std::vector<IRLoop> loops;
+    for (auto &hl : latches)
+    {
+        IRLoop loop;
+        loop.header = hl.first;
+        loop.latch = hl.second.size() == 1 ? hl.second[0] : -1;
+        loop.contains.assign(fn.blocks.size(), 0);
+        loop.contains[loop.header] = 1;
+        std::vector<int> work = hl.second;
+        while (!work.empty())
+        {
+            int b = work.back();
+            work.pop_back();
+            if (loop.contains[b] || !reachable[b])
+                continue;
+            loop.contains[b] = 1;
+            for (int p : fn.blocks[b].preds)
+                work.push_back(p);
+        }
+        for (int b : rpo)
+            if (loop.contains[b])
+                loop.blocks.push_back(b);
+
+        int outside = -1, count = 0;
+        for (int p : fn.blocks[loop.header].preds)
+            if (!loop.contains[p])
+            {
+                outside = p;
+                ++count;
+            }
+        const IRInstr *t = count == 1 ? fn.terminator(outside) : nullptr;
+        if (t && t->op == IROp::BR)
+            loop.preheader = outside;
+        loops.push_back(std::move(loop));
+    }
+    std::stable_sort(loops.begin(), loops.end(), [](const IRLoop &a, const IRLoop &b)
+                     { return a.blocks.size() < b.blocks.size(); });
+    return loops;
+}
+
+// Acrescenta uma instrução nova ao fim do bloco b, antes do terminador
+static int irInsertBeforeTerminator(IRFunction &fn, int b, IRInstr in)
+{
+    int id = (int)fn.instrs.size();
+    in.block = b;
+    fn.instrs.push_back(std::move(in));
+    auto &list = fn.blocks[b].instrs;
+    list.insert(fn.terminator(b) ? list.end() - 1 : list.end(), id);
+    return id;
+}
+
+static IRInstr irMakeInstr(IROp op, IRType type, std::vector<int> args, int line)
+{
+    IRInstr in;
+    in.op = op;
+    in.type = type;
+    in.args = std::move(args);
+    in.line = line;
+    return in;
+}
+
+// Movimentação de código invariante: instruções cujo valor não muda entre as
+// iterações vão para o pré-cabeçalho e executam uma vez por entrada no laço.
+// Só saem do laço instruções que não podem falhar (divisão apenas por
+// constante diferente de 0 e -1) e leituras de globais que o laço não grava.
+class LoopInvariantCodeMotionPass : public Pass
+{
+public:
+    const char *name() const override { return "licm"; }
+
+    bool run(IRFunction &fn) override
+    {
+        bool changed = false;
+        for (const IRLoop &loop : irFindLoops(fn))
+        {
+            if (loop.preheader < 0)
+                continue;
+            std::set<std::string> stored;
+            bool calls = false;
+            for (int b : loop.blocks)
+                for (int id : fn.blocks[b].instrs)
+                {
+                    const IRInstr &in = fn.instrs[id];
+                    if (in.op == IROp::STOREG)
+                        stored.insert(in.sval);
+                    calls |= in.op == IROp::CALL;
+                }
+
+            // Em ordem reversa de pós-ordem os operandos saem antes de quem os usa
+            for (int b : loop.blocks)
+            {
+                auto &list = fn.blocks[b].instrs;
+                for (size_t k = 0; k < list.size();)
+                {
+                    int id = list[k];
+                    if (!invariant(fn, loop, fn.instrs[id], stored, calls))
+                    {
+                        ++k;
+                        continue;
+                    }
+                    list.erase(list.begin() + k);
+                    auto &pre = fn.blocks[loop.preheader].instrs;
+                    pre.insert(pre.end() - 1, id);
+                    fn.instrs[id].block = loop.preheader;
+                    ++hoisted_;
+                    changed = true;
+                }
+            }
+        }
+        return changed;
+    }
+
+    std::string summary() const override
+    {
+        return std::to_string(hoisted_) + " instrucoes movidas para fora de lacos";
+    }
+
+private:
+    int hoisted_ = 0;
+
+    static bool invariant(const IRFunction &fn, const IRLoop &loop, const IRInstr &in,
+                          const std::set<std::string> &stored, bool calls)
+    {
+        // Operações de arrays criam um array novo a cada execução
+        if (irIsArray(in.type) && in.op != IROp::LOADG)
+            return false;
+        switch (in.op)
+        {
+        case IROp::CONST:
+        case IROp::COPY:
+        case IROp::ADD:
+        case IROp::SUB:
+        case IROp::MUL:
+        case IROp::NEG:
+        case IROp::NOT:
+        case IROp::LT:
+        case IROp::LE:
+        case IROp::GT:
+        case IROp::GE:
+        case IROp::EQ:
+        case IROp::NE:
+        case IROp::CONV:
+            break;
+        case IROp::DIV:
+        case IROp::MOD:
+        {
+            const IRInstr &d = fn.instrs[in.args[1]];
+            if (in.type != IRType::REAL && (d.op != IROp::CONST || d.ival == 0 || d.ival == -1))
+                return false;
+            break;
+        }
+        case IROp::LOADG:
+            if (calls || stored.count(in.sval))
+                return false;
+            break;
+        default:
+            return false;
+        }
+        for (int a : in.args)
+            if (loop.inside(fn, a))
+                return false;
+        return true;
+    }
+};
+
+// Variáveis de indução e redução de força. Um PHI do header cujo valor na
+// aresta de retorno é ele mesmo mais (ou menos) um passo invariante é uma
+// variável de indução básica i; cada `i * k` inteiro do laço, com k
+// invariante, vira uma variável de indução derivada j, iniciada com
+// i0 * k no pré-cabeçalho e somada de passo * k logo depois do incremento
+// de i, no lugar da multiplicação a cada iteração.
+class StrengthReductionPass : public Pass
+{
+public:
+    const char *name() const override { return "strength-reduction"; }
+
+    bool run(IRFunction &fn) override
+    {
+        std::vector<std::pair<int, int>> reduced; // (multiplicação, j)
+        for (const IRLoop &loop : irFindLoops(fn))
+        {
+            const IRBlock &header = fn.blocks[loop.header];
+            if (!loop.simple() || header.preds.size() != 2)
+                continue;
+            size_t kl = header.preds[0] == loop.latch ? 0 : 1, kp = 1 - kl;
+
+            std::vector<int> muls;
+            for (int b : loop.blocks)
+                for (int id : fn.blocks[b].instrs)
+                    if (fn.instrs[id].op == IROp::MUL && fn.instrs[id].type == IRType::INT && !fn.instrs[id].dead)
+                        muls.push_back(id);
+            for (int m : muls)
+                for (int side = 0; side < 2; ++side)
+                {
+                    int i = fn.instrs[m].args[side], factor = fn.instrs[m].args[1 - side];
+                    int step = -1;
+                    bool subtract = false;
+                    if (loop.inside(fn, factor) || !inductionStep(fn, loop, i, kl, step, subtract))
+                        continue;
+                    reduced.push_back({m, reduce(fn, loop, kp, kl, i, factor, step, subtract, fn.instrs[m].line)});
+                    fn.instrs[m].dead = true;
+                    break;
+                }
+        }
+        if (reduced.empty())
+            return false;
+        std::vector<int> repl(fn.instrs.size());
+        for (size_t v = 0; v < repl.size(); ++v)
+            repl[v] = (int)v;
+        for (auto &r : reduced)
+            repl[r.first] = r.second;
+        irApplyReplacements(fn, repl);
+        irRemoveDeadInstrs(fn);
+        reduced_ += (int)reduced.size();
+        return true;
+    }
+
+    std::string summary() const override
+    {
+        return std::to_string(reduced_) + " multiplicacoes por variaveis de inducao reduzidas a somas";
+    }
+
+private:
+    int reduced_ = 0;
+
+    // i é variável de indução básica do laço: i = PHI(i0, i +/- passo)
+    static bool inductionStep(const IRFunction &fn, const IRLoop &loop, int i, size_t kl, int &step, bool &subtract)
+    {
+        const IRInstr &phi = fn.instrs[i];
+        if (phi.op != IROp::PHI || phi.block != loop.header || phi.type != IRType::INT || phi.args.size() != 2)
+            return false;
+        const IRInstr &inc = fn.instrs[phi.args[kl]];
+        if ((inc.op != IROp::ADD && inc.op != IROp::SUB) || inc.type != IRType::INT)
+            return false;
+        if (inc.args[0] == i)
+            step = inc.args[1];
+        else if (inc.op == IROp::ADD && inc.args[1] == i)
+            step = inc.args[0];
+        else
+            return false;
+        subtract = inc.op == IROp::SUB;
+        return !loop.inside(fn, step);
+    }
+
+    // Cria j = PHI(i0 * k, j +/- passo * k) e devolve j
+    static int reduce(IRFunction &fn, const IRLoop &loop, size_t kp, size_t kl, int i, int factor,
+                      int step, bool subtract, int line)
+    {
+        int init = irInsertBeforeTerminator(
+            fn, loop.preheader, irMakeInstr(IROp::MUL, IRType::INT, {fn.instrs[i].args[kp], factor}, line));
+        int scaled = irInsertBeforeTerminator(
+            fn, loop.preheader, irMakeInstr(IROp::MUL, IRType::INT, {step, factor}, line));
+
+        int j = (int)fn.instrs.size();
+        IRInstr phi = irMakeInstr(IROp::PHI, IRType::INT, {0, 0}, line);
+        phi.block = loop.header;
+        fn.instrs.push_back(phi);
+        auto &headerInstrs = fn.blocks[loop.header].instrs;
+        headerInstrs.insert(headerInstrs.begin(), j);
+
+        // O incremento de j vai logo depois do incremento de i
+        int inc = fn.instrs[i].args[kl];
+        int b = fn.instrs[inc].block;
+        int next = (int)fn.instrs.size();
+        IRInstr add = irMakeInstr(subtract ? IROp::SUB : IROp::ADD, IRType::INT, {j, scaled}, line);
+        add.block = b;
+        fn.instrs.push_back(add);
+        auto &list = fn.blocks[b].instrs;
+        list.insert(std::find(list.begin(), list.end(), inc) + 1, next);
+
+        fn.instrs[j].args[kp] = init;
+        fn.instrs[j].args[kl] = next;
+        return j;
+    }
+};
+
+// Desenrolamento completo de laços com poucas iterações, contadas em tempo
+// de compilação: i = PHI(constante, i +/- constante) comparado a uma
+// constante no header. O laço vira uma sequência de cópias do corpo, uma por
+// iteração, com a variável de indução substituída pelo seu valor em cada
+// cópia; o dobramento de constantes remove depois os testes do header.
+class LoopUnrollPass : public Pass
+{
+public:
+    static const int MAX_TRIPS = 16;
+    static const int MAX_SIZE = 256; // instruções do laço desenrolado
+
+    const char *name() const override { return "loop-unroll"; }
+
+    bool run(IRFunction &fn) override
+    {
+        // Um laço por vez: desenrolar muda os blocos dos laços externos
+        bool changed = false;
+        while (unrollOne(fn))
+            changed = true;
+        return changed;
+    }
+
+    std::string summary() const override
+    {
+        return std::to_string(unrolled_) + " lacos desenrolados";
+    }
+
+private:
+    int unrolled_ = 0;
+
+    // Bloco de saída (o sucessor do header fora do laço), ou -1 se o laço
+    // tiver outra saída (BREAK)
+    static int exitBlock(const IRFunction &fn, const IRLoop &loop)
+    {
+        int exit = -1;
+        for (int b : loop.blocks)
+            for (int s : fn.successors(b))
+                if (!loop.contains[s])
+                {
+                    if (b != loop.header || exit >= 0)
+                        return -1;
+                    exit = s;
+                }
+        return exit;
+    }
+
+    bool unrollOne(IRFunction &fn)
+    {
+        for (const IRLoop &loop : irFindLoops(fn))
+        {
+            int trips = tripCount(fn, loop);
+            if (trips < 0)
+                continue;
+            int size = 0;
+            for (int b : loop.blocks)
+                size += (int)fn.blocks[b].instrs.size();
+            if ((long long)size * (trips + 1) > MAX_SIZE)
+                continue;
+            unroll(fn, loop, trips);
+            ++unrolled_;
+            return true;
+        }
+        return false;
+    }
+
+    static int tripCount(const IRFunction &fn, const IRLoop &loop)
+    {
+        const IRBlock &header = fn.blocks[loop.header];
+        const IRInstr *t = fn.terminator(loop.header);
+        if (!loop.simple() || header.preds.size() != 2 || !t || t->op != IROp::CBR || exitBlock(fn, loop) < 0)
+            return -1;
+        size_t kl = header.preds[0] == loop.latch ? 0 : 1, kp = 1 - kl;
+        bool continueWhen = loop.contains[t->target1];
+
+        const IRInstr &cond = fn.instrs[t->args[0]];
+        if (cond.args.size() != 2)
+            return -1;
+        int side = fn.instrs[cond.args[0]].op == IROp::PHI ? 0 : 1;
+        const IRInstr &phi = fn.instrs[cond.args[side]];
+        const IRInstr &bound = fn.instrs[cond.args[1 - side]];
+        if (phi.op != IROp::PHI || phi.block != loop.header || phi.type != IRType::INT ||
+            bound.op != IROp::CONST || bound.type != IRType::INT)
+            return -1;
+        const IRInstr &init = fn.instrs[phi.args[kp]];
+        const IRInstr &inc = fn.instrs[phi.args[kl]];
+        if (init.op != IROp::CONST || init.type != IRType::INT || (inc.op != IROp::ADD && inc.op != IROp::SUB) ||
+            inc.args[0] != cond.args[side] || fn.instrs[inc.args[1]].op != IROp::CONST)
+            return -1;
+        long long step = fn.instrs[inc.args[1]].ival;
+        if (inc.op == IROp::SUB)
+            step = -step;
+
+        long long i = init.ival;
+        for (int n = 0; n <= MAX_TRIPS; ++n)
+        {
+            long long x = side == 0 ? i : bound.ival, y = side == 0 ? bound.ival : i;
+            bool holds = cond.op == IROp::LT   ? x < y
+                         : cond.op == IROp::LE ? x <= y
+                         : cond.op == IROp::GT ? x > y
+                         : cond.op == IROp::GE ? x >= y
+                         : cond.op == IROp::EQ ? x == y
+                         : cond.op == IROp::NE ? x != y
+                                               : !continueWhen;
+            if (holds != continueWhen)
+                return n;
+            i = (long long)((unsigned long long)i + (unsigned long long)step);
+        }
+        return -1;
+    }
+
+    // Cópias 0..trips-1 do laço inteiro, com o header desviando direto para o
+    // corpo, e uma última cópia só do header, desviando para a saída
+    static void unroll(IRFunction &fn, const IRLoop &loop, int trips)
+    {
+        const int header = loop.header;
+        const IRInstr &t = *fn.terminator(header);
+        const int body = loop.contains[t.target1] ? t.target1 : t.target2;
+        const int exit = loop.contains[t.target1] ? t.target2 : t.target1;
+        const size_t kl = fn.blocks[header].preds[0] == loop.latch ? 0 : 1, kp = 1 - kl;
+
+        std::vector<std::map<int, int>> blockCopy(trips + 1);
+        for (int k = 0; k <= trips; ++k)
+            for (int b : loop.blocks)
+                if (k < trips || b == header)
+                {
+                    blockCopy[k][b] = (int)fn.blocks.size();
+                    fn.blocks.emplace_back();
+                    fn.blocks.back().sealed = true;
+                }
+
+        std::map<int, int> values, previous;
+        for (int k = 0; k <= trips; ++k)
+        {
+            // Os PHIs do header valem o operando de entrada na primeira cópia
+            // e o valor da aresta de retorno da cópia anterior nas demais
+            values.clear();
+            for (int id : fn.blocks[header].instrs)
+            {
+                const IRInstr &in = fn.instrs[id];
+                if (in.op != IROp::PHI)
+                    continue;
+                int v = k == 0 ? in.args[kp] : in.args[kl];
+                values[id] = k > 0 && previous.count(v) ? previous[v] : v;
+            }
+            // Numera antes as cópias, na mesma ordem em que são criadas:
+            // PHIs de laços internos usam valores definidos mais adiante
+            int next = (int)fn.instrs.size();
+            for (int b : loop.blocks)
+                if (blockCopy[k].count(b))
+                    for (int id : fn.blocks[b].instrs)
+                        if (!values.count(id))
+                            values[id] = next++;
+
+            for (int b : loop.blocks)
+            {
+                if (!blockCopy[k].count(b))
+                    continue;
+                int nb = blockCopy[k][b];
+                std::vector<int> preds;
+                if (b == header)
+                    preds.push_back(k == 0 ? loop.preheader : blockCopy[k - 1][loop.latch]);
+                else
+                    for (int p : fn.blocks[b].preds)
+                        preds.push_back(blockCopy[k][p]);
+                fn.blocks[nb].preds = preds;
+
+                std::vector<int> ids = fn.blocks[b].instrs;
+                for (int id : ids)
+                {
+                    IRInstr c = fn.instrs[id];
+                    if (b == header && c.op == IROp::PHI)
+                        continue;
+                    c.block = nb;
+                    for (auto &a : c.args)
+                        if (values.count(a))
+                            a = values[a];
+                    if (b == header && (c.op == IROp::CBR || c.op == IROp::BR))
+                    {
+                        c.op = IROp::BR;
+                        c.args.clear();
+                        c.target1 = k < trips ? blockCopy[k][body] : exit;
+                        c.target2 = -1;
+                    }
+                    else if (c.op == IROp::BR || c.op == IROp::CBR)
+                    {
+                        for (int *target : {&c.target1, &c.target2})
+                            if (*target >= 0)
+                                *target = *target == header ? blockCopy[k + 1][header] : blockCopy[k][*target];
+                    }
+                    fn.instrs.push_back(c);
+                    fn.blocks[nb].instrs.push_back(values[id]);
+                }
+            }
+            previous = values;
+        }
+
+        // Entrada e saída passam pelas cópias; fora do laço, os valores do
+        // header são os da última cópia
+        IRInstr &enter = fn.instrs[fn.blocks[loop.preheader].instrs.back()];
+        enter.target1 = blockCopy[0][header];
+        for (auto &p : fn.blocks[exit].preds)
+            if (p == header)
+                p = blockCopy[trips][header];
+        for (size_t b = 0; b < loop.contains.size(); ++b)
+        {
+            if (loop.contains[b] || fn.blocks[b].removed)
+                continue;
+            for (int id : fn.blocks[b].instrs)
+                for (auto &a : fn.instrs[id].args)
+                    if (fn.instrs[a].block == header && values.count(a))
+                        a = values[a];
+        }
+        for (int b : loop.blocks)
+        {
+            for (int id : fn.blocks[b].instrs)
+                fn.instrs[id].dead = true;
+            fn.blocks[b].instrs.clear();
+            fn.blocks[b].preds.clear();
+            fn.blocks[b].removed = true;
+        }
+    }
+};
+
+// ===============================
+//  Expansão de funções (inlining)
+// ===============================
+// Cada CALL para uma função pequena é substituído por uma cópia do corpo da
+// função chamada: os PARAM viram os argumentos da chamada (na ordem dos
+// grupos de paramType, já achatada na IR, arrays incluídos por referência),
+// cada RET vira um desvio para o restante do bloco da chamada e o valor
+// devolvido, um PHI ali. Os STOREG/LOADG que sincronizam as globais em volta
+// da chamada continuam no lugar, então a semântica não muda.
+//
+// Modelo de custo: o tamanho da função chamada (instruções vivas, sem os
+// PARAM) é comparado a um limite que cresce com a profundidade de laços em
+// volta da chamada, já que uma chamada dentro de WHILE executa muitas vezes.
+// O crescimento total da IR é limitado a uma porcentagem do tamanho original.
+class InlinePass : public Pass
+{
+public:
+    static const int DEFAULT_GROWTH = 100; // % do tamanho original da IR
+    static const int BASE_SIZE = 12;       // sempre expandida
+    static const int LOOP_BONUS = 24;      // por nível de laço em volta da chamada
+    static const int MAX_SIZE = 80;
+
+    explicit InlinePass(int maxGrowthPercent = DEFAULT_GROWTH)
+        : maxGrowth_(maxGrowthPercent) {}
+
+    const char *name() const override { return "inline"; }
+
+    void prepare(IRModule &module) override
+    {
+        if (!module_)
+            originalSize_ = module.size();
+        module_ = &module;
+    }
+
+    bool run(IRFunction &fn) override
+    {
+        bool changed = false;
+        while (inlineOne(fn))
+            changed = true;
+        return changed;
+    }
+
+    std::string summary() const override
+    {
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "%d chamadas expandidas; %d instrucoes copiadas (+%.1f%% sobre as %d "
+                                        "instrucoes da IR)",
+                      sites_, added_, originalSize_ ? 100.0 * added_ / originalSize_ : 0.0, originalSize_);
+        return buf;
+    }
+
+private:
+    int maxGrowth_;
+    IRModule *module_ = nullptr;
+    int originalSize_ = 0;
+    int added_ = 0;
+    int sites_ = 0;
+
+    static int cost(const IRFunction &callee)
+    {
+        return callee.size() - (int)callee.params.size();
+    }
+
+    // Função que pode ser copiada: não recursiva, entrada sem predecessores,
+    // ao menos um RET alcançável e, se o valor da chamada for usado, todos os
+    // RET com valor
+    static bool inlinable(const IRFunction &callee, bool needsValue)
+    {
+        if (!callee.blocks[0].preds.empty())
+            return false;
+        int rets = 0;
+        for (int b : callee.reversePostOrder())
+            for (int id : callee.blocks[b].instrs)
+            {
+                const IRInstr &in = callee.instrs[id];
+                if (in.op == IROp::CALL && in.sval == callee.name)
+                    return false;
+                if (in.op != IROp::RET)
+                    continue;
+                ++rets;
+                if (needsValue && in.args.empty())
+                    return false;
+            }
+        return rets > 0;
+    }
+
+    bool inlineOne(IRFunction &fn)
+    {
+        if (maxGrowth_ <= 0)
+            return false;
+        std::vector<int> depth(fn.blocks.size(), 0);
+        for (const IRLoop &loop : irFindLoops(fn))
+            for (int b : loop.blocks)
+                ++depth[b];
+        std::vector<char> used(fn.instrs.size(), 0);
+        for (auto &blk : fn.blocks)
+            if (!blk.removed)
+                for (int id : blk.instrs)
+                    for (int a : fn.instrs[id].args)
+                        used[a] = 1;
+
+        long long budget = (long long)originalSize_ * maxGrowth_ / 100 - added_;
+        for (int b : fn.reversePostOrder())
+            for (int id : fn.blocks[b].instrs)
+            {
+                const IRInstr &call = fn.instrs[id];
+                if (call.op != IROp::CALL || call.sval == fn.name)
+                    continue;
+                const IRFunction *callee = module_->find(call.sval);
+                if (!callee || callee == &fn)
+                    continue;
+                int size = cost(*callee);
+                if (size > BASE_SIZE + LOOP_BONUS * depth[b] || size > MAX_SIZE || size > budget ||
+                    !inlinable(*callee, used[id]))
+                    continue;
+                expand(fn, b, id, *callee);
+                added_ += size;
+                ++sites_;
+                return true;
+            }
+        return false;
+    }
+
+    static void expand(IRFunction &fn, int b, int callId, const IRFunction &callee)
+    {
+        // Divide o bloco: o que vem depois da chamada vai para `rest`
+        int rest = (int)fn.blocks.size();
+        fn.blocks.emplace_back();
+        fn.blocks[rest].sealed = true;
+        auto &list = fn.blocks[b].instrs;
+        size_t at = std::find(list.begin(), list.end(), callId) - list.begin();
+        std::vector<int> tail(list.begin() + at + 1, list.end());
+        list.resize(at);
+        fn.blocks[rest].instrs = tail;
+        for (int id : tail)
+            fn.instrs[id].block = rest;
+        for (int s : fn.successors(rest))
+            for (auto &p : fn.blocks[s].preds)
+                if (p == b)
+                    p = rest;
+
+        // Blocos e valores copiados
+        std::vector<int> order = callee.reversePostOrder();
+        std::map<int, int> blockCopy;
+        for (int cb : order)
+        {
+            blockCopy[cb] = (int)fn.blocks.size();
+            fn.blocks.emplace_back();
+            fn.blocks.back().sealed = true;
+        }
+        std::map<int, int> values;
+        int next = (int)fn.instrs.size();
+        for (int cb : order)
+            for (int id : callee.blocks[cb].instrs)
+            {
+                const IRInstr &in = callee.instrs[id];
+                if (in.op == IROp::PARAM)
+                    values[id] = fn.instrs[callId].args[in.ival];
+                else
+                    values[id] = next++;
+            }
+
+        IRType resultType = fn.instrs[callId].type;
+        int line = fn.instrs[callId].line;
+        std::vector<std::pair<int, int>> returns; // (bloco, valor)
+        for (int cb : order)
+        {
+            int nb = blockCopy[cb];
+            for (int p : callee.blocks[cb].preds)
+                if (blockCopy.count(p))
+                    fn.blocks[nb].preds.push_back(blockCopy[p]);
+            for (int id : callee.blocks[cb].instrs)
+            {
+                IRInstr c = callee.instrs[id];
+                if (c.op == IROp::PARAM)
+                    continue;
+                c.block = nb;
+                for (auto &a : c.args)
+                    a = values[a];
+                // O argumento passado pode ser menor que a extensão declarada
+                // no parâmetro: os limites são provados de novo no chamador
+                if (c.op == IROp::ALOAD || c.op == IROp::ASTORE)
+                    c.boundsCheck = true;
+                if (c.op == IROp::BR || c.op == IROp::CBR)
+                {
+                    c.target1 = blockCopy[c.target1];
+                    if (c.target2 >= 0)
+                        c.target2 = blockCopy[c.target2];
+                }
+                else if (c.op == IROp::RET)
+                {
+                    returns.push_back({nb, c.args.empty() ? -1 : c.args[0]});
+                    c = irMakeInstr(IROp::BR, IRType::VOID, {}, c.line);
+                    c.block = nb;
+                    c.target1 = rest;
+                }
+                fn.instrs.push_back(c);
+                fn.blocks[nb].instrs.push_back(values[id]);
+            }
+        }
+        // PHIs de blocos cujos predecessores não eram alcançáveis perdem
+        // os operandos correspondentes
+        for (int cb : order)
+        {
+            const auto &preds = callee.blocks[cb].preds;
+            for (int id : callee.blocks[cb].instrs)
+            {
+                if (callee.instrs[id].op != IROp::PHI)
+                    continue;
+                IRInstr &phi = fn.instrs[values[id]];
+                std::vector<int> args;
+                for (size_t k = 0; k < preds.size() && k < phi.args.size(); ++k)
+                    if (blockCopy.count(preds[k]))
+                        args.push_back(phi.args[k]);
+                phi.args = args;
+            }
+        }
+
+        // Chamada -> desvio para a cópia; RETs -> `rest`
+        IRInstr br = irMakeInstr(IROp::BR, IRType::VOID, {}, line);
+        br.block = b;
+        br.target1 = blockCopy[order[0]];
+        int brId = (int)fn.instrs.size();
+        fn.instrs.push_back(br);
+        fn.blocks[b].instrs.push_back(brId);
+        fn.blocks[blockCopy[order[0]]].preds.push_back(b);
+
+        int result = -1;
+        for (auto &r : returns)
+            fn.blocks[rest].preds.push_back(r.first);
+        if (returns.size() == 1)
+            result = returns[0].second;
+        else if (resultType != IRType::VOID)
+        {
+            std::vector<int> args;
+            for (auto &r : returns)
+                args.push_back(r.second);
+            IRInstr phi = irMakeInstr(IROp::PHI, resultType, args, line);
+            phi.block = rest;
+            result = (int)fn.instrs.size();
+            fn.instrs.push_back(phi);
+            fn.blocks[rest].instrs.insert(fn.blocks[rest].instrs.begin(), result);
+        }
+
+        fn.instrs[callId].dead = true;
+        std::vector<int> repl(fn.instrs.size());
+        for (size_t v = 0; v < repl.size(); ++v)
+            repl[v] = (int)v;
+        if (result >= 0)
+            repl[callId] = result;
+        irApplyReplacements(fn, repl);
+    }
+};
+
+// ===============================
+//  Gerenciador de passes
+// ===============================
+class PassManager
+{
+public:
+    void add(std::unique_ptr<Pass> pass)
+    {
+        passes_.push_back(std::move(pass));
+    }
+
+    // Pipeline escalar padrão. A expansão de funções vem depois da limpeza,
+    // para medir as funções chamadas já simplificadas; a redução de força,
+    // depois da eliminação de verificações de limites, que precisa ver os
+    // índices na forma i * k. `inlineGrowth` limita o crescimento da IR pela
+    // expansão, em % do tamanho original (0 desliga)
+    static PassManager standard(int inlineGrowth = InlinePass::DEFAULT_GROWTH)
+    {
+        PassManager pm;
+        pm.add(std::unique_ptr<Pass>(new ConstantFoldingPass()));
+        pm.add(std::unique_ptr<Pass>(new CopyPropagationPass()));
+        pm.add(std::unique_ptr<Pass>(new CSEPass()));
+        pm.add(std::unique_ptr<Pass>(new DeadCodeEliminationPass()));
+        pm.add(std::unique_ptr<Pass>(new InlinePass(inlineGrowth)));
+        pm.add(std::unique_ptr<Pass>(new LoopUnrollPass()));
+        pm.add(std::unique_ptr<Pass>(new LoopInvariantCodeMotionPass()));
+        pm.add(std::unique_ptr<Pass>(new BoundsCheckEliminationPass()));
+        pm.add(std::unique_ptr<Pass>(new StrengthReductionPass()));
+        return pm;
+    }
+
+    // Retira um passo do pipeline pelo nome; false se não houver
+    bool remove(const std::string &name)
+    {
+        for (auto it = passes_.begin(); it != passes_.end(); ++it)
+            if (name == (*it)->name())
+            {
+                passes_.erase(it);
+                return true;
+            }
+        return false;
+    }
+
+    // Executa o pipeline até não haver mais alterações
+    void run(IRModule &module, int maxIterations = 4)
+    {
+        for (int it = 0; it < maxIterations; ++it)
+        {
+            bool changed = false;
+            for (auto &pass : passes_)
+            {
+                PassStats s;
+                s.pass = pass->name();
+                s.sizeBefore = module.size();
+                TRACE_SCOPE("passo", s.pass);
+                auto t0 = std::chrono::steady_clock::now();
+                pass->prepare(module);
+                for (auto &fn : module.functions)
+                    changed |= pass->run(fn);
+                auto t1 = std::chrono::steady_clock::now();
+                s.millis = std::chrono::duration<double, std::milli>(t1 - t0).count();
+                s.sizeAfter = module.size();
+                stats_.push_back(s);
+            }
+            if (!changed)
+                break;
+        }
+    }
+
+    const std::vector<PassStats> &stats() const
+    {
+        return stats_;
+    }
+
+    void printStats(std::ostream &out) const
+    {
+        out << "Pass                 Tempo(ms)   Antes  Depois   Delta\n";
+        for (auto &s : stats_)
+        {
+            char line[128];
+            std::snprintf(line, sizeof(line), "%-20s %9.3f %7d %7d %7d\n", s.pass.c_str(),
+                          s.millis, s.sizeBefore, s.sizeAfter, s.sizeAfter - s.sizeBefore);
+            out << line;
+        }
+        for (auto &pass : passes_)
+        {
+            std::string summary = pass->summary();
+            if (!summary.empty())
+                out << pass->name() << ": " << summary << "\n";
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Pass>> passes_;
+    std::vector<PassStats> stats_;
+};
+
+// ===============================
+//  Impressão da IR
+// ===============================
+static void irPrintFunction(std::ostream &out, const IRFunction &fn)
+{
+    out << "FUNCTION " << fn.name << "(";
+    for (size_t i = 0; i < fn.params.size(); ++i)
+        out << (i ? ", " : "") << fn.params[i].first << ": " << irTypeToCode(fn.params[i].second);
+    out << ") -> " << irTypeToCode(fn.retType) << "\n";
+    for (size_t b = 0; b < fn.blocks.size(); ++b)
+    {
+        const IRBlock &blk = fn.blocks[b];
+        if (blk.removed)
+            continue;
+        out << "  B" << b << ":";
+        if (!blk.preds.empty())
+        {
+            out << "    ; preds:";
+            for (int p : blk.preds)
+                out << " B" << p;
+        }
+        out << "\n";
+        for (int id : blk.instrs)
+        {
+            const IRInstr &in = fn.instrs[id];
+            out << "    ";
+            bool hasValue = in.type != IRType::VOID && in.op != IROp::RET;
+            if (hasValue)
+                out << "%" << id << " = ";
+            out << irOpName(in.op);
+            if (in.type != IRType::VOID)
+                out << " " << irTypeToCode(in.type);
+            if (in.op == IROp::CONST)
+            {
+                if (in.type == IRType::REAL)
+                    out << " " << in.fval;
+                else if (in.type == IRType::STRING)
+                    out << " \"" << in.sval << "\"";
+                else
+                    out << " " << in.ival;
+            }
+            else if (!in.sval.empty())
+            {
+                out << " " << in.sval;
+            }
+            for (size_t k = 0; k < in.args.size(); ++k)
+                out << (k ? ", %" : " %") << in.args[k];
+            if (in.op == IROp::BR)
+                out << " B" << in.target1;
+            if (in.op == IROp::CBR)
+                out << ", B" << in.target1 << ", B" << in.target2;
+            if ((in.op == IROp::ALOAD || in.op == IROp::ASTORE) && !in.boundsCheck)
+                out << "    ; limites provados";
+            out << "\n";
+        }
+    }
+}
+
+static void irPrintModule(std::ostream &out, const IRModule &module)
+{
+    for (size_t i = 0; i < module.functions.size(); ++i)
+    {
+        if (i)
+            out << "\n";
+        irPrintFunction(out, module.functions[i]);
+    }
+}
@@ -0,0 +1,616 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#define CANGA_JIT 1
+#endif
+
+// ===============================
+//  JIT de base para x86-64
+// ===============================
+// Funções (FUNCTYPE e o programa principal) que passam de JIT_THRESHOLD
+// entradas + voltas de laço (desvios para trás) são traduzidas instrução a
+// instrução para código de máquina x86-64, gravado em memória obtida com
+// mmap e protegida como executável só depois de pronta.
+//
+// O código gerado trabalha sobre os mesmos registradores do interpretador
+// (o vetor de Slots da função, em memória) e sobre os globais: não há
+// estado a converter na entrada nem na saída. Por isso ele pode começar em
+// qualquer instrução, inclusive no meio de um laço já em andamento, e pode
+// devolver o controle ao interpretador em qualquer instrução (deopt):
+// - instruções sem tradução (strings, PRINT de strings e arrays, kernels de
+//   arrays, STOREGA)
+//   saem para o interpretador, que as executa e continua interpretando até o
+//   próximo desvio para trás ou chamada, onde volta ao código nativo
+// - divisão por zero e índice fora dos limites também saem, antes de mudar
+//   qualquer registrador; o interpretador refaz a instrução e gera o erro com
+//   a mesma mensagem e linha
+// Traduzidas: constantes, cópias, aritmética e comparações de inteiros e
+// reais, NOT, conversões inteiro/real, globais, acesso a arrays, desvios e
+// retornos. Chamadas e PRINT de escalares chamam funções auxiliares do
+// interpretador (a chamada executa a função chamada, nativa ou não).
+//
+// Registradores fixos no código gerado: rbx = registradores da função,
+// r14 = globais, r15 = JitFrame. Exceções C++ nunca atravessam o código
+// gerado: a função auxiliar de chamada as captura e devolve JIT_EXCEPTION.
+
+const int64_t JIT_THRESHOLD = 1000;
+const int32_t JIT_RETURNED = -1;
+const int32_t JIT_EXCEPTION = -2;
+
+// Estado de uma execução nativa, lido pelo código gerado por deslocamento
+struct JitFrame
+{
+    Slot *R;
+    Slot *globals;
+    void *context; // interpretador
+    size_t base;   // posição de R na pilha do interpretador
+    int32_t fidx;
+    Slot result; // valor devolvido quando o código termina com JIT_RETURNED
+};
+
+// Funções auxiliares chamadas pelo código gerado para a instrução em `pc`;
+// devolvem 0 ou JIT_EXCEPTION. A de CALL atualiza frame->R, pois a pilha do
+// interpretador pode ter sido realocada
+using JitHelperFn = int32_t (*)(JitFrame *frame, int32_t pc);
+
+// Montador das poucas formas de instrução usadas pela tradução
+class X64Assembler
+{
+public:
+    enum Reg
+    {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R12 = 12,
+        R14 = 14,
+        R15 = 15
+    };
+
+    // Códigos de condição (jcc/setcc)
+    enum Cond
+    {
+        CC_AE = 0x3,
+        CC_E = 0x4,
+        CC_NE = 0x5,
+        CC_A = 0x7,
+        CC_P = 0xA,
+        CC_NP = 0xB,
+        CC_L = 0xC,
+        CC_GE = 0xD,
+        CC_LE = 0xE,
+        CC_G = 0xF
+    };
+
+    std::vector<uint8_t> bytes;
+
+    size_t size() const
+    {
+        return bytes.size();
+    }
+
+    void byte(uint8_t b)
+    {
+        bytes.push_back(b);
+    }
+
+    void u32(uint32_t v)
+    {
+        for (int k = 0; k < 4; ++k)
+            byte((uint8_t)(v >> (8 * k)));
+    }
+
+    void u64(uint64_t v)
+    {
+        for (int k = 0; k < 8; ++k)
+            byte((uint8_t)(v >> (8 * k)));
+    }
+
+    // `op reg, [base + disp32]`; `prefix` (66/F2) vem antes do REX
+    void mem(std::initializer_list<uint8_t> op, int reg, int base, int32_t disp, bool wide = true, int prefix = -1)
+    {
+        if (prefix >= 0)
+            byte((uint8_t)prefix);
+        rex(wide, reg, base);
+        for (uint8_t b : op)
+            byte(b);
+        byte((uint8_t)(0x80 | (reg & 7) << 3 | (base & 7)));
+        if ((base & 7) == RSP)
+            byte(0x24);
+        u32((uint32_t)disp);
+    }
+
+    // `op reg, rm` entre registradores
+    void rr(std::initializer_list<uint8_t> op, int reg, int rm, bool wide = true)
+    {
+        rex(wide, reg, rm);
+        for (uint8_t b : op)
+            byte(b);
+        byte((uint8_t)(0xC0 | (reg & 7) << 3 | (rm & 7)));
+    }
+
+    void push(int reg)
+    {
+        if (reg >= 8)
+            byte(0x41);
+        byte((uint8_t)(0x50 | (reg & 7)));
+    }
+
+    void pop(int reg)
+    {
+        if (reg >= 8)
+            byte(0x41);
+        byte((uint8_t)(0x58 | (reg & 7)));
+    }
+
+    void movImm64(int reg, uint64_t v)
+    {
+        rex(true, 0, reg);
+        byte((uint8_t)(0xB8 | (reg & 7)));
+        u64(v);
+    }
+
+    void movImm32(int reg, int32_t v) // zera a parte alta
+    {
+        rex(false, 0, reg);
+        byte((uint8_t)(0xB8 | (reg & 7)));
+        u32((uint32_t)v);
+    }
+
+    void setcc(Cond cc, int reg8) // al, cl, dl, bl
+    {
+        byte(0x0F);
+        byte((uint8_t)(0x90 | cc));
+        byte((uint8_t)(0xC0 | reg8));
+    }
+
+    // Desvios com deslocamento de 32 bits; devolvem a posição a corrigir
+    size_t jmp()
+    {
+        byte(0xE9);
+        u32(0);
+        return size() - 4;
+    }
+
+    size_t jcc(Cond cc)
+    {
+        byte(0x0F);
+        byte((uint8_t)(0x80 | cc));
+        u32(0);
+        return size() - 4;
+    }
+
+    void patch(size_t at, size_t target)
+    {
+        int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+        std::memcpy(&bytes[at], &rel, 4);
+    }
+
+private:
+    void rex(bool wide, int reg, int rm)
+    {
+        uint8_t r = (uint8_t)(0x40 | (wide ? 8 : 0) | (reg >> 3 & 1) << 2 | (rm >> 3 & 1));
+        if (r != 0x40)
+            byte(r);
+    }
+};
+
+class BaselineJit
+{
+public:
+    BaselineJit(const BcProgram &program, JitHelperFn call, JitHelperFn print)
+        : prog_(program), call_(call), print_(print), hot_(program.functions.size(), 0), native_(program.functions.size())
+    {
+    }
+
+    ~BaselineJit()
+    {
+#ifdef CANGA_JIT
+        for (auto &n : native_)
+            if (n.code)
+                munmap(n.code, n.mapped);
+#endif
+    }
+
+    BaselineJit(const BaselineJit &) = delete;
+    BaselineJit &operator=(const BaselineJit &) = delete;
+
+    // Há tradução para esta plataforma
+    static bool available()
+    {
+#ifdef CANGA_JIT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Conta uma entrada ou volta de laço de `fidx`, traduzindo a função ao
+    // atingir JIT_THRESHOLD; true se ela já tem código nativo
+    bool tick(int32_t fidx)
+    {
+        if (native_[fidx].code)
+            return true;
+        return ++hot_[fidx] == JIT_THRESHOLD && compile(fidx);
+    }
+
+    // Executa o código de frame.fidx a partir de `pc`. Devolve JIT_RETURNED,
+    // JIT_EXCEPTION ou o pc em que o interpretador deve continuar
+    int32_t run(JitFrame &frame, int32_t pc)
+    {
+        const Native &n = native_[frame.fidx];
+        using Entry = int32_t (*)(JitFrame *, const void *);
+        return ((Entry)n.code)(&frame, n.code + n.offsets[pc - prog_.functions[frame.fidx].codeStart]);
+    }
+
+    size_t compiledFunctions() const
+    {
+        size_t count = 0;
+        for (auto &n : native_)
+            count += n.code != nullptr;
+        return count;
+    }
+
+    size_t codeBytes() const
+    {
+        size_t total = 0;
+        for (auto &n : native_)
+            total += n.size;
+        return total;
+    }
+
+private:
+    using A = X64Assembler;
+
+    struct Native
+    {
+        uint8_t *code = nullptr;
+        size_t size = 0;
+        size_t mapped = 0;
+        std::vector<uint32_t> offsets; // início de cada instrução da função
+    };
+
+    const BcProgram &prog_;
+    JitHelperFn call_;
+    JitHelperFn print_;
+    std::vector<int64_t> hot_;
+    std::vector<Native> native_;
+
+    static int32_t slot(int32_t r)
+    {
+        return r * (int32_t)sizeof(Slot);
+    }
+
+    bool compile(int32_t fidx)
+    {
+#ifdef CANGA_JIT
+        const BcFunction &fn = prog_.functions[fidx];
+        A as;
+        std::vector<uint32_t> offsets(fn.codeEnd - fn.codeStart);
+        std::vector<std::pair<size_t, int32_t>> jumps; // (posição, pc de destino)
+        std::vector<std::pair<size_t, int32_t>> exits; // (posição, pc do deopt)
+        std::vector<size_t> toEpilogue;
+
+        // Entrada: int32_t (JitFrame *frame, const void *início)
+        as.push(A::RBP);
+        as.push(A::RBX);
+        as.push(A::R12);
+        as.push(A::R14);
+        as.push(A::R15);
+        as.rr({0x89}, A::RDI, A::R15);
+        as.mem({0x8B}, A::RBX, A::R15, (int32_t)offsetof(JitFrame, R));
+        as.mem({0x8B}, A::R14, A::R15, (int32_t)offsetof(JitFrame, globals));
+        as.byte(0xFF); // jmp rsi
+        as.byte(0xE6);
+
+        auto load = [&](int reg, int32_t r)
+        { as.mem({0x8B}, reg, A::RBX, slot(r)); };
+        auto store = [&](int32_t r, int reg)
+        { as.mem({0x89}, reg, A::RBX, slot(r)); };
+        auto loadF = [&](int xmm, int32_t r)
+        { as.mem({0x0F, 0x10}, xmm, A::RBX, slot(r), false, 0xF2); };
+        auto storeBool = [&](int32_t r)
+        {
+            as.rr({0x0F, 0xB6}, A::RAX, A::RAX, false); // movzx eax, al
+            store(r, A::RAX);
+        };
+        auto callHelper = [&](JitHelperFn helper, int32_t pc)
+        {
+            as.rr({0x89}, A::R15, A::RDI);
+            as.movImm32(A::RSI, pc);
+            as.movImm64(A::RAX, (uint64_t)(uintptr_t)helper);
+            as.byte(0xFF); // call rax
+            as.byte(0xD0);
+        };
+        auto exitTo = [&](int32_t pc)
+        {
+            as.movImm32(A::RAX, pc);
+            toEpilogue.push_back(as.jmp());
+        };
+
+        for (int32_t pc = fn.codeStart; pc < fn.codeEnd; ++pc)
+        {
+            offsets[pc - fn.codeStart] = (uint32_t)as.size();
+            const BcInstr &in = prog_.code[pc];
+            switch (in.op)
+            {
+            case Opcode::LOADK:
+            {
+                uint64_t v = (uint64_t)(uint32_t)in.b | ((uint64_t)(uint32_t)in.c << 32);
+                if ((int64_t)v == (int64_t)(int32_t)v)
+                {
+                    as.mem({0xC7}, 0, A::RBX, slot(in.a));
+                    as.u32((uint32_t)v);
+                }
+                else
+                {
+                    as.movImm64(A::RAX, v);
+                    store(in.a, A::RAX);
+                }
+                break;
+            }
+            case Opcode::MOV:
+                load(A::RAX, in.b);
+                store(in.a, A::RAX);
+                break;
+            case Opcode::ADDI:
+            case Opcode::SUBI:
+            case Opcode::MULI:
+                load(A::RAX, in.b);
+                if (in.op == Opcode::ADDI)
+                    as.mem({0x03}, A::RAX, A::RBX, slot(in.c));
+                else if (in.op == Opcode::SUBI)
+                    as.mem({0x2B}, A::RAX, A::RBX, slot(in.c));
+                else
+                    as.mem({0x0F, 0xAF}, A::RAX, A::RBX, slot(in.c));
+                store(in.a, A::RAX);
+                break;
+            case Opcode::DIVI:
+            case Opcode::MODI:
+            {
+                load(A::RCX, in.c);
+                as.rr({0x85}, A::RCX, A::RCX);
+                exits.push_back({as.jcc(A::CC_E), pc});
+                as.rr({0x83}, 7, A::RCX); // cmp rcx, -1
+                as.byte(0xFF);
+                size_t general = as.jcc(A::CC_NE);
+                // Divisor -1: sem idiv, que falha com INT64_MIN
+                if (in.op == Opcode::DIVI)
+                {
+                    load(A::RAX, in.b);
+                    as.rr({0xF7}, 3, A::RAX); // neg
+                    store(in.a, A::RAX);
+                }
+                else
+                {
+                    as.mem({0xC7}, 0, A::RBX, slot(in.a));
+                    as.u32(0);
+                }
+                size_t done = as.jmp();
+                as.patch(general, as.size());
+                load(A::RAX, in.b);
+                as.byte(0x48); // cqo
+                as.byte(0x99);
+                as.rr({0xF7}, 7, A::RCX); // idiv rcx
+                store(in.a, in.op == Opcode::DIVI ? A::RAX : A::RDX);
+                as.patch(done, as.size());
+                break;
+            }
+            case Opcode::NEGI:
+                load(A::RAX, in.b);
+                as.rr({0xF7}, 3, A::RAX);
+                store(in.a, A::RAX);
+                break;
+            case Opcode::ADDF:
+            case Opcode::SUBF:
+            case Opcode::MULF:
+            case Opcode::DIVF:
+            {
+                uint8_t op = in.op == Opcode::ADDF ? 0x58 : in.op == Opcode::SUBF ? 0x5C
+                                                        : in.op == Opcode::MULF   ? 0x59
+                                                                                  : 0x5E;
+                loadF(0, in.b);
+                as.mem({0x0F, op}, 0, A::RBX, slot(in.c), false, 0xF2);
+                as.mem({0x0F, 0x11}, 0, A::RBX, slot(in.a), false, 0xF2);
+                break;
+            }
+            case Opcode::NEGF:
+                load(A::RAX, in.b);
+                as.movImm64(A::RCX, 0x8000000000000000ull);
+                as.rr({0x31}, A::RCX, A::RAX); // xor rax, rcx
+                store(in.a, A::RAX);
+                break;
+            case Opcode::LTI:
+            case Opcode::LEI:
+            case Opcode::GTI:
+            case Opcode::GEI:
+            case Opcode::EQI:
+            case Opcode::NEI:
+            {
+                const A::Cond conds[] = {A::CC_L, A::CC_LE, A::CC_G, A::CC_GE, A::CC_E, A::CC_NE};
+                load(A::RAX, in.b);
+                as.mem({0x3B}, A::RAX, A::RBX, slot(in.c));
+                as.setcc(conds[(int)in.op - (int)Opcode::LTI], A::RAX);
+                storeBool(in.a);
+                break;
+            }
+            case Opcode::LTF:
+            case Opcode::LEF:
+            case Opcode::GTF:
+            case Opcode::GEF:
+            case Opcode::EQF:
+            case Opcode::NEF:
+            {
+                // ucomisd: um NaN dá "não ordenado" (ZF = PF = CF = 1), e
+                // só NEF é verdadeira, como nas comparações de C++. LTF e LEF
+                // trocam os operandos para usar as condições "acima"
+                bool swap = in.op == Opcode::LTF || in.op == Opcode::LEF;
+                loadF(0, swap ? in.c : in.b);
+                as.mem({0x0F, 0x2E}, 0, A::RBX, slot(swap ? in.b : in.c), false, 0x66);
+                if (in.op == Opcode::EQF)
+                {
+                    as.setcc(A::CC_E, A::RAX);
+                    as.setcc(A::CC_NP, A::RCX);
+                    as.rr({0x20}, A::RCX, A::RAX, false); // and al, cl
+                }
+                else if (in.op == Opcode::NEF)
+                {
+                    as.setcc(A::CC_NE, A::RAX);
+                    as.setcc(A::CC_P, A::RCX);
+                    as.rr({0x08}, A::RCX, A::RAX, false); // or al, cl
+                }
+                else
+                    as.setcc(in.op == Opcode::LTF || in.op == Opcode::GTF ? A::CC_A : A::CC_AE, A::RAX);
+                storeBool(in.a);
+                break;
+            }
+            case Opcode::NOT:
+                as.mem({0x83}, 7, A::RBX, slot(in.b)); // cmp qword [b], 0
+                as.byte(0);
+                as.setcc(A::CC_E, A::RAX);
+                storeBool(in.a);
+                break;
+            case Opcode::I2F:
+                as.mem({0x0F, 0x2A}, 0, A::RBX, slot(in.b), true, 0xF2); // cvtsi2sd
+                as.mem({0x0F, 0x11}, 0, A::RBX, slot(in.a), false, 0xF2);
+                break;
+            case Opcode::F2I:
+                as.mem({0x0F, 0x2C}, A::RAX, A::RBX, slot(in.b), true, 0xF2); // cvttsd2si
+                store(in.a, A::RAX);
+                break;
+            case Opcode::LOADG:
+                as.mem({0x8B}, A::RAX, A::R14, slot(in.b));
+                store(in.a, A::RAX);
+                break;
+            case Opcode::STOREG:
+                load(A::RAX, in.a);
+                as.mem({0x89}, A::RAX, A::R14, slot(in.b));
+                break;
+            case Opcode::ALOAD:
+            case Opcode::ALOADNC:
+                load(A::RDX, in.b);
+                load(A::RCX, in.c);
+                if (in.op == Opcode::ALOAD)
+                {
+                    // Array nulo (variável escalar indexada): o interpretador reporta
+                    as.rr({0x85}, A::RDX, A::RDX);
+                    exits.push_back({as.jcc(A::CC_E), pc});
+                    // Sem sinal: um índice negativo também fica acima do tamanho
+                    as.mem({0x3B}, A::RCX, A::RDX, (int32_t)offsetof(ArrayObj, length));
+                    exits.push_back({as.jcc(A::CC_AE), pc});
+                }
+                as.mem({0x8B}, A::RDX, A::RDX, (int32_t)offsetof(ArrayObj, items));
+                as.byte(0x48); // mov rax, [rdx + rcx*8]
+                as.byte(0x8B);
+                as.byte(0x04);
+                as.byte(0xCA);
+                store(in.a, A::RAX);
+                break;
+            case Opcode::ASTORE:
+            case Opcode::ASTORENC:
+                load(A::RDX, in.a);
+                load(A::RCX, in.b);
+                if (in.op == Opcode::ASTORE)
+                {
+                    as.rr({0x85}, A::RDX, A::RDX);
+                    exits.push_back({as.jcc(A::CC_E), pc});
+                    as.mem({0x3B}, A::RCX, A::RDX, (int32_t)offsetof(ArrayObj, length));
+                    exits.push_back({as.jcc(A::CC_AE), pc});
+                }
+                as.mem({0x8B}, A::RDX, A::RDX, (int32_t)offsetof(ArrayObj, items));
+                load(A::RAX, in.c);
+                as.byte(0x48); // mov [rdx + rcx*8], rax
+                as.byte(0x89);
+                as.byte(0x04);
+                as.byte(0xCA);
+                break;
+            case Opcode::CALL:
+                callHelper(call_, pc);
+                as.mem({0x8B}, A::RBX, A::R15, (int32_t)offsetof(JitFrame, R));
+                as.rr({0x85}, A::RAX, A::RAX, false);
+                toEpilogue.push_back(as.jcc(A::CC_NE)); // eax = JIT_EXCEPTION
+                break;
+            case Opcode::PRINTI:
+            case Opcode::PRINTF:
+            case Opcode::PRINTC:
+            case Opcode::PRINTB:
+                callHelper(print_, pc);
+                break;
+            case Opcode::RET:
+                load(A::RAX, in.a);
+                as.mem({0x89}, A::RAX, A::R15, (int32_t)offsetof(JitFrame, result));
+                as.movImm32(A::RAX, JIT_RETURNED);
+                toEpilogue.push_back(as.jmp());
+                break;
+            case Opcode::RETV:
+                as.mem({0xC7}, 0, A::R15, (int32_t)offsetof(JitFrame, result));
+                as.u32(0);
+                as.movImm32(A::RAX, JIT_RETURNED);
+                toEpilogue.push_back(as.jmp());
+                break;
+            case Opcode::JMP:
+                jumps.push_back({as.jmp(), in.a});
+                break;
+            case Opcode::JT:
+            case Opcode::JF:
+                as.mem({0x83}, 7, A::RBX, slot(in.a));
+                as.byte(0);
+                jumps.push_back({as.jcc(in.op == Opcode::JT ? A::CC_NE : A::CC_E), in.b});
+                break;
+            default:
+                exitTo(pc);
+            }
+        }
+
+        // Saídas das verificações (divisão por zero, limites), fora do
+        // caminho principal
+        for (auto &e : exits)
+        {
+            as.patch(e.first, as.size());
+            exitTo(e.second);
+        }
+        size_t epilogue = as.size();
+        as.pop(A::R15);
+        as.pop(A::R14);
+        as.pop(A::R12);
+        as.pop(A::RBX);
+        as.pop(A::RBP);
+        as.byte(0xC3);
+        for (size_t at : toEpilogue)
+            as.patch(at, epilogue);
+        for (auto &j : jumps)
+            as.patch(j.first, offsets[j.second - fn.codeStart]);
+
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t mapped = (as.size() + page - 1) / page * page;
+        void *mem = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+            return false;
+        std::memcpy(mem, as.bytes.data(), as.size());
+        if (mprotect(mem, mapped, PROT_READ | PROT_EXEC) != 0)
+        {
+            munmap(mem, mapped);
+            return false;
+        }
+        Native &n = native_[fidx];
+        n.code = (uint8_t *)mem;
+        n.size = as.size();
+        n.mapped = mapped;
+        n.offsets = std::move(offsets);
+        return true;
+#else
+        (void)fidx;
+        return false;
+#endif
+    }
+};
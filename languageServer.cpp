@@ -0,0 +1,842 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "analyzer.cpp"
+#include "incrementalLexer.cpp"
+
+// ===============================
+//  JSON mínimo para o protocolo
+// ===============================
+struct JsonValue
+{
+    enum class Kind
+    {
+        NUL,
+        BOOL,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Kind kind = Kind::NUL;
+    bool boolean = false;
+    double number = 0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> fields;
+
+    const JsonValue &operator[](const std::string &key) const
+    {
+        static const JsonValue missing;
+        for (auto &f : fields)
+            if (f.first == key)
+                return f.second;
+        return missing;
+    }
+
+    bool isNull() const
+    {
+        return kind == Kind::NUL;
+    }
+
+    int asInt() const
+    {
+        return (int)number;
+    }
+};
+
+class JsonParser
+{
+public:
+    explicit JsonParser(const std::string &text)
+        : text_(text), pos_(0) {}
+
+    JsonValue parse()
+    {
+        JsonValue v = value();
+        skipSpace();
+        if (pos_ != text_.size())
+            fail();
+        return v;
+    }
+
+private:
+    const std::string &text_;
+    size_t pos_;
+
+    [[noreturn]] void fail() const
+    {
+        throw std::runtime_error("JSON invalido na posicao " + std::to_string(pos_));
+    }
+
+    void skipSpace()
+    {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                       text_[pos_] == '\n' || text_[pos_] == '\r'))
+            ++pos_;
+    }
+
+    bool consume(const char *word)
+    {
+        size_t n = std::strlen(word);
+        if (text_.compare(pos_, n, word) != 0)
+            return false;
+        pos_ += n;
+        return true;
+    }
+
+    JsonValue value()
+    {
+        skipSpace();
+        if (pos_ >= text_.size())
+            fail();
+        JsonValue v;
+        char c = text_[pos_];
+        if (c == '{')
+        {
+            v.kind = JsonValue::Kind::OBJECT;
+            ++pos_;
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == '}')
+            {
+                ++pos_;
+                return v;
+            }
+            while (true)
+            {
+                skipSpace();
+                std::string key = string();
+                skipSpace();
+                if (pos_ >= text_.size() || text_[pos_++] != ':')
+                    fail();
+                v.fields.push_back({key, value()});
+                skipSpace();
+                if (pos_ < text_.size() && text_[pos_] == ',')
+                {
+                    ++pos_;
+                    continue;
+                }
+                if (pos_ < text_.size() && text_[pos_] == '}')
+                {
+                    ++pos_;
+                    return v;
+                }
+                fail();
+            }
+        }
+        if (c == '[')
+        {
+            v.kind = JsonValue::Kind::ARRAY;
+            ++pos_;
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ']')
+            {
+                ++pos_;
+                return v;
+            }
+            while (true)
+            {
+                v.items.push_back(value());
+                skipSpace();
+                if (pos_ < text_.size() && text_[pos_] == ',')
+                {
+                    ++pos_;
+                    continue;
+                }
+                if (pos_ < text_.size() && text_[pos_] == ']')
+                {
+                    ++pos_;
+                    return v;
+                }
+                fail();
+            }
+        }
+        if (c == '"')
+        {
+            v.kind = JsonValue::Kind::STRING;
+            v.text = string();
+            return v;
+        }
+        if (consume("true") || consume("false"))
+        {
+            v.kind = JsonValue::Kind::BOOL;
+            v.boolean = c == 't';
+            return v;
+        }
+        if (consume("null"))
+            return v;
+        size_t start = pos_;
+        while (pos_ < text_.size() && (std::isdigit((unsigned char)text_[pos_]) || text_[pos_] == '-' ||
+                                       text_[pos_] == '+' || text_[pos_] == '.' || text_[pos_] == 'e' ||
+                                       text_[pos_] == 'E'))
+            ++pos_;
+        if (start == pos_)
+            fail();
+        v.kind = JsonValue::Kind::NUMBER;
+        v.number = std::strtod(text_.c_str() + start, nullptr);
+        return v;
+    }
+
+    std::string string()
+    {
+        if (pos_ >= text_.size() || text_[pos_] != '"')
+            fail();
+        ++pos_;
+        std::string out;
+        while (pos_ < text_.size() && text_[pos_] != '"')
+        {
+            char c = text_[pos_++];
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size())
+                fail();
+            char e = text_[pos_++];
+            switch (e)
+            {
+            case 'n':
+                out += '\n';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'u':
+            {
+                if (pos_ + 4 > text_.size())
+                    fail();
+                unsigned cp = (unsigned)std::stoul(text_.substr(pos_, 4), nullptr, 16);
+                pos_ += 4;
+                // Pares substitutos UTF-16
+                if (cp >= 0xD800 && cp <= 0xDBFF && text_.compare(pos_, 2, "\\u") == 0 && pos_ + 6 <= text_.size())
+                {
+                    unsigned lo = (unsigned)std::stoul(text_.substr(pos_ + 2, 4), nullptr, 16);
+                    pos_ += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                out += e;
+            }
+        }
+        if (pos_ >= text_.size())
+            fail();
+        ++pos_;
+        return out;
+    }
+
+    static void appendUtf8(std::string &out, unsigned cp)
+    {
+        if (cp < 0x80)
+            out += (char)cp;
+        else if (cp < 0x800)
+        {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+};
+
+static std::string jsonQuote(const std::string &s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                out += buf;
+            }
+            else
+                out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Reescreve um valor JSON (usado para devolver o `id` da requisição)
+static std::string jsonWrite(const JsonValue &v)
+{
+    switch (v.kind)
+    {
+    case JsonValue::Kind::BOOL:
+        return v.boolean ? "true" : "false";
+    case JsonValue::Kind::NUMBER:
+    {
+        std::ostringstream ss;
+        ss << v.number;
+        return ss.str();
+    }
+    case JsonValue::Kind::STRING:
+        return jsonQuote(v.text);
+    case JsonValue::Kind::ARRAY:
+    {
+        std::string out = "[";
+        for (size_t k = 0; k < v.items.size(); ++k)
+            out += (k ? "," : "") + jsonWrite(v.items[k]);
+        return out + "]";
+    }
+    case JsonValue::Kind::OBJECT:
+    {
+        std::string out = "{";
+        for (size_t k = 0; k < v.fields.size(); ++k)
+            out += (k ? "," : "") + jsonQuote(v.fields[k].first) + ":" + jsonWrite(v.fields[k].second);
+        return out + "}";
+    }
+    default:
+        return "null";
+    }
+}
+
+// ===============================
+//  Servidor de linguagem (LSP)
+// ===============================
+// Maior corpo de mensagem aceito (Content-Length acima disso é ignorado)
+const size_t LSP_MAX_MESSAGE_BYTES = 64 << 20;
+// Edições seguidas só em espaços ou comentários aplicadas como deslocamento
+// antes de a análise ser refeita
+const size_t LSP_MAX_PENDING_SHIFTS = 256;
+
+// Fala o Language Server Protocol via stdio. Cada documento aberto mantém
+// em memória os tokens (re-analisados incrementalmente a cada edição), a
+// tabela de símbolos com o índice de referências cruzadas e um índice de
+// declarações; hover, definição e referências são respondidos só com
+// consultas a esses índices. A análise sintática é refeita sobre os tokens
+// residentes, sem passar o lexer pelo texto de novo, e é dispensada quando a
+// edição não muda nenhum token (espaços, comentários): os offsets guardados
+// são só deslocados. As colunas do protocolo contam unidades UTF-16
+// (o padrão do LSP) e são convertidas de e para offsets em bytes; se o
+// cliente aceitar, `initialize` negocia "utf-8" e elas passam a ser bytes.
+class LanguageServer
+{
+public:
+    LanguageServer(std::istream &in, std::ostream &out)
+        : in_(in), out_(out) {}
+
+    // Processa mensagens até `exit`; retorna o código de saída do processo
+    int run()
+    {
+        std::string body;
+        while (readMessage(body))
+        {
+            JsonValue msg;
+            try
+            {
+                msg = JsonParser(body).parse();
+            }
+            catch (const std::exception &e)
+            {
+                sendError("null", -32700, e.what());
+                continue;
+            }
+            std::string method = msg["method"].text;
+            if (method == "exit")
+                return shutdown_ ? 0 : 1;
+            handle(method, msg);
+        }
+        return shutdown_ ? 0 : 1;
+    }
+
+private:
+    struct Declaration
+    {
+        size_t offset;
+        size_t length;
+    };
+
+    struct Document
+    {
+        std::string text;
+        LineIndex lines;
+        std::unique_ptr<IncrementalLexer> lexer; // nulo enquanto houver erro léxico
+        // Resultado da última análise; vazio e `analyzed` falso enquanto o
+        // texto tiver erro. Os offsets são os do texto analisado, corrigidos
+        // por `shifts` (início do trecho deslocado, deslocamento)
+        bool analyzed = false;
+        SymbolTable symtab;
+        std::map<std::string, Declaration> declarations;
+        std::vector<std::pair<size_t, long long>> shifts;
+    };
+
+    std::istream &in_;
+    std::ostream &out_;
+    std::map<std::string, Document> documents_;
+    bool shutdown_ = false;
+    bool utf16_ = true; // colunas em unidades UTF-16 (false: em bytes)
+
+    // ---------- transporte ----------
+    bool readMessage(std::string &body)
+    {
+        size_t length = 0;
+        bool haveLength = false;
+        std::string header;
+        while (std::getline(in_, header))
+        {
+            if (!header.empty() && header.back() == '\r')
+                header.pop_back();
+            if (header.empty())
+            {
+                if (haveLength)
+                    break;
+                continue;
+            }
+            const std::string key = "Content-Length:";
+            if (header.compare(0, key.size(), key) == 0)
+            {
+                // Sem um tamanho válido o corpo não tem como ser delimitado:
+                // a mensagem é ignorada e a leitura segue até o próximo cabeçalho
+                try
+                {
+                    length = (size_t)std::stoul(header.substr(key.size()));
+                    if (length > LSP_MAX_MESSAGE_BYTES)
+                        throw std::out_of_range("Content-Length");
+                    haveLength = true;
+                }
+                catch (const std::logic_error &)
+                {
+                    std::cerr << "Cabecalho invalido, mensagem ignorada: " << header << "\n";
+                    haveLength = false;
+                }
+            }
+        }
+        if (!haveLength)
+            return false;
+        body.assign(length, '\0');
+        in_.read(&body[0], (std::streamsize)length);
+        return (size_t)in_.gcount() == length;
+    }
+
+    void send(const std::string &json)
+    {
+        out_ << "Content-Length: " << json.size() << "\r\n\r\n"
+             << json;
+        out_.flush();
+    }
+
+    void sendResult(const std::string &id, const std::string &result)
+    {
+        send("{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":" + result + "}");
+    }
+
+    void sendError(const std::string &id, int code, const std::string &message)
+    {
+        send("{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"error\":{\"code\":" + std::to_string(code) +
+             ",\"message\":" + jsonQuote(message) + "}}");
+    }
+
+    // ---------- despacho ----------
+    void handle(const std::string &method, const JsonValue &msg)
+    {
+        const JsonValue &params = msg["params"];
+        bool isRequest = !msg["id"].isNull();
+        std::string id = jsonWrite(msg["id"]);
+
+        if (method == "initialize")
+        {
+            // Colunas em bytes só se o cliente as aceitar; senão, UTF-16
+            utf16_ = true;
+            for (auto &encoding : params["capabilities"]["general"]["positionEncodings"].items)
+                if (encoding.text == "utf-8")
+                    utf16_ = false;
+            sendResult(id, std::string("{\"capabilities\":{\"positionEncoding\":") +
+                               (utf16_ ? "\"utf-16\"" : "\"utf-8\"") +
+                               ",\"textDocumentSync\":2,\"hoverProvider\":true,"
+                               "\"definitionProvider\":true,\"referencesProvider\":true},"
+                               "\"serverInfo\":{\"name\":\"CangaCompiler\"}}");
+        }
+        else if (method == "shutdown")
+        {
+            shutdown_ = true;
+            sendResult(id, "null");
+        }
+        else if (method == "textDocument/didOpen")
+        {
+            const JsonValue &doc = params["textDocument"];
+            open(doc["uri"].text, doc["text"].text);
+        }
+        else if (method == "textDocument/didChange")
+        {
+            change(params["textDocument"]["uri"].text, params["contentChanges"]);
+        }
+        else if (method == "textDocument/didClose")
+        {
+            documents_.erase(params["textDocument"]["uri"].text);
+        }
+        else if (method == "textDocument/hover")
+        {
+            sendResult(id, hover(params));
+        }
+        else if (method == "textDocument/definition")
+        {
+            sendResult(id, definition(params));
+        }
+        else if (method == "textDocument/references")
+        {
+            sendResult(id, references(params));
+        }
+        else if (isRequest)
+        {
+            sendError(id, -32601, "Metodo nao suportado: " + method);
+        }
+    }
+
+    // ---------- documentos ----------
+    void open(const std::string &uri, const std::string &text)
+    {
+        Document &doc = documents_[uri];
+        doc.text = text;
+        doc.lexer.reset();
+        refresh(uri, doc, nullptr);
+    }
+
+    void change(const std::string &uri, const JsonValue &changes)
+    {
+        auto it = documents_.find(uri);
+        if (it == documents_.end())
+            return;
+        Document &doc = it->second;
+        for (auto &c : changes.items)
+        {
+            if (c["range"].isNull())
+            {
+                doc.text = c["text"].text;
+                doc.lexer.reset();
+                refresh(uri, doc, nullptr);
+                continue;
+            }
+            TextEdit edit;
+            edit.offset = offsetOf(doc, c["range"]["start"]);
+            edit.removed = offsetOf(doc, c["range"]["end"]) - edit.offset;
+            edit.inserted = c["text"].text;
+            doc.text.replace(edit.offset, edit.removed, edit.inserted);
+            refresh(uri, doc, &edit);
+        }
+    }
+
+    // Atualiza tokens, tabela de símbolos e índices após uma mudança no texto
+    void refresh(const std::string &uri, Document &doc, const TextEdit *edit)
+    {
+        if (edit)
+            doc.lines.replace(edit->offset, edit->removed, edit->inserted);
+        else
+            doc.lines = LineIndex(doc.text);
+
+        std::string diagnostic;
+        int diagnosticLine = 1;
+        try
+        {
+            if (doc.lexer && edit)
+                doc.lexer->applyEdit(*edit);
+            else
+                doc.lexer.reset(new IncrementalLexer(doc.text));
+        }
+        catch (const std::runtime_error &e)
+        {
+            // Com erro léxico as consultas ficam sem resposta até o texto voltar a ser válido
+            doc.lexer.reset();
+            diagnostic = e.what();
+        }
+
+        // Nenhum token mudou: a análise continua valendo, deslocada (os
+        // diagnósticos, vazios, também)
+        if (doc.lexer && edit && doc.analyzed && doc.lexer->lastKeptTokens() &&
+            doc.shifts.size() < LSP_MAX_PENDING_SHIFTS)
+        {
+            doc.shifts.push_back({edit->offset + edit->removed,
+                                  (long long)edit->inserted.size() - (long long)edit->removed});
+            return;
+        }
+
+        // Com erro as consultas ficam sem resposta, em vez de usar a tabela antiga
+        doc.analyzed = false;
+        doc.symtab = SymbolTable();
+        doc.declarations.clear();
+        doc.shifts.clear();
+        if (doc.lexer)
+        {
+            SymbolTable symtab;
+            LexemeList lexemes;
+            try
+            {
+                symtab.lines() = doc.lines;
+                TokenCursor tokens(doc.lexer->tokens(), doc.lines);
+                analyzeTokens(tokens, symtab, lexemes, AnalysisLimits(), nullptr);
+                doc.symtab = std::move(symtab);
+                indexDeclarations(doc);
+                doc.analyzed = true;
+            }
+            catch (const std::runtime_error &e)
+            {
+                diagnostic = e.what();
+            }
+        }
+        if (!diagnostic.empty())
+        {
+            size_t at = diagnostic.find("linha ");
+            if (at != std::string::npos)
+                diagnosticLine = std::max(1, std::atoi(diagnostic.c_str() + at + 6));
+        }
+        publishDiagnostics(uri, doc, diagnostic, diagnosticLine);
+    }
+
+    // Índice de declarações: variáveis (varType), parâmetros (paramType) e
+    // funções (FUNCTYPE), a partir dos tokens residentes
+    void indexDeclarations(Document &doc)
+    {
+        doc.declarations.clear();
+        const std::vector<Token> &toks = doc.lexer->tokens();
+        for (size_t k = 0; k < toks.size(); ++k)
+        {
+            TokenType t = toks[k].type;
+            if (t == TokenType::FUNCTYPE)
+            {
+                // FUNCTYPE <tipo> [ '[' ']' ] ':' <nome>
+                size_t j = k + 1;
+                while (j < toks.size() && toks[j].type != TokenType::COLON &&
+                       toks[j].type != TokenType::END_OF_FILE)
+                    ++j;
+                if (j + 1 < toks.size() && toks[j + 1].type == TokenType::IDENT)
+                    declare(doc, toks[j + 1]);
+            }
+            else if (t == TokenType::VARTYPE || t == TokenType::PARAMTYPE)
+            {
+                // Identificadores até ';' (varType) ou até o próximo grupo de parâmetros
+                size_t j = k + 1;
+                int depth = 0;
+                for (; j < toks.size(); ++j)
+                {
+                    TokenType u = toks[j].type;
+                    if (u == TokenType::SEMI || u == TokenType::RPAREN || u == TokenType::PARAMTYPE ||
+                        u == TokenType::VARTYPE || u == TokenType::END_OF_FILE)
+                        break;
+                    if (u == TokenType::LBRACK)
+                        ++depth;
+                    else if (u == TokenType::RBRACK)
+                        --depth;
+                    else if (u == TokenType::IDENT && depth == 0)
+                        declare(doc, toks[j]);
+                }
+            }
+        }
+    }
+
+    static void declare(Document &doc, const Token &tok)
+    {
+        std::string key(std::string_view(tok.lexeme).substr(0, SymbolTable::MAX_LEXEME));
+        if (!doc.declarations.count(key))
+            doc.declarations[key] = {tok.offset, tok.length};
+    }
+
+    void publishDiagnostics(const std::string &uri, const Document &doc, const std::string &message, int line)
+    {
+        std::string diags = "[]";
+        if (!message.empty())
+            diags = "[{\"range\":" + range(doc, doc.lines.lineStart(line), 0) + ",\"severity\":1,\"source\":\"CangaCompiler\",\"message\":" +
+                    jsonQuote(message) + "}]";
+        send("{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\",\"params\":{\"uri\":" +
+             jsonQuote(uri) + ",\"diagnostics\":" + diags + "}}");
+    }
+
+    // ---------- posições ----------
+    // Offset no texto de uma posição do protocolo (linha e coluna a partir de 0)
+    size_t offsetOf(const Document &doc, const JsonValue &pos) const
+    {
+        int line = std::max(0, pos["line"].asInt()) + 1;
+        if (line > doc.lines.lineCount())
+            return doc.text.size();
+        size_t at = doc.lines.lineStart(line), end = doc.lines.lineStart(line + 1);
+        size_t character = (size_t)std::max(0, pos["character"].asInt());
+        if (!utf16_)
+            return std::min(at + character, end);
+        // Caracteres de 4 bytes em UTF-8 ocupam duas unidades em UTF-16
+        for (size_t units = 0; units < character && at < end && doc.text[at] != '\n';)
+        {
+            unsigned char lead = (unsigned char)doc.text[at];
+            units += lead >= 0xF0 ? 2 : 1;
+            at += lead < 0xC0 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+        }
+        return std::min(at, end);
+    }
+
+    // Posição do protocolo de um offset no texto
+    std::string position(const Document &doc, size_t offset) const
+    {
+        SourcePosition at = doc.lines.position(offset);
+        size_t character = (size_t)at.column - 1;
+        if (utf16_)
+        {
+            character = 0;
+            for (size_t k = offset - ((size_t)at.column - 1); k < offset; ++k)
+            {
+                unsigned char c = (unsigned char)doc.text[k];
+                if ((c & 0xC0) != 0x80)
+                    character += c >= 0xF0 ? 2 : 1;
+            }
+        }
+        return "{\"line\":" + std::to_string(at.line - 1) + ",\"character\":" + std::to_string(character) + "}";
+    }
+
+    std::string range(const Document &doc, size_t offset, size_t length) const
+    {
+        return "{\"start\":" + position(doc, offset) + ",\"end\":" + position(doc, offset + length) + "}";
+    }
+
+    std::string location(const std::string &uri, const Document &doc, size_t offset, size_t length) const
+    {
+        return "{\"uri\":" + jsonQuote(uri) + ",\"range\":" + range(doc, offset, length) + "}";
+    }
+
+    // Offset no texto atual de um offset do texto analisado
+    static size_t current(const Document &doc, size_t offset)
+    {
+        for (auto &shift : doc.shifts)
+            if (offset >= shift.first)
+                offset = (size_t)((long long)offset + shift.second);
+        return offset;
+    }
+
+    // ---------- consultas ----------
+    // Identificador sob a posição da requisição (nulo se não houver)
+    const Token *identifierAt(const JsonValue &params, const Document **docOut)
+    {
+        auto it = documents_.find(params["textDocument"]["uri"].text);
+        if (it == documents_.end() || !it->second.analyzed)
+            return nullptr;
+        const Document &doc = it->second;
+        *docOut = &doc;
+        size_t offset = offsetOf(doc, params["position"]);
+        const std::vector<Token> &toks = doc.lexer->tokens();
+        auto t = std::upper_bound(toks.begin(), toks.end(), offset,
+                                  [](size_t off, const Token &tok)
+                                  { return off < tok.offset; });
+        if (t == toks.begin())
+            return nullptr;
+        --t;
+        // Cursor imediatamente após o identificador também conta
+        if (t->type != TokenType::IDENT && t != toks.begin() && t->offset == offset)
+            --t;
+        if (t->type != TokenType::IDENT || offset > t->offset + t->length)
+            return nullptr;
+        return &*t;
+    }
+
+    std::string hover(const JsonValue &params)
+    {
+        const Document *doc = nullptr;
+        const Token *tok = identifierAt(params, &doc);
+        if (!tok)
+            return "null";
+        const SymbolTable::SymbolInfo *found = doc->symtab.find(tok->lexeme);
+        if (!found)
+            return "null";
+        const SymbolTable::SymbolInfo &info = *found;
+        std::string text = "**" + std::string(info.lexeme) + "** — TipoSimb: `" + std::string(info.type) + "`";
+        if (info.arraySize > 0)
+            text += ", tamanho " + std::to_string(info.arraySize);
+        text += " (entrada " + std::to_string(info.entry) + ")";
+        return "{\"contents\":{\"kind\":\"markdown\",\"value\":" + jsonQuote(text) + "},\"range\":" +
+               range(*doc, tok->offset, tok->length) + "}";
+    }
+
+    std::string definition(const JsonValue &params)
+    {
+        const Document *doc = nullptr;
+        const Token *tok = identifierAt(params, &doc);
+        if (!tok)
+            return "null";
+        std::string key(std::string_view(tok->lexeme).substr(0, SymbolTable::MAX_LEXEME));
+        std::string uri = params["textDocument"]["uri"].text;
+        auto d = doc->declarations.find(key);
+        if (d != doc->declarations.end())
+            return location(uri, *doc, current(*doc, d->second.offset), d->second.length);
+        // Sem declaração explícita: primeira ocorrência registrada
+        auto uses = doc->symtab.crossReference().uses(doc->symtab.getIndex(key));
+        if (uses.empty())
+            return "null";
+        return location(uri, *doc, current(*doc, uses[0]), tok->length);
+    }
+
+    std::string references(const JsonValue &params)
+    {
+        const Document *doc = nullptr;
+        const Token *tok = identifierAt(params, &doc);
+        if (!tok)
+            return "null";
+        std::string key(std::string_view(tok->lexeme).substr(0, SymbolTable::MAX_LEXEME));
+        std::string uri = params["textDocument"]["uri"].text;
+        bool includeDeclaration = params["context"]["includeDeclaration"].boolean;
+        auto d = doc->declarations.find(key);
+
+        std::string out = "[";
+        bool first = true;
+        auto add = [&](size_t offset, size_t length)
+        {
+            out += (first ? "" : ",") + location(uri, *doc, offset, length);
+            first = false;
+        };
+        bool declarationSeen = false;
+        for (size_t offset : doc->symtab.crossReference().uses(doc->symtab.getIndex(key)))
+        {
+            bool isDeclaration = d != doc->declarations.end() && d->second.offset == offset;
+            declarationSeen |= isDeclaration;
+            if (isDeclaration && !includeDeclaration)
+                continue;
+            add(current(*doc, offset), tok->length);
+        }
+        if (includeDeclaration && !declarationSeen && d != doc->declarations.end())
+            add(current(*doc, d->second.offset), d->second.length);
+        return out + "]";
+    }
+};
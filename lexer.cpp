@@ -1,30 +1,254 @@
+#pragma once
 #include <string>
 #include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
 #include "token.cpp"
+#include "utf8.cpp"
+#include "lineIndex.cpp"
 #include <stdexcept>
+#include <algorithm>
+
+// Limites de recursos da análise, para que uma entrada hostil ou gerada não
+// trave o compilador
+struct AnalysisLimits
+{
+    size_t maxTokens = 10000000;       // tokens lidos, incluindo releituras após putBackToken
+    int maxNestingDepth = 1000;        // chaves, parênteses e contextos aninhados
+    size_t maxIdentifierLength = 4096; // caracteres de um identificador
+};
+
+// Classes de caracteres por tabela: std::isalpha e afins recebem int e têm
+// comportamento indefinido para bytes negativos (acentos em UTF-8), além de
+// depender do locale. Só letras, dígitos e '_' ASCII formam identificadores.
+struct CharClass
+{
+    enum : uint8_t
+    {
+        ALPHA = 1,
+        DIGIT = 2
+    };
+
+    static const uint8_t *table()
+    {
+        static const struct Table
+        {
+            uint8_t v[256];
+            Table() : v()
+            {
+                for (int c = 'A'; c <= 'Z'; ++c)
+                    v[c] = v[c + ('a' - 'A')] = ALPHA;
+                v[(unsigned char)'_'] = ALPHA;
+                for (int c = '0'; c <= '9'; ++c)
+                    v[c] = DIGIT;
+            }
+        } t;
+        return t.v;
+    }
+
+    // Letra ou '_': início de identificador
+    static bool identStart(char c)
+    {
+        return table()[(unsigned char)c] & ALPHA;
+    }
+
+    static bool identChar(char c)
+    {
+        return table()[(unsigned char)c] != 0;
+    }
+
+    static bool digit(char c)
+    {
+        return table()[(unsigned char)c] & DIGIT;
+    }
+
+    static char upper(char c)
+    {
+        return c >= 'a' && c <= 'z' ? (char)(c - ('a' - 'A')) : c;
+    }
+};
 
 class Lexer
 {
 public:
-    Lexer(const std::string &src)
-        : src_(src), pos_(0), line_(1) {}
+    // O texto não é copiado: deve permanecer vivo enquanto o lexer for usado.
+    // O UTF-8 é validado por inteiro aqui; um erro só é reportado quando a
+    // análise chega ao byte inválido. Linhas vêm de `lines` (índice do mesmo
+    // texto) ou, sem ele, de um índice montado na primeira vez que uma linha
+    // é pedida.
+    explicit Lexer(const std::string &src, const LineIndex *lines = nullptr)
+        : src_(src), pos_(0), lines_(lines),
+          utf8_(scanUtf8(src.data(), src.size())), validatedTo_(src.size()) {}
+
+    // Retoma a análise a partir de `pos`, que deve ser uma fronteira entre
+    // tokens (fim de um token ou início do texto). Como a re-análise costuma
+    // parar logo, aqui o UTF-8 é validado aos poucos, à frente da posição.
+    // `base` é o offset de `src` dentro do texto indexado por `lines`.
+    Lexer(const std::string &src, size_t pos, const LineIndex *lines, size_t base = 0)
+        : src_(src), pos_(pos), base_(base), lines_(lines),
+          validatedTo_(std::min(pos, src.size())) {}
+
+    // Resultado da validação (do trecho já validado, no modo de retomada):
+    // texto só ASCII e posição do primeiro byte inválido
+    const Utf8Scan &utf8() const
+    {
+        return utf8_;
+    }
+
+    void setLimits(const AnalysisLimits &limits)
+    {
+        limits_ = limits;
+    }
+
+    // Recurso de memória dos lexemas dos tokens (deve viver mais que eles)
+    void setMemoryResource(std::pmr::memory_resource *resource)
+    {
+        resource_ = resource;
+    }
+
+    std::pmr::memory_resource *memoryResource() const
+    {
+        return resource_;
+    }
+
+    // Tokens entregues até agora (tokens devolvidos e relidos contam de novo)
+    size_t tokensRead() const
+    {
+        return tokensRead_;
+    }
+
+    // Posição atual no texto
+    size_t position() const
+    {
+        return pos_;
+    }
+
+    // Índice de linhas do texto
+    const LineIndex &lines() const
+    {
+        if (!lines_)
+        {
+            ownLines_.reset(new LineIndex(src_));
+            lines_ = ownLines_.get();
+        }
+        return *lines_;
+    }
+
+    // Linha da posição atual
+    int line() const
+    {
+        return lineAt(pos_);
+    }
+
+    // Linha do início do token
+    int lineOf(const Token &tok) const
+    {
+        return lineAt(tok.offset);
+    }
+
+    // Salta para `pos`, fronteira entre tokens já analisada por outro lexer
+    // sobre o mesmo texto, contando os `tokens` que ele leu até ali
+    void skipTo(size_t pos, size_t tokens)
+    {
+        pos_ = pos;
+        tokensRead_ += tokens;
+    }
 
     Token nextToken()
     {
+        if (++tokensRead_ > limits_.maxTokens)
+            throw std::runtime_error("Erro na linha " + std::to_string(line()) +
+                                     ": Limite de " + std::to_string(limits_.maxTokens) + " tokens excedido");
 
         skipWhitespaceAndComments();
 
+        size_t start = pos_;
+        Token tok = scanToken();
+
+        // Texto só ASCII não tem o que verificar; nos demais, comentários e
+        // literais passam os bytes adiante e o erro aparece se o token (ou o
+        // comentário antes dele) atravessou uma sequência inválida
+        if (pos_ > validatedTo_)
+            validateUpTo(pos_);
+        if (!utf8_.ascii && pos_ > utf8_.errorOffset)
+            throw invalidUtf8();
+
+        tok.offset = start;
+        tok.length = pos_ - start;
+        return tok;
+    }
+
+    // Volta ao início do token
+    void putBackToken(const Token& tok)
+    {
+        pos_ = tok.offset;
+    }
+
+private:
+    const std::string &src_;
+    size_t pos_;
+    size_t base_ = 0;
+    mutable const LineIndex *lines_;
+    mutable std::unique_ptr<LineIndex> ownLines_; // sem índice externo
+    AnalysisLimits limits_;
+    size_t tokensRead_ = 0;
+    Utf8Scan utf8_;
+    size_t validatedTo_; // fim do trecho já validado (fronteira de caractere)
+    std::pmr::memory_resource *resource_ = std::pmr::get_default_resource();
+
+    int lineAt(size_t pos) const
+    {
+        return lines().line(base_ + pos);
+    }
+
+    std::pmr::string slice(size_t start, size_t length) const
+    {
+        return std::pmr::string(src_.data() + start, length, resource_);
+    }
+
+    void validateUpTo(size_t target)
+    {
+        const size_t CHUNK = 4096;
+        size_t end = std::min(std::max(target, validatedTo_ + CHUNK), src_.size());
+        while (end < src_.size() && ((unsigned char)src_[end] & 0xC0) == 0x80)
+            ++end;
+        Utf8Scan part = scanUtf8(src_.data(), end, validatedTo_);
+        utf8_.ascii = utf8_.ascii && part.ascii;
+        if (!part.valid() && utf8_.valid())
+        {
+            utf8_.errorOffset = part.errorOffset;
+            end = src_.size(); // o primeiro erro já basta
+        }
+        validatedTo_ = end;
+    }
+
+    std::runtime_error invalidUtf8() const
+    {
+        return std::runtime_error("Erro na linha " + std::to_string(lineAt(utf8_.errorOffset)) +
+                                  ": Sequencia UTF-8 invalida (byte 0x" + hexByte(src_[utf8_.errorOffset]) + ")");
+    }
+
+    static std::string hexByte(char c)
+    {
+        static const char digits[] = "0123456789ABCDEF";
+        unsigned char b = (unsigned char)c;
+        return {digits[b >> 4], digits[b & 0x0F]};
+    }
+
+    Token scanToken()
+    {
         if (pos_ >= src_.size())
-            return {TokenType::END_OF_FILE, "", line_};
+            return {TokenType::END_OF_FILE, ""};
 
         char c = src_[pos_];
 
         // Identificadores ou palavras-chave
-        if (std::isalpha(c) || c == '_')
+        if (CharClass::identStart(c))
             return identifierOrKeyword();
 
         // Números
-        if (std::isdigit(c))
+        if (CharClass::digit(c))
             return number();
 
         // Literais de string ou char
@@ -35,49 +259,26 @@ public:
         return symbol();
     }
 
-    void putBackToken(const Token& tok)
-    {
-        pos_ -= tok.lexeme.size();
-    }
-
-private:
-    const std::string src_;
-    size_t pos_;
-    int line_;
-
+    // Linhas não são contadas aqui: comentários são pulados com find
     void skipWhitespaceAndComments()
     {
         while (pos_ < src_.size())
         {
-            if (src_[pos_] == ' ' || src_[pos_] == '\t' || src_[pos_] == '\r')
-            {
-                ++pos_;
-            }
-            else if (src_[pos_] == '\n')
+            char c = src_[pos_];
+            if (c == ' ' || c == '\n' || c == '\t' || c == '\r')
             {
                 ++pos_;
-                ++line_;
             }
-            else if (src_[pos_] == '/' && pos_ + 1 < src_.size())
+            else if (c == '/' && pos_ + 1 < src_.size())
             {
                 if (src_[pos_ + 1] == '/')
                 { // comentário de linha
-                    pos_ += 2;
-                    while (pos_ < src_.size() && src_[pos_] != '\n')
-                        ++pos_;
+                    pos_ = std::min(src_.find('\n', pos_ + 2), src_.size());
                 }
                 else if (src_[pos_ + 1] == '*')
                 { // comentário de bloco
-                    pos_ += 2;
-                    while (pos_ + 1 < src_.size() && !(src_[pos_] == '*' && src_[pos_ + 1] == '/'))
-                    {
-
-                        if (src_[pos_] == '\n')
-                            ++line_;
-
-                        ++pos_;
-                    }
-                    pos_ += 2;
+                    size_t close = src_.find("*/", pos_ + 2);
+                    pos_ = close == std::string::npos ? src_.size() : close + 2;
                 }
                 else
                     break;
@@ -92,15 +293,20 @@ private:
         size_t start = pos_;
 
         while (pos_ < src_.size() &&
-               (std::isalnum(src_[pos_]) || src_[pos_] == '_'))
+               CharClass::identChar(src_[pos_]))
             ++pos_;
 
-        std::string lex = src_.substr(start, pos_ - start);
+        if (pos_ - start > limits_.maxIdentifierLength)
+            throw std::runtime_error("Erro na linha " + std::to_string(lineAt(start)) +
+                                     ": Identificador excede o limite de " +
+                                     std::to_string(limits_.maxIdentifierLength) + " caracteres");
+
+        std::pmr::string lex = slice(start, pos_ - start);
 
         for (auto &ch : lex)
-            ch = std::toupper(ch);
+            ch = CharClass::upper(ch);
 
-        static const std::map<std::string, TokenType> kw = {
+        static const std::map<std::string, TokenType, std::less<>> kw = {
             {"PROGRAM", TokenType::PROGRAM},
             {"DECLARATIONS", TokenType::DECLARATIONS},
             {"ENDDECLARATIONS", TokenType::ENDDECLARATIONS},
@@ -128,32 +334,32 @@ private:
             {"TRUE", TokenType::TRUE},
             {"FALSE", TokenType::FALSE}};
 
-        auto it = kw.find(lex);
+        auto it = kw.find(std::string_view(lex));
 
         if (it != kw.end())
-            return {it->second, lex, line_};
+            return {it->second, std::move(lex)};
 
-        return {TokenType::IDENT, lex, line_};
+        return {TokenType::IDENT, std::move(lex)};
     }
 
     Token number()
     {
         size_t start = pos_;
 
-        while (pos_ < src_.size() && std::isdigit(src_[pos_]))
+        while (pos_ < src_.size() && CharClass::digit(src_[pos_]))
             ++pos_;
 
         if (pos_ < src_.size() && src_[pos_] == '.')
         {
             ++pos_;
 
-            while (pos_ < src_.size() && std::isdigit(src_[pos_]))
+            while (pos_ < src_.size() && CharClass::digit(src_[pos_]))
                 ++pos_;
 
-            return {TokenType::REALCONST, src_.substr(start, pos_ - start), line_};
+            return {TokenType::REALCONST, slice(start, pos_ - start)};
         }
 
-        return {TokenType::INTCONST, src_.substr(start, pos_ - start), line_};
+        return {TokenType::INTCONST, slice(start, pos_ - start)};
     }
 
     Token stringOrChar()
@@ -162,27 +368,23 @@ private:
 
         size_t start = pos_;
 
-        while (pos_ < src_.size() && src_[pos_] != quote)
-        {
-            if (src_[pos_] == '\n')
-                ++line_;
-            ++pos_;
-        }
+        pos_ = std::min(src_.find(quote, pos_), src_.size());
 
         if (pos_ >= src_.size())
         {
-            throw std::runtime_error("Erro na linha " + std::to_string(line_) +
+            // Aponta a linha da aspa de abertura
+            throw std::runtime_error("Erro na linha " + std::to_string(lineAt(start - 1)) +
                                      ": String nao fechada. Esperava '" + quote + "'");
         }
 
-        std::string lit = src_.substr(start, pos_ - start);
+        std::pmr::string lit = slice(start, pos_ - start);
 
         pos_++;
 
         return {quote == '"'
                     ? TokenType::STRINGCONST
                     : TokenType::CHARCONST,
-                lit, line_};
+                std::move(lit)};
     }
 
     Token symbol()
@@ -192,12 +394,12 @@ private:
             if (src_[pos_] == a && pos_ + 1 < src_.size() && src_[pos_ + 1] == b)
             {
                 pos_ += 2;
-                return Token{two, std::string(1, a) + b, line_};
+                return Token{two, slice(pos_ - 2, 2)};
             }
 
             pos_++;
 
-            return Token{one, std::string(1, a), line_};
+            return Token{one, slice(pos_ - 1, 1)};
         };
 
         char c = src_[pos_];
@@ -206,33 +408,33 @@ private:
         {
         case ';':
             ++pos_;
-            return {TokenType::SEMI, ";", line_};
+            return {TokenType::SEMI, ";"};
         case ':':
             return match2(':', '=', TokenType::ASSIGN, TokenType::COLON);
         case ',':
             ++pos_;
-            return {TokenType::COMMA, ",", line_};
+            return {TokenType::COMMA, ","};
         case '[':
             ++pos_;
-            return {TokenType::LBRACK, "[", line_};
+            return {TokenType::LBRACK, "["};
         case ']':
             ++pos_;
-            return {TokenType::RBRACK, "]", line_};
+            return {TokenType::RBRACK, "]"};
         case '(':
             ++pos_;
-            return {TokenType::LPAREN, "(", line_};
+            return {TokenType::LPAREN, "("};
         case ')':
             ++pos_;
-            return {TokenType::RPAREN, ")", line_};
+            return {TokenType::RPAREN, ")"};
         case '{':
             ++pos_;
-            return {TokenType::LBRACE, "{", line_};
+            return {TokenType::LBRACE, "{"};
         case '}':
             ++pos_;
-            return {TokenType::RBRACE, "}", line_};
+            return {TokenType::RBRACE, "}"};
         case '?':
             ++pos_;
-            return {TokenType::QUESTION, "?", line_};
+            return {TokenType::QUESTION, "?"};
         case '<':
             return match2('<', '=', TokenType::LE, TokenType::LT);
         case '>':
@@ -243,22 +445,89 @@ private:
             return match2('!', '=', TokenType::NE, TokenType::HASH);
         case '+':
             ++pos_;
-            return {TokenType::PLUS, "+", line_};
+            return {TokenType::PLUS, "+"};
         case '-':
             ++pos_;
-            return {TokenType::MINUS, "-", line_};
+            return {TokenType::MINUS, "-"};
         case '*':
             ++pos_;
-            return {TokenType::MUL, "*", line_};
+            return {TokenType::MUL, "*"};
         case '/':
             ++pos_;
-            return {TokenType::DIV, "/", line_};
+            return {TokenType::DIV, "/"};
         case '%':
             ++pos_;
-            return {TokenType::MOD, "%", line_};
+            return {TokenType::MOD, "%"};
         default:
-            throw std::runtime_error("Erro na linha " + std::to_string(line_) +
-                                     ": Caractere invalido '" + c + "'");
+        {
+            // Fora de comentários e literais só há ASCII; um caractere
+            // multibyte é mostrado inteiro na mensagem
+            size_t len = 1;
+            if ((unsigned char)c >= 0x80)
+            {
+                if (pos_ >= validatedTo_)
+                    validateUpTo(pos_ + 1);
+                if (pos_ == utf8_.errorOffset)
+                    throw invalidUtf8();
+                len = utf8SequenceLength((const unsigned char *)src_.data(), src_.size(), pos_);
+            }
+            throw std::runtime_error("Erro na linha " + std::to_string(line()) +
+                                     ": Caractere invalido '" + src_.substr(pos_, len) + "'");
+        }
+        }
+    }
+};
+
+// Varredura rápida do texto atrás de uma palavra-chave (em maiúsculas),
+// sem montar tokens: pula espaços, comentários, literais, números e
+// símbolos pelas mesmas regras do Lexer, então cada posição devolvida é o
+// início de um token que o Lexer também leria como a palavra-chave. Para
+// na primeira string não fechada.
+inline std::vector<size_t> findKeyword(const std::string &src, std::string_view keyword)
+{
+    std::vector<size_t> found;
+    size_t pos = 0;
+    const size_t n = src.size();
+    while (pos < n)
+    {
+        char c = src[pos];
+        if (c == '/' && pos + 1 < n && src[pos + 1] == '/')
+        {
+            pos = std::min(src.find('\n', pos + 2), n);
+        }
+        else if (c == '/' && pos + 1 < n && src[pos + 1] == '*')
+        {
+            size_t close = src.find("*/", pos + 2);
+            pos = close == std::string::npos ? n : close + 2;
+        }
+        else if (CharClass::identStart(c))
+        {
+            size_t start = pos;
+            while (pos < n && CharClass::identChar(src[pos]))
+                ++pos;
+            bool match = pos - start == keyword.size();
+            for (size_t k = 0; match && k < keyword.size(); ++k)
+                match = CharClass::upper(src[start + k]) == keyword[k];
+            if (match)
+                found.push_back(start);
+        }
+        else if (CharClass::digit(c))
+        {
+            while (pos < n && CharClass::digit(src[pos]))
+                ++pos;
+            if (pos < n && src[pos] == '.')
+                for (++pos; pos < n && CharClass::digit(src[pos]);)
+                    ++pos;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            pos = src.find(c, pos + 1);
+            if (pos == std::string::npos)
+                break;
+            ++pos;
         }
+        else
+            ++pos;
     }
-};
\ No newline at end of file
+    return found;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CANGA_LINES_SSE2 1
+#endif
+
+// ===============================
+//  Índice de linhas
+// ===============================
+// Tokens, registros do .LEX e ocorrências de símbolos guardam só a posição
+// (offset) no texto. Linha e coluna são calculadas quando alguém vai
+// mostrá-las (relatórios, mensagens de erro, LSP): o índice guarda o início
+// de cada linha, montado numa única varredura do texto, 16 bytes por vez
+// com SSE2, e cada consulta é uma busca binária. Assim o laço do lexer não
+// conta quebras de linha. Colunas contam bytes a partir de 1.
+
+struct SourcePosition
+{
+    int line;
+    int column;
+};
+
+class LineIndex
+{
+public:
+    // `firstLine` é o número da linha do início do texto (corpos de funções
+    // importadas começam na linha do FUNCTYPE no fonte original)
+    explicit LineIndex(int firstLine = 1)
+        : firstLine_(firstLine), starts_(1, 0) {}
+
+    explicit LineIndex(std::string_view text, int firstLine = 1, bool vectorized = true)
+        : LineIndex(firstLine)
+    {
+        append(text, vectorized);
+    }
+
+    // Acrescenta o próximo trecho do texto (leitura em blocos)
+    void append(std::string_view chunk, bool vectorized = true)
+    {
+        const char *data = chunk.data();
+        size_t n = chunk.size(), i = 0;
+#ifdef CANGA_LINES_SSE2
+        if (vectorized)
+        {
+            const __m128i newline = _mm_set1_epi8('\n');
+            for (; i + 16 <= n; i += 16)
+            {
+                __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+                unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+                for (; mask; mask &= mask - 1)
+                    starts_.push_back(size_ + i + __builtin_ctz(mask) + 1);
+            }
+        }
+#else
+        (void)vectorized;
+#endif
+        for (const char *nl; i < n && (nl = (const char *)std::memchr(data + i, '\n', n - i)); i = nl - data + 1)
+            starts_.push_back(size_ + (nl - data) + 1);
+        size_ += n;
+    }
+
+    // Substitui `removed` bytes em `offset` por `inserted` (edição no
+    // editor): só o texto inserido é varrido; as linhas seguintes têm o
+    // início deslocado
+    void replace(size_t offset, size_t removed, std::string_view inserted)
+    {
+        // Linhas que começavam dentro do trecho removido deixam de existir
+        size_t first = std::upper_bound(starts_.begin() + 1, starts_.end(), offset) - starts_.begin();
+        size_t last = std::upper_bound(starts_.begin() + first, starts_.end(), offset + removed) - starts_.begin();
+        long long delta = (long long)inserted.size() - (long long)removed;
+        for (size_t k = last; k < starts_.size(); ++k)
+            starts_[k] = (size_t)((long long)starts_[k] + delta);
+        std::vector<size_t> fresh;
+        for (size_t i = 0; (i = inserted.find('\n', i)) != std::string_view::npos; ++i)
+            fresh.push_back(offset + i + 1);
+        starts_.erase(starts_.begin() + first, starts_.begin() + last);
+        starts_.insert(starts_.begin() + first, fresh.begin(), fresh.end());
+        size_ = (size_t)((long long)size_ + delta);
+    }
+
+    // Bytes já indexados
+    size_t size() const
+    {
+        return size_;
+    }
+
+    int lineCount() const
+    {
+        return (int)starts_.size();
+    }
+
+    int line(size_t offset) const
+    {
+        return firstLine_ + (int)lineAt(offset);
+    }
+
+    int column(size_t offset) const
+    {
+        return (int)(offset - starts_[lineAt(offset)]) + 1;
+    }
+
+    SourcePosition position(size_t offset) const
+    {
+        size_t k = lineAt(offset);
+        return {firstLine_ + (int)k, (int)(offset - starts_[k]) + 1};
+    }
+
+    // Offset do início da linha `line` (o fim do texto se ela não existir)
+    size_t lineStart(int line) const
+    {
+        size_t k = (size_t)std::max(line - firstLine_, 0);
+        return k < starts_.size() ? starts_[k] : size_;
+    }
+
+private:
+    int firstLine_;
+    std::vector<size_t> starts_; // início de cada linha; starts_[0] = 0
+    size_t size_ = 0;
+
+    // Índice (a partir de 0) da linha que contém `offset`
+    size_t lineAt(size_t offset) const
+    {
+        return (size_t)(std::upper_bound(starts_.begin(), starts_.end(), offset) - starts_.begin()) - 1;
+    }
+};
@@ -1,155 +1,414 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <stack>
 #include <algorithm>
-#include "symbolTable.cpp"
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <memory_resource>
+#include <chrono>
+#include <iomanip>
+#include <unordered_map>
+#include "analyzer.cpp"
+#include "reports.cpp"
+#include "interpreter.cpp"
+#include "profiler.cpp"
+#include "bytecodeCache.cpp"
+#include "languageServer.cpp"
+#include "batchIo.cpp"
+#include "fileWatcher.cpp"
+#include "trace.cpp"
 
-class TypeContext
+void _teamHeader(std::ostream &stream)
 {
-public:
-    enum class Context
-    {
-        GLOBAL,
-        DECLARATIONS,
-        FUNCTIONS,
-        FUNCTION_PARAMS,
-        VARIABLE_DECL,
-        ARRAY_DECL,
-        FUNCTION_DECL
-    };
+    stream << "Código da Equipe: 2" << std::endl
+           << "Componentes:" << std::endl
+           << "    Davih de Andrade Machado Borges Santos; davih.santos@ba.estudante.senai.br" << std::endl
+           << "    Felipe Azevedo Ribeiro; felipe.r@aln.senaicimatec.edu.br" << std::endl
+           << "    Gabriel Trindade Santana; gabriel.t.santana@ba.estudante.senai.br" << std::endl
+           << "    Pedro Quadros de Freitas; _@aln.senaicimatec.edu.br" << std::endl
+           << std::endl;
+}
+
+// Conteúdo do .LEX; com jobs > 1 os registros são formatados em paralelo
+void _writeLexReport(std::ostream &lexOut, const LexemeList &lexemes, const LineIndex &lines, unsigned jobs = 1)
+{
+    _teamHeader(lexOut);
+
+    for (auto &shard : formatLexRecords(lexemes, lines, jobs))
+        lexOut << shard;
+}
+
+// Conteúdo do .TAB, percorrendo os símbolos na ordem de entrada, sem cópias
+void _writeTabReport(std::ostream &tabOut, const SymbolTable &symtab, unsigned jobs = 1)
+{
+    _teamHeader(tabOut);
+
+    for (auto &shard : formatSymbolEntries(symtab, jobs))
+        tabOut << shard;
+}
+
+// Conteúdo do .XRF: todas as ocorrências (linha:coluna) de cada símbolo
+void _writeXrefReport(std::ostream &xrefOut, const SymbolTable &symtab)
+{
+    _teamHeader(xrefOut);
+
+    for (auto &info : symtab.all())
+    {
+        xrefOut << "Entrada: " << info.entry << ", Lexeme: " << info.lexeme << ", Ocorrencias: {";
+        auto uses = symtab.usesOf(info.entry);
+        for (size_t j = 0; j < uses.size(); ++j)
+        {
+            if (j)
+                xrefOut << ", ";
+            xrefOut << uses[j].line << ":" << uses[j].column;
+        }
+        xrefOut << "}.\n";
+    }
+}
+
+void _generateLexFile(std::string base, const LexemeList &lexemes, const LineIndex &lines, unsigned jobs = 1)
+{
+    TRACE_SCOPE("_generateLexFile", base);
+    std::ofstream lexOut(base + ".LEX");
+    _writeLexReport(lexOut, lexemes, lines, jobs);
+    lexOut.close();
+}
+
+void _generateTabFile(std::string base, const SymbolTable &symtab, unsigned jobs = 1)
+{
+    TRACE_SCOPE("_generateTabFile", base);
+    std::ofstream tabOut(base + ".TAB");
+    _writeTabReport(tabOut, symtab, jobs);
+    tabOut.close();
+}
+
+void _generateXrefFile(std::string base, const SymbolTable &symtab)
+{
+    TRACE_SCOPE("_generateXrefFile", base);
+    std::ofstream xrefOut(base + ".XRF");
+    _writeXrefReport(xrefOut, symtab);
+    xrefOut.close();
+}
+
+// Grava o arquivo .IR com a IR (otimizada ou não) e as estatísticas de cada pass
+void _generateIRFile(std::string base, const IRModule &module, const PassManager &passes, bool optimize)
+{
+    std::ofstream irOut(base + ".IR");
 
-    TypeContext()
+    _teamHeader(irOut);
+
+    irPrintModule(irOut, module);
+    if (optimize)
     {
-        contextStack_.push(Context::GLOBAL);
+        irOut << "\n";
+        passes.printStats(irOut);
+        passes.printStats(std::cout);
     }
+    irOut.close();
+}
+
+// Grava o relatório de pontos quentes (.PROF) e as pilhas para flamegraph (.folded)
+void _generateProfileFiles(std::string base, const BcProgram &program, const ExecutionProfile &profile)
+{
+    std::ofstream profOut(base + ".PROF");
+
+    _teamHeader(profOut);
+
+    writeProfileReport(profOut, program, profile);
+    profOut.close();
+
+    std::ofstream foldedOut(base + ".folded");
+    writeFoldedStacks(foldedOut, program, profile);
+    foldedOut.close();
+}
+
+// Executa o bytecode; com `profileBase`, coleta o perfil e grava os
+// relatórios mesmo se a execução terminar com erro. `jit`: funções e laços
+// quentes viram código nativo (sem efeito com perfil)
+void _runProgram(const BcProgram &program, const std::string &profileBase = "", bool jit = true)
+{
+    TRACE_SCOPE("execucao", "");
+    Interpreter interpreter(program);
+    interpreter.setJit(jit);
+    if (profileBase.empty())
+    {
+        interpreter.run();
+        return;
+    }
+
+    ExecutionProfile profile;
+    interpreter.setProfile(&profile);
+    try
+    {
+        interpreter.run();
+    }
+    catch (const std::runtime_error &)
+    {
+        _generateProfileFiles(profileBase, program, profile);
+        throw;
+    }
+    _generateProfileFiles(profileBase, program, profile);
+    std::cout << "Perfil gerado: " << profileBase << ".PROF e " << profileBase << ".folded\n";
+}
+
+// Conteúdo dos relatórios de um fonte
+struct SourceReports
+{
+    std::string lex, tab, xref;
+};
+
+// Analisa `source` e formata o .LEX, o .TAB e, com `dumpXref`, o .XRF. A
+// arena da análise pede memória a `upstream`
+SourceReports _buildReports(const std::string &source,
+                            const std::vector<std::unique_ptr<ModuleInterface>> &interfaces,
+                            const AnalysisLimits &limits, unsigned jobs, bool dumpXref,
+                            std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+{
+    std::pmr::monotonic_buffer_resource arena(1 << 16, upstream);
+    SymbolTable symtab(&arena);
+    for (auto &iface : interfaces)
+        symtab.importInterface(*iface);
+    LexemeList lexemes(&arena);
+    analyzeSource(source, symtab, lexemes, limits, nullptr, jobs);
 
-    void pushContext(Context ctx)
+    SourceReports reports;
+    std::ostringstream lexOut, tabOut;
+    {
+        TRACE_SCOPE("relatorio .LEX", "");
+        _writeLexReport(lexOut, lexemes, symtab.lines(), jobs);
+        reports.lex = lexOut.str();
+    }
+    {
+        TRACE_SCOPE("relatorio .TAB", "");
+        _writeTabReport(tabOut, symtab, jobs);
+        reports.tab = tabOut.str();
+    }
+    if (dumpXref)
     {
-        contextStack_.push(ctx);
+        TRACE_SCOPE("relatorio .XRF", "");
+        std::ostringstream xrefOut;
+        _writeXrefReport(xrefOut, symtab);
+        reports.xref = xrefOut.str();
     }
+    return reports;
+}
+
+// Fontes lidos antes de serem analisados na compilação de vários arquivos
+const size_t BATCH_READ_AHEAD = 32;
 
-    void popContext()
+// Maior valor aceito em --jobs (threads da análise e da formatação)
+const unsigned long MAX_JOBS = 1024;
+
+// Vários fontes na linha de comando: gera .LEX e .TAB (e .XRF) de cada um.
+// As leituras dos próximos BATCH_READ_AHEAD fontes e as gravações dos
+// relatórios prontos seguem em segundo plano (batchIo.cpp) enquanto a
+// thread principal analisa, num pool de threads ou, com `ioUring`, num
+// io_uring. Um fonte com erro é reportado e os demais continuam.
+int _compileBatch(const std::vector<std::string> &files,
+                  const std::vector<std::unique_ptr<ModuleInterface>> &interfaces,
+                  const AnalysisLimits &limits, unsigned jobs, bool dumpXref, bool ioUring)
+{
+    BatchIo io(4, ioUring);
+    std::vector<size_t> reads(files.size());
+    size_t queued = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < files.size(); ++i)
     {
-        if (contextStack_.size() > 1)
+        for (; queued < files.size() && queued < i + BATCH_READ_AHEAD; ++queued)
+            reads[queued] = io.read(files[queued]);
+        io.submit();
+
+        TRACE_SCOPE("fonte", files[i]);
+        std::string base = files[i].substr(0, files[i].find_last_of('.'));
+        try
+        {
+            SourceReports reports = _buildReports(io.take(reads[i]), interfaces, limits, jobs, dumpXref);
+            io.write(base + ".LEX", std::move(reports.lex));
+            io.write(base + ".TAB", std::move(reports.tab));
+            if (dumpXref)
+                io.write(base + ".XRF", std::move(reports.xref));
+        }
+        catch (const std::runtime_error &e)
         {
-            contextStack_.pop();
+            std::cerr << files[i] << ": " << e.what() << "\n";
+            ++failed;
         }
     }
-
-    Context currentContext() const
+    try
     {
-        return contextStack_.top();
+        io.finish();
     }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "Arquivos gerados para " << files.size() - failed << " de " << files.size() << " fontes ("
+              << (dumpXref ? ".LEX, .TAB e .XRF" : ".LEX e .TAB") << "; E/S por "
+              << (io.usingIoUring() ? "io_uring" : "pool de threads") << ")\n";
+    return failed ? 1 : 0;
+}
 
-    static std::string mapTypeToCode(TokenType type, bool isArray = false)
+// Modo --check: só valida léxico e estrutura de cada fonte, sem tabela de
+// símbolos, relatórios nem arquivos gravados. Erros vão para stderr no
+// formato `fonte: mensagem`; retorna 1 se algum fonte tiver erro.
+int _checkSources(const std::vector<std::string> &files, const AnalysisLimits &limits)
+{
+    size_t failed = 0;
+    for (auto &file : files)
     {
-        if (isArray)
+        TRACE_SCOPE("verificacao", file);
+        try
         {
-            switch (type)
+            if (isGzipPath(file))
             {
-            case TokenType::REAL:
-                return "AF";
-            case TokenType::INTEGER:
-                return "AI";
-            case TokenType::STRING:
-                return "AS";
-            case TokenType::CHARACTER:
-                return "AC";
-            case TokenType::BOOLEAN:
-                return "AB";
-            default:
-                return "";
+                std::unique_ptr<SourceReader> reader = openSourceReader(file);
+                checkStream(*reader, limits);
+                continue;
             }
+            std::ifstream ifs(file, std::ios::binary | std::ios::ate);
+            if (!ifs)
+                throw std::runtime_error("Erro ao abrir arquivo: " + file);
+            // Uma única alocação do tamanho do arquivo
+            std::string source((size_t)ifs.tellg(), '\0');
+            ifs.seekg(0);
+            ifs.read(&source[0], (std::streamsize)source.size());
+            checkSource(source, limits);
         }
-
-        switch (type)
+        catch (const std::runtime_error &e)
         {
-        case TokenType::REAL:
-            return "FP";
-        case TokenType::INTEGER:
-            return "IN";
-        case TokenType::STRING:
-            return "ST";
-        case TokenType::CHARACTER:
-            return "CH";
-        case TokenType::BOOLEAN:
-            return "BL";
-        case TokenType::VOID:
-            return "VD";
-        default:
-            return "";
+            std::cerr << file << ": " << e.what() << "\n";
+            ++failed;
         }
     }
-
-private:
-    std::stack<Context> contextStack_;
-};
-
-void _teamHeader(std::ofstream &stream)
-{
-    stream << "Código da Equipe: 2" << std::endl
-           << "Componentes:" << std::endl
-           << "    Davih de Andrade Machado Borges Santos; davih.santos@ba.estudante.senai.br" << std::endl
-           << "    Felipe Azevedo Ribeiro; felipe.r@aln.senaicimatec.edu.br" << std::endl
-           << "    Gabriel Trindade Santana; gabriel.t.santana@ba.estudante.senai.br" << std::endl
-           << "    Pedro Quadros de Freitas; _@aln.senaicimatec.edu.br" << std::endl
-           << std::endl;
+    std::cout << "Fontes validos: " << files.size() - failed << " de " << files.size() << "\n";
+    return failed ? 1 : 0;
 }
 
-void _generateLexFile(std::string base, std::vector<LexemeRecord> lexemes)
+// Grava `content` em `path` só se ele mudou em relação à última gravação
+// (ou, na primeira vez, ao arquivo em disco); true se o arquivo foi gravado
+bool _writeIfChanged(const std::string &path, std::string content,
+                     std::unordered_map<std::string, std::string> &written)
 {
-    std::ofstream lexOut(base + ".LEX");
-
-    _teamHeader(lexOut);
-
-    for (auto &r : lexemes)
+    auto it = written.find(path);
+    if (it == written.end())
     {
-        lexOut
-            << "Lexeme: " << r.lexeme << ", Código: "
-            << (SymbolTable::tokenTypeToString(r.type)) << ", ÍndiceTabSimb: "
-            << (r.tableIndex > 0 ? std::to_string(r.tableIndex) : "-") << ", Linha: "
-            << r.line << ".\n";
+        std::ifstream current(path, std::ios::binary);
+        std::stringstream buffer;
+        if (current)
+            buffer << current.rdbuf();
+        it = written.emplace(path, current ? buffer.str() : std::string()).first;
+        if (current && it->second == content)
+            return false;
     }
-    lexOut.close();
+    else if (it->second == content)
+        return false;
+
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+    if (!out.flush())
+        throw std::runtime_error("Erro ao gravar arquivo: " + path);
+    it->second = std::move(content);
+    return true;
 }
 
-void _generateTabFile(std::string base, SymbolTable symtab)
+// Modo --watch: compila todos os fontes e, a cada rajada de alterações
+// (fileWatcher.cpp), recompila só os fontes que mudaram. O processo fica
+// vivo entre as recompilações: interfaces importadas continuam mapeadas,
+// tabelas estáticas do lexer já inicializadas e os blocos das arenas voltam
+// para um pool reaproveitado na próxima análise. Os relatórios só são
+// regravados quando o texto muda, para não disparar quem observa os .LEX e
+// .TAB. Roda até ser interrompido (Ctrl+C).
+int _watchSources(const std::vector<std::string> &paths,
+                  const std::vector<std::unique_ptr<ModuleInterface>> &interfaces,
+                  const AnalysisLimits &limits, unsigned jobs, bool dumpXref)
 {
-    std::ofstream tabOut(base + ".TAB");
-
-    std::vector<std::pair<std::string, SymbolTable::SymbolInfo>> syms;
-    for (auto &p : symtab.all())
-        syms.push_back(p);
-    std::sort(syms.begin(), syms.end(),
-              [](auto &a, auto &b)
-              { return a.second.entry < b.second.entry; });
+    std::unique_ptr<FileWatcher> watcher;
+    try
+    {
+        watcher.reset(new FileWatcher(paths));
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    std::pmr::unsynchronized_pool_resource pool(std::pmr::pool_options{0, 1 << 22});
+    std::unordered_map<std::string, std::string> written;
 
-    _teamHeader(tabOut);
+    auto rebuild = [&](const std::vector<std::string> &files, FileWatcher::Clock::time_point changedAt)
+    {
+        auto start = FileWatcher::Clock::now();
+        size_t rewritten = 0, failed = 0;
+        for (auto &file : files)
+        {
+            std::string base = file.substr(0, file.find_last_of('.'));
+            try
+            {
+                std::ifstream ifs(file, std::ios::binary);
+                if (!ifs)
+                    throw std::runtime_error("Erro ao abrir arquivo: " + file);
+                std::stringstream buffer;
+                buffer << ifs.rdbuf();
+                SourceReports reports = _buildReports(buffer.str(), interfaces, limits, jobs, dumpXref, &pool);
+                rewritten += _writeIfChanged(base + ".LEX", std::move(reports.lex), written);
+                rewritten += _writeIfChanged(base + ".TAB", std::move(reports.tab), written);
+                if (dumpXref)
+                    rewritten += _writeIfChanged(base + ".XRF", std::move(reports.xref), written);
+            }
+            catch (const std::runtime_error &e)
+            {
+                std::cerr << file << ": " << e.what() << "\n";
+                ++failed;
+            }
+        }
+        auto end = FileWatcher::Clock::now();
+        std::cout << "Recompilados " << files.size() - failed << " de " << files.size() << " fontes em "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms";
+        if (changedAt != FileWatcher::Clock::time_point{})
+            std::cout << " (" << std::chrono::duration<double, std::milli>(end - changedAt).count()
+                      << " ms desde a ultima alteracao)";
+        std::cout << "; arquivos regravados: " << rewritten << std::endl;
+    };
 
-    for (size_t i = 0; i < syms.size(); ++i)
-    {
-        auto &p = syms[i];
-        auto &info = p.second;
-        tabOut
-            << "Entrada: " << info.entry << ", Codigo: "
-            << info.atomCode << ", Lexeme: " << info.lexeme << ",\n"
-            << "QtdCharAntesTrunc: " << info.lenBefore << ", QtdCharDepoisTrunc: "
-            << info.lenAfter << ",\n"
-            << "TipoSimb: " << info.type << ", Linhas: {";
-        for (size_t j = 0; j < info.lines.size(); ++j)
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Observando " << watcher->sources().size() << " fontes via "
+              << (watcher->usingInotify() ? "inotify" : "consulta periodica") << " (Ctrl+C para sair)" << std::endl;
+    rebuild(watcher->sources(), {});
+    for (;;)
+    {
+        std::vector<std::string> changed;
+        try
         {
-            if (j)
-                tabOut << ", ";
-            tabOut << info.lines[j];
+            changed = watcher->wait();
         }
-        tabOut << "}.\n";
-        if (i < syms.size() - 1)
+        catch (const std::runtime_error &e)
         {
-            tabOut << "----------------------------------------------------------------------------------------------------\n";
+            std::cerr << e.what() << "\n";
+            return 1;
         }
+        for (auto &file : changed)
+            std::cout << "Alterado: " << file << "\n";
+        rebuild(changed, watcher->lastEvent());
     }
-    tabOut.close();
+}
+
+// Valor de uma opção numérica (--jobs N, --max-depth N, ...): inteiro
+// decimal entre `min` e `max`, sem sinal. Fora disso, escreve o erro e
+// retorna false.
+bool _parseOptionValue(const std::string &option, const char *text, unsigned long min, unsigned long max,
+                       unsigned long &value)
+{
+    const char *end = text ? text + std::strlen(text) : nullptr;
+    auto result = text ? std::from_chars(text, end, value) : std::from_chars_result{nullptr, std::errc::invalid_argument};
+    if (result.ec == std::errc() && result.ptr == end && value >= min && value <= max)
+        return true;
+    std::cerr << option << " espera um inteiro entre " << min << " e " << max;
+    if (text)
+        std::cerr << " (recebido: '" << text << "')";
+    std::cerr << "\n";
+    return false;
 }
 
 // Lógica principal do compilador:
@@ -160,483 +419,381 @@ void _generateTabFile(std::string base, SymbolTable symtab)
 int main(int argc, char *argv[])
 {
     // Verifica se o nome do arquivo foi passado como argumento
-    if (argc < 2)
+    std::string filename;
+    std::vector<std::string> filenames;
+    bool dumpIR = false;
+    bool optimize = true;
+    bool run = false;
+    bool fuseKernels = true;
+    bool jit = true;
+    bool dumpXref = false;
+    bool emitInterface = false;
+    bool profile = false;
+    bool cache = false;
+    bool watch = false;
+    bool check = false;
+    bool ioUring = false;
+    std::string tracePath;
+    std::vector<std::string> importPaths;
+    std::vector<std::string> disabledPasses;
+    int inlineGrowth = InlinePass::DEFAULT_GROWTH;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    AnalysisLimits limits;
+    for (int i = 1; i < argc; ++i)
     {
-        std::cerr << "Use: ./CangaCompiler <file_name>.251\n";
+        std::string arg = argv[i];
+        // Opções numéricas; o valor é o próximo argumento
+        const char *next = i + 1 < argc ? argv[i + 1] : nullptr;
+        unsigned long value;
+        // Limites de recursos: --max-tokens N, --max-depth N, --max-ident N
+        if (arg == "--max-tokens" || arg == "--max-depth" || arg == "--max-ident")
+        {
+            if (!_parseOptionValue(arg, next, 0, arg == "--max-depth" ? INT_MAX : SIZE_MAX, value))
+                return 1;
+            ++i;
+            if (arg == "--max-tokens")
+                limits.maxTokens = value;
+            else if (arg == "--max-depth")
+                limits.maxNestingDepth = (int)value;
+            else
+                limits.maxIdentifierLength = value;
+        }
+        else if (arg == "--jobs")
+        {
+            if (!_parseOptionValue(arg, next, 1, MAX_JOBS, value))
+                return 1;
+            ++i;
+            jobs = (unsigned)value;
+        }
+        else if (arg == "--ir")
+            dumpIR = true;
+        else if (arg == "--no-opt")
+            optimize = false;
+        else if (arg == "--run")
+            run = true;
+        else if (arg == "--profile")
+            run = profile = true;
+        else if (arg == "--cache")
+            run = cache = true;
+        else if (arg == "--no-pass" && i + 1 < argc)
+            disabledPasses.push_back(argv[++i]);
+        else if (arg == "--inline-growth")
+        {
+            if (!_parseOptionValue(arg, next, 0, INT_MAX, value))
+                return 1;
+            ++i;
+            inlineGrowth = (int)value;
+        }
+        else if (arg == "--no-fuse")
+            fuseKernels = false;
+        else if (arg == "--no-jit")
+            jit = false;
+        else if (arg == "--xref")
+            dumpXref = true;
+        else if (arg == "--emit-interface")
+            emitInterface = true;
+        else if (arg == "--import" && i + 1 < argc)
+            importPaths.push_back(argv[++i]);
+        else if (arg == "--watch")
+            watch = true;
+        else if (arg == "--check")
+            check = true;
+        else if (arg == "--io-uring")
+            ioUring = true;
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--lsp")
+            return LanguageServer(std::cin, std::cout).run();
+        else
+            filenames.push_back(arg);
+    }
+    if (!filenames.empty())
+        filename = filenames.back();
+    if (filename.empty())
+    {
+        std::cerr << "Use: ./CangaCompiler [--ir] [--no-opt] [--run] [--profile] [--cache] [--no-fuse] [--no-jit] [--no-pass <passo>]...\n"
+                  << "                      [--inline-growth N] [--xref] [--jobs N] [--trace <arquivo>.json]\n"
+                  << "                      [--emit-interface] [--import <modulo>.251i]...\n"
+                  << "                      [--max-tokens N] [--max-depth N] [--max-ident N] <file_name>.251[.gz]\n"
+                  << "     ./CangaCompiler [--xref] [--jobs N] [--io-uring] [--import <modulo>.251i]... <a>.251 <b>.251...\n"
+                  << "     ./CangaCompiler --check [--max-tokens N] [--max-depth N] [--max-ident N] <fonte.251[.gz]>...\n"
+                  << "     ./CangaCompiler --watch [--xref] [--jobs N] [--import <modulo>.251i]... <fonte.251|diretorio>...\n"
+                  << "     ./CangaCompiler [--profile] [--no-jit] <file_name>.251c\n"
+                  << "     ./CangaCompiler --lsp\n";
         return 1;
     }
-    std::string filename = argv[1];
-    std::ifstream ifs(filename);
-    if (!ifs)
+    // Linha do tempo das fases, gravada ao sair de main
+#ifdef CANGA_WITH_TRACE
+    std::unique_ptr<TraceSession> trace;
+#endif
+    if (!tracePath.empty())
     {
-        std::cerr << "Erro ao abrir arquivo: " << filename << "\n";
+#ifdef CANGA_WITH_TRACE
+        if (watch)
+        {
+            std::cerr << "--trace nao pode ser usado com --watch\n";
+            return 1;
+        }
+        trace.reset(new TraceSession(tracePath));
+#else
+        std::cerr << "--trace requer compilar com -DCANGA_WITH_TRACE\n";
         return 1;
+#endif
+    }
+    if (check)
+    {
+        if (dumpIR || run || dumpXref || emitInterface || watch || !importPaths.empty())
+        {
+            std::cerr << "--check apenas valida os fontes "
+                         "(sem --ir, --run, --profile, --cache, --xref, --emit-interface, --import nem --watch)\n";
+            return 1;
+        }
+        return _checkSources(filenames, limits);
     }
+    auto onlySingleFile = [](const std::string &f)
+    {
+        return isGzipPath(f) || (f.size() > 5 && f.compare(f.size() - 5, 5, ".251c") == 0);
+    };
+    if ((filenames.size() > 1 || watch) && (dumpIR || run || emitInterface ||
+                                 std::any_of(filenames.begin(), filenames.end(), onlySingleFile)))
+    {
+        std::cerr << "Com varios fontes ou --watch apenas .LEX, .TAB e .XRF sao gerados "
+                     "(sem --ir, --run, --profile, --cache, --emit-interface, .gz nem .251c)\n";
+        return 1;
+    }
+    // Bytecode gerado com --cache: executado direto, sem o fonte
+    if (filename.size() > 5 && filename.compare(filename.size() - 5, 5, ".251c") == 0)
+    {
+        try
+        {
+            BcProgram program = BytecodeCache(filename).load();
+            _runProgram(program, profile ? filename.substr(0, filename.size() - 5) : "", jit);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    // Entrada compactada (<file_name>.251.gz): descompactada em blocos, sem
+    // gravar o texto em disco; os arquivos gerados usam o nome sem o .gz
+    bool compressed = isGzipPath(filename);
+    std::string sourceName = compressed ? filename.substr(0, filename.size() - 3) : filename;
 
-    // Lê todo o conteúdo do arquivo fonte para uma string
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    std::string source = buffer.str();
+    // Interfaces importadas: mapeadas em memória e consultadas pela tabela de
+    // símbolos e pela IR, sem reanalisar o fonte das bibliotecas
+    std::vector<std::unique_ptr<ModuleInterface>> interfaces;
+    try
+    {
+        for (auto &path : importPaths)
+            interfaces.emplace_back(new ModuleInterface(path));
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (watch)
+        return _watchSources(filenames, interfaces, limits, jobs, dumpXref);
+    if (filenames.size() > 1)
+        return _compileBatch(filenames, interfaces, limits, jobs, dumpXref, ioUring);
 
-    // Inicializa o analisador léxico, tabela de símbolos e contexto de tipos
-    Lexer lexer(source);
-    SymbolTable symtab;
-    TypeContext typeContext;
-    std::vector<LexemeRecord> lexemes;
+    // Tudo o que a compilação aloca por token e por símbolo sai de uma única
+    // arena, liberada de uma vez no fim
+    std::pmr::monotonic_buffer_resource arena(1 << 16);
+    SymbolTable symtab(&arena);
+    for (auto &iface : interfaces)
+        symtab.importInterface(*iface);
+    LexemeList lexemes(&arena);
+    std::string source;
+    bool streamed = false;
+    if (compressed)
+    {
+        std::unique_ptr<SourceReader> reader;
+        try
+        {
+            reader = openSourceReader(filename);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        // A IR e a interface precisam do texto completo; sem elas, a análise
+        // lê o fluxo com memória limitada
+        streamed = !(dumpIR || run || emitInterface);
+        try
+        {
+            if (streamed)
+                analyzeStream(*reader, symtab, lexemes, limits);
+            else
+                source = readAllSource(*reader);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        TRACE_SCOPE("leitura", filename);
+        std::ifstream ifs(filename);
+        if (!ifs)
+        {
+            std::cerr << "Erro ao abrir arquivo: " << filename << "\n";
+            return 1;
+        }
 
-    TokenType currentType = TokenType::VOID;
-    bool isArray = false;
-    std::string lastIdentifier;
+        // Lê todo o conteúdo do arquivo fonte para uma string
+        std::stringstream buffer;
+        buffer << ifs.rdbuf();
+        source = buffer.str();
+    }
 
-    // ===============================
-    //  Loop principal de análise
-    // ===============================
-    // Lê tokens um a um e executa ações conforme o tipo do token
-    while (true)
+    // Com --cache, um .251c gerado a partir do mesmo fonte e das mesmas
+    // opções dispensa toda a compilação
+    std::string base = sourceName.substr(0, sourceName.find_last_of('.'));
+    uint64_t cacheKey = 0;
+    if (cache)
     {
-        Token tok = lexer.nextToken();
-        if (tok.type == TokenType::END_OF_FILE)
-            break;
-
-        // Switch principal para tratar cada tipo de token
-        switch (tok.type)
+        std::vector<std::string_view> importBytes;
+        for (auto &iface : interfaces)
+            importBytes.push_back(iface->bytes());
+        std::string options = std::string(optimize ? "O" : "") + (fuseKernels ? "F" : "");
+        for (auto &name : disabledPasses)
+            options += " -" + name;
+        options += " i" + std::to_string(inlineGrowth);
+        cacheKey = bytecodeCacheKey(source, options, importBytes);
+        std::unique_ptr<BytecodeCache> cached;
+        try
         {
-        // ====== Seções e Contextos ======
-        case TokenType::PROGRAM:
-            // Início do programa
-            typeContext.pushContext(TypeContext::Context::GLOBAL);
-            break;
-        case TokenType::DECLARATIONS:
-            // Início da seção de declarações
-            typeContext.pushContext(TypeContext::Context::DECLARATIONS);
-            break;
-        case TokenType::ENDDECLARATIONS:
-            // Fim da seção de declarações
-            typeContext.popContext();
-            break;
-        case TokenType::FUNCTIONS:
-            // Início da seção de funções
-            typeContext.pushContext(TypeContext::Context::FUNCTIONS);
-            break;
-        case TokenType::ENDFUNCTIONS:
-            // Fim da seção de funções
-            typeContext.popContext();
-            break;
-        case TokenType::VARTYPE:
-            // Início de declaração de variáveis
-            typeContext.pushContext(TypeContext::Context::VARIABLE_DECL);
-            break;
-        // ====== Declaração de Função ======
-        case TokenType::FUNCTYPE:
-            typeContext.pushContext(TypeContext::Context::FUNCTION_DECL);
-            {
-                // Espera um tipo válido após FUNCTYPE
-                Token typeTok = lexer.nextToken();
-                if (typeTok.type != TokenType::REAL && typeTok.type != TokenType::INTEGER && typeTok.type != TokenType::STRING && typeTok.type != TokenType::BOOLEAN && typeTok.type != TokenType::CHARACTER && typeTok.type != TokenType::VOID) {
-                    throw std::runtime_error("Erro: FUNCTYPE deve ser seguido de um tipo valido (linha " + std::to_string(tok.line) + ")");
-                }
-                // Espera ':' após o tipo
-                Token colonTok = lexer.nextToken();
-                if (colonTok.type != TokenType::COLON) {
-                    throw std::runtime_error("Erro: Esperado ':' apos o tipo na declaracao de funcao (linha " + std::to_string(tok.line) + ")");
-                }
-                // Processa o nome da função, parâmetros e corpo
-                Token nextTok = lexer.nextToken();
-                do {
-                    nextTok = lexer.nextToken();
-                } while (nextTok.type != TokenType::LPAREN && nextTok.type != TokenType::END_OF_FILE && nextTok.type != TokenType::ENDFUNCTIONS && nextTok.type != TokenType::LBRACE);
-                if (nextTok.type == TokenType::LPAREN) {
-                    // Processa parâmetros seguindo a BNF: <Parameters> ::= <ParamTypeList> | "?"
-                    Token paramStartTok = lexer.nextToken();
-                    if (paramStartTok.type == TokenType::QUESTION) {
-                        // Parâmetros vazios (?)
-                        LexemeRecord paramRecord;
-                        paramRecord.type = paramStartTok.type;
-                        paramRecord.lexeme = paramStartTok.lexeme;
-                        paramRecord.tableIndex = -1;
-                        paramRecord.line = paramStartTok.line;
-                        lexemes.push_back(paramRecord);
-                    } else {
-                        // Processa lista de parâmetros
-                        lexer.putBackToken(paramStartTok);
-                        
-                        while (true) {
-                            Token paramTok = lexer.nextToken();
-                            if (paramTok.type == TokenType::RPAREN) {
-                                lexer.putBackToken(paramTok);
-                                break;
-                            }
-                            if (paramTok.type == TokenType::PARAMTYPE) {
-                                // Espera tipo do parâmetro
-                                Token paramTypeTok = lexer.nextToken();
-                                TokenType paramType = paramTypeTok.type;
-                                
-                                // Verifica se é um tipo válido
-                                if (paramTypeTok.type != TokenType::REAL && paramTypeTok.type != TokenType::INTEGER && 
-                                    paramTypeTok.type != TokenType::STRING && paramTypeTok.type != TokenType::BOOLEAN && 
-                                    paramTypeTok.type != TokenType::CHARACTER && paramTypeTok.type != TokenType::VOID) {
-                                    throw std::runtime_error("Erro: Tipo invalido para parametro (linha " + std::to_string(paramTypeTok.line) + ")");
-                                }
-                               
-                                // Espera ':'
-                                Token paramColonTok = lexer.nextToken();
-                                if (paramColonTok.type != TokenType::COLON) {
-                                    throw std::runtime_error("Erro: Esperado ':' apos o tipo do parametro (linha " + std::to_string(paramTypeTok.line) + ")");
-                                }
-                                
-                                // Processa lista de parâmetros
-                                while (true) {
-                                    Token paramIdentTok = lexer.nextToken();
-                                    if (paramIdentTok.type == TokenType::IDENT) {
-                                
-                                        int idx = symtab.defineOrGet(paramIdentTok.lexeme, paramIdentTok.line, TokenType::IDENT);
-                                        
-                                        // Verifica se é array
-                                        Token nextParamTok = lexer.nextToken();
-                                        
-                                        bool isParamArray = false;
-                                        
-                                        if (nextParamTok.type == TokenType::LBRACK) {
-                                            Token sizeTok = lexer.nextToken();
-                                            
-                                            if (sizeTok.type != TokenType::INTCONST) {
-                                                throw std::runtime_error("Erro: Tamanho do array deve ser constante inteira (linha " + std::to_string(sizeTok.line) + ")");
-                                            }
-                                            Token rbrack = lexer.nextToken();
-                                            
-                                            if (rbrack.type != TokenType::RBRACK) {
-                                                throw std::runtime_error("Erro: Esperado ']' apos tamanho do array (linha " + std::to_string(sizeTok.line) + ")");
-                                            }
-                                            
-                                            isParamArray = true;
-                                        } else {
-                                            lexer.putBackToken(nextParamTok);
-                                        }
-                                        
-                                        // Define o tipo correto do parâmetro na tabela de símbolos
-                                        std::string typeCode = TypeContext::mapTypeToCode(paramType, isParamArray);
-                                        symtab.setType(paramIdentTok.lexeme, typeCode);
-                                        
-                                        LexemeRecord paramRecord;
-                                        paramRecord.type = paramIdentTok.type;
-                                        paramRecord.lexeme = paramIdentTok.lexeme;
-                                        paramRecord.tableIndex = symtab.getIndex(paramIdentTok.lexeme);
-                                        paramRecord.line = paramIdentTok.line;
-                                        lexemes.push_back(paramRecord);
-                                    } else if (paramIdentTok.type == TokenType::COMMA) {
-                                        continue;
-                                    } else if (paramIdentTok.type == TokenType::SEMI) {
-                                        // Fim deste grupo de parâmetros, continua para o próximo grupo
-                                        break;
-                                    } else if (paramIdentTok.type == TokenType::RPAREN) {
-                                        // Fim de todos os parâmetros
-                                        lexer.putBackToken(paramIdentTok);
-                                        break;
-                                    } else {
-                                        // Se não for identificador, vírgula, ponto e vírgula ou parêntese, volta o token e sai do loop
-                                        lexer.putBackToken(paramIdentTok);
-                                        break;
-                                    }
-                                }
-                            } else if (paramTok.type == TokenType::IDENT) {
-                                // Só identificador, sem tipo explícito
-                                
-                                int idx = symtab.defineOrGet(paramTok.lexeme, paramTok.line, TokenType::IDENT);
-                                
-                                LexemeRecord paramRecord;
-                                
-                                paramRecord.type = paramTok.type;
-                                paramRecord.lexeme = paramTok.lexeme;
-                                paramRecord.tableIndex = symtab.getIndex(paramTok.lexeme);
-                                paramRecord.line = paramTok.line;
-                                lexemes.push_back(paramRecord);
-                            } else if (paramTok.type != TokenType::RPAREN) {
-                                LexemeRecord paramRecord;
-                                
-                                paramRecord.type = paramTok.type;
-                                paramRecord.lexeme = paramTok.lexeme;
-                                paramRecord.tableIndex = -1;
-                                paramRecord.line = paramTok.line;
-                                lexemes.push_back(paramRecord);
-                            }
-                            if (paramTok.type == TokenType::END_OF_FILE || paramTok.type == TokenType::ENDFUNCTIONS) {
-                                
-                                throw std::runtime_error("Erro: fim inesperado ao processar parametros da funcao (linha " + std::to_string(tok.line) + ")");
-                            }
-                        }
-                    }
-                    nextTok = lexer.nextToken();
-                }
-
-                // Pula tokens até encontrar o início do corpo da função
-                while (nextTok.type != TokenType::LBRACE && nextTok.type != TokenType::END_OF_FILE && nextTok.type != TokenType::ENDFUNCTIONS) {
-                    
-                    LexemeRecord skippedRecord;
-                    skippedRecord.type = nextTok.type;
-                    skippedRecord.lexeme = nextTok.lexeme;
-                    skippedRecord.tableIndex = -1;
-                    skippedRecord.line = nextTok.line;
-                    lexemes.push_back(skippedRecord);
-                    nextTok = lexer.nextToken();
-                }
-                
-                if (nextTok.type != TokenType::LBRACE) {
-                    throw std::runtime_error("Erro: funcao nao possui corpo iniciado por '{' (linha " + std::to_string(tok.line) + ")");
-                }
-                
-                // Processa o corpo da função
-                int braceCount = 1;
-                
-                while (braceCount > 0) {
-                    Token bodyTok = lexer.nextToken();
-                    
-                    if (bodyTok.type == TokenType::END_OF_FILE) {
-                        throw std::runtime_error("Erro: funcao nao termina com '}' (linha " + std::to_string(tok.line) + ")");
-                    }
-                    
-                    if (bodyTok.type == TokenType::LBRACE) braceCount++;
-                    
-                    if (bodyTok.type == TokenType::RBRACE) braceCount--;
-                    
-                    if (bodyTok.type == TokenType::ENDFUNCTIONS && braceCount > 0) {
-                        throw std::runtime_error("Erro: funcao nao termina com '}' antes de ENDFUNCTIONS (linha " + std::to_string(tok.line) + ")");
-                    }
-                }
-                
-                // Espera ENDFUNCTION após o corpo
-                Token endFuncTok = lexer.nextToken();
-                if (endFuncTok.type != TokenType::ENDFUNCTION) {
-                    throw std::runtime_error("Erro: funcao deve terminar com ENDFUNCTION (linha " + std::to_string(tok.line) + ")");
-                }
-                typeContext.popContext();
-                break;
-            }
-        
-        // ====== Parâmetros de Função ======
-        case TokenType::PARAMTYPE:
-            if (typeContext.currentContext() == TypeContext::Context::FUNCTION_PARAMS)
-            {
-                typeContext.pushContext(TypeContext::Context::VARIABLE_DECL);
-            }
-            break;
-        case TokenType::LPAREN:
-            if (typeContext.currentContext() == TypeContext::Context::FUNCTION_DECL)
-            {
-                typeContext.pushContext(TypeContext::Context::FUNCTION_PARAMS);
-            }
-            break;
-        case TokenType::RPAREN:
-            if (typeContext.currentContext() == TypeContext::Context::FUNCTION_PARAMS)
-            {
-                typeContext.popContext();
-            }
-            break;
-        // ====== Declaração de Arrays ======
-        case TokenType::LBRACK:
-            isArray = true;
-            break;
-        case TokenType::RBRACK:
-            isArray = false;
-            break;
-        // ====== Fim de Declaração ======
-        case TokenType::SEMI:
-            if (typeContext.currentContext() == TypeContext::Context::VARIABLE_DECL ||
-                typeContext.currentContext() == TypeContext::Context::FUNCTION_DECL)
+            cached.reset(new BytecodeCache(base + ".251c"));
+        }
+        catch (const std::runtime_error &)
+        {
+            // Sem cache (ou de outra versão): compila normalmente
+        }
+        if (cached && cached->key() == cacheKey)
+        {
+            BcProgram program;
+            bool loaded = false;
+            try
             {
-                typeContext.popContext();
+                program = cached->load();
+                loaded = true;
             }
-            break;
-        // ====== Tipos de Variáveis ======
-        case TokenType::REAL:
-        case TokenType::INTEGER:
-        case TokenType::STRING:
-        case TokenType::BOOLEAN:
-        case TokenType::CHARACTER:
-        case TokenType::VOID:
-            // Atualiza o tipo atual para declaração
-            currentType = tok.type;
+            catch (const std::runtime_error &e)
             {
-                if (currentType != TokenType::VOID) {
-                    Token lookahead = lexer.nextToken();
-                    if (lookahead.type == TokenType::LBRACK) {
-                        Token lookahead2 = lexer.nextToken();
-                        if (lookahead2.type == TokenType::RBRACK) {
-                            isArray = true;
-                        } else {
-                            lexer.putBackToken(lookahead2);
-                            lexer.putBackToken(lookahead);
-                            isArray = false;
-                        }
-                    } else {
-                        lexer.putBackToken(lookahead);
-                        isArray = false;
-                    }
-                }
+                // Cache inválido: compila normalmente e o regrava
+                std::cerr << e.what() << "; recompilando\n";
             }
-            break;
-        // ====== Constantes Booleanas ======
-        case TokenType::TRUE:
-        case TokenType::FALSE:
-            break;
-        // ====== Identificadores ======
-        case TokenType::IDENT: {
-            // Processa identificadores (variáveis, nomes de função, etc.)
-            lastIdentifier = tok.lexeme;
-            int idx = symtab.defineOrGet(tok.lexeme, tok.line, TokenType::IDENT);
-
-            Token nextTok = lexer.nextToken();
-            if (nextTok.type == TokenType::LBRACK)
+            if (loaded)
             {
-                Token sizeTok = lexer.nextToken();
-                if (sizeTok.type != TokenType::INTCONST)
+                std::cout << "Bytecode carregado do cache: " << base << ".251c\n";
+                try
                 {
-                    throw std::runtime_error("Erro na linha " + std::to_string(tok.line) +
-                                           ": Tamanho do array deve ser uma constante inteira");
+                    _runProgram(program, profile ? base : "", jit);
                 }
-                Token rbrack = lexer.nextToken();
-                if (rbrack.type != TokenType::RBRACK)
+                catch (const std::runtime_error &e)
                 {
-                    throw std::runtime_error("Erro na linha " + std::to_string(tok.line) +
-                                           ": Esperava ']' apos tamanho do array");
+                    std::cerr << e.what() << "\n";
+                    return 1;
                 }
+                return 0;
             }
-            else
-            {
-                lexer.putBackToken(nextTok);
-            }
-
-            if (typeContext.currentContext() == TypeContext::Context::VARIABLE_DECL)
-            {
-                std::string typeCode;
-                if (isArray)
-                {
-                    switch (currentType)
-                    {
-                    case TokenType::REAL:
-                        typeCode = "AF";
-                        break;
-                    case TokenType::INTEGER:
-                        typeCode = "AI";
-                        break;
-                    case TokenType::STRING:
-                        typeCode = "AS";
-                        break;
-                    case TokenType::CHARACTER:
-                        typeCode = "AC";
-                        break;
-                    case TokenType::BOOLEAN:
-                        typeCode = "AB";
-                        break;
-                    default:
-                        typeCode = "VD";
-                    }
-                }
-                else
-                {
-                    switch (currentType)
-                    {
-                    case TokenType::REAL:
-                        typeCode = "FP";
-                        break;
-                    case TokenType::INTEGER:
-                        typeCode = "IN";
-                        break;
-                    case TokenType::STRING:
-                        typeCode = "ST";
-                        break;
-                    case TokenType::CHARACTER:
-                        typeCode = "CH";
-                        break;
-                    case TokenType::BOOLEAN:
-                        typeCode = "BL";
-                        break;
-                    case TokenType::VOID:
-                        typeCode = "VD";
-                        break;
-                    default:
-                        typeCode = "VD";
-                    }
-                }
-                symtab.setType(tok.lexeme, typeCode);
-            }
-            break;
-        }
-        // ====== Estrutura de Repetição WHILE ======
-        case TokenType::WHILE: {
-            // Processa a condição do WHILE (entre parênteses)
-            Token nextTok = lexer.nextToken();
-            if (nextTok.type != TokenType::LPAREN) {
-                throw std::runtime_error("Erro: WHILE deve ser seguido de '(' (linha " + std::to_string(tok.line) + ")");
-            }
-            int parenCount = 1;
-            while (parenCount > 0) {
-                Token condTok = lexer.nextToken();
-                if (condTok.type == TokenType::END_OF_FILE) {
-                    throw std::runtime_error("Erro: WHILE sem fechamento de ')' (linha " + std::to_string(tok.line) + ")");
-                }
-                if (condTok.type == TokenType::LPAREN) parenCount++;
-                if (condTok.type == TokenType::RPAREN) parenCount--;
-                // Atualiza tabela de símbolos para identificadores na condição
-                if (condTok.type == TokenType::IDENT) {
-                    symtab.defineOrGet(condTok.lexeme, condTok.line, TokenType::IDENT);
-                }
-            }
-            // Espera o início do bloco '{'
-            Token braceTok = lexer.nextToken();
-            if (braceTok.type != TokenType::LBRACE) {
-                throw std::runtime_error("Erro: WHILE deve ter bloco iniciado por '{' (linha " + std::to_string(tok.line) + ")");
-            }
-            // Processa o bloco do WHILE
-            int braceCount = 1;
-            while (braceCount > 0) {
-                Token bodyTok = lexer.nextToken();
-                if (bodyTok.type == TokenType::END_OF_FILE) {
-                    throw std::runtime_error("Erro: WHILE sem fechamento de '}' (linha " + std::to_string(tok.line) + ")");
-                }
-                if (bodyTok.type == TokenType::LBRACE) braceCount++;
-                if (bodyTok.type == TokenType::RBRACE) braceCount--;
-                // Atualiza tabela de símbolos para identificadores no bloco
-                if (bodyTok.type == TokenType::IDENT) {
-                    symtab.defineOrGet(bodyTok.lexeme, bodyTok.line, TokenType::IDENT);
-                }
-                LexemeRecord record;
-                record.type = bodyTok.type;
-                record.lexeme = bodyTok.lexeme;
-                record.tableIndex = symtab.getIndex(bodyTok.lexeme);
-                record.line = bodyTok.line;
-                lexemes.push_back(record);
-            }
-            // Espera ENDWHILE após o bloco
-            Token endWhileTok = lexer.nextToken();
-            if (endWhileTok.type != TokenType::ENDWHILE) {
-                throw std::runtime_error("Erro: WHILE deve terminar com ENDWHILE (linha " + std::to_string(tok.line) + ")");
-            }
-            // Registra o token ENDWHILE
-            LexemeRecord record;
-            record.type = endWhileTok.type;
-            record.lexeme = endWhileTok.lexeme;
-            record.tableIndex = symtab.getIndex(endWhileTok.lexeme);
-            record.line = endWhileTok.line;
-            lexemes.push_back(record);
-            break;
-        }
         }
+    }
 
-        // Registra cada token lido para o relatório .LEX
-        LexemeRecord record;
-        record.type = tok.type;
-        record.lexeme = tok.lexeme;
-        record.tableIndex = symtab.getIndex(tok.lexeme);
-        record.line = tok.line;
-        lexemes.push_back(record);
+    // Análise léxica e sintática, preenchendo a tabela de símbolos
+    try
+    {
+        if (!streamed)
+            analyzeSource(source, symtab, lexemes, limits, nullptr, jobs);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
     }
 
     // ===============================
     //  Geração dos arquivos de saída
     // ===============================
-    _generateLexFile(filename.substr(0, filename.find_last_of('.')), lexemes);
-    _generateTabFile(filename.substr(0, filename.find_last_of('.')), symtab);
+    _generateLexFile(sourceName.substr(0, sourceName.find_last_of('.')), lexemes, symtab.lines(), jobs);
+    _generateTabFile(sourceName.substr(0, sourceName.find_last_of('.')), symtab, jobs);
+    if (dumpXref)
+        _generateXrefFile(sourceName.substr(0, sourceName.find_last_of('.')), symtab);
+    if (emitInterface)
+    {
+        std::string path = sourceName.substr(0, sourceName.find_last_of('.')) + ".251i";
+        try
+        {
+            emitModuleInterface(path, source, symtab, limits);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        std::cout << "Interface gerada: " << path << "\n";
+    }
+
+    IRModule module;
+    PassManager passes = PassManager::standard(inlineGrowth);
+    for (auto &name : disabledPasses)
+        if (!passes.remove(name))
+        {
+            std::cerr << "Passo de otimizacao desconhecido: " << name << "\n";
+            return 1;
+        }
+    if (dumpIR || run)
+    {
+        // Erros que só a IR detecta (expressão incompleta, constante fora do
+        // intervalo, índice em variável escalar) saem como os da análise
+        try
+        {
+            TRACE_SCOPE("geracao da IR", "");
+            module = IRBuilder(source, symtab, limits).build();
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        if (optimize)
+        {
+            TRACE_SCOPE("otimizacao", "");
+            passes.run(module);
+        }
+    }
+    if (dumpIR)
+        _generateIRFile(sourceName.substr(0, sourceName.find_last_of('.')), module, passes, optimize);
 
-    std::cout << "Arquivos gerados: " << filename.substr(0, filename.find_last_of('.')) << ".LEX e " << filename.substr(0, filename.find_last_of('.')) << ".TAB\n";
+    std::cout << "Arquivos gerados: " << sourceName.substr(0, sourceName.find_last_of('.')) << ".LEX e " << sourceName.substr(0, sourceName.find_last_of('.')) << ".TAB\n";
+
+    if (run)
+    {
+        try
+        {
+            BcProgram program;
+            {
+                TRACE_SCOPE("bytecode", "");
+                program = BcLowering(fuseKernels).lower(module);
+            }
+            if (cache)
+            {
+                writeBytecodeCache(base + ".251c", program, cacheKey);
+                std::cout << "Bytecode gerado: " << base << ".251c\n";
+            }
+            _runProgram(program, profile ? base : "", jit);
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
     return 0;
 }
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CANGA_MMAP 1
+#endif
+
+// ===============================
+//  Arquivo mapeado em memória
+// ===============================
+// Somente leitura, usado pelos formatos binários (.251i, .251c). Sem mmap
+// (fora de sistemas POSIX) o arquivo é lido para um buffer.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path)
+    {
+#ifdef CANGA_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Erro ao abrir arquivo: " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Erro ao abrir arquivo: " + path);
+        }
+        size_ = (size_t)st.st_size;
+        if (size_ > 0)
+        {
+            void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Erro ao mapear arquivo: " + path);
+            }
+            data_ = (const char *)p;
+        }
+        ::close(fd);
+#else
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            throw std::runtime_error("Erro ao abrir arquivo: " + path);
+        char chunk[64 * 1024];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+            buffer_.insert(buffer_.end(), chunk, chunk + n);
+        std::fclose(file);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef CANGA_MMAP
+        if (data_)
+            munmap((void *)data_, size_);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> buffer_;
+};
@@ -0,0 +1,346 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mappedFile.cpp"
+
+// ===============================
+//  Interface de módulo (.251i)
+// ===============================
+// Um .251 compilado com --emit-interface gera um arquivo binário com o que
+// outro programa precisa para usá-lo sem reanalisar o texto: os símbolos
+// das seções DECLARATIONS e dos parâmetros (tipo e extensão de arrays, como
+// na tabela de símbolos), as assinaturas das funções (FUNCTYPE/paramType) e
+// o texto de cada função, lido só quando a IR precisa do corpo.
+//
+// O arquivo é mapeado em memória (mmap) e usado no lugar: as tabelas de
+// símbolos e de funções são vetores de registros de tamanho fixo ordenados
+// por nome, consultados por busca binária, e os nomes são offsets num bloco
+// de texto. Abrir uma interface custa O(1), e cada consulta O(log n), sem
+// depender do tamanho da biblioteca. Os inteiros estão na ordem de bytes da
+// máquina que gerou o arquivo.
+
+const char INTERFACE_MAGIC[8] = {'C', 'A', 'N', 'G', 'A', '2', '5', '1'};
+const uint32_t INTERFACE_VERSION = 1;
+
+struct InterfaceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t symbolCount;
+    uint32_t functionCount;
+    uint32_t paramCount;
+    uint32_t symbolsOffset; // offsets a partir do início do arquivo
+    uint32_t functionsOffset;
+    uint32_t paramsOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+// Símbolo declarado: variável de DECLARATIONS ou parâmetro de função
+struct InterfaceSymbol
+{
+    enum : uint8_t
+    {
+        GLOBAL = 1,
+        PARAM = 2
+    };
+
+    uint32_t name; // offset no bloco de texto
+    uint32_t nameLength;
+    char type[2]; // código da tabela de símbolos (IN, FP, AI, ...)
+    uint8_t kind;
+    uint8_t padding;
+    int32_t arraySize;
+};
+
+struct InterfaceFunction
+{
+    uint32_t name;
+    uint32_t nameLength;
+    char retType[2];
+    uint16_t padding;
+    uint32_t firstParam; // índice em params
+    uint32_t paramCount;
+    uint32_t body; // texto de FUNCTYPE até ENDFUNCTION
+    uint32_t bodyLength;
+    int32_t bodyLine; // linha do FUNCTYPE no fonte original
+};
+
+struct InterfaceParam
+{
+    uint32_t name;
+    uint32_t nameLength;
+    char type[2];
+    uint16_t padding;
+    int32_t arraySize;
+};
+
+class ModuleInterface
+{
+public:
+    explicit ModuleInterface(const std::string &path)
+        : path_(path), file_(path), data_(file_.data()), size_(file_.size())
+    {
+        load();
+    }
+
+    ModuleInterface(const ModuleInterface &) = delete;
+    ModuleInterface &operator=(const ModuleInterface &) = delete;
+
+    const std::string &path() const
+    {
+        return path_;
+    }
+
+    size_t symbolCount() const
+    {
+        return header_.symbolCount;
+    }
+
+    size_t functionCount() const
+    {
+        return header_.functionCount;
+    }
+
+    const InterfaceFunction &function(size_t i) const
+    {
+        return functions_[i];
+    }
+
+    const InterfaceParam &param(const InterfaceFunction &fn, size_t i) const
+    {
+        size_t k = (size_t)fn.firstParam + i;
+        if (i >= fn.paramCount || k >= header_.paramCount)
+            invalid("parametro fora da tabela");
+        return params_[k];
+    }
+
+    // Símbolo ou função pelo nome (já truncado como na tabela de símbolos), ou nulo
+    const InterfaceSymbol *findSymbol(std::string_view name) const
+    {
+        return find(symbols_, header_.symbolCount, name);
+    }
+
+    const InterfaceFunction *findFunction(std::string_view name) const
+    {
+        return find(functions_, header_.functionCount, name);
+    }
+
+    std::string_view text(uint32_t offset, uint32_t length) const
+    {
+        if (offset > header_.stringsSize || length > header_.stringsSize - offset)
+            invalid("texto fora do arquivo");
+        return std::string_view(strings_ + offset, length);
+    }
+
+    template <typename Record>
+    std::string_view nameOf(const Record &r) const
+    {
+        return text(r.name, r.nameLength);
+    }
+
+    // Conteúdo do arquivo (entra na chave do cache de bytecode)
+    std::string_view bytes() const
+    {
+        return std::string_view(data_, size_);
+    }
+
+    static std::string_view code(const char (&type)[2])
+    {
+        return std::string_view(type, 2);
+    }
+
+private:
+    std::string path_;
+    MappedFile file_;
+    const char *data_;
+    size_t size_;
+    InterfaceHeader header_;
+    const InterfaceSymbol *symbols_ = nullptr;
+    const InterfaceFunction *functions_ = nullptr;
+    const InterfaceParam *params_ = nullptr;
+    const char *strings_ = nullptr;
+
+    [[noreturn]] void invalid(const std::string &why) const
+    {
+        throw std::runtime_error("Interface invalida (" + why + "): " + path_);
+    }
+
+    // Confere o cabeçalho e localiza as tabelas
+    void load()
+    {
+        if (size_ < sizeof(InterfaceHeader))
+            invalid("arquivo truncado");
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (std::memcmp(header_.magic, INTERFACE_MAGIC, sizeof(INTERFACE_MAGIC)) != 0)
+            invalid("nao e uma interface .251i");
+        if (header_.version != INTERFACE_VERSION)
+            invalid("versao " + std::to_string(header_.version) + " nao suportada");
+
+        // Só os limites das tabelas são verificados aqui; offsets de nomes e
+        // corpos, a cada acesso
+        checkTable(header_.symbolsOffset, header_.symbolCount, sizeof(InterfaceSymbol));
+        checkTable(header_.functionsOffset, header_.functionCount, sizeof(InterfaceFunction));
+        checkTable(header_.paramsOffset, header_.paramCount, sizeof(InterfaceParam));
+        checkTable(header_.stringsOffset, header_.stringsSize, 1);
+        symbols_ = (const InterfaceSymbol *)(data_ + header_.symbolsOffset);
+        functions_ = (const InterfaceFunction *)(data_ + header_.functionsOffset);
+        params_ = (const InterfaceParam *)(data_ + header_.paramsOffset);
+        strings_ = data_ + header_.stringsOffset;
+    }
+
+    void checkTable(uint32_t offset, uint32_t count, size_t recordSize) const
+    {
+        if (offset % 4 != 0 || offset > size_ || (uint64_t)count * recordSize > size_ - offset)
+            invalid("tabela fora do arquivo");
+    }
+
+    template <typename Record>
+    const Record *find(const Record *table, uint32_t count, std::string_view name) const
+    {
+        size_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int c = nameOf(table[mid]).compare(name);
+            if (c == 0)
+                return &table[mid];
+            if (c < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return nullptr;
+    }
+};
+
+// Monta as tabelas de uma interface e grava o arquivo .251i
+class InterfaceBuilder
+{
+public:
+    struct Param
+    {
+        std::string name;
+        std::string type;
+        int arraySize = 0;
+    };
+
+    void addSymbol(std::string_view name, std::string_view type, uint8_t kind, int arraySize)
+    {
+        symbols_.push_back({std::string(name), std::string(type), kind, arraySize});
+    }
+
+    void addFunction(std::string_view name, std::string_view retType, std::vector<Param> params,
+                     std::string_view body, int bodyLine)
+    {
+        functions_.push_back({std::string(name), std::string(retType), std::move(params), std::string(body), bodyLine});
+    }
+
+    void write(const std::string &path)
+    {
+        std::sort(symbols_.begin(), symbols_.end(), [](auto &a, auto &b)
+                  { return a.name < b.name; });
+        std::sort(functions_.begin(), functions_.end(), [](auto &a, auto &b)
+                  { return a.name < b.name; });
+
+        std::string strings;
+        auto intern = [&](const std::string &s)
+        {
+            uint32_t at = (uint32_t)strings.size();
+            strings += s;
+            return at;
+        };
+        auto setCode = [](char (&dst)[2], const std::string &code)
+        {
+            dst[0] = code.size() > 0 ? code[0] : 'V';
+            dst[1] = code.size() > 1 ? code[1] : 'D';
+        };
+
+        std::vector<InterfaceSymbol> symbols;
+        for (auto &s : symbols_)
+        {
+            InterfaceSymbol r = {};
+            r.name = intern(s.name);
+            r.nameLength = (uint32_t)s.name.size();
+            setCode(r.type, s.type);
+            r.kind = s.kind;
+            r.arraySize = s.arraySize;
+            symbols.push_back(r);
+        }
+        std::vector<InterfaceFunction> functions;
+        std::vector<InterfaceParam> params;
+        for (auto &f : functions_)
+        {
+            InterfaceFunction r = {};
+            r.name = intern(f.name);
+            r.nameLength = (uint32_t)f.name.size();
+            setCode(r.retType, f.retType);
+            r.firstParam = (uint32_t)params.size();
+            r.paramCount = (uint32_t)f.params.size();
+            for (auto &p : f.params)
+            {
+                InterfaceParam q = {};
+                q.name = intern(p.name);
+                q.nameLength = (uint32_t)p.name.size();
+                setCode(q.type, p.type);
+                q.arraySize = p.arraySize;
+                params.push_back(q);
+            }
+            r.body = intern(f.body);
+            r.bodyLength = (uint32_t)f.body.size();
+            r.bodyLine = f.bodyLine;
+            functions.push_back(r);
+        }
+
+        InterfaceHeader header = {};
+        std::memcpy(header.magic, INTERFACE_MAGIC, sizeof(INTERFACE_MAGIC));
+        header.version = INTERFACE_VERSION;
+        header.symbolCount = (uint32_t)symbols.size();
+        header.functionCount = (uint32_t)functions.size();
+        header.paramCount = (uint32_t)params.size();
+        header.symbolsOffset = (uint32_t)sizeof(InterfaceHeader);
+        header.functionsOffset = header.symbolsOffset + (uint32_t)(symbols.size() * sizeof(InterfaceSymbol));
+        header.paramsOffset = header.functionsOffset + (uint32_t)(functions.size() * sizeof(InterfaceFunction));
+        header.stringsOffset = header.paramsOffset + (uint32_t)(params.size() * sizeof(InterfaceParam));
+        header.stringsSize = (uint32_t)strings.size();
+
+        std::FILE *out = std::fopen(path.c_str(), "wb");
+        if (!out)
+            throw std::runtime_error("Erro ao criar arquivo: " + path);
+        bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  std::fwrite(symbols.data(), sizeof(InterfaceSymbol), symbols.size(), out) == symbols.size() &&
+                  std::fwrite(functions.data(), sizeof(InterfaceFunction), functions.size(), out) == functions.size() &&
+                  std::fwrite(params.data(), sizeof(InterfaceParam), params.size(), out) == params.size() &&
+                  std::fwrite(strings.data(), 1, strings.size(), out) == strings.size();
+        if (std::fclose(out) != 0 || !ok)
+            throw std::runtime_error("Erro ao gravar arquivo: " + path);
+    }
+
+private:
+    struct Symbol
+    {
+        std::string name;
+        std::string type;
+        uint8_t kind;
+        int arraySize;
+    };
+
+    struct Function
+    {
+        std::string name;
+        std::string retType;
+        std::vector<Param> params;
+        std::string body;
+        int bodyLine;
+    };
+
+    std::vector<Symbol> symbols_;
+    std::vector<Function> functions_;
+};
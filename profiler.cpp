@@ -0,0 +1,163 @@
+#pragma once
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "interpreter.cpp"
+
+// ===============================
+//  Relatórios do perfil de execução
+// ===============================
+// A partir dos contadores por pc e das pilhas amostradas do ExecutionProfile:
+// - relatório de pontos quentes por função (FUNCTYPE e o bloco principal) e
+//   por linha do fonte, ordenados por instruções executadas
+// - pilhas no formato "folded" (quadro;quadro;... valor) lido por
+//   flamegraph.pl, speedscope e afins; cada quadro é "FUNCAO:linha" e o
+//   valor está em microssegundos
+
+// Função que contém o pc (os trechos de código das funções não se sobrepõem)
+static int32_t _profileFunctionOf(const BcProgram &program, int32_t pc)
+{
+    for (size_t f = 0; f < program.functions.size(); ++f)
+        if (pc >= program.functions[f].codeStart && pc < program.functions[f].codeEnd)
+            return (int32_t)f;
+    return -1;
+}
+
+// Linha de cada pc. Instruções sem linha própria (cópias de PHI, cargas de
+// globais) ficam com a linha da próxima instrução do mesmo trecho sem
+// desvios, ou da anterior quando o trecho termina sem linha.
+static std::vector<int> _profileLines(const BcProgram &program)
+{
+    std::vector<int> lines(program.lines.begin(), program.lines.end());
+    auto endsRun = [&](int32_t pc)
+    {
+        Opcode op = program.code[pc].op;
+        return op == Opcode::JMP || op == Opcode::JT || op == Opcode::JF || op == Opcode::RET ||
+               op == Opcode::RETV;
+    };
+    for (auto &fn : program.functions)
+    {
+        int next = 0;
+        for (int32_t pc = fn.codeEnd - 1; pc >= fn.codeStart; --pc)
+        {
+            if (endsRun(pc))
+                next = 0;
+            next = lines[pc] = lines[pc] ? lines[pc] : next;
+        }
+        int last = 0;
+        for (int32_t pc = fn.codeStart; pc < fn.codeEnd; ++pc)
+            last = lines[pc] = lines[pc] ? lines[pc] : last;
+        // Início da função sem linha: a primeira linha conhecida
+        for (int32_t pc = fn.codeEnd - 1; pc >= fn.codeStart; --pc)
+            next = lines[pc] = lines[pc] ? lines[pc] : next;
+    }
+    return lines;
+}
+
+struct ProfileEntry
+{
+    std::string name;
+    int line = 0;
+    uint64_t instructions = 0;
+    uint64_t nanoseconds = 0;
+};
+
+// Totais por função ou por linha, do mais executado para o menos executado
+static std::vector<ProfileEntry> _profileTotals(const BcProgram &program, const ExecutionProfile &profile,
+                                                bool byLine)
+{
+    std::vector<int32_t> functionOf(program.code.size(), -1);
+    for (size_t f = 0; f < program.functions.size(); ++f)
+        for (int32_t pc = program.functions[f].codeStart; pc < program.functions[f].codeEnd; ++pc)
+            functionOf[pc] = (int32_t)f;
+
+    std::vector<int> lines = _profileLines(program);
+    std::map<std::pair<int32_t, int>, ProfileEntry> totals;
+    auto entryAt = [&](int32_t pc) -> ProfileEntry &
+    {
+        int32_t f = functionOf[pc];
+        int line = byLine ? lines[pc] : 0;
+        ProfileEntry &e = totals[{f, line}];
+        e.name = f >= 0 ? program.functions[f].name : "?";
+        e.line = line;
+        return e;
+    };
+    for (size_t pc = 0; pc < profile.counts.size(); ++pc)
+        if (profile.counts[pc])
+            entryAt((int32_t)pc).instructions += profile.counts[pc];
+    for (auto &s : profile.stacks)
+        entryAt(s.first.back()).nanoseconds += s.second;
+
+    std::vector<ProfileEntry> out;
+    for (auto &t : totals)
+        out.push_back(t.second);
+    std::stable_sort(out.begin(), out.end(), [](const ProfileEntry &a, const ProfileEntry &b)
+                     { return a.instructions != b.instructions ? a.instructions > b.instructions
+                                                               : a.nanoseconds > b.nanoseconds; });
+    return out;
+}
+
+void writeProfileReport(std::ostream &os, const BcProgram &program, const ExecutionProfile &profile)
+{
+    uint64_t instructions = 0, nanoseconds = 0;
+    for (uint64_t c : profile.counts)
+        instructions += c;
+    for (auto &s : profile.stacks)
+        nanoseconds += s.second;
+    auto percent = [](uint64_t part, uint64_t total)
+    {
+        return total ? 100.0 * (double)part / (double)total : 0.0;
+    };
+
+    os << "Perfil de execucao: " << instructions << " instrucoes, " << std::fixed << std::setprecision(3)
+       << profile.wallNs / 1e6 << " ms";
+    if (profile.timed)
+        os << ", " << profile.samples << " amostras de tempo a cada " << PROFILE_SAMPLE_US << " us";
+    else
+        os << " (amostragem de tempo indisponivel nesta plataforma)";
+    os << "\n\n";
+
+    os << "Funcoes:\n"
+       << std::left << std::setw(36) << "Funcao" << std::right << std::setw(16) << "Instrucoes"
+       << std::setw(9) << "%" << std::setw(14) << "Tempo(ms)" << std::setw(9) << "%" << "\n";
+    for (auto &e : _profileTotals(program, profile, false))
+        os << std::left << std::setw(36) << e.name << std::right << std::setw(16) << e.instructions
+           << std::setprecision(2) << std::setw(9) << percent(e.instructions, instructions)
+           << std::setprecision(3) << std::setw(14) << e.nanoseconds / 1e6
+           << std::setprecision(2) << std::setw(9) << percent(e.nanoseconds, nanoseconds) << "\n";
+
+    os << "\nLinhas:\n"
+       << std::left << std::setw(8) << "Linha" << std::setw(28) << "Funcao" << std::right << std::setw(16)
+       << "Instrucoes" << std::setw(9) << "%" << std::setw(14) << "Tempo(ms)" << std::setw(9) << "%" << "\n";
+    for (auto &e : _profileTotals(program, profile, true))
+        os << std::left << std::setw(8) << e.line << std::setw(28) << e.name << std::right << std::setw(16)
+           << e.instructions << std::setprecision(2) << std::setw(9) << percent(e.instructions, instructions)
+           << std::setprecision(3) << std::setw(14) << e.nanoseconds / 1e6
+           << std::setprecision(2) << std::setw(9) << percent(e.nanoseconds, nanoseconds) << "\n";
+}
+
+// Uma linha por pilha distinta; pilhas que diferem só pelo pc dentro da
+// mesma linha são somadas
+void writeFoldedStacks(std::ostream &os, const BcProgram &program, const ExecutionProfile &profile)
+{
+    std::vector<int> lines = _profileLines(program);
+    std::map<std::string, uint64_t> folded;
+    for (auto &s : profile.stacks)
+    {
+        std::string key;
+        for (int32_t pc : s.first)
+        {
+            int32_t f = _profileFunctionOf(program, pc);
+            if (!key.empty())
+                key += ';';
+            key += (f >= 0 ? program.functions[f].name : "?") + ":" + std::to_string(lines[pc]);
+        }
+        folded[key] += s.second;
+    }
+    for (auto &f : folded)
+        if (f.second >= 1000)
+            os << f.first << " " << f.second / 1000 << "\n";
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "symbolTable.cpp"
+#include "trace.cpp"
+
+// ===============================
+//  Formatação dos relatórios .LEX e .TAB
+// ===============================
+// Cada registro é formatado de forma independente, então a lista é dividida
+// em fatias contíguas formatadas em threads separadas; concatenar as fatias
+// na ordem produz exatamente o mesmo texto da formatação sequencial.
+
+// Fatias menores que isso não compensam criar uma thread
+const size_t REPORT_MIN_SHARD = 4096;
+
+// Formata os itens [0, count) com format(os, i) em até `jobs` fatias
+// e devolve o texto de cada fatia, na ordem
+template <typename Format>
+std::vector<std::string> formatSharded(size_t count, unsigned jobs, Format format)
+{
+    size_t shards = std::max<size_t>(1, std::min<size_t>(jobs, count / REPORT_MIN_SHARD));
+    std::vector<std::string> out(shards);
+    auto work = [&](size_t shard)
+    {
+        TRACE_SCOPE("formatacao", "");
+        std::ostringstream os;
+        for (size_t i = count * shard / shards; i < count * (shard + 1) / shards; ++i)
+            format(os, i);
+        out[shard] = os.str();
+    };
+
+    // A última fatia fica com a thread atual
+    std::vector<std::thread> threads;
+    for (size_t shard = 0; shard + 1 < shards; ++shard)
+        threads.emplace_back([&work, shard]
+                             {
+                                 TRACE_THREAD("relatorios");
+                                 work(shard); });
+    work(shards - 1);
+    for (auto &t : threads)
+        t.join();
+    return out;
+}
+
+// Registros do .LEX (sem o cabeçalho da equipe); `lines` é o índice do texto
+// analisado (SymbolTable::lines)
+std::vector<std::string> formatLexRecords(const LexemeList &lexemes, const LineIndex &lines, unsigned jobs = 1)
+{
+    return formatSharded(lexemes.size(), jobs, [&](std::ostream &os, size_t i)
+                         {
+                             const LexemeRecord &r = lexemes[i];
+                             os << "Lexeme: " << r.lexeme << ", Código: "
+                                << (SymbolTable::tokenTypeToString(r.type)) << ", ÍndiceTabSimb: "
+                                << (r.tableIndex > 0 ? std::to_string(r.tableIndex) : "-") << ", Linha: "
+                                << lines.line(r.offset) << ".\n"; });
+}
+
+// Entradas do .TAB (sem o cabeçalho da equipe), em ordem de entrada
+std::vector<std::string> formatSymbolEntries(const SymbolTable &symtab, unsigned jobs = 1)
+{
+    const auto &syms = symtab.all();
+    return formatSharded(syms.size(), jobs, [&](std::ostream &os, size_t i)
+                         {
+                             const SymbolTable::SymbolInfo &info = syms[i];
+                             os << "Entrada: " << info.entry << ", Codigo: "
+                                << info.atomCode << ", Lexeme: " << info.lexeme << ",\n"
+                                << "QtdCharAntesTrunc: " << info.lenBefore << ", QtdCharDepoisTrunc: "
+                                << info.lenAfter << ",\n"
+                                << "TipoSimb: " << info.type << ", Linhas: {";
+                             std::vector<int> lines = symtab.tableLines(info.entry);
+                             for (size_t j = 0; j < lines.size(); ++j)
+                             {
+                                 if (j)
+                                     os << ", ";
+                                 os << lines[j];
+                             }
+                             os << "}.\n";
+                             if (i < syms.size() - 1)
+                             {
+                                 os << "----------------------------------------------------------------------------------------------------\n";
+                             } });
+}
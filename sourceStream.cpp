@@ -0,0 +1,279 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include "lexer.cpp"
+#ifdef CANGA_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+// ===============================
+//  Leitura do fonte em fluxo
+// ===============================
+// Fontes de bytes lidas em blocos: arquivo comum ou compactado com gzip.
+// O StreamingLexer analisa o fluxo mantendo em memória só uma janela do
+// texto, em vez do arquivo inteiro.
+
+class SourceReader
+{
+public:
+    virtual ~SourceReader() {}
+
+    // Lê até `capacity` bytes; devolve 0 no fim do arquivo
+    virtual size_t read(char *buffer, size_t capacity) = 0;
+};
+
+class FileSourceReader : public SourceReader
+{
+public:
+    explicit FileSourceReader(const std::string &path)
+        : file_(std::fopen(path.c_str(), "rb"))
+    {
+        if (!file_)
+            throw std::runtime_error("Erro ao abrir arquivo: " + path);
+    }
+
+    ~FileSourceReader()
+    {
+        std::fclose(file_);
+    }
+
+    size_t read(char *buffer, size_t capacity) override
+    {
+        return std::fread(buffer, 1, capacity, file_);
+    }
+
+private:
+    std::FILE *file_;
+};
+
+#ifdef CANGA_WITH_ZLIB
+// Descompacta um arquivo .gz em blocos, sem gravar o texto descompactado
+class GzipSourceReader : public SourceReader
+{
+public:
+    explicit GzipSourceReader(const std::string &path)
+        : file_(gzopen(path.c_str(), "rb"))
+    {
+        if (!file_)
+            throw std::runtime_error("Erro ao abrir arquivo: " + path);
+        gzbuffer(file_, 128 * 1024);
+    }
+
+    ~GzipSourceReader()
+    {
+        gzclose(file_);
+    }
+
+    size_t read(char *buffer, size_t capacity) override
+    {
+        int n = gzread(file_, buffer, (unsigned)std::min<size_t>(capacity, 1u << 30));
+        if (n < 0)
+        {
+            int code;
+            throw std::runtime_error(std::string("Erro ao descompactar: ") + gzerror(file_, &code));
+        }
+        return (size_t)n;
+    }
+
+private:
+    gzFile file_;
+};
+#endif
+
+inline bool isGzipPath(const std::string &path)
+{
+    return path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+}
+
+// Abre o arquivo com o leitor adequado à extensão
+inline std::unique_ptr<SourceReader> openSourceReader(const std::string &path)
+{
+    if (isGzipPath(path))
+    {
+#ifdef CANGA_WITH_ZLIB
+        return std::unique_ptr<SourceReader>(new GzipSourceReader(path));
+#else
+        throw std::runtime_error("Entrada compactada requer compilar com -DCANGA_WITH_ZLIB -lz: " + path);
+#endif
+    }
+    return std::unique_ptr<SourceReader>(new FileSourceReader(path));
+}
+
+// Lê o fluxo inteiro (usado quando a IR precisa do texto completo)
+inline std::string readAllSource(SourceReader &reader)
+{
+    std::string text;
+    const size_t CHUNK = 64 * 1024;
+    while (true)
+    {
+        size_t used = text.size();
+        text.resize(used + CHUNK);
+        size_t n = reader.read(&text[used], CHUNK);
+        text.resize(used + n);
+        if (n == 0)
+            return text;
+    }
+}
+
+// Lexer sobre uma janela do fluxo. A janela guarda o texto a partir do
+// início dos últimos tokens entregues (para putBackToken) e é completada
+// em blocos quando restam menos de meio bloco à frente. Um token que chega
+// ao fim da janela (comentário ou literal longo) é re-analisado depois de
+// ler mais texto, então a janela só cresce além de ~2 blocos por causa de
+// tokens maiores que isso. Offsets dos tokens são absolutos; cada bloco lido
+// é acrescentado ao índice de linhas `lines`, que cobre o fluxo inteiro.
+class StreamingLexer
+{
+public:
+    StreamingLexer(SourceReader &reader, LineIndex &lines, size_t chunk = 64 * 1024)
+        : reader_(reader), lines_(lines), chunk_(chunk)
+    {
+        restart(0);
+    }
+
+    void setLimits(const AnalysisLimits &limits)
+    {
+        limits_ = limits;
+        restart(lexer_->position());
+    }
+
+    void setMemoryResource(std::pmr::memory_resource *resource)
+    {
+        resource_ = resource;
+        lexer_->setMemoryResource(resource);
+    }
+
+    Token nextToken()
+    {
+        if (++tokensRead_ > limits_.maxTokens)
+            throw std::runtime_error("Erro na linha " + std::to_string(lexer_->line()) +
+                                     ": Limite de " + std::to_string(limits_.maxTokens) + " tokens excedido");
+
+        while (true)
+        {
+            if (!eof_ && window_.size() - lexer_->position() < chunk_ / 2)
+                refill();
+
+            size_t start = lexer_->position();
+            // Mesmo recurso do lexer: a atribuição move o lexema sem copiar
+            Token tok{TokenType::END_OF_FILE, std::pmr::string(resource_)};
+            try
+            {
+                tok = lexer_->nextToken();
+            }
+            catch (const std::runtime_error &)
+            {
+                // O erro pode ser só o fim da janela (string ou comentário
+                // ainda não fechados, UTF-8 cortado ao meio)
+                if (eof_ || lexer_->position() + 4 < window_.size())
+                    throw;
+                restart(start);
+                refill();
+                continue;
+            }
+
+            // O lexer olha no máximo um caractere além do token
+            if (!eof_ && lexer_->position() + 4 >= window_.size())
+            {
+                restart(start);
+                refill();
+                continue;
+            }
+
+            tok.offset += base_;
+            recent_.push_back(tok.offset);
+            if (recent_.size() > KEEP_TOKENS)
+                recent_.pop_front();
+            return tok;
+        }
+    }
+
+    // Devolve um dos últimos KEEP_TOKENS tokens entregues
+    void putBackToken(const Token &tok)
+    {
+        if (tok.offset < base_)
+            throw std::runtime_error("Token devolvido fora da janela de leitura");
+        Token local = tok;
+        local.offset -= base_;
+        lexer_->putBackToken(local);
+        while (!recent_.empty() && recent_.back() >= tok.offset)
+            recent_.pop_back();
+    }
+
+    // Linha do início do token (offset absoluto)
+    int lineOf(const Token &tok) const
+    {
+        return lines_.line(tok.offset);
+    }
+
+    size_t tokensRead() const
+    {
+        return tokensRead_;
+    }
+
+    // Posição absoluta no fluxo
+    size_t position() const
+    {
+        return base_ + lexer_->position();
+    }
+
+    // Maior tamanho alcançado pela janela
+    size_t peakWindow() const
+    {
+        return peakWindow_;
+    }
+
+private:
+    static const size_t KEEP_TOKENS = 4;
+
+    SourceReader &reader_;
+    LineIndex &lines_;
+    size_t chunk_;
+    std::string window_; // texto a partir da posição absoluta base_
+    size_t base_ = 0;
+    bool eof_ = false;
+    std::unique_ptr<Lexer> lexer_;
+    AnalysisLimits limits_;
+    std::pmr::memory_resource *resource_ = std::pmr::get_default_resource();
+    size_t tokensRead_ = 0;
+    std::deque<size_t> recent_; // início absoluto dos últimos tokens
+    size_t peakWindow_ = 0;
+
+    // Recria o lexer na posição relativa `pos`; a contagem de tokens fica aqui
+    void restart(size_t pos)
+    {
+        AnalysisLimits limits = limits_;
+        limits.maxTokens = std::numeric_limits<size_t>::max();
+        lexer_.reset(new Lexer(window_, pos, &lines_, base_));
+        lexer_->setLimits(limits);
+        lexer_->setMemoryResource(resource_);
+    }
+
+    // Descarta o texto já consumido e lê mais um bloco
+    void refill()
+    {
+        size_t pos = lexer_->position();
+        size_t keep = pos;
+        if (!recent_.empty())
+            keep = std::min(keep, recent_.front() - base_);
+        if (keep >= chunk_)
+        {
+            window_.erase(0, keep);
+            base_ += keep;
+            pos -= keep;
+        }
+
+        size_t used = window_.size();
+        window_.resize(used + chunk_);
+        size_t n = reader_.read(&window_[used], chunk_);
+        window_.resize(used + n);
+        lines_.append(std::string_view(window_.data() + used, n));
+        eof_ = n == 0;
+        peakWindow_ = std::max(peakWindow_, window_.size());
+        restart(pos);
+    }
+};
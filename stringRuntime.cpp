@@ -0,0 +1,324 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "As strings curtas no Slot supoem ordem de bytes little-endian"
+#endif
+
+// ===============================
+//  Strings em tempo de execução
+// ===============================
+// Um valor string ocupa 8 bytes no Slot, como os demais tipos, numa de duas
+// formas:
+// - curta (até STRING_INLINE_MAX bytes): o texto fica no próprio valor; o
+//   primeiro byte guarda (tamanho << 1) | 1 e os seguintes, os caracteres.
+//   Conversões de char, booleanos e inteiros pequenos não alocam nada
+// - ponteiro para um StringObj imutável (alinhado, então o bit 0 é zero):
+//   texto contíguo (constante do programa ou copiado para a arena) ou uma
+//   corda, a concatenação adiada de dois StringObj. A corda é achatada na
+//   primeira vez que o texto é lido (PRINT, comparação) e o texto montado
+//   fica guardado no próprio nó, num StringBuffer com folga.
+// Assim `s := s + x` num WHILE custa O(|x|) por iteração em vez de copiar s
+// inteira a cada volta. Se o texto for lido a cada volta, a corda nova é
+// `s` já achatada mais o acréscimo: o acréscimo é copiado para o fim do
+// buffer de `s`, que só é realocado (com o dobro do tamanho) quando enche,
+// e a memória total fica linear no tamanho final. Tudo é alocado numa
+// arena liberada com o interpretador, como os arrays.
+
+const size_t STRING_INLINE_MAX = 7;
+// Concatenações até este tamanho são copiadas em vez de virar corda: evita
+// nós para pedaços pequenos e mantém as folhas da corda com algumas dezenas
+// de bytes
+const size_t STRING_LEAF_MAX = 32;
+
+// Área de texto de uma corda achatada, seguida dos seus `capacity` bytes.
+// Várias strings podem apontar para o início dela, cada uma com o seu
+// tamanho; `used` é o da mais longa, e só ela pode ser estendida no lugar
+// (as demais continuam vendo os seus primeiros bytes, que não mudam)
+struct StringBuffer
+{
+    size_t capacity;
+    size_t used;
+
+    char *data()
+    {
+        return (char *)(this + 1);
+    }
+};
+
+// Tamanho mínimo do buffer de uma corda achatada que estende outro buffer
+const size_t STRING_BUFFER_MIN = 256;
+
+struct StringObj
+{
+    size_t length;
+    mutable const char *text;              // nulo numa corda ainda não achatada
+    mutable const StringObj *left, *right; // partes da corda
+    mutable StringBuffer *buffer;          // onde `text` está, se veio de um achatamento
+};
+
+class StringHeap
+{
+public:
+    static uint64_t empty()
+    {
+        return 1;
+    }
+
+    static bool isInline(uint64_t s)
+    {
+        return s & 1;
+    }
+
+    static size_t length(uint64_t s)
+    {
+        return isInline(s) ? (size_t)((s & 0xff) >> 1) : object(s)->length;
+    }
+
+    // Texto de `s`; para uma string curta, aponta para dentro do próprio
+    // valor, que deve continuar vivo enquanto a view for usada
+    std::string_view view(const uint64_t &s)
+    {
+        if (isInline(s))
+            return std::string_view((const char *)&s + 1, length(s));
+        const StringObj *obj = object(s);
+        if (!obj->text)
+            flatten(obj);
+        return std::string_view(obj->text, obj->length);
+    }
+
+    // Cópia de `text`
+    uint64_t make(std::string_view text)
+    {
+        if (text.size() <= STRING_INLINE_MAX)
+            return shortString(text, std::string_view());
+        return value(newLeaf(copy(text, std::string_view()), text.size()));
+    }
+
+    // Constante do programa: o texto não é copiado e deve continuar vivo
+    uint64_t literal(const std::string &text)
+    {
+        if (text.size() <= STRING_INLINE_MAX)
+            return shortString(text, std::string_view());
+        return value(newLeaf(text.data(), text.size()));
+    }
+
+    uint64_t concat(uint64_t a, uint64_t b)
+    {
+        size_t la = length(a), lb = length(b);
+        if (la == 0)
+            return b;
+        if (lb == 0)
+            return a;
+        if (la + lb <= STRING_INLINE_MAX)
+            return shortString(view(a), view(b));
+        if (la + lb <= STRING_LEAF_MAX)
+            return value(newLeaf(copy(view(a), view(b)), la + lb));
+
+        // Acréscimo curto a uma corda cuja última folha também é curta: a
+        // folha é refeita com o acréscimo, sem aprofundar a corda
+        if (!isInline(a) && !object(a)->text && lb < STRING_LEAF_MAX)
+        {
+            const StringObj *last = object(a)->right;
+            if (last->text && last->length + lb <= STRING_LEAF_MAX)
+            {
+                const StringObj *leaf = newLeaf(copy(std::string_view(last->text, last->length), view(b)),
+                                                last->length + lb);
+                return value(newRope(object(a)->left, leaf));
+            }
+        }
+        return value(newRope(toObject(a), toObject(b)));
+    }
+
+    // Bytes já alocados na arena (texto e nós)
+    size_t allocated() const
+    {
+        return allocated_;
+    }
+
+private:
+    std::pmr::monotonic_buffer_resource arena_;
+    size_t allocated_ = 0;
+    std::vector<const StringObj *> pending_; // pilha do achatamento
+
+    static const StringObj *object(uint64_t s)
+    {
+        return (const StringObj *)(uintptr_t)s;
+    }
+
+    static uint64_t value(const StringObj *obj)
+    {
+        return (uint64_t)(uintptr_t)obj;
+    }
+
+    static uint64_t shortString(std::string_view a, std::string_view b)
+    {
+        uint64_t s = ((uint64_t)(a.size() + b.size()) << 1) | 1;
+        a.copy((char *)&s + 1, a.size());
+        b.copy((char *)&s + 1 + a.size(), b.size());
+        return s;
+    }
+
+    void *allocate(size_t bytes, size_t alignment)
+    {
+        allocated_ += bytes;
+        return arena_.allocate(bytes, alignment);
+    }
+
+    const char *copy(std::string_view a, std::string_view b)
+    {
+        char *text = (char *)allocate(a.size() + b.size(), 1);
+        a.copy(text, a.size());
+        b.copy(text + a.size(), b.size());
+        return text;
+    }
+
+    const StringObj *newLeaf(const char *text, size_t length)
+    {
+        return new (allocate(sizeof(StringObj), alignof(StringObj))) StringObj{length, text, nullptr, nullptr, nullptr};
+    }
+
+    const StringObj *newRope(const StringObj *left, const StringObj *right)
+    {
+        return new (allocate(sizeof(StringObj), alignof(StringObj)))
+            StringObj{left->length + right->length, nullptr, left, right, nullptr};
+    }
+
+    const StringObj *toObject(const uint64_t &s)
+    {
+        if (!isInline(s))
+            return object(s);
+        std::string_view text = view(s);
+        return newLeaf(copy(text, std::string_view()), text.size());
+    }
+
+    // Monta o texto da corda percorrendo as folhas da esquerda para a
+    // direita com uma pilha explícita: `s := s + x` repetido gera cordas tão
+    // profundas quanto o número de voltas. A descida começa pela espinha
+    // esquerda até o primeiro nó com texto (a base); se a base é a string
+    // mais longa do seu buffer e ele tem espaço, o restante é escrito logo
+    // depois dela, sem copiar a base
+    void flatten(const StringObj *rope)
+    {
+        const StringObj *base = rope;
+        while (!base->text)
+            base = base->left;
+        StringBuffer *buffer = base->buffer;
+        char *out;
+        if (buffer && buffer->used == base->length && buffer->capacity >= rope->length)
+            out = buffer->data() + base->length;
+        else
+        {
+            // Só estende com folga o que já veio de um achatamento: cordas
+            // achatadas uma única vez ficam com o tamanho exato
+            size_t capacity = buffer ? std::max(2 * rope->length, STRING_BUFFER_MIN) : rope->length;
+            buffer = new (allocate(sizeof(StringBuffer) + capacity, alignof(StringBuffer))) StringBuffer{capacity, 0};
+            std::memcpy(buffer->data(), base->text, base->length);
+            out = buffer->data() + base->length;
+        }
+
+        // Os filhos direitos da espinha, do mais fundo para o topo, seguem a base
+        pending_.clear();
+        for (const StringObj *node = rope; node != base; node = node->left)
+            pending_.push_back(node->right);
+        while (!pending_.empty())
+        {
+            const StringObj *node = pending_.back();
+            pending_.pop_back();
+            if (node->text)
+            {
+                std::memcpy(out, node->text, node->length);
+                out += node->length;
+                continue;
+            }
+            pending_.push_back(node->right);
+            pending_.push_back(node->left);
+        }
+        buffer->used = rope->length;
+        rope->text = buffer->data();
+        rope->buffer = buffer;
+        rope->left = rope->right = nullptr;
+    }
+};
+
+// ===============================
+//  Saída do PRINT
+// ===============================
+// O texto de cada PRINT é formatado direto num buffer, escrito no ostream
+// em blocos de PRINT_BUFFER_SIZE bytes e ao fim da execução. Reais seguem
+// o formato padrão do ostream (%g, precisão 6).
+const size_t PRINT_BUFFER_SIZE = 64 * 1024;
+
+class PrintBuffer
+{
+public:
+    explicit PrintBuffer(std::ostream &out)
+        : out_(out)
+    {
+        buffer_.reserve(PRINT_BUFFER_SIZE);
+    }
+
+    ~PrintBuffer()
+    {
+        flush();
+    }
+
+    void text(std::string_view s)
+    {
+        if (buffer_.size() + s.size() > PRINT_BUFFER_SIZE)
+        {
+            flush();
+            if (s.size() > PRINT_BUFFER_SIZE)
+            {
+                out_.write(s.data(), (std::streamsize)s.size());
+                return;
+            }
+        }
+        buffer_.append(s.data(), s.size());
+    }
+
+    void put(char c)
+    {
+        if (buffer_.size() >= PRINT_BUFFER_SIZE)
+            flush();
+        buffer_.push_back(c);
+    }
+
+    void integer(int64_t v)
+    {
+        char digits[24];
+        text(std::string_view(digits, std::to_chars(digits, digits + sizeof(digits), v).ptr - digits));
+    }
+
+    void real(double v)
+    {
+        char digits[32];
+        text(std::string_view(digits, formatReal(digits, sizeof(digits), v)));
+    }
+
+    void flush()
+    {
+        if (buffer_.empty())
+            return;
+        out_.write(buffer_.data(), (std::streamsize)buffer_.size());
+        buffer_.clear();
+    }
+
+    static size_t formatReal(char *out, size_t size, double v)
+    {
+        return (size_t)std::snprintf(out, size, "%g", v);
+    }
+
+private:
+    std::ostream &out_;
+    std::string buffer_;
+};
@@ -1,28 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "lexer.cpp"
+#include "crossReference.cpp"
+#include "moduleInterface.cpp"
 #include <bits/algorithmfwd.h>
 #include <iostream>
 
 class SymbolTable
 {
 public:
+    // As strings usam o recurso de memória da tabela: os nós do map
+    // constroem o SymbolInfo com o alocador do próprio map
     struct SymbolInfo
     {
-        int entry;
-        std::string atomCode;
-        std::string lexeme;
-        int lenBefore;
-        int lenAfter;
-        std::string type;
-        std::vector<int> lines;
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        int entry = 0;
+        std::pmr::string atomCode;
+        std::pmr::string lexeme;
+        int lenBefore = 0;
+        int lenAfter = 0;
+        std::pmr::string type;
+        int arraySize = 0; // extensão declarada do array (0 se não for array)
+
+        SymbolInfo() = default;
+        explicit SymbolInfo(const allocator_type &alloc)
+            : atomCode(alloc), lexeme(alloc), type(alloc) {}
+        SymbolInfo(const SymbolInfo &other, const allocator_type &alloc = {})
+            : entry(other.entry), atomCode(other.atomCode, alloc), lexeme(other.lexeme, alloc),
+              lenBefore(other.lenBefore), lenAfter(other.lenAfter), type(other.type, alloc),
+              arraySize(other.arraySize) {}
+        SymbolInfo(SymbolInfo &&other, const allocator_type &alloc)
+            : entry(other.entry), atomCode(std::move(other.atomCode), alloc),
+              lexeme(std::move(other.lexeme), alloc), lenBefore(other.lenBefore),
+              lenAfter(other.lenAfter), type(std::move(other.type), alloc), arraySize(other.arraySize) {}
+        SymbolInfo(SymbolInfo &&other) = default;
+        SymbolInfo &operator=(const SymbolInfo &other) = default;
+        SymbolInfo &operator=(SymbolInfo &&other) = default;
     };
 
-    SymbolTable() : nextEntry_(1) {}
+    // Toda a memória da tabela (símbolos, strings, índice por lexema) vem de
+    // `resource`, que deve viver mais que ela
+    explicit SymbolTable(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : symbols_(resource), index_(resource) {}
+
+    std::pmr::memory_resource *memoryResource() const
+    {
+        return symbols_.get_allocator().resource();
+    }
+
+    // Índice de linhas do texto analisado: as ocorrências guardam offsets e
+    // são convertidas em linha e coluna por ele
+    LineIndex &lines()
+    {
+        return lines_;
+    }
+
+    const LineIndex &lines() const
+    {
+        return lines_;
+    }
 
-    void checkIfIdentifierIsReservedKeyword(std::string truncatedLex, int line)
+    void checkIfIdentifierIsReservedKeyword(std::string_view truncatedLex, size_t offset)
     {
-        static const std::map<std::string, TokenType> reservedKeywords = {
+        static const std::map<std::string, TokenType, std::less<>> reservedKeywords = {
             {"PROGRAM", TokenType::PROGRAM},
             {"DECLARATIONS", TokenType::DECLARATIONS},
             {"ENDDECLARATIONS", TokenType::ENDDECLARATIONS},
@@ -49,66 +96,197 @@ public:
             {"TRUE", TokenType::TRUE},
             {"FALSE", TokenType::FALSE}};
 
-        std::string upperLex = truncatedLex;
-        for (auto &ch : upperLex)
-            ch = std::toupper(ch);
+        // Lexemas já vêm truncados em 35 caracteres: cabe num buffer local
+        char upperLex[MAX_LEXEME];
+        size_t n = std::min(truncatedLex.size(), sizeof(upperLex));
+        for (size_t k = 0; k < n; ++k)
+            upperLex[k] = CharClass::upper(truncatedLex[k]);
 
-        if (reservedKeywords.find(upperLex) != reservedKeywords.end())
+        if (reservedKeywords.find(std::string_view(upperLex, n)) != reservedKeywords.end())
         {
-            throw std::runtime_error("Erro na linha " + std::to_string(line) +
-                                     ": Nao pode utilizar a palavra reservada '" + truncatedLex +
+            throw std::runtime_error("Erro na linha " + std::to_string(lines_.line(offset)) +
+                                     ": Nao pode utilizar a palavra reservada '" + std::string(truncatedLex) +
                                      "' como nome de variavel");
         }
     }
 
-    int defineOrGet(const std::string &lex, int line, TokenType type)
+    // Define o símbolo (se novo) e registra a ocorrência em `offset` no
+    // índice de referências cruzadas
+    int defineOrGet(std::string_view lex, size_t offset, TokenType type)
     {
-        std::string truncatedLex = lex.substr(0, 35);
+        std::string_view truncatedLex = lex.substr(0, MAX_LEXEME);
 
-        checkIfIdentifierIsReservedKeyword(truncatedLex, line);
+        checkIfIdentifierIsReservedKeyword(truncatedLex, offset);
 
-        auto it = table_.find(truncatedLex);
+        auto it = index_.find(truncatedLex);
 
-        if (it == table_.end())
+        if (it == index_.end())
         {
-            SymbolInfo info;
-            info.entry = nextEntry_++;
+            SymbolInfo &info = symbols_.emplace_back();
+            info.entry = (int)symbols_.size();
             info.atomCode = tokenTypeToString(type);
             info.lexeme = truncatedLex;
             info.lenBefore = (int)lex.size();
             info.lenAfter = (int)truncatedLex.size();
             info.type = tokenTypeToString(TokenType::VOID);
-            info.lines.push_back(line);
-            table_[truncatedLex] = info;
+            info.arraySize = 0;
+            seedFromImports(info);
+            index_.emplace(info.lexeme, info.entry);
+            xref_.add(info.entry, offset, true);
 
             return info.entry;
         }
 
-        SymbolInfo &info = it->second;
+        xref_.add(it->second, offset, true);
+
+        return it->second;
+    }
+
+    // Registra uma ocorrência de um símbolo já definido sem alterar as linhas
+    // apresentadas no .TAB (ex.: referências dentro do corpo de funções)
+    void noteReference(std::string_view lex, size_t offset)
+    {
+        int entry = getIndex(lex);
+        if (entry > 0)
+            xref_.add(entry, offset, false);
+    }
+
+    // Ocorrência de um símbolo pela entrada; `counted` como em defineOrGet
+    // (aparece nas linhas do .TAB)
+    void noteReference(int entry, size_t offset, bool counted = false)
+    {
+        xref_.add(entry, offset, counted);
+    }
+
+    // Linhas apresentadas no .TAB: até 5 linhas das ocorrências contadas,
+    // ignorando repetições consecutivas da mesma linha
+    std::vector<int> tableLines(int entry) const
+    {
+        const size_t max = 5;
+        std::vector<int> out;
+        xref_.forEachUse(entry, [&](size_t offset, bool counted)
+                         {
+                             if (!counted || out.size() >= max)
+                                 return;
+                             int line = lines_.line(offset);
+                             if (out.empty() || out.back() != line)
+                                 out.push_back(line); });
+        return out;
+    }
+
+    // Todas as ocorrências (linha e coluna) do símbolo
+    std::vector<SourcePosition> usesOf(int entry) const
+    {
+        std::vector<SourcePosition> out;
+        xref_.forEachUse(entry, [&](size_t offset, bool)
+                         { out.push_back(lines_.position(offset)); });
+        return out;
+    }
+
+    std::vector<SourcePosition> usesOf(std::string_view lex) const
+    {
+        return usesOf(getIndex(lex));
+    }
+
+    // Lexemas dos símbolos usados na linha, em ordem de entrada
+    std::vector<std::string> symbolsOnLine(int line) const
+    {
+        size_t from = lines_.lineStart(line), to = lines_.lineStart(line + 1);
+        std::vector<int> entries;
+        xref_.forEachInRange(from, to, [&](size_t, int entry)
+                             { entries.push_back(entry); });
+        std::sort(entries.begin(), entries.end());
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+        std::vector<std::string> out;
+        for (int entry : entries)
+            out.emplace_back(symbols_[entry - 1].lexeme);
+        return out;
+    }
+
+    // Símbolos ainda não vistos no programa passam a receber tipo e extensão
+    // declarados na interface (a primeira importada que os declara)
+    void importInterface(const ModuleInterface &iface)
+    {
+        imports_.push_back(&iface);
+    }
+
+    const std::vector<const ModuleInterface *> &imports() const
+    {
+        return imports_;
+    }
 
-        if ((int)info.lines.size() < 5 && info.lines.back() != line)
-            info.lines.push_back(line);
+    const CrossReferenceIndex &crossReference() const
+    {
+        return xref_;
+    }
 
-        return info.entry;
+    void setType(std::string_view lex, std::string_view type)
+    {
+        SymbolInfo *info = find(lex);
+        if (info && isValidType(type))
+        {
+            info->type = type;
+        }
     }
 
-    void setType(const std::string &lex, const std::string &type)
+    void setArraySize(std::string_view lex, int size)
     {
-        auto it = table_.find(lex.substr(0, 35));
-        if (it != table_.end() && isValidType(type))
+        SymbolInfo *info = find(lex);
+        if (info)
         {
-            it->second.type = type;
+            info->arraySize = size;
         }
     }
 
-    const std::map<std::string, SymbolInfo> &all() const
+    // Versões pela entrada, sem procurar o lexema
+    void setType(int entry, std::string_view type)
+    {
+        if (isValidType(type))
+            symbols_[entry - 1].type = type;
+    }
+
+    void setArraySize(int entry, int size)
     {
-        return table_;
+        symbols_[entry - 1].arraySize = size;
     }
 
-    static bool isValidType(const std::string &type)
+    // Extensão declarada a partir do lexema do tamanho; um valor que não
+    // cabe em int fica como extensão desconhecida (0), e os acessos ao
+    // array mantêm a verificação de limites
+    static int parseArraySize(std::string_view lexeme)
     {
-        static const std::vector<std::string> validTypes = {
+        int size = 0;
+        auto result = std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), size);
+        return result.ec == std::errc() && result.ptr == lexeme.data() + lexeme.size() ? size : 0;
+    }
+
+    int getArraySize(std::string_view lex) const
+    {
+        const SymbolInfo *info = find(lex);
+        return info ? info->arraySize : 0;
+    }
+
+    // Símbolos na ordem de criação: o índice k guarda a entrada k + 1
+    const std::pmr::vector<SymbolInfo> &all() const
+    {
+        return symbols_;
+    }
+
+    // Símbolo pelo lexema (truncado em MAX_LEXEME), ou nulo
+    const SymbolInfo *find(std::string_view lex) const
+    {
+        auto it = index_.find(lex.substr(0, MAX_LEXEME));
+        return it != index_.end() ? &symbols_[it->second - 1] : nullptr;
+    }
+
+    SymbolInfo *find(std::string_view lex)
+    {
+        return const_cast<SymbolInfo *>(static_cast<const SymbolTable *>(this)->find(lex));
+    }
+
+    static bool isValidType(std::string_view type)
+    {
+        static const std::string_view validTypes[] = {
             "FP", // Floating Point
             "IN", // Integer
             "ST", // String
@@ -121,7 +299,7 @@ public:
             "AC", // Array of Character
             "AB", // Array of Boolean
         };
-        return std::find(validTypes.begin(), validTypes.end(), type) != validTypes.end();
+        return std::find(std::begin(validTypes), std::end(validTypes), type) != std::end(validTypes);
     }
 
     static std::string tokenTypeToString(TokenType t)
@@ -241,21 +419,61 @@ public:
         }
     }
 
-    int getIndex(const std::string &lex) const
+    int getIndex(std::string_view lex) const
     {
-        auto it = table_.find(lex.substr(0, 35));
-        return it != table_.end() ? it->second.entry : -1;
+        auto it = index_.find(lex.substr(0, MAX_LEXEME));
+        return it != index_.end() ? it->second : -1;
     }
 
+    // Lexemas de identificadores são truncados neste tamanho
+    static const size_t MAX_LEXEME = 35;
+
 private:
-    std::map<std::string, SymbolInfo> table_;
-    int nextEntry_;
+    // Entradas são criadas em ordem crescente: o vetor já está na ordem do
+    // .TAB, e o map só traduz lexema em entrada (std::less<> permite buscar
+    // por string_view)
+    std::pmr::vector<SymbolInfo> symbols_;
+    std::pmr::map<std::pmr::string, int, std::less<>> index_;
+    CrossReferenceIndex xref_;
+    LineIndex lines_;
+    std::vector<const ModuleInterface *> imports_;
+
+    void seedFromImports(SymbolInfo &info) const
+    {
+        for (const ModuleInterface *iface : imports_)
+        {
+            if (const InterfaceSymbol *sym = iface->findSymbol(info.lexeme))
+            {
+                std::string_view type = ModuleInterface::code(sym->type);
+                if (isValidType(type))
+                    info.type = type;
+                info.arraySize = sym->arraySize;
+                return;
+            }
+        }
+    }
 };
 
+// Registro de um lexema para o relatório .LEX. Num std::pmr::vector o
+// lexema usa o recurso de memória do vetor.
 struct LexemeRecord
 {
-    std::string lexeme;
-    TokenType type;
-    int tableIndex; // -1 se não for identificador
-    int line;
-};
\ No newline at end of file
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string lexeme;
+    TokenType type = TokenType::END_OF_FILE;
+    int tableIndex = -1; // -1 se não for identificador
+    size_t offset = 0;   // do token no texto (a linha sai do LineIndex)
+
+    LexemeRecord() = default;
+    explicit LexemeRecord(const allocator_type &alloc) : lexeme(alloc) {}
+    LexemeRecord(const LexemeRecord &other, const allocator_type &alloc = {})
+        : lexeme(other.lexeme, alloc), type(other.type), tableIndex(other.tableIndex), offset(other.offset) {}
+    LexemeRecord(LexemeRecord &&other, const allocator_type &alloc)
+        : lexeme(std::move(other.lexeme), alloc), type(other.type), tableIndex(other.tableIndex), offset(other.offset) {}
+    LexemeRecord(LexemeRecord &&other) = default;
+    LexemeRecord &operator=(const LexemeRecord &other) = default;
+    LexemeRecord &operator=(LexemeRecord &&other) = default;
+};
+
+using LexemeList = std::pmr::vector<LexemeRecord>;
\ No newline at end of file
@@ -1,3 +1,6 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
 #include <string>
 
 enum class TokenType
@@ -69,6 +72,7 @@ enum class TokenType
 struct Token
 {
     TokenType type;
-    std::string lexeme;
-    int line;
+    std::pmr::string lexeme; // no recurso de memória do lexer que o produziu
+    size_t offset = 0;       // posição do primeiro caractere no texto (linha e coluna pelo LineIndex)
+    size_t length = 0;       // caracteres consumidos no texto (inclui aspas)
 };
\ No newline at end of file
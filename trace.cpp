@@ -0,0 +1,277 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ===============================
+//  Linha do tempo das fases (--trace)
+// ===============================
+// Intervalos marcados com TRACE_SCOPE (leitura, análise, formatação e
+// gravação de cada fonte, passes de otimização, execução) são gravados no
+// formato de eventos do Chrome (JSON), aberto em chrome://tracing ou no
+// Perfetto, com uma linha por thread. Cada thread grava num buffer circular
+// próprio, sem travas: a trava só é usada uma vez por thread, para registrar
+// o buffer, e na gravação do arquivo. Quando o buffer enche, os eventos mais
+// antigos da thread são descartados e contados.
+//
+// Só existe compilando com -DCANGA_WITH_TRACE; sem ele as macros somem e
+// --trace é recusado.
+
+#ifdef CANGA_WITH_TRACE
+
+// Eventos guardados por thread (o buffer cresce até isso e passa a circular)
+const size_t TRACE_RING_EVENTS = 1 << 16;
+// Bytes do detalhe (nome do arquivo, etc.) copiados para cada evento
+const size_t TRACE_DETAIL_BYTES = 64;
+
+class TraceLog
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static bool enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Liga a gravação; a thread atual é chamada de `threadName`
+    static void start(const char *threadName)
+    {
+        epoch_ = Clock::now();
+        enabled_.store(true, std::memory_order_relaxed);
+        nameThread(threadName);
+    }
+
+    static void nameThread(const char *name)
+    {
+        if (enabled())
+            buffer().name = name;
+    }
+
+    // Intervalo [start, end) na thread atual
+    static void record(const char *name, std::string_view detail, Clock::time_point start, Clock::time_point end)
+    {
+        push(name, detail, start, end, false);
+    }
+
+    // Operação assíncrona (ex.: leitura no io_uring) que começou em `start`
+    // e terminou agora; aparece numa linha própria, fora das threads
+    static void recordAsync(const char *name, std::string_view detail, Clock::time_point start)
+    {
+        if (enabled())
+            push(name, detail, start, Clock::now(), true);
+    }
+
+    // Desliga a gravação e grava o JSON. As threads que gravaram eventos já
+    // devem ter terminado ou estar paradas
+    static void write(const std::string &path)
+    {
+        enabled_.store(false, std::memory_order_relaxed);
+        std::ofstream out(path, std::ios::binary);
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t lost = 0, asyncId = 0;
+        bool first = true;
+        auto separator = [&]() -> std::ostream &
+        {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            return out;
+        };
+        out << "{\"traceEvents\":[";
+        for (size_t t = 0; t < buffers_.size(); ++t)
+        {
+            const ThreadBuffer &b = *buffers_[t];
+            separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t + 1
+                        << ",\"args\":{\"name\":\"" << escaped(b.name) << "\"}}";
+            size_t count = b.count.load(std::memory_order_acquire);
+            size_t kept = std::min(count, b.events.size());
+            lost += count - kept;
+            for (size_t i = count - kept; i < count; ++i)
+            {
+                const Event &e = b.events[i % TRACE_RING_EVENTS];
+                std::string head = "{\"name\":\"" + escaped(e.name) + "\",\"cat\":\"" +
+                                   (e.async ? "io" : "fase") + "\",\"pid\":1,\"tid\":" + std::to_string(t + 1);
+                std::string args = e.detail[0] ? ",\"args\":{\"detalhe\":\"" + escaped(e.detail) + "\"}}" : "}";
+                if (e.async)
+                {
+                    std::string id = ",\"id\":" + std::to_string(++asyncId);
+                    separator() << head << id << ",\"ph\":\"b\",\"ts\":" << micros(e.start) << args;
+                    separator() << head << id << ",\"ph\":\"e\",\"ts\":" << micros(e.end) << "}";
+                }
+                else
+                    separator() << head << ",\"ph\":\"X\",\"ts\":" << micros(e.start)
+                                << ",\"dur\":" << micros(e.end - e.start) << args;
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"eventosDescartados\":" << lost << "}}\n";
+        if (!out.flush())
+            throw std::runtime_error("Erro ao gravar arquivo: " + path);
+    }
+
+private:
+    struct Event
+    {
+        const char *name;
+        int64_t start, end; // ns desde o início da gravação
+        bool async;
+        char detail[TRACE_DETAIL_BYTES];
+    };
+
+    struct ThreadBuffer
+    {
+        std::string name = "thread";
+        std::vector<Event> events;
+        std::atomic<size_t> count{0}; // eventos já gravados, inclusive descartados
+    };
+
+    static inline std::atomic<bool> enabled_{false};
+    static inline Clock::time_point epoch_;
+    static inline std::mutex mutex_;
+    static inline std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+
+    // Buffer da thread atual, registrado no primeiro evento. Os buffers
+    // pertencem a buffers_ e sobrevivem ao fim das threads
+    static ThreadBuffer &buffer()
+    {
+        thread_local ThreadBuffer *local = nullptr;
+        if (!local)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffers_.emplace_back(new ThreadBuffer());
+            local = buffers_.back().get();
+        }
+        return *local;
+    }
+
+    static void push(const char *name, std::string_view detail, Clock::time_point start, Clock::time_point end,
+                     bool async)
+    {
+        ThreadBuffer &b = buffer();
+        size_t n = b.count.load(std::memory_order_relaxed);
+        if (b.events.size() < TRACE_RING_EVENTS)
+            b.events.emplace_back();
+        Event &e = b.events[n % TRACE_RING_EVENTS];
+        e.name = name;
+        e.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count();
+        e.end = std::chrono::duration_cast<std::chrono::nanoseconds>(end - epoch_).count();
+        e.async = async;
+        copyDetail(e.detail, detail);
+        b.count.store(n + 1, std::memory_order_release);
+    }
+
+    friend class TraceScope;
+
+    // Caminhos longos perdem o começo, não o nome do arquivo
+    static void copyDetail(char (&to)[TRACE_DETAIL_BYTES], std::string_view detail)
+    {
+        if (detail.size() >= TRACE_DETAIL_BYTES)
+            detail.remove_prefix(detail.size() - (TRACE_DETAIL_BYTES - 1));
+        std::memcpy(to, detail.data(), detail.size());
+        to[detail.size()] = '\0';
+    }
+
+    static std::string micros(int64_t ns)
+    {
+        return std::to_string(ns / 1000) + "." + std::to_string(1000 + ns % 1000).substr(1);
+    }
+
+    static std::string escaped(std::string_view text)
+    {
+        std::string out;
+        for (unsigned char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            if (c < 0x20)
+            {
+                char hex[8];
+                std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+                out += hex;
+            }
+            else
+                out += (char)c;
+        }
+        return out;
+    }
+};
+
+// Marca o intervalo do escopo atual (só grava se a gravação estiver ligada);
+// o detalhe é copiado na entrada
+class TraceScope
+{
+public:
+    TraceScope(const char *name, std::string_view detail)
+        : name_(TraceLog::enabled() ? name : nullptr)
+    {
+        if (!name_)
+            return;
+        TraceLog::copyDetail(detail_, detail);
+        start_ = TraceLog::Clock::now();
+    }
+
+    ~TraceScope()
+    {
+        if (name_)
+            TraceLog::record(name_, detail_, start_, TraceLog::Clock::now());
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name_;
+    char detail_[TRACE_DETAIL_BYTES];
+    TraceLog::Clock::time_point start_;
+};
+
+// Liga a gravação ao ser criada e grava `path` ao sair de main
+class TraceSession
+{
+public:
+    explicit TraceSession(const std::string &path) : path_(path)
+    {
+        TraceLog::start("principal");
+    }
+
+    ~TraceSession()
+    {
+        try
+        {
+            TraceLog::write(path_);
+            std::cout << "Linha do tempo gerada: " << path_ << "\n";
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << "\n";
+        }
+    }
+
+    TraceSession(const TraceSession &) = delete;
+    TraceSession &operator=(const TraceSession &) = delete;
+
+private:
+    std::string path_;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// TRACE_SCOPE("nome", detalhe); sem -DCANGA_WITH_TRACE nada é avaliado
+#define TRACE_SCOPE(name, detail) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, detail)
+#define TRACE_THREAD(name) TraceLog::nameThread(name)
+
+#else
+
+#define TRACE_SCOPE(name, detail) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+
+#endif
@@ -0,0 +1,277 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CANGA_UTF8_X86 1
+#endif
+
+// ===============================
+//  Validação de UTF-8
+// ===============================
+// O texto fonte é validado de uma vez antes da análise léxica. A versão AVX2
+// segue o algoritmo de Keiser e Lemire: cada byte é classificado pelos
+// nibbles dele e do byte anterior com três consultas a tabelas (pshufb), o
+// que cobre sequências curtas/longas demais, codificações longas, surrogates
+// e valores acima de U+10FFFF; a exigência de 2º/3º bytes de continuação é
+// verificada à parte. Blocos só com ASCII pulam a classificação.
+// Quando há erro, a varredura escalar é refeita a partir da última fronteira
+// de caractere conhecida para obter a posição exata.
+
+struct Utf8Scan
+{
+    bool ascii = true;                        // nenhum byte >= 0x80
+    size_t errorOffset = std::string::npos;   // primeiro byte inválido
+
+    bool valid() const
+    {
+        return errorOffset == std::string::npos;
+    }
+};
+
+// Valida um caractere começando em `i`; devolve o tamanho da sequência ou 0
+inline size_t utf8SequenceLength(const unsigned char *s, size_t n, size_t i)
+{
+    unsigned char c = s[i];
+    if (c < 0x80)
+        return 1;
+
+    size_t len;
+    unsigned char lo = 0x80, hi = 0xBF; // faixa permitida para o 2º byte
+    if (c >= 0xC2 && c <= 0xDF)
+        len = 2;
+    else if (c >= 0xE0 && c <= 0xEF)
+    {
+        len = 3;
+        if (c == 0xE0)
+            lo = 0xA0; // codificação longa
+        else if (c == 0xED)
+            hi = 0x9F; // surrogates
+    }
+    else if (c >= 0xF0 && c <= 0xF4)
+    {
+        len = 4;
+        if (c == 0xF0)
+            lo = 0x90; // codificação longa
+        else if (c == 0xF4)
+            hi = 0x8F; // acima de U+10FFFF
+    }
+    else
+        return 0;
+
+    if (len > n - i || s[i + 1] < lo || s[i + 1] > hi)
+        return 0;
+    for (size_t k = 2; k < len; ++k)
+        if ((s[i + k] & 0xC0) != 0x80)
+            return 0;
+    return len;
+}
+
+inline Utf8Scan scanUtf8Scalar(const char *data, size_t size, size_t from = 0)
+{
+    const unsigned char *s = (const unsigned char *)data;
+    Utf8Scan out;
+    size_t i = from;
+    while (i < size)
+    {
+        // ASCII em palavras de 8 bytes
+        while (i + 8 <= size)
+        {
+            uint64_t w;
+            std::memcpy(&w, s + i, sizeof(w));
+            if (w & 0x8080808080808080ULL)
+                break;
+            i += 8;
+        }
+        if (i >= size)
+            break;
+        if (s[i] < 0x80)
+        {
+            ++i;
+            continue;
+        }
+        out.ascii = false;
+        size_t len = utf8SequenceLength(s, size, i);
+        if (!len)
+        {
+            out.errorOffset = i;
+            return out;
+        }
+        i += len;
+    }
+    return out;
+}
+
+#ifdef CANGA_UTF8_X86
+namespace utf8Avx2
+{
+#define CANGA_UTF8_AVX2 __attribute__((target("avx2")))
+
+    // Bits de erro das tabelas (um por tipo de sequência inválida)
+    const uint8_t TOO_SHORT = 1 << 0;
+    const uint8_t TOO_LONG = 1 << 1;
+    const uint8_t OVERLONG_3 = 1 << 2;
+    const uint8_t TOO_LARGE = 1 << 3;
+    const uint8_t SURROGATE = 1 << 4;
+    const uint8_t OVERLONG_2 = 1 << 5;
+    const uint8_t TOO_LARGE_1000 = 1 << 6;
+    const uint8_t OVERLONG_4 = 1 << 6;
+    const uint8_t TWO_CONTS = 1 << 7;
+    const uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    CANGA_UTF8_AVX2 static inline __m256i table(uint8_t t0, uint8_t t1, uint8_t t2, uint8_t t3,
+                                                uint8_t t4, uint8_t t5, uint8_t t6, uint8_t t7,
+                                                uint8_t t8, uint8_t t9, uint8_t t10, uint8_t t11,
+                                                uint8_t t12, uint8_t t13, uint8_t t14, uint8_t t15)
+    {
+        return _mm256_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15,
+                                t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15);
+    }
+
+    // Bytes de `input` deslocados N posições, completados com o fim do bloco anterior
+    template <int N>
+    CANGA_UTF8_AVX2 static inline __m256i prev(__m256i input, __m256i previous)
+    {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+    }
+
+    CANGA_UTF8_AVX2 static inline __m256i high(__m256i v)
+    {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    CANGA_UTF8_AVX2 static inline __m256i checkBlock(__m256i input, __m256i previous)
+    {
+        const __m256i byte1High = table(
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2,
+            TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+        const __m256i byte1Low = table(
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+            CARRY | OVERLONG_2,
+            CARRY, CARRY,
+            CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000);
+        const __m256i byte2High = table(
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+        __m256i prev1 = prev<1>(input, previous);
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(byte1High, high(prev1)),
+                             _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+            _mm256_shuffle_epi8(byte2High, high(input)));
+
+        // Depois de um líder de 3 ou 4 bytes, o 2º/3º byte seguinte tem de ser continuação
+        __m256i third = _mm256_subs_epu8(prev<2>(input, previous), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+        __m256i fourth = _mm256_subs_epu8(prev<3>(input, previous), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+        __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+        return _mm256_xor_si256(must23, special);
+    }
+
+    // Sequência começada nos últimos 3 bytes e ainda não terminada
+    CANGA_UTF8_AVX2 static inline __m256i incomplete(__m256i input)
+    {
+        const __m256i maxValue = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+        return _mm256_subs_epu8(input, maxValue);
+    }
+
+    CANGA_UTF8_AVX2 static Utf8Scan scan(const char *data, size_t size, size_t from)
+    {
+        Utf8Scan out;
+        __m256i previous = _mm256_setzero_si256();
+        __m256i pending = _mm256_setzero_si256(); // sequência incompleta no fim do bloco anterior
+        size_t safe = from;                       // início de caractere conhecido
+        size_t i = from;
+        bool error = false;
+
+        while (i < size && !error)
+        {
+            __m256i input;
+            if (i + 32 <= size)
+                input = _mm256_loadu_si256((const __m256i *)(data + i));
+            else
+            {
+                // Último bloco completado com zeros (ASCII)
+                alignas(32) char tail[32] = {0};
+                std::memcpy(tail, data + i, size - i);
+                input = _mm256_load_si256((const __m256i *)tail);
+            }
+
+            if (_mm256_testz_si256(pending, pending))
+                safe = i;
+
+            if (!_mm256_movemask_epi8(input))
+            {
+                // Bloco ASCII: só a sequência pendente pode estar errada
+                error = !_mm256_testz_si256(pending, pending);
+                pending = _mm256_setzero_si256();
+            }
+            else
+            {
+                out.ascii = false;
+                __m256i err = checkBlock(input, previous);
+                error = !_mm256_testz_si256(err, err);
+                pending = incomplete(input);
+            }
+            previous = input;
+            i += 32;
+        }
+        if (!error && !_mm256_testz_si256(pending, pending))
+            error = true;
+
+        if (error)
+        {
+            // Posição exata pela varredura escalar a partir da última fronteira
+            Utf8Scan exact = scanUtf8Scalar(data, size, safe);
+            out.errorOffset = exact.errorOffset;
+        }
+        return out;
+    }
+}
+
+inline bool utf8HasAvx2()
+{
+    static const bool has = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return has;
+}
+#else
+inline bool utf8HasAvx2()
+{
+    return false;
+}
+#endif
+
+// Valida data[from, size); `from` deve ser o início de um caractere
+inline Utf8Scan scanUtf8(const char *data, size_t size, size_t from = 0, bool vectorized = utf8HasAvx2())
+{
+#ifdef CANGA_UTF8_X86
+    if (vectorized)
+        return utf8Avx2::scan(data, size, from);
+#else
+    (void)vectorized;
+#endif
+    return scanUtf8Scalar(data, size, from);
+}